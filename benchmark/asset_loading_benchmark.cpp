@@ -0,0 +1,147 @@
+#include "common/common.h"
+
+#include "core/pak_archive.h"
+#include "core/resource_data.h"
+#include "os/timer.h"
+
+/// Headless benchmark that loads every file under a directory, game/assets by default, once as loose files
+/// and once out of a .pak archive. The loose run pays for the directory traversal, a stat and an open per file,
+/// the archive run pays for a table of contents lookup and decompression per file.
+/// Usage: AssetLoadingBenchmark [directory] [archive.pak]. Without an archive, the directory is packed after the first loose run.
+/// Only the first run of each can be cold. For cold start numbers, empty the OS file cache before running,
+/// with a reboot or by emptying the standby list with RAMMap, and pass an archive packed beforehand.
+
+static const int RunCount = 5;
+
+struct LoadResult
+{
+	float m_Ms = 0.0f;
+	int m_FileCount = 0;
+	unsigned long long m_Bytes = 0;
+};
+
+void CollectFiles(const String& directory, Vector<FilePath>& files)
+{
+	for (auto& file : OS::GetFilesInDirectory(directory))
+	{
+		files.push_back(file);
+	}
+	for (auto& subDirectory : OS::GetDirectoriesInDirectory(directory))
+	{
+		CollectFiles(subDirectory.generic_string(), files);
+	}
+}
+
+LoadResult LoadLooseFiles(const String& directory)
+{
+	LoadResult result;
+	StopTimer timer;
+
+	Vector<FilePath> files;
+	CollectFiles(directory, files);
+	for (auto& file : files)
+	{
+		if (OS::IsExists(file.generic_string()))
+		{
+			result.m_Bytes += OS::LoadFileContents(file.generic_string()).size();
+			result.m_FileCount++;
+		}
+	}
+
+	result.m_Ms = timer.getTimeMs();
+	return result;
+}
+
+LoadResult LoadArchivedFiles(const String& archivePath)
+{
+	LoadResult result;
+	StopTimer timer;
+
+	Ptr<PakArchive> archive = PakArchive::Open(archivePath);
+	if (!archive)
+	{
+		return result;
+	}
+	for (int i = 0; i < archive->getEntryCount(); i++)
+	{
+		const PakEntry* entry = archive->find(archive->getEntryPath(archive->getEntry(i)));
+		if (entry)
+		{
+			result.m_Bytes += archive->load(entry).size();
+			result.m_FileCount++;
+		}
+	}
+
+	result.m_Ms = timer.getTimeMs();
+	return result;
+}
+
+bool PackDirectory(const String& directory, const FilePath& archivePath)
+{
+	Vector<FilePath> files;
+	CollectFiles(directory, files);
+
+	PakWriter writer;
+	for (auto& file : files)
+	{
+		writer.add(file.generic_string(), OS::GetAbsolutePath(file.generic_string()), file.extension() != ".wav" && file.extension() != ".ogg");
+	}
+	return writer.write(archivePath);
+}
+
+void PrintResult(const String& name, const LoadResult& result)
+{
+	OS::Print(name
+	    + ": " + std::to_string(result.m_Ms) + "ms"
+	    + " for " + std::to_string(result.m_FileCount) + " files"
+	    + ", " + std::to_string(result.m_Bytes * B_TO_KB * KB_TO_MB) + " MB");
+}
+
+void PrintAverage(const String& name, const Vector<LoadResult>& results)
+{
+	float totalMs = 0.0f;
+	for (int i = 1; i < results.size(); i++)
+	{
+		totalMs += results[i].m_Ms;
+	}
+	OS::Print(name + ": " + std::to_string(totalMs / (results.size() - 1)) + "ms on average over " + std::to_string(results.size() - 1) + " warm runs");
+}
+
+int main(int argc, char* argv[])
+{
+	OS::Initialize();
+	const String directory = argc > 1 ? argv[1] : "game/assets";
+	OS::Print("Asset loading benchmark: " + directory + ". " + OS::GetBuildType() + " build");
+
+	Vector<LoadResult> looseResults;
+	looseResults.push_back(LoadLooseFiles(directory));
+	PrintResult("Loose files, first run", looseResults.front());
+
+	String archivePath;
+	if (argc > 2)
+	{
+		archivePath = argv[2];
+	}
+	else
+	{
+		archivePath = (std::filesystem::temp_directory_path() / "asset_loading_benchmark.pak").generic_string();
+		if (!PackDirectory(directory, archivePath))
+		{
+			return 1;
+		}
+	}
+
+	Vector<LoadResult> archiveResults;
+	archiveResults.push_back(LoadArchivedFiles(archivePath));
+	PrintResult("Archive, first run", archiveResults.front());
+
+	for (int i = 1; i < RunCount; i++)
+	{
+		looseResults.push_back(LoadLooseFiles(directory));
+		archiveResults.push_back(LoadArchivedFiles(archivePath));
+	}
+	PrintAverage("Loose files", looseResults);
+	PrintAverage("Archive", archiveResults);
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "common/common.h"
+
+#include "core/audio/audio_mixer.h"
+#include "os/timer.h"
+
+/// Headless benchmark that renders growing numbers of voices through the software AudioMixer, without an audio device,
+/// and reports the mixing cost per voice. Pass a path to also save the mix of the first run as a .wav file.
+
+static const float SampleRate = 48000.0f;
+static const float RenderSeconds = 10.0f;
+static const int VoiceCounts[] = { 16, 64, 256, 1024 };
+
+/// One second of a sine wave at a frequency, at 44.1 kHz so that the mixer has to resample it.
+Ref<MixerSound> CreateTone(float frequency, int channels)
+{
+	const float toneSampleRate = 44100.0f;
+	Vector<float> samples((int)toneSampleRate * channels);
+	for (int i = 0; i < samples.size() / channels; i++)
+	{
+		float value = 0.25f * sinf(DirectX::XM_2PI * frequency * i / toneSampleRate);
+		for (int c = 0; c < channels; c++)
+		{
+			samples[i * channels + c] = value;
+		}
+	}
+	return Ref<MixerSound>(new MixerSound(std::move(samples), channels, toneSampleRate));
+}
+
+/// Sets up a mixer with half mono and half stereo voices spread around the listener, split over 2 buses.
+void SetupMixer(AudioMixer& mixer, int voiceCount)
+{
+	Ref<MixerSound> mono = CreateTone(440.0f, 1);
+	Ref<MixerSound> stereo = CreateTone(220.0f, 2);
+	AudioMixer::BusID effects = mixer.addBus(0.8f);
+	AudioMixer::BusID music = mixer.addBus(0.5f);
+
+	for (int i = 0; i < voiceCount; i++)
+	{
+		AudioMixer::VoiceID voice = mixer.addVoice(i % 2 ? stereo : mono, i % 2 ? music : effects);
+		mixer.setLooping(voice, true);
+		mixer.setGain(voice, 1.0f / voiceCount);
+		mixer.setPan(voice, (i % 9) / 4.0f - 1.0f);
+		mixer.setPitch(voice, 0.5f + (i % 7) * 0.25f);
+		mixer.setPosition(voice, { (float)(i % 32), 0.0f, (float)(i / 32) });
+		mixer.setAttenuation(voice, (AudioSource::AttenuationModel)(i % 3 ? AL_INVERSE_DISTANCE_CLAMPED : AL_LINEAR_DISTANCE_CLAMPED), 1.0f, 50.0f, 1.0f);
+		mixer.play(voice);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	OS::Initialize();
+	OS::Print("Audio mixer benchmark: " + std::to_string(RenderSeconds) + "s at " + std::to_string((int)SampleRate) + " Hz. " + OS::GetBuildType() + " build");
+
+	for (int voiceCount : VoiceCounts)
+	{
+		AudioMixer mixer(SampleRate);
+		SetupMixer(mixer, voiceCount);
+
+		Vector<float> output;
+		StopTimer timer;
+		mixer.render(output, RenderSeconds);
+		float totalMs = timer.getTimeMs();
+
+		OS::Print(std::to_string(voiceCount) + " voices: " + std::to_string(totalMs) + "ms"
+		    + ", " + std::to_string(totalMs / RenderSeconds) + "ms per second of audio"
+		    + ", " + std::to_string(totalMs * 1000.0f / RenderSeconds / voiceCount) + "us per voice per second of audio");
+	}
+
+	if (argc > 1)
+	{
+		AudioMixer mixer(SampleRate);
+		SetupMixer(mixer, VoiceCounts[0]);
+		if (mixer.renderToWAV(argv[1], RenderSeconds))
+		{
+			OS::Print("Saved mix to " + String(argv[1]));
+		}
+	}
+
+	return 0;
+}
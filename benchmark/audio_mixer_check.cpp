@@ -0,0 +1,261 @@
+#include "check.h"
+
+#include "core/audio/audio_dsp.h"
+#include "core/audio/audio_mixer.h"
+
+/// Headless check of the software AudioMixer and the SSE kernels in AudioDSP. Offline renders have to be bit identical between runs,
+/// and every SSE kernel has to match a plain scalar version of it. Does not need an audio device.
+/// Exits with 1 if any check fails.
+
+static const float SampleRate = 48000.0f;
+/// Sizes that are not multiples of 4 or 8, so that the SSE kernels also take their scalar tails
+static const int SampleCount = 1021;
+static const float Tolerance = 1e-5f;
+
+/// Pseudo random floats in [minimum, maximum), the same on every run.
+static Vector<float> CreateValues(int count, float minimum, float maximum, unsigned int seed)
+{
+	Vector<float> values(count);
+	for (float& value : values)
+	{
+		seed = seed * 1103515245 + 12345;
+		value = minimum + (maximum - minimum) * ((seed >> 8) & 0xffff) / 65536.0f;
+	}
+	return values;
+}
+
+static float MaxDifference(const Vector<float>& a, const Vector<float>& b)
+{
+	float difference = 0.0f;
+	for (int i = 0; i < a.size(); i++)
+	{
+		difference = std::max(difference, fabsf(a[i] - b[i]));
+	}
+	return difference;
+}
+
+/// Mixes voices of every attenuation model, pitch and pan into 2 buses, like AudioMixerBenchmark.
+static void RenderMix(Vector<float>& output)
+{
+	AudioMixer mixer(SampleRate);
+	Ref<MixerSound> mono(new MixerSound(CreateValues(44100, -0.25f, 0.25f, 1), 1, 44100.0f));
+	Ref<MixerSound> stereo(new MixerSound(CreateValues(2 * 22050, -0.25f, 0.25f, 2), 2, 22050.0f));
+	AudioMixer::BusID effects = mixer.addBus(0.8f);
+	AudioMixer::BusID music = mixer.addBus(0.5f);
+
+	const AudioSource::AttenuationModel models[] = {
+		AudioSource::AttenuationModel::Linear,
+		AudioSource::AttenuationModel::Inverse,
+		AudioSource::AttenuationModel::Exponential,
+		AudioSource::AttenuationModel::LinearClamped,
+		AudioSource::AttenuationModel::InverseClamped,
+		AudioSource::AttenuationModel::ExponentialClamped
+	};
+	const int voiceCount = 64;
+	for (int i = 0; i < voiceCount; i++)
+	{
+		AudioMixer::VoiceID voice = mixer.addVoice(i % 2 ? stereo : mono, i % 2 ? music : effects);
+		mixer.setLooping(voice, i % 5 != 0);
+		mixer.setGain(voice, 1.0f / voiceCount);
+		mixer.setPan(voice, (i % 9) / 4.0f - 1.0f);
+		mixer.setPitch(voice, 0.5f + (i % 7) * 0.25f);
+		mixer.setPosition(voice, { (float)(i % 8), 0.0f, (float)(i / 8) });
+		mixer.setAttenuation(voice, models[i % 6], 1.0f, 20.0f, 1.0f);
+		mixer.play(voice);
+	}
+	mixer.setListenerPosition({ 2.0f, 0.0f, 1.0f });
+	mixer.render(output, 2.0f);
+}
+
+static void CheckDeterministicRender()
+{
+	Vector<float> first;
+	Vector<float> second;
+	RenderMix(first);
+	RenderMix(second);
+	Check(!first.empty() && first.size() == second.size(), "offline renders have the same length");
+	Check(first.size() == second.size() && memcmp(first.data(), second.data(), first.size() * sizeof(float)) == 0, "offline renders are bit identical between runs");
+	Check(std::any_of(first.begin(), first.end(), [](float sample) { return sample != 0.0f; }), "offline render is not silent");
+}
+
+static void CheckAttenuation()
+{
+	const AudioSource::AttenuationModel models[] = {
+		AudioSource::AttenuationModel::Linear,
+		AudioSource::AttenuationModel::Inverse,
+		AudioSource::AttenuationModel::Exponential,
+		AudioSource::AttenuationModel::LinearClamped,
+		AudioSource::AttenuationModel::InverseClamped,
+		AudioSource::AttenuationModel::ExponentialClamped
+	};
+	// Distances inside and outside the reference and max distances, and max distances below the reference distance
+	const Vector<float> distances = CreateValues(SampleCount, 0.0f, 60.0f, 3);
+	const Vector<float> referenceDistances = CreateValues(SampleCount, 0.5f, 5.0f, 4);
+	const Vector<float> maxDistances = CreateValues(SampleCount, 0.0f, 50.0f, 5);
+	const Vector<float> rolloffFactors = CreateValues(SampleCount, 0.0f, 3.0f, 6);
+
+	for (AudioSource::AttenuationModel model : models)
+	{
+		Vector<float> gains(SampleCount);
+		Vector<float> scalarGains(SampleCount);
+		AudioDSP::Attenuate(model, distances.data(), referenceDistances.data(), maxDistances.data(), rolloffFactors.data(), gains.data(), SampleCount);
+		for (int i = 0; i < SampleCount; i++)
+		{
+			scalarGains[i] = AudioDSP::Attenuate(model, distances[i], referenceDistances[i], maxDistances[i], rolloffFactors[i]);
+		}
+		Check(MaxDifference(gains, scalarGains) <= Tolerance, "SSE attenuation matches the scalar path for model " + std::to_string((int)model));
+	}
+
+	Check(AudioDSP::Attenuate(AudioSource::AttenuationModel::InverseClamped, 0.5f, 1.0f, 10.0f, 1.0f) == 1.0f, "clamped inverse attenuation does not boost inside the reference distance");
+	Check(fabsf(AudioDSP::Attenuate(AudioSource::AttenuationModel::InverseClamped, 4.0f, 1.0f, 10.0f, 1.0f) - 0.25f) <= Tolerance, "inverse attenuation follows OpenAL");
+	Check(AudioDSP::Attenuate(AudioSource::AttenuationModel::LinearClamped, 30.0f, 1.0f, 10.0f, 1.0f) == 0.0f, "linear attenuation is silent past the max distance");
+}
+
+static void CheckGainAndPan()
+{
+	const int frames = SampleCount;
+	const Vector<float> mono = CreateValues(frames, -1.0f, 1.0f, 7);
+	const Vector<float> stereo = CreateValues(frames * 2, -1.0f, 1.0f, 8);
+	const Vector<float> start = CreateValues(frames * 2, -1.0f, 1.0f, 9);
+
+	for (float pan : { -1.0f, -0.3f, 0.0f, 0.7f, 1.0f })
+	{
+		float leftGain;
+		float rightGain;
+
+		AudioDSP::GetPanGains(pan, 1, leftGain, rightGain);
+		leftGain *= 0.6f;
+		rightGain *= 0.6f;
+		Vector<float> output = start;
+		Vector<float> scalarOutput = start;
+		AudioDSP::MixMono(mono.data(), frames, leftGain, rightGain, output.data());
+		for (int i = 0; i < frames; i++)
+		{
+			scalarOutput[i * 2] += mono[i] * leftGain;
+			scalarOutput[i * 2 + 1] += mono[i] * rightGain;
+		}
+		Check(MaxDifference(output, scalarOutput) <= Tolerance, "SSE mono mix matches the scalar path at pan " + std::to_string(pan));
+
+		AudioDSP::GetPanGains(pan, 2, leftGain, rightGain);
+		leftGain *= 0.6f;
+		rightGain *= 0.6f;
+		output = start;
+		scalarOutput = start;
+		AudioDSP::MixStereo(stereo.data(), frames, leftGain, rightGain, output.data());
+		for (int i = 0; i < frames; i++)
+		{
+			scalarOutput[i * 2] += stereo[i * 2] * leftGain;
+			scalarOutput[i * 2 + 1] += stereo[i * 2 + 1] * rightGain;
+		}
+		Check(MaxDifference(output, scalarOutput) <= Tolerance, "SSE stereo mix matches the scalar path at pan " + std::to_string(pan));
+	}
+
+	float leftGain;
+	float rightGain;
+	AudioDSP::GetPanGains(0.0f, 1, leftGain, rightGain);
+	Check(fabsf(leftGain * leftGain + rightGain * rightGain - 1.0f) <= Tolerance && fabsf(leftGain - rightGain) <= Tolerance, "centered mono pan keeps constant power");
+	AudioDSP::GetPanGains(-1.0f, 1, leftGain, rightGain);
+	Check(fabsf(leftGain - 1.0f) <= Tolerance && fabsf(rightGain) <= Tolerance, "mono panned fully left is silent on the right");
+	AudioDSP::GetPanGains(0.5f, 2, leftGain, rightGain);
+	Check(leftGain == 0.5f && rightGain == 1.0f, "stereo pan is a balance");
+
+	// A voice panned fully right, at half gain, into a bus at half gain
+	AudioMixer mixer(SampleRate);
+	Ref<MixerSound> constant(new MixerSound(Vector<float>(4800, 0.8f), 1, SampleRate));
+	AudioMixer::VoiceID voice = mixer.addVoice(constant, mixer.addBus(0.5f));
+	mixer.setGain(voice, 0.5f);
+	mixer.setPan(voice, 1.0f);
+	mixer.play(voice);
+	Vector<float> output;
+	mixer.render(output, 0.05f);
+	bool isPanned = !output.empty();
+	for (int i = 0; i < output.size(); i += 2)
+	{
+		isPanned &= fabsf(output[i]) <= Tolerance && fabsf(output[i + 1] - 0.2f) <= Tolerance;
+	}
+	Check(isPanned, "mixer applies voice gain, bus gain and pan");
+}
+
+static void CheckResample()
+{
+	const Vector<float> samples = CreateValues(SampleCount * 2, -1.0f, 1.0f, 10);
+	for (int channels : { 1, 2 })
+	{
+		const int frameCount = SampleCount * 2 / channels;
+		for (double step : { 0.37, 1.0, 1.7 })
+		{
+			const int outputFrames = 501;
+			Vector<float> output(outputFrames * channels);
+			double cursor = 3.25;
+			int produced = AudioDSP::Resample(samples.data(), frameCount, channels, cursor, step, false, output.data(), outputFrames);
+
+			Vector<float> scalarOutput(outputFrames * channels);
+			for (int frame = 0; frame < outputFrames; frame++)
+			{
+				double position = 3.25 + frame * step;
+				int index = (int)position;
+				float fraction = (float)(position - index);
+				for (int c = 0; c < channels; c++)
+				{
+					float a = samples[index * channels + c];
+					float b = samples[(index + 1) * channels + c];
+					scalarOutput[frame * channels + c] = a + (b - a) * fraction;
+				}
+			}
+			Check(produced == outputFrames && MaxDifference(output, scalarOutput) <= Tolerance,
+			    "SSE resampling matches linear interpolation for " + std::to_string(channels) + " channels at step " + std::to_string(step));
+		}
+	}
+}
+
+static void CheckPCMConversion()
+{
+	// Every 16 bit value, plus a few more so that the SSE loops leave a tail
+	Vector<short> pcm(65536 + 5);
+	for (int i = 0; i < pcm.size(); i++)
+	{
+		pcm[i] = (short)(i % 65536 - 32768);
+	}
+	Vector<float> samples(pcm.size());
+	AudioDSP::ConvertFromPCM16(pcm.data(), pcm.size(), samples.data());
+	bool isScaled = true;
+	for (int i = 0; i < pcm.size(); i++)
+	{
+		isScaled &= samples[i] == pcm[i] / 32768.0f;
+	}
+	Check(isScaled, "16 bit PCM converts to floats in [-1, 1]");
+
+	Vector<short> roundTrip(pcm.size());
+	AudioDSP::ConvertToPCM16(samples.data(), samples.size(), roundTrip.data());
+	int maxDifference = 0;
+	for (int i = 0; i < pcm.size(); i++)
+	{
+		maxDifference = std::max(maxDifference, abs(pcm[i] - roundTrip[i]));
+	}
+	// Floats are converted back with a scale of 32767, so that 1 does not overflow
+	Check(maxDifference <= 1, "16 bit PCM round trips through floats within 1");
+
+	const Vector<float> clipped = { -2.0f, -1.0f, 0.0f, 1.0f, 2.0f, 0.5f, -0.5f, 1e-6f, 1.5f };
+	Vector<short> clippedPCM(clipped.size());
+	AudioDSP::ConvertToPCM16(clipped.data(), clipped.size(), clippedPCM.data());
+	Check(clippedPCM[0] == -32767 && clippedPCM[1] == -32767 && clippedPCM[2] == 0 && clippedPCM[3] == 32767 && clippedPCM[4] == 32767 && clippedPCM[8] == 32767,
+	    "floats outside [-1, 1] are clipped");
+
+	const unsigned char pcm8[] = { 0, 128, 255 };
+	float samples8[3];
+	AudioDSP::ConvertFromPCM8(pcm8, 3, samples8);
+	Check(samples8[0] == -1.0f && samples8[1] == 0.0f && samples8[2] == 127.0f / 128.0f, "8 bit PCM converts to floats in [-1, 1]");
+}
+
+int main()
+{
+	OS::Initialize();
+
+	CheckDeterministicRender();
+	CheckAttenuation();
+	CheckGainAndPan();
+	CheckResample();
+	CheckPCMConversion();
+
+	return FinishChecks("audio mixer");
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Harness shared by the headless checks in benchmark/. Every check is its own executable, so the state lives in this header.
+
+/// Number of checks that failed so far.
+static int FailedCount = 0;
+
+/// Print whether a check passed, counting it if it failed.
+static void Check(bool isPassed, const String& name)
+{
+	OS::Print(String(isPassed ? "Passed: " : "Failed: ") + name, isPassed ? "Print" : "Warning");
+	FailedCount += isPassed ? 0 : 1;
+}
+
+/// Print how many of the named checks failed. Returns the exit code of the check, which is 1 if any failed.
+static int FinishChecks(const String& name)
+{
+	OS::Print(std::to_string(FailedCount) + " " + name + " checks failed");
+	return FailedCount ? 1 : 0;
+}
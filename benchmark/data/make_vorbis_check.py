@@ -0,0 +1,844 @@
+#!/usr/bin/env python3
+"""Minimal Ogg Vorbis encoder written straight from the Vorbis I spec, that makes the stream VorbisCheck decodes.
+
+Usage: make_vorbis_check.py out.ogg [seed]. Writes out.ogg and out.pcm, the 16 bit interleaved PCM that a decoder
+following the spec reconstructs from out.ogg, computed in double precision.
+
+It exercises ordered, sparse and single-entry codebooks, lookup types 1 and 2 with sequence_p,
+floor 1 with subclasses, residue types 0, 1 and 2, cascades with high bits, submaps, coupling,
+unused floors, short/long block transitions, packets spanning pages and granule trimming.
+"""
+import math, random, struct, sys
+
+random.seed(int(sys.argv[2]) if len(sys.argv) > 2 else 1)
+
+# ---------------------------------------------------------------- bits
+
+class BitWriter:
+    def __init__(self):
+        self.buf = bytearray()
+        self.bit = 0
+
+    def write(self, value, n):
+        for i in range(n):
+            if self.bit % 8 == 0:
+                self.buf.append(0)
+            if (value >> i) & 1:
+                self.buf[-1] |= 1 << (self.bit % 8)
+            self.bit += 1
+
+    def data(self):
+        return bytes(self.buf)
+
+
+def ilog(v):
+    return v.bit_length() if v > 0 else 0
+
+
+def float32_pack(x):
+    if x == 0:
+        return 0
+    sign = 0
+    if x < 0:
+        sign = 0x80000000
+        x = -x
+    e = math.frexp(x)[1]
+    mant = int(round(x * 2 ** (21 - e)))
+    if mant == 2 ** 21:
+        mant //= 2
+        e += 1
+    exp = e - 21 + 788
+    assert 0 < mant < 2 ** 21 and 0 <= exp < 1024
+    return sign | (exp << 21) | mant
+
+
+def float32_unpack(v):
+    mant = v & 0x1fffff
+    exp = (v & 0x7fe00000) >> 21
+    if v & 0x80000000:
+        mant = -mant
+    return math.ldexp(mant, exp - 788)
+
+# ---------------------------------------------------------------- codebooks
+
+def assign_codewords(lengths):
+    """Lowest valued codeword of each length that does not clash with earlier ones (spec section 3.2.1)."""
+    assigned = []
+    words = []
+    for length in lengths:
+        if length == 0:
+            words.append(None)
+            continue
+        found = None
+        for c in range(2 ** length):
+            bits = format(c, '0%db' % length)
+            if any(bits.startswith(a) or a.startswith(bits) for a in assigned):
+                continue
+            found = bits
+            break
+        assert found is not None, 'overspecified'
+        assigned.append(found)
+        words.append(found)
+    return words
+
+
+class Codebook:
+    def __init__(self, dims, lengths, ordered=False, sparse=False, lookup=None):
+        self.dims = dims
+        self.lengths = lengths
+        self.ordered = ordered
+        self.sparse = sparse
+        self.lookup = lookup
+        used = [i for i, l in enumerate(lengths) if l]
+        if len(used) == 1:
+            self.words = [None] * len(lengths)
+            self.words[used[0]] = '0'
+        else:
+            self.words = assign_codewords(lengths)
+        self.vectors = None
+        self.index = {}
+        if lookup:
+            ltype, minimum, delta, valuebits, seq, mults = lookup
+            mn = float32_unpack(float32_pack(minimum))
+            dl = float32_unpack(float32_pack(delta))
+            entries = len(lengths)
+            if ltype == 1:
+                lv = 0
+                while (lv + 1) ** dims <= entries:
+                    lv += 1
+                assert len(mults) == lv
+            else:
+                assert len(mults) == entries * dims
+            self.vectors = []
+            for e in range(entries):
+                last = 0.0
+                div = 1
+                vec = []
+                for i in range(dims):
+                    off = (e // div) % lv if ltype == 1 else e * dims + i
+                    v = mults[off] * dl + mn + last
+                    vec.append(v)
+                    if seq:
+                        last = v
+                    div *= lv if ltype == 1 else 1
+                self.vectors.append(tuple(vec))
+                if lengths[e]:
+                    self.index.setdefault(tuple(int(round(x)) for x in vec), e)
+
+    def write_header(self, w):
+        n = len(self.lengths)
+        w.write(0x564342, 24)
+        w.write(self.dims, 16)
+        w.write(n, 24)
+        if self.ordered:
+            w.write(1, 1)
+            cur = self.lengths[0]
+            w.write(cur - 1, 5)
+            e = 0
+            while e < n:
+                count = 0
+                while e + count < n and self.lengths[e + count] == cur:
+                    count += 1
+                w.write(count, ilog(n - e))
+                e += count
+                cur += 1
+        else:
+            w.write(0, 1)
+            w.write(1 if self.sparse else 0, 1)
+            for l in self.lengths:
+                if self.sparse:
+                    w.write(1 if l else 0, 1)
+                    if l:
+                        w.write(l - 1, 5)
+                else:
+                    w.write(l - 1, 5)
+        if not self.lookup:
+            w.write(0, 4)
+        else:
+            ltype, minimum, delta, valuebits, seq, mults = self.lookup
+            w.write(ltype, 4)
+            w.write(float32_pack(minimum), 32)
+            w.write(float32_pack(delta), 32)
+            w.write(valuebits - 1, 4)
+            w.write(1 if seq else 0, 1)
+            for m in mults:
+                w.write(m, valuebits)
+
+    def write_entry(self, w, e):
+        word = self.words[e]
+        assert word is not None, 'unused entry %d' % e
+        for b in word:
+            w.write(int(b), 1)
+
+    def write_vector(self, w, vec):
+        self.write_entry(w, self.index[tuple(vec)])
+
+# ---------------------------------------------------------------- setup
+
+books = []
+
+def add(book):
+    books.append(book)
+    return len(books) - 1
+
+# Floor books
+F0 = add(Codebook(1, [1] + [9] * 255, ordered=True))
+MB = add(Codebook(1, [2, 2, 2, 2]))
+F1 = add(Codebook(1, [8] * 200 + [0] * 56, sparse=True))
+# Irregular lengths from the example in the spec, padded to a full tree
+IRR = add(Codebook(1, [2, 4, 4, 4, 4, 2, 3, 3]))
+# Residue classbooks
+CB3 = add(Codebook(2, [4] * 9))
+CB4 = add(Codebook(2, [4] * 16))
+# Residue VQ books, lookup type 1 over 9 values
+C64 = add(Codebook(2, [7] * 81, lookup=(1, -256, 64, 4, False, list(range(9)))))
+C8 = add(Codebook(2, [7] * 81, lookup=(1, -32, 8, 4, False, list(range(9)))))
+C1 = add(Codebook(2, [7] * 81, lookup=(1, -4, 1, 4, False, list(range(9)))))
+# Lookup type 2 with sequence_p: vectors in {-1, 0, 1}^4 stored as differences
+seq_vectors = [tuple(((e // 3 ** i) % 3) - 1 for i in range(4)) for e in range(81)]
+seq_mults = []
+for v in seq_vectors:
+    last = 0
+    for x in v:
+        seq_mults.append(x - last + 2)
+        last = x
+SEQ = add(Codebook(4, [7] * 81, lookup=(2, -2, 1, 3, True, seq_mults)))
+# A single entry book, used as the classbook of a residue with one classification
+ONE = add(Codebook(1, [1] + [0] * 3, sparse=True))
+
+# Floors: partitions of classes, class 0 is 3 values from F0, class 1 is 2 values from F1 or none
+classes = [
+    dict(dims=3, subbits=0, master=-1, subbooks=[F0]),
+    dict(dims=2, subbits=1, master=MB, subbooks=[-1, F1]),
+    dict(dims=1, subbits=0, master=-1, subbooks=[IRR]),
+]
+floors = [
+    dict(multiplier=2, rangebits=6, partitions=[0, 1, 2], X=[0, 64, 8, 32, 48, 4, 60, 20]),
+    dict(multiplier=2, rangebits=9, partitions=[0, 1, 0, 2], X=[0, 512, 32, 128, 256, 8, 400, 64, 16, 200, 100]),
+]
+
+residues = [
+    dict(type=0, begin=0, end=64, psize=8, classbook=CB3, books=[[], [SEQ], [C64, C8, C1]]),
+    dict(type=1, begin=0, end=512, psize=16, classbook=CB4, books=[[], [C1], [C64, C8, C1], [None, None, None, C1]]),
+    dict(type=2, begin=0, end=1024, psize=32, classbook=CB4, books=[[], [C1], [C64, C8, C1], [None, None, None, C1]]),
+    dict(type=1, begin=16, end=500, psize=16, classbook=CB4, books=[[], [C1], [C64, C8, C1], [None, None, None, C1]]),
+    dict(type=1, begin=0, end=64, psize=8, classbook=ONE, books=[[C64, C8, C1]]),
+]
+
+mappings = [
+    dict(submaps=[(0, 0)], mux=[0, 0], coupling=[]),
+    dict(submaps=[(1, 1), (1, 3)], mux=[0, 1], coupling=[]),
+    dict(submaps=[(1, 2)], mux=[0, 0], coupling=[(0, 1)]),
+    dict(submaps=[(0, 4)], mux=[0, 0], coupling=[(1, 0)]),
+]
+modes = [(0, 0), (1, 1), (1, 2), (0, 3)]
+
+CHANNELS = 2
+RATE = 8000
+SHORT, LONG = 128, 1024
+
+
+def header_packets():
+    w = BitWriter()
+    w.write(1, 8)
+    for c in b'vorbis':
+        w.write(c, 8)
+    w.write(0, 32)
+    w.write(CHANNELS, 8)
+    w.write(RATE, 32)
+    w.write(0, 32); w.write(64000, 32); w.write(0, 32)
+    w.write(ilog(SHORT) - 1, 4)
+    w.write(ilog(LONG) - 1, 4)
+    w.write(1, 1)
+    ident = w.data()
+
+    w = BitWriter()
+    w.write(3, 8)
+    for c in b'vorbis':
+        w.write(c, 8)
+    vendor = b'test encoder'
+    w.write(len(vendor), 32)
+    for c in vendor:
+        w.write(c, 8)
+    w.write(1, 32)
+    comment = b'TITLE=test'
+    w.write(len(comment), 32)
+    for c in comment:
+        w.write(c, 8)
+    w.write(1, 1)
+    comment_packet = w.data()
+
+    w = BitWriter()
+    w.write(5, 8)
+    for c in b'vorbis':
+        w.write(c, 8)
+    w.write(len(books) - 1, 8)
+    for b in books:
+        b.write_header(w)
+    w.write(0, 6); w.write(0, 16)
+    w.write(len(floors) - 1, 6)
+    for f in floors:
+        w.write(1, 16)
+        w.write(len(f['partitions']), 5)
+        for p in f['partitions']:
+            w.write(p, 4)
+        for c in classes[:max(f['partitions']) + 1]:
+            w.write(c['dims'] - 1, 3)
+            w.write(c['subbits'], 2)
+            if c['subbits']:
+                w.write(c['master'], 8)
+            for sb in c['subbooks']:
+                w.write(sb + 1, 8)
+        w.write(f['multiplier'] - 1, 2)
+        w.write(f['rangebits'], 4)
+        for x in f['X'][2:]:
+            w.write(x, f['rangebits'])
+    w.write(len(residues) - 1, 6)
+    for r in residues:
+        w.write(r['type'], 16)
+        w.write(r['begin'], 24)
+        w.write(r['end'], 24)
+        w.write(r['psize'] - 1, 24)
+        w.write(len(r['books']) - 1, 6)
+        w.write(r['classbook'], 8)
+        for bl in r['books']:
+            cascade = sum(1 << i for i, b in enumerate(bl) if b is not None)
+            w.write(cascade & 7, 3)
+            if cascade >> 3:
+                w.write(1, 1)
+                w.write(cascade >> 3, 5)
+            else:
+                w.write(0, 1)
+        for bl in r['books']:
+            for b in bl:
+                if b is not None:
+                    w.write(b, 8)
+    w.write(len(mappings) - 1, 6)
+    for m in mappings:
+        w.write(0, 16)
+        if len(m['submaps']) > 1:
+            w.write(1, 1)
+            w.write(len(m['submaps']) - 1, 4)
+        else:
+            w.write(0, 1)
+        if m['coupling']:
+            w.write(1, 1)
+            w.write(len(m['coupling']) - 1, 8)
+            for mag, ang in m['coupling']:
+                w.write(mag, ilog(CHANNELS - 1))
+                w.write(ang, ilog(CHANNELS - 1))
+        else:
+            w.write(0, 1)
+        w.write(0, 2)
+        if len(m['submaps']) > 1:
+            for mx in m['mux']:
+                w.write(mx, 4)
+        for fl, rs in m['submaps']:
+            w.write(0, 8)
+            w.write(fl, 8)
+            w.write(rs, 8)
+    w.write(len(modes) - 1, 6)
+    for blockflag, mapping in modes:
+        w.write(blockflag, 1)
+        w.write(0, 16)
+        w.write(0, 16)
+        w.write(mapping, 8)
+    w.write(1, 1)
+    return ident, comment_packet, w.data()
+
+# ---------------------------------------------------------------- floor 1
+
+DB = [math.exp(math.log(1.0649863e-07) * (255 - i) / 255) for i in range(256)]
+RANGES = [256, 128, 86, 64]
+
+
+def render_point(x0, y0, x1, y1, x):
+    dy = y1 - y0
+    adx = x1 - x0
+    err = abs(dy) * (x - x0)
+    off = int(err / adx)
+    return y0 - off if dy < 0 else y0 + off
+
+
+def render_line(x0, y0, x1, y1, v, n):
+    dy = y1 - y0
+    adx = x1 - x0
+    ady = abs(dy)
+    base = int(dy / adx)
+    sy = base - 1 if dy < 0 else base + 1
+    ady -= abs(base) * adx
+    x, y, err = x0, y0, 0
+    if x < n:
+        v[x] = y
+    for x in range(x0 + 1, x1):
+        err += ady
+        if err >= adx:
+            err -= adx
+            y += sy
+        else:
+            y += base
+        if x < n:
+            v[x] = y
+
+
+def neighbors(X, i):
+    low = max((j for j in range(i) if X[j] < X[i]), key=lambda j: X[j])
+    high = min((j for j in range(i) if X[j] > X[i]), key=lambda j: X[j])
+    return low, high
+
+
+def floor_synthesis(f, vals, n):
+    X = f['X']
+    rng = RANGES[f['multiplier'] - 1]
+    fy = [vals[0], vals[1]] + [0] * (len(X) - 2)
+    step2 = [True, True] + [False] * (len(X) - 2)
+    for i in range(2, len(X)):
+        lo, hi = neighbors(X, i)
+        pred = render_point(X[lo], fy[lo], X[hi], fy[hi], X[i])
+        val = vals[i]
+        hr = rng - pred
+        lr = pred
+        room = hr * 2 if hr < lr else lr * 2
+        if val:
+            step2[lo] = step2[hi] = step2[i] = True
+            if val >= room:
+                fy[i] = val - lr + pred if hr > lr else pred - val + hr - 1
+            else:
+                fy[i] = pred - (val + 1) // 2 if val % 2 else pred + val // 2
+        else:
+            fy[i] = pred
+    order = sorted(range(len(X)), key=lambda i: X[i])
+    curve = [0] * n
+    lx, ly = 0, fy[order[0]] * f['multiplier']
+    hx, hy = 0, 0
+    for i in order[1:]:
+        if step2[i]:
+            hy = fy[i] * f['multiplier']
+            hx = X[i]
+            render_line(lx, ly, hx, hy, curve, n)
+            lx, ly = hx, hy
+    if hx < n:
+        render_line(hx, hy, n, hy, curve, n)
+    return [DB[min(max(c, 0), 255)] for c in curve]
+
+
+def floor_encode(f, spectrum, n):
+    """Pick floor values that sit above the spectrum, returning the coded values and the floor curve."""
+    X = f['X']
+    rng = RANGES[f['multiplier'] - 1]
+    mult = f['multiplier']
+
+    def desired(x):
+        lo = max(0, x - max(4, n // 6))
+        hi = min(n, x + max(4, n // 6))
+        peak = max(abs(v) for v in spectrum[lo:hi]) if hi > lo else 0
+        target = max(peak / 100.0, 1e-6)
+        y = 0
+        while y < rng - 1 and DB[min(y * mult, 255)] < target:
+            y += 1
+        return y
+
+    vals = [desired(0), desired(min(X[1], n - 1))] + [0] * (len(X) - 2)
+    fy = [vals[0], vals[1]] + [0] * (len(X) - 2)
+    # Which class and subclass book each point is coded with, to know which values are allowed
+    point_book = [None, None]
+    for p in f['partitions']:
+        c = classes[p]
+        for j in range(c['dims']):
+            point_book.append(c)
+    for i in range(2, len(X)):
+        lo, hi = neighbors(X, i)
+        pred = render_point(X[lo], fy[lo], X[hi], fy[hi], X[i])
+        want = desired(min(X[i], n - 1))
+        hr, lr = rng - pred, pred
+        room = hr * 2 if hr < lr else lr * 2
+        if want == pred:
+            val = 0
+        elif want > pred and (want - pred) * 2 < room:
+            val = (want - pred) * 2
+        elif want < pred and (pred - want) * 2 - 1 < room:
+            val = (pred - want) * 2 - 1
+        elif hr > lr:
+            val = want - pred + lr
+        else:
+            val = pred + hr - 1 - want
+        c = point_book[i]
+        limit = 199 if c is classes[1] else (7 if c is classes[2] else 255)
+        if val > limit or val < 0:
+            val = 0
+        vals[i] = val
+        # Work out the final value the decoder will see
+        if val:
+            if val >= room:
+                fy[i] = val - lr + pred if hr > lr else pred - val + hr - 1
+            else:
+                fy[i] = pred - (val + 1) // 2 if val % 2 else pred + val // 2
+        else:
+            fy[i] = pred
+    return vals, floor_synthesis(f, vals, n)
+
+
+def floor_write(w, f, vals):
+    w.write(1, 1)
+    rng = RANGES[f['multiplier'] - 1]
+    w.write(vals[0], ilog(rng - 1))
+    w.write(vals[1], ilog(rng - 1))
+    off = 2
+    for p in f['partitions']:
+        c = classes[p]
+        cval = 0
+        subs = []
+        for j in range(c['dims']):
+            if c['subbits']:
+                sub = 1 if vals[off + j] else 0
+            else:
+                sub = 0
+            subs.append(sub)
+            cval |= sub << (j * c['subbits'])
+        if c['subbits']:
+            books[c['master']].write_entry(w, cval)
+        for j in range(c['dims']):
+            book = c['subbooks'][subs[j]]
+            if book >= 0:
+                books[book].write_entry(w, vals[off + j])
+            else:
+                assert vals[off + j] == 0
+        off += c['dims']
+
+# ---------------------------------------------------------------- residue
+
+def decompose(q):
+    c0 = max(-4, min(4, int(round(q / 64.0))))
+    r = q - 64 * c0
+    c1 = max(-4, min(4, int(round(r / 8.0))))
+    r -= 8 * c1
+    assert -4 <= r <= 4, q
+    return [c0, c1, r]
+
+
+def residue_write(w, r, vectors, skipped):
+    n = len(vectors[0])
+    if r['type'] == 2:
+        if all(skipped):
+            return
+        inter = [0] * (n * len(vectors))
+        for ch, v in enumerate(vectors):
+            for i in range(n):
+                inter[i * len(vectors) + ch] = v[i]
+        vectors = [inter]
+        skipped = [False]
+        n = len(inter)
+    cb = books[r['classbook']]
+    cw = cb.dims
+    ncls = len(r['books'])
+    begin = min(r['begin'], n)
+    end = min(r['end'], n)
+    P = (end - begin) // r['psize'] if end > begin else 0
+
+    cls = []
+    for ch, v in enumerate(vectors):
+        row = []
+        for p in range(P):
+            part = v[begin + p * r['psize']: begin + (p + 1) * r['psize']]
+            mx = max(abs(x) for x in part)
+            if ncls == 1:
+                row.append(0)
+            elif mx == 0:
+                row.append(0)
+            elif mx <= 1 and r['books'][1] == [SEQ]:
+                row.append(1)
+            elif mx <= 4 and ncls > 1 and r['books'][1] == [C1]:
+                row.append(1 if (p % 2 == 0 or ncls < 4) else 3)
+            else:
+                row.append(2)
+        cls.append(row)
+
+    for pss in range(8):
+        p = 0
+        while p < P:
+            if pss == 0:
+                for ch in range(len(vectors)):
+                    if skipped[ch]:
+                        continue
+                    temp = 0
+                    for i in range(cw):
+                        c = cls[ch][p + i] if p + i < P else 0
+                        temp = temp * ncls + c
+                    cb.write_entry(w, temp)
+            for i in range(cw):
+                if p >= P:
+                    break
+                for ch in range(len(vectors)):
+                    if skipped[ch]:
+                        continue
+                    bl = r['books'][cls[ch][p]]
+                    if pss >= len(bl) or bl[pss] is None:
+                        continue
+                    book = books[bl[pss]]
+                    part = vectors[ch][begin + p * r['psize']: begin + (p + 1) * r['psize']]
+                    if bl == [C64, C8, C1]:
+                        vals = [decompose(x)[pss] * (64, 8, 1)[pss] for x in part]
+                    else:
+                        vals = part
+                    d = book.dims
+                    if r['type'] == 0:
+                        step = r['psize'] // d
+                        for k in range(step):
+                            book.write_vector(w, [vals[k + j * step] for j in range(d)])
+                    else:
+                        for k in range(0, r['psize'], d):
+                            book.write_vector(w, vals[k:k + d])
+                p += 1
+
+# ---------------------------------------------------------------- transform
+
+def slope(i, n):
+    x = math.sin((i + 0.5) / n * math.pi / 2)
+    return math.sin(math.pi / 2 * x * x)
+
+
+def window(n, prev_long, next_long):
+    w = [0.0] * n
+    ls = SHORT // 2 if (n == LONG and not prev_long) else n // 2
+    rs = SHORT // 2 if (n == LONG and not next_long) else n // 2
+    lstart = n // 4 - ls // 2
+    rstart = n * 3 // 4 - rs // 2
+    for i in range(n):
+        if i < lstart:
+            w[i] = 0.0
+        elif i < lstart + ls:
+            w[i] = slope(i - lstart, ls)
+        elif i < rstart:
+            w[i] = 1.0
+        elif i < rstart + rs:
+            w[i] = slope(rs - 1 - (i - rstart), rs)
+        else:
+            w[i] = 0.0
+    return w
+
+
+cos_tables = {}
+
+
+def imdct(X, n):
+    if n not in cos_tables:
+        mdct([0.0] * n, n)
+    t = cos_tables[n]
+    return [sum(X[k] * t[k][i] for k in range(n // 2)) for i in range(n)]
+
+
+def mdct(x, n):
+    if n not in cos_tables:
+        cos_tables[n] = [[math.cos(2 * math.pi / n * (i + 0.5 + n / 4) * (k + 0.5)) for i in range(n)] for k in range(n // 2)]
+    t = cos_tables[n]
+    scale = 4.0 / n
+    return [scale * sum(a * b for a, b in zip(x, row)) for row in t]
+
+# ---------------------------------------------------------------- ogg
+
+def crc_table():
+    t = []
+    for i in range(256):
+        r = i << 24
+        for _ in range(8):
+            r = ((r << 1) ^ 0x04c11db7) if r & 0x80000000 else r << 1
+        t.append(r & 0xffffffff)
+    return t
+
+CRC = crc_table()
+
+
+def page(serial, seq, flags, granule, segs, body):
+    hdr = b'OggS' + bytes([0, flags]) + struct.pack('<qII', granule, serial, seq) + b'\0\0\0\0' + bytes([len(segs)]) + bytes(segs)
+    data = bytearray(hdr + body)
+    crc = 0
+    for b in data:
+        crc = ((crc << 8) & 0xffffffff) ^ CRC[((crc >> 24) & 0xff) ^ b]
+    data[22:26] = struct.pack('<I', crc)
+    return bytes(data)
+
+
+def paginate(serial, packets, seq_start, max_segs_fn, first_flags=0, last=False, final_granule=None):
+    """packets: list of (bytes, granule). Returns pages and the next sequence number."""
+    out = []
+    seq = seq_start
+    segs, body, granule = [], b'', -1
+    cont = False
+    flags = first_flags
+    maxs = max_segs_fn()
+    for pi, (data, gran) in enumerate(packets):
+        lace = []
+        rem = len(data)
+        while rem >= 255:
+            lace.append(255)
+            rem -= 255
+        lace.append(rem)
+        pos = 0
+        for li, l in enumerate(lace):
+            if len(segs) == maxs:
+                out.append(page(serial, seq, flags | (1 if cont else 0), granule, segs, body))
+                seq += 1
+                flags = 0
+                cont = li > 0
+                segs, body, granule = [], b'', -1
+                maxs = max_segs_fn()
+            segs.append(l)
+            body += data[pos:pos + l]
+            pos += l
+        granule = gran
+    if segs:
+        if last and final_granule is not None:
+            granule = final_granule
+        out.append(page(serial, seq, flags | (1 if cont else 0) | (4 if last else 0), granule, segs, body))
+        seq += 1
+    return out, seq
+
+# ---------------------------------------------------------------- main
+
+def main():
+    out_path = sys.argv[1]
+    length = int(RATE * 0.6) + random.randint(0, 300)
+    sig = [[0.0] * length for _ in range(CHANNELS)]
+    for i in range(length):
+        t = i / RATE
+        env = 0.6 + 0.4 * math.sin(2 * math.pi * 1.5 * t)
+        sig[0][i] = 0.35 * env * math.sin(2 * math.pi * 330 * t) + 0.1 * math.sin(2 * math.pi * 1250 * t)
+        # The second channel is silent for a while so its floor goes unused
+        if 0.2 < t < 0.32:
+            sig[1][i] = 0.0
+        else:
+            sig[1][i] = 0.25 * math.sin(2 * math.pi * 523 * t + 1.0) + 0.05 * math.sin(2 * math.pi * 2100 * t)
+    # A click that a real encoder would use short blocks for
+    for i in range(length // 2, length // 2 + 6):
+        sig[0][i] += 0.3
+
+    # Block sizes and positions
+    sizes = []
+    starts = []
+    s = -LONG // 2
+    n = LONG
+    while True:
+        sizes.append(n)
+        starts.append(s)
+        if s + n // 2 >= length:
+            break
+        nxt = LONG if random.random() < 0.6 else SHORT
+        s = s + n * 3 // 4 - nxt // 4
+        n = nxt
+
+    packets = []
+    total = 0
+    recon = [[0.0] * length for _ in range(CHANNELS)]
+    for k, n in enumerate(sizes):
+        prev_long = sizes[k - 1] == LONG if k > 0 else True
+        next_long = sizes[k + 1] == LONG if k + 1 < len(sizes) else True
+        win = window(n, prev_long, next_long)
+        if n == SHORT:
+            mode = 0 if random.random() < 0.6 else 3
+        else:
+            mode = 1 if random.random() < 0.5 else 2
+        mapping = mappings[modes[mode][1]]
+        half = n // 2
+
+        specs = []
+        for ch in range(CHANNELS):
+            x = [sig[ch][starts[k] + i] * win[i] if 0 <= starts[k] + i < length else 0.0 for i in range(n)]
+            specs.append(mdct(x, n))
+
+        w = BitWriter()
+        w.write(0, 1)
+        w.write(mode, ilog(len(modes) - 1))
+        if n == LONG:
+            w.write(1 if prev_long else 0, 1)
+            w.write(1 if next_long else 0, 1)
+
+        used = []
+        curves = []
+        floor_vals = []
+        for ch in range(CHANNELS):
+            f = floors[mapping['submaps'][mapping['mux'][ch]][0]]
+            if max(abs(v) for v in specs[ch]) < 1e-7:
+                used.append(False)
+                curves.append(None)
+                floor_vals.append(None)
+                continue
+            vals, curve = floor_encode(f, specs[ch], half)
+            used.append(True)
+            curves.append(curve)
+            floor_vals.append(vals)
+        for ch in range(CHANNELS):
+            if used[ch]:
+                floor_write(w, floors[mapping['submaps'][mapping['mux'][ch]][0]], floor_vals[ch])
+            else:
+                w.write(0, 1)
+
+        limit = 144 if mapping['coupling'] else 288
+        q = []
+        for ch in range(CHANNELS):
+            if not used[ch]:
+                q.append([0] * half)
+            else:
+                q.append([max(-limit, min(limit, int(round(specs[ch][i] / curves[ch][i])))) for i in range(half)])
+            # Bins below the begin of a residue are not coded
+            r = residues[mapping['submaps'][mapping['mux'][ch]][1]]
+            for i in range(half):
+                coded_end = r['begin'] + (r['end'] - r['begin']) // r['psize'] * r['psize']
+                if i < r['begin'] or i >= coded_end:
+                    if r['type'] != 2:
+                        q[ch][i] = 0
+        # What a decoder reconstructs, before windowing
+        for ch in range(CHANNELS):
+            spec = [q[ch][i] * curves[ch][i] if used[ch] else 0.0 for i in range(half)]
+            y = imdct(spec, n)
+            for i in range(n):
+                pos = starts[k] + i
+                if 0 <= pos < length:
+                    recon[ch][pos] += y[i] * win[i]
+        skipped = [not u for u in used]
+        for mag, ang in mapping['coupling']:
+            if not skipped[mag] or not skipped[ang]:
+                skipped[mag] = skipped[ang] = False
+            M, A = q[mag], q[ang]
+            for i in range(half):
+                L, R = M[i], A[i]
+                if L > 0 and L > R:
+                    m, a = L, L - R
+                elif R > 0 and L <= R:
+                    m, a = R, L - R
+                elif L <= 0 and R > L:
+                    m, a = L, R - L
+                else:
+                    m, a = R, R - L
+                M[i], A[i] = m, a
+        for sm, (fl, rs) in enumerate(mapping['submaps']):
+            chs = [ch for ch in range(CHANNELS) if mapping['mux'][ch] == sm]
+            residue_write(w, residues[rs], [q[ch] for ch in chs], [skipped[ch] for ch in chs])
+
+        frames = sizes[k - 1] // 4 + n // 4 if k > 0 else 0
+        total += frames
+        packets.append((w.data(), total))
+
+    serial = 0x1234abcd
+    ident, comment, setup = header_packets()
+    pages = []
+    p, seq = paginate(serial, [(ident, 0)], 0, lambda: 255, first_flags=2)
+    pages += p
+    p, seq = paginate(serial, [(comment, 0), (setup, 0)], seq, lambda: random.choice([3, 255]))
+    pages += p
+    p, seq = paginate(serial, packets, seq, lambda: random.randint(2, 20), last=True, final_granule=length)
+    pages += p
+    # A page of another logical stream in the middle, which must be skipped
+    other = page(0x55555555, 0, 2, 0, [5], b'hello')
+    mid = len(pages) // 2
+    pages.insert(mid, other)
+    with open(out_path, 'wb') as f:
+        f.write(b''.join(pages))
+    pcm = []
+    for i in range(length):
+        for ch in range(CHANNELS):
+            pcm.append(max(-32768, min(32767, math.floor(recon[ch][i] * 32768 + 0.5))))
+    with open(out_path[:-len('.ogg')] + '.pcm', 'wb') as f:
+        f.write(struct.pack('<%dh' % len(pcm), *pcm))
+
+
+main()
@@ -0,0 +1,146 @@
+#include "check.h"
+
+#include "core/input/input_recording.h"
+
+/// Headless check of the .rinput format of InputRecording. Saves a recording and loads it back, then loads truncated and corrupt copies of it.
+/// Writes the recordings under benchmark/results/input_recording_check.
+/// Exits with 1 if any check fails.
+
+static const String CheckDirectory = "benchmark/results/input_recording_check/";
+static const String RecordingPath = CheckDirectory + "recording.rinput";
+static const String CorruptPath = CheckDirectory + "corrupt.rinput";
+
+static void WriteFile(const String& path, const String& contents)
+{
+	OutputFileStream(OS::GetAbsolutePath(path), std::ios::binary) << contents;
+}
+
+/// A recording with bool and float changes of 3 actions, with tick deltas that take 1 to 3 varint bytes.
+static void AddChanges(InputRecording& recording)
+{
+	recording.add(0, "Jump", false, 0.0f, 1.0f);
+	recording.add(0, "MouseX", true, 0.0f, -0.5f);
+	recording.add(1, "Jump", false, 1.0f, 0.0f);
+	recording.add(130, "MouseX", true, -0.5f, 1234.25f);
+	recording.add(130, "Fire", false, 0.0f, 1.0f);
+	recording.add(130 + 20000, "Fire", false, 1.0f, 0.0f);
+	recording.add(130 + 20000, "MouseX", true, 1234.25f, 1e-7f);
+}
+
+static String CreateRecordingFile(unsigned int actionCount, unsigned int changeCount, unsigned int action)
+{
+	InputRecordingHeader header;
+	memcpy(header.m_Magic, INPUT_RECORDING_MAGIC, 4);
+	header.m_Version = INPUT_RECORDING_VERSION;
+	header.m_TickRate = 60.0f;
+	header.m_ActionCount = actionCount;
+	header.m_ChangeCount = changeCount;
+
+	String file((const char*)&header, sizeof(header));
+	file += (char)4;
+	file += "Jump";
+	// Tick delta, action index and float flag, and the old and new value bits of a bool change
+	file += (char)0;
+	file += (char)(action << 1);
+	file += (char)2;
+	return file;
+}
+
+static void CheckRoundTrip()
+{
+	InputRecording recording(60.0f);
+	AddChanges(recording);
+	Check(recording.save(RecordingPath), "recording is saved");
+
+	Ptr<InputRecording> loaded = InputRecording::Load(RecordingPath);
+	Check(loaded != nullptr, "saved recording loads");
+	if (!loaded)
+	{
+		return;
+	}
+	Check(loaded->getTickRate() == 60.0f, "tick rate is loaded");
+
+	const Vector<InputChange>& changes = recording.getChanges();
+	const Vector<InputChange>& loadedChanges = loaded->getChanges();
+	Check(loadedChanges.size() == changes.size(), "every change is loaded");
+	bool isSame = loadedChanges.size() == changes.size();
+	for (int i = 0; isSame && i < changes.size(); i++)
+	{
+		isSame = loadedChanges[i].m_Tick == changes[i].m_Tick
+		    && loaded->getAction(loadedChanges[i].m_Action) == recording.getAction(changes[i].m_Action)
+		    && loadedChanges[i].m_IsFloat == changes[i].m_IsFloat;
+	}
+	Check(isSame, "ticks, actions and value types are loaded in order");
+
+	bool isFloatSame = isSame;
+	bool isBoolSame = isSame;
+	for (int i = 0; isSame && i < changes.size(); i++)
+	{
+		bool isValueSame = memcmp(&loadedChanges[i].m_OldValue, &changes[i].m_OldValue, sizeof(float)) == 0
+		    && memcmp(&loadedChanges[i].m_NewValue, &changes[i].m_NewValue, sizeof(float)) == 0;
+		(changes[i].m_IsFloat ? isFloatSame : isBoolSame) &= isValueSame;
+	}
+	Check(isFloatSame, "float values are loaded bit for bit");
+	Check(isBoolSame, "bool values are loaded as 0 and 1");
+
+	InputRecording boolRecording(60.0f);
+	boolRecording.add(0, "Jump", false, 0.25f, -3.0f);
+	boolRecording.save(CorruptPath);
+	loaded = InputRecording::Load(CorruptPath);
+	Check(loaded && loaded->getChanges()[0].m_OldValue == 1.0f && loaded->getChanges()[0].m_NewValue == 1.0f, "any bool value that is not 0 is saved as 1");
+}
+
+static void CheckTruncated()
+{
+	const FileBuffer file = OS::LoadFileContents(RecordingPath);
+	bool isRejected = !file.empty();
+	for (size_t size = 0; size < file.size(); size++)
+	{
+		WriteFile(CorruptPath, String(file.data(), size));
+		if (InputRecording::Load(CorruptPath))
+		{
+			isRejected = false;
+			Check(false, "recording cut to " + std::to_string(size) + " of " + std::to_string(file.size()) + " bytes is rejected");
+		}
+	}
+	Check(isRejected, "recording cut at every byte is rejected");
+}
+
+static void CheckCorrupt()
+{
+	WriteFile(CorruptPath, CreateRecordingFile(1, 1, 0));
+	Check(InputRecording::Load(CorruptPath) != nullptr, "handmade recording loads");
+
+	WriteFile(CorruptPath, CreateRecordingFile(1, 1, 1));
+	Check(InputRecording::Load(CorruptPath) == nullptr, "change with an action index past the action names is rejected");
+
+	WriteFile(CorruptPath, CreateRecordingFile(1, 1000000, 0));
+	Check(InputRecording::Load(CorruptPath) == nullptr, "change count larger than the file is rejected");
+
+	WriteFile(CorruptPath, CreateRecordingFile(1000000, 1, 0));
+	Check(InputRecording::Load(CorruptPath) == nullptr, "action count larger than the file is rejected");
+
+	String file = CreateRecordingFile(1, 1, 0);
+	file[0] = 'X';
+	WriteFile(CorruptPath, file);
+	Check(InputRecording::Load(CorruptPath) == nullptr, "file without the magic is rejected");
+
+	file = CreateRecordingFile(1, 1, 0);
+	file[4] = INPUT_RECORDING_VERSION + 1;
+	WriteFile(CorruptPath, file);
+	Check(InputRecording::Load(CorruptPath) == nullptr, "other version is rejected");
+
+	Check(InputRecording::Load(CheckDirectory + "missing.rinput") == nullptr, "missing file is rejected");
+}
+
+int main()
+{
+	OS::Initialize();
+	OS::CreateDirectoryName(CheckDirectory);
+
+	CheckRoundTrip();
+	CheckTruncated();
+	CheckCorrupt();
+
+	return FinishChecks("input recording");
+}
@@ -0,0 +1,459 @@
+#include "common/common.h"
+
+#include "app/application.h"
+#include "app/level_manager.h"
+#include "core/input/input_manager.h"
+#include "core/renderer/gpu_profiler.h"
+#include "framework/systems/audio_system.h"
+#include "framework/systems/physics_system.h"
+#include "framework/systems/render_system.h"
+#include "framework/systems/render_ui_system.h"
+#include "framework/systems/script_system.h"
+#include "framework/systems/transform_animation_system.h"
+#include "framework/systems/ui_system.h"
+#include "os/metrics.h"
+
+#include <Psapi.h>
+
+/// Headless benchmark that loads a level and runs it for a fixed number of frames, each advancing the simulation by exactly one tick.
+/// Levels are named in the "benchmark" section of benchmark/benchmark.app.json, together with the presses sent to them or an input recording to replay.
+/// Levels with "generateEntities" are written out the first time they are run.
+/// Rendering is skipped unless --render is passed. The device runs on the WARP software rasterizer, so no GPU is needed.
+/// Usage: RootexBench <level> [--frames N] [--warmup N] [--render] [--replay input.rinput] [--out results.json] [--baseline baseline.json] [--tolerance 0.1]
+/// Reports per system times, frame times, allocations and peak memory as JSON. With a baseline, exits with 1 if anything got slower than the tolerance allows.
+
+static std::atomic<unsigned long long> AllocationCount = 0;
+static std::atomic<unsigned long long> AllocatedBytes = 0;
+
+void* operator new(size_t size)
+{
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept
+{
+	std::free(memory);
+}
+
+/// Metrics that are compared against the baseline. Higher is worse for all of them.
+static bool IsCompared(const String& name)
+{
+	for (const char* prefix : { "System Time/", "Frame Time", "Allocat", "Peak Memory" })
+	{
+		if (name.rfind(prefix, 0) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static JSON::json MakeTransform(float x, float y, float z)
+{
+	return {
+		{ "position", { { "x", x }, { "y", y }, { "z", z } } },
+		{ "rotation", { { "w", 1.0f }, { "x", 0.0f }, { "y", 0.0f }, { "z", 0.0f } } },
+		{ "scale", { { "x", 1.0f }, { "y", 1.0f }, { "z", 1.0f } } }
+	};
+}
+
+static JSON::json MakeBoxCollider(float halfSize, bool isMoveable)
+{
+	return {
+		{ "dimensions", { { "x", halfSize }, { "y", 0.5f }, { "z", halfSize } } },
+		{ "gravity", { { "x", 0.0f }, { "y", isMoveable ? -9.8f : 0.0f }, { "z", 0.0f } } },
+		{ "isGeneratesHitEvents", false },
+		{ "isMoveable", isMoveable },
+		{ "matName", "Air" }
+	};
+}
+
+static void WriteEntity(const String& levelPath, EntityID id, const String& name, const JSON::json& components)
+{
+	JSON::json entity = { { "Components", components }, { "Entity", { { "ID", id }, { "name", name } } } };
+	OutputFileStream(OS::GetAbsolutePath(levelPath + "/entities/" + name + " #" + std::to_string(id) + ".entity.json")) << entity.dump(4);
+}
+
+/// Write a level of cubes over a floor to levelPath. A quarter of the cubes fall under physics and an eighth spin with a script.
+static void GenerateLevel(const String& levelPath, int entityCount)
+{
+	const String levelName = FilePath(levelPath).filename().string();
+	OS::CreateDirectoryName(levelPath + "/entities");
+	OutputFileStream(OS::GetAbsolutePath(levelPath + "/" + levelName + ".level.json")) << JSON::json({ { "camera", ROOT_ENTITY_ID } }).dump(4);
+
+	const int side = (int)std::ceil(std::sqrt(entityCount / 4.0f));
+	JSON::json floor;
+	floor["HierarchyComponent"] = { { "children", JSON::json::array() }, { "parent", ROOT_ENTITY_ID } };
+	floor["TransformComponent"] = MakeTransform(0.0f, -2.0f, -side - 10.0f);
+	floor["BoxColliderComponent"] = MakeBoxCollider(side, false);
+	WriteEntity(levelPath, ROOT_ENTITY_ID + 1, "Floor", floor);
+
+	for (int i = 0; i < entityCount; i++)
+	{
+		const int x = i % side;
+		const int z = (i / side) % side;
+		const int y = i / (side * side);
+
+		JSON::json components;
+		components["HierarchyComponent"] = { { "children", JSON::json::array() }, { "parent", ROOT_ENTITY_ID } };
+		components["TransformComponent"] = MakeTransform(x * 2.0f - side, y * 2.0f, -z * 2.0f - 10.0f);
+		components["ModelComponent"] = { { "isVisible", true }, { "renderPass", 1 }, { "resFile", "rootex/assets/cube.obj" } };
+		if (i % 4 == 0)
+		{
+			components["BoxColliderComponent"] = MakeBoxCollider(0.5f, true);
+		}
+		if (i % 8 == 1)
+		{
+			components["ScriptComponent"] = { { "scripts", { "game/assets/scripts/rotator.lua" } } };
+		}
+
+		WriteEntity(levelPath, ROOT_ENTITY_ID + 2 + i, "Cube" + std::to_string(i), components);
+	}
+
+	PRINT("Generated level with " + std::to_string(entityCount) + " entities: " + levelPath);
+}
+
+class BenchmarkApplication : public Application
+{
+	String m_LevelName;
+	/// Presses sent to the level, as objects of "event", "frame" and an optional "every" to repeat the press
+	JSON::json m_Input;
+	int m_Frames;
+	int m_WarmupFrames;
+	float m_TickMilliseconds;
+	bool m_IsRendering;
+	String m_ReplayFile;
+	String m_OutputFile;
+	String m_BaselineFile;
+	float m_Tolerance;
+	/// Smallest difference that counts as a regression, so that metrics close to 0 do not flag noise
+	float m_NoiseFloor;
+	int m_ExitCode;
+
+	bool parseCommandLine(const JSON::json& benchmark);
+
+	void sendInput(int frame);
+	/// Advance all simulation systems by one fixed tick.
+	void tick(float deltaMilliseconds);
+
+	JSON::json makeResults(unsigned long long allocations, unsigned long long allocatedBytes);
+	/// Returns the number of metrics that regressed from the baseline.
+	int compare(const JSON::json& results, const JSON::json& baseline);
+
+public:
+	BenchmarkApplication();
+	BenchmarkApplication(BenchmarkApplication&) = delete;
+	~BenchmarkApplication() = default;
+
+	void run() override;
+	void shutDown() override;
+
+	String getAppTitle() const override { return "Rootex Benchmark"; }
+	int getExitCode() const override { return m_ExitCode; }
+};
+
+Ref<Application> CreateRootexApplication()
+{
+	return Ref<Application>(new BenchmarkApplication());
+}
+
+BenchmarkApplication::BenchmarkApplication()
+    : Application("benchmark/benchmark.app.json")
+    , m_Input(JSON::json::array())
+    , m_ExitCode(0)
+{
+	const JSON::json& benchmark = m_ApplicationSettings->getJSON()["benchmark"];
+	m_Frames = benchmark.value("frames", 600);
+	m_WarmupFrames = benchmark.value("warmupFrames", 60);
+	m_TickMilliseconds = S_TO_MS / benchmark.value("tickRate", 60.0f);
+	m_IsRendering = benchmark.value("render", false);
+	m_Tolerance = benchmark.value("tolerance", 0.1f);
+	m_NoiseFloor = benchmark.value("noiseFloor", 0.05f);
+	if (!parseCommandLine(benchmark))
+	{
+		m_ExitCode = 2;
+		return;
+	}
+
+	String levelPath = m_LevelName;
+	const JSON::json levels = benchmark.value("levels", JSON::json::object());
+	auto&& level = levels.find(m_LevelName);
+	if (level != levels.end())
+	{
+		levelPath = level->value("path", "");
+		m_Input = level->value("input", JSON::json::array());
+		if (m_ReplayFile.empty())
+		{
+			m_ReplayFile = level->value("replayFile", "");
+		}
+		if (level->contains("generateEntities") && !OS::IsExists(levelPath))
+		{
+			GenerateLevel(levelPath, level->value("generateEntities", 0));
+		}
+	}
+	if (!OS::IsExists(levelPath))
+	{
+		WARN("Level not found: " + m_LevelName);
+		m_ExitCode = 2;
+		return;
+	}
+	if (m_OutputFile.empty())
+	{
+		m_OutputFile = "benchmark/results/" + FilePath(levelPath).filename().string() + ".json";
+	}
+
+	LevelManager::GetSingleton()->openLevel(levelPath);
+	InputManager::GetSingleton()->setTickRate(benchmark.value("tickRate", 60.0f));
+	if (!m_ReplayFile.empty() && !InputManager::GetSingleton()->startReplay(m_ReplayFile))
+	{
+		m_ExitCode = 2;
+		return;
+	}
+
+	RenderingDevice::GetSingleton()->setBackBufferRenderTarget();
+	AudioSystem::GetSingleton()->begin();
+	TransformAnimationSystem::GetSingleton()->begin();
+	ScriptSystem::GetSingleton()->begin();
+}
+
+bool BenchmarkApplication::parseCommandLine(const JSON::json& benchmark)
+{
+	for (int i = 1; i < __argc; i++)
+	{
+		const String argument = __argv[i];
+		const bool hasValue = i + 1 < __argc;
+		if (argument == "--frames" && hasValue)
+		{
+			m_Frames = std::stoi(__argv[++i]);
+		}
+		else if (argument == "--warmup" && hasValue)
+		{
+			m_WarmupFrames = std::stoi(__argv[++i]);
+		}
+		else if (argument == "--render")
+		{
+			m_IsRendering = true;
+		}
+		else if (argument == "--replay" && hasValue)
+		{
+			m_ReplayFile = __argv[++i];
+		}
+		else if (argument == "--out" && hasValue)
+		{
+			m_OutputFile = __argv[++i];
+		}
+		else if (argument == "--baseline" && hasValue)
+		{
+			m_BaselineFile = __argv[++i];
+		}
+		else if (argument == "--tolerance" && hasValue)
+		{
+			m_Tolerance = std::stof(__argv[++i]);
+		}
+		else if (argument.rfind("--", 0) != 0 && m_LevelName.empty())
+		{
+			m_LevelName = argument;
+		}
+		else
+		{
+			WARN("Unknown argument: " + argument);
+			return false;
+		}
+	}
+
+	if (m_LevelName.empty())
+	{
+		String levelNames;
+		const JSON::json levels = benchmark.value("levels", JSON::json::object());
+		for (auto& level : levels.items())
+		{
+			levelNames += " " + level.key();
+		}
+		WARN("Usage: RootexBench <level> [--frames N] [--warmup N] [--render] [--replay input.rinput] [--out results.json] [--baseline baseline.json] [--tolerance 0.1]. Levels:" + levelNames);
+		return false;
+	}
+	return true;
+}
+
+void BenchmarkApplication::sendInput(int frame)
+{
+	for (auto& input : m_Input)
+	{
+		const int since = frame - input.value("frame", 0);
+		const int every = input.value("every", 0);
+		if (since < 0 || (every == 0 && since > 1))
+		{
+			continue;
+		}
+
+		// Buttons are pressed for one frame and released on the next
+		const int phase = every ? since % every : since;
+		if (phase == 0)
+		{
+			EventManager::GetSingleton()->call("BoolInputEvent", input.value("event", ""), Vector2(0.0f, 1.0f));
+		}
+		else if (phase == 1)
+		{
+			EventManager::GetSingleton()->call("BoolInputEvent", input.value("event", ""), Vector2(1.0f, 0.0f));
+		}
+	}
+}
+
+void BenchmarkApplication::tick(float deltaMilliseconds)
+{
+	PROFILE_FUNCTION();
+	InputManager::GetSingleton()->tick();
+	RenderSystem::GetSingleton()->savePreviousTransforms();
+	PhysicsSystem::GetSingleton()->update(deltaMilliseconds);
+	ScriptSystem::GetSingleton()->update(deltaMilliseconds);
+	TransformAnimationSystem::GetSingleton()->update(deltaMilliseconds);
+}
+
+void BenchmarkApplication::run()
+{
+	if (m_ExitCode != 0)
+	{
+		return;
+	}
+
+	PRINT("Benchmarking " + m_LevelName + " for " + std::to_string(m_Frames) + " frames after " + std::to_string(m_WarmupFrames) + " warm up frames" + (m_IsRendering ? ", rendering" : ""));
+
+	// Only the end of the warm up and the end of the run are reported
+	Metrics::GetSingleton()->setPeriod(m_WarmupFrames + m_Frames + 1);
+	unsigned long long allocationCount = 0;
+	unsigned long long allocatedBytes = 0;
+
+	StopTimer frameTimer;
+	for (int frame = 0; frame < m_WarmupFrames + m_Frames; frame++)
+	{
+		if (frame == m_WarmupFrames)
+		{
+			Metrics::GetSingleton()->report();
+			allocationCount = AllocationCount;
+			allocatedBytes = AllocatedBytes;
+		}
+
+		PROFILE_SCOPE("Frame");
+		frameTimer.reset();
+
+		if (m_Window->processMessages())
+		{
+			break;
+		}
+
+		AudioSystem::GetSingleton()->update();
+		InputManager::GetSingleton()->update();
+		sendInput(frame);
+
+		tick(m_TickMilliseconds);
+
+		LuaInterpreter::GetSingleton()->stepGarbageCollector();
+		UISystem::GetSingleton()->update();
+
+		if (m_IsRendering)
+		{
+			m_Window->clearCurrentTarget();
+			GPUProfiler::GetSingleton()->beginFrame();
+			RenderSystem::GetSingleton()->render();
+			RenderUISystem::GetSingleton()->render();
+			UISystem::GetSingleton()->render();
+			GPUProfiler::GetSingleton()->endFrame();
+			m_Window->swapBuffers();
+		}
+
+		EventManager::GetSingleton()->dispatchDeferred();
+		Metrics::GetSingleton()->endFrame(frameTimer.getTimeMs());
+	}
+	Metrics::GetSingleton()->report();
+
+	JSON::json results = makeResults(AllocationCount - allocationCount, AllocatedBytes - allocatedBytes);
+	if (!OS::IsExists(FilePath(m_OutputFile).parent_path().generic_string()))
+	{
+		OS::CreateDirectoryName(FilePath(m_OutputFile).parent_path().generic_string());
+	}
+	OutputFileStream(OS::GetAbsolutePath(m_OutputFile)) << results.dump(4);
+	PRINT("Wrote benchmark results to " + m_OutputFile);
+
+	if (!m_BaselineFile.empty())
+	{
+		if (!OS::IsExists(m_BaselineFile))
+		{
+			WARN("Baseline not found: " + m_BaselineFile);
+			m_ExitCode = 2;
+			return;
+		}
+		const int regressions = compare(results, JSON::json::parse(OS::LoadFileContents(m_BaselineFile)));
+		PRINT(std::to_string(regressions) + " regressions from " + m_BaselineFile);
+		m_ExitCode = regressions ? 1 : 0;
+	}
+}
+
+JSON::json BenchmarkApplication::makeResults(unsigned long long allocations, unsigned long long allocatedBytes)
+{
+	JSON::json metrics = JSON::json::object();
+	for (auto& value : Metrics::GetSingleton()->getSnapshot().m_Values)
+	{
+		metrics[value.m_Name] = value.m_Value;
+	}
+	metrics["Allocations Per Frame"] = (double)allocations / m_Frames;
+	metrics["Allocated MB Per Frame"] = (double)allocatedBytes / m_Frames / (MB_TO_KB * KB_TO_B);
+
+	PROCESS_MEMORY_COUNTERS memory = {};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		metrics["Peak Memory MB"] = (double)memory.PeakWorkingSetSize / (MB_TO_KB * KB_TO_B);
+	}
+
+	return {
+		{ "level", m_LevelName },
+		{ "frames", m_Frames },
+		{ "tickMs", m_TickMilliseconds },
+		{ "render", m_IsRendering },
+		{ "build", OS::GetBuildType() },
+		{ "metrics", metrics }
+	};
+}
+
+int BenchmarkApplication::compare(const JSON::json& results, const JSON::json& baseline)
+{
+	if (baseline.value("level", "") != results["level"] || baseline.value("frames", 0) != results["frames"] || baseline.value("render", false) != results["render"])
+	{
+		WARN("Baseline was made with a different level, frame count or render setting, comparing anyway");
+	}
+
+	int regressions = 0;
+	const JSON::json& baselineMetrics = baseline["metrics"];
+	for (auto& metric : results["metrics"].items())
+	{
+		auto&& baselineMetric = baselineMetrics.find(metric.key());
+		if (!IsCompared(metric.key()) || baselineMetric == baselineMetrics.end())
+		{
+			continue;
+		}
+
+		const double value = metric.value();
+		const double baselineValue = *baselineMetric;
+		if (value > baselineValue * (1.0 + m_Tolerance) && value - baselineValue > m_NoiseFloor)
+		{
+			WARN("Regression in " + metric.key() + ": " + std::to_string(baselineValue) + " -> " + std::to_string(value));
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+void BenchmarkApplication::shutDown()
+{
+	ScriptSystem::GetSingleton()->end();
+}
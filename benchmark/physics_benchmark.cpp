@@ -0,0 +1,143 @@
+#include "common/common.h"
+
+#include "core/physics/bullet_task_scheduler.h"
+#include "os/timer.h"
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+
+#include <algorithm>
+
+/// Headless benchmark that drops a grid of boxes onto a plane and measures how long each physics step takes,
+/// with the single threaded world and with the multithreaded world running on the engine thread pool.
+
+static const int BoxCount = 10000;
+static const int StepCount = 600;
+static const float StepSize = 1.0f / 60.0f;
+
+struct BenchmarkResult
+{
+	float m_TotalMs = 0.0f;
+	float m_MinMs = 0.0f;
+	float m_MaxMs = 0.0f;
+	int m_ActiveBodies = 0;
+};
+
+BenchmarkResult RunBenchmark(bool isMultithreaded, int threadCount, ThreadPool& threadPool)
+{
+	btDefaultCollisionConstructionInfo constructionInfo;
+	constructionInfo.m_defaultMaxPersistentManifoldPoolSize = BoxCount * 8;
+	constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = BoxCount * 8;
+	btDefaultCollisionConfiguration collisionConfiguration(constructionInfo);
+	btDbvtBroadphase broadphase;
+
+	Ptr<BulletTaskScheduler> taskScheduler;
+	Ptr<btCollisionDispatcher> dispatcher;
+	Ptr<btConstraintSolverPoolMt> solverPool;
+	Ptr<btConstraintSolver> solver;
+	Ptr<btDiscreteDynamicsWorld> world;
+	if (isMultithreaded)
+	{
+		taskScheduler.reset(new BulletTaskScheduler(threadPool));
+		taskScheduler->setNumThreads(threadCount);
+		btSetTaskScheduler(taskScheduler.get());
+
+		dispatcher.reset(new btCollisionDispatcherMt(&collisionConfiguration));
+		solverPool.reset(new btConstraintSolverPoolMt(taskScheduler->getParallelism()));
+		solver.reset(new btSequentialImpulseConstraintSolverMt);
+		world.reset(new btDiscreteDynamicsWorldMt(dispatcher.get(), &broadphase, solverPool.get(), solver.get(), &collisionConfiguration));
+	}
+	else
+	{
+		dispatcher.reset(new btCollisionDispatcher(&collisionConfiguration));
+		solver.reset(new btSequentialImpulseConstraintSolver);
+		world.reset(new btDiscreteDynamicsWorld(dispatcher.get(), &broadphase, solver.get(), &collisionConfiguration));
+	}
+	world->setGravity({ 0.0f, -9.8f, 0.0f });
+
+	btStaticPlaneShape groundShape({ 0.0f, 1.0f, 0.0f }, 0.0f);
+	btRigidBody ground(btRigidBody::btRigidBodyConstructionInfo(0.0f, nullptr, &groundShape));
+	world->addRigidBody(&ground);
+
+	btBoxShape boxShape({ 0.5f, 0.5f, 0.5f });
+	btVector3 boxInertia;
+	boxShape.calculateLocalInertia(1.0f, boxInertia);
+
+	// Columns of boxes, slightly offset so that they topple into each other instead of stacking perfectly
+	const int side = 25;
+	const int layers = BoxCount / (side * side);
+	Vector<Ptr<btDefaultMotionState>> motionStates;
+	Vector<Ptr<btRigidBody>> boxes;
+	motionStates.reserve(BoxCount);
+	boxes.reserve(BoxCount);
+	for (int y = 0; y < layers; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			for (int z = 0; z < side; z++)
+			{
+				btTransform transform;
+				transform.setIdentity();
+				transform.setOrigin({ x * 1.1f - side * 0.55f + (y % 2) * 0.25f, 1.0f + y * 1.2f, z * 1.1f - side * 0.55f });
+				motionStates.emplace_back(new btDefaultMotionState(transform));
+				boxes.emplace_back(new btRigidBody(btRigidBody::btRigidBodyConstructionInfo(1.0f, motionStates.back().get(), &boxShape, boxInertia)));
+				world->addRigidBody(boxes.back().get());
+			}
+		}
+	}
+
+	BenchmarkResult result;
+	result.m_MinMs = FLT_MAX;
+	StopTimer timer;
+	for (int i = 0; i < StepCount; i++)
+	{
+		timer.reset();
+		world->stepSimulation(StepSize, 1, StepSize);
+		float stepMs = timer.getTimeMs();
+
+		result.m_TotalMs += stepMs;
+		result.m_MinMs = std::min(result.m_MinMs, stepMs);
+		result.m_MaxMs = std::max(result.m_MaxMs, stepMs);
+	}
+
+	for (auto& box : boxes)
+	{
+		result.m_ActiveBodies += box->isActive() ? 1 : 0;
+		world->removeRigidBody(box.get());
+	}
+	world->removeRigidBody(&ground);
+	world.reset();
+
+	btSetTaskScheduler(btGetSequentialTaskScheduler());
+	return result;
+}
+
+void PrintResult(const String& name, const BenchmarkResult& result)
+{
+	OS::Print(name
+	    + ": average " + std::to_string(result.m_TotalMs / StepCount) + "ms"
+	    + ", min " + std::to_string(result.m_MinMs) + "ms"
+	    + ", max " + std::to_string(result.m_MaxMs) + "ms"
+	    + ", total " + std::to_string(result.m_TotalMs) + "ms"
+	    + ", " + std::to_string(result.m_ActiveBodies) + " bodies still active");
+}
+
+int main()
+{
+	OS::Initialize();
+	OS::Print("Physics benchmark: " + std::to_string(BoxCount) + " boxes, " + std::to_string(StepCount) + " steps of " + std::to_string(StepSize * S_TO_MS) + "ms. " + OS::GetBuildType() + " build");
+
+	ThreadPool threadPool;
+	PrintResult("btDiscreteDynamicsWorld", RunBenchmark(false, 1, threadPool));
+
+	const int maxThreads = BulletTaskScheduler(threadPool).getMaxNumThreads();
+	for (int threads = 2; threads < maxThreads; threads *= 2)
+	{
+		PrintResult("btDiscreteDynamicsWorldMt with " + std::to_string(threads) + " threads", RunBenchmark(true, threads, threadPool));
+	}
+	PrintResult("btDiscreteDynamicsWorldMt with " + std::to_string(maxThreads) + " threads", RunBenchmark(true, maxThreads, threadPool));
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "check.h"
+
+#include "core/renderer/shader_cache.h"
+
+/// Headless check of how ShaderCache keys and invalidates cached permutations. Does not compile any shader.
+/// Writes a shader and an include under benchmark/results/shader_cache_check, and fake bytecode to the shader cache.
+/// Exits with 1 if any check fails.
+
+static const String CheckDirectory = "benchmark/results/shader_cache_check/";
+
+static void WriteFile(const String& path, const String& contents)
+{
+	OutputFileStream(OS::GetAbsolutePath(path), std::ios::binary) << contents;
+}
+
+int main()
+{
+	OS::Initialize();
+	OS::CreateDirectoryName(CheckDirectory);
+	const String sourcePath = CheckDirectory + "shader_cache_check.hlsl";
+	const String includePath = CheckDirectory + "shader_cache_check_include.hlsli";
+	WriteFile(sourcePath, "#include \"shader_cache_check_include.hlsli\"\nfloat4 main() : SV_TARGET { return Color; }\n");
+	WriteFile(includePath, "static const float4 Color = float4(1, 0, 0, 1);\n");
+
+	ShaderPermutationDesc desc = { sourcePath, "main", "ps_4_0", { "NORMAL_MAP", "SHADOWS", "FOG" } };
+	ShaderPermutationDesc reordered = { sourcePath, "main", "ps_4_0", { "FOG", "NORMAL_MAP", "SHADOWS" } };
+	ShaderPermutationDesc other = { sourcePath, "main", "ps_4_0", { "FOG", "NORMAL_MAP" } };
+	Check(ShaderCache::GetPermutationHash(desc) == ShaderCache::GetPermutationHash(reordered), "reordering defines keeps the permutation hash");
+	Check(ShaderCache::GetCachePath(desc) == ShaderCache::GetCachePath(reordered), "reordering defines keeps the cache path");
+	Check(ShaderCache::GetPermutationHash(desc) != ShaderCache::GetPermutationHash(other), "other defines change the permutation hash");
+
+	const unsigned long long sourceHash = ShaderCache::GetSourceHash(sourcePath);
+	Check(sourceHash != 0, "source hash is found");
+	Check(sourceHash == ShaderCache::GetSourceHash(sourcePath), "source hash is stable");
+	WriteFile(includePath, "static const float4 Color = float4(0, 1, 0, 1);\n");
+	const unsigned long long editedHash = ShaderCache::GetSourceHash(sourcePath);
+	Check(editedHash != sourceHash, "editing an include changes the source hash");
+	Check(ShaderCache::GetSourceHash(CheckDirectory + "missing.hlsl") == 0, "missing source hashes to 0");
+
+	const FileBuffer bytecode = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+	FileBuffer loaded;
+	Check(ShaderCache::Store(desc, editedHash, bytecode), "permutation is stored");
+	Check(ShaderCache::Load(reordered, editedHash, loaded) && loaded == bytecode, "stored permutation loads with reordered defines");
+	Check(!ShaderCache::Load(desc, sourceHash, loaded), "cache made from another source is rejected");
+
+	// A permutation whose hash differs but is stored under the same file name, as if their file name hashes collided
+	FileBuffer cached = OS::LoadFileContents(ShaderCache::GetCachePath(desc));
+	ShaderCacheHeader header;
+	memcpy(&header, cached.data(), sizeof(header));
+	header.m_PermutationHash ^= 1;
+	memcpy(cached.data(), &header, sizeof(header));
+	WriteFile(ShaderCache::GetCachePath(desc), String(cached.begin(), cached.end()));
+	Check(!ShaderCache::Load(desc, editedHash, loaded), "cache made for another permutation is rejected");
+
+	std::filesystem::remove(OS::GetAbsolutePath(ShaderCache::GetCachePath(desc)));
+	OS::DeleteDirectory(CheckDirectory);
+
+	return FinishChecks("shader cache");
+}
@@ -0,0 +1,96 @@
+#include "check.h"
+
+#include "core/renderer/texture_residency.h"
+
+/// Headless check of which mips TextureResidency streams in and evicts. Does not create any texture.
+/// Exits with 1 if any check fails.
+
+/// Mip sizes of an 8x8 RGBA texture, with 5 bytes from mip 2 down, 21 from mip 1 down and 85 for the whole chain
+static const Vector<size_t> MipSizes = { 64, 16, 4, 1 };
+
+static void CheckAdd()
+{
+	TextureResidency residency(1000, 4);
+	Check(residency.add({}, 0) == -1, "texture without mips is rejected");
+	Check(residency.getStats().m_TextureCount == 0 && residency.getStats().m_ResidentBytes == 0, "rejected texture is not counted");
+
+	TextureResidency::TextureID texture = residency.add(MipSizes, 2);
+	Check(residency.getResidentMip(texture) == 2, "base mip is resident after adding");
+	Check(residency.getStats().m_ResidentBytes == 5, "resident bytes count the mips from the base mip down");
+	Check(residency.getResidentMip(residency.add(MipSizes, 10)) == 3, "base mip is clamped to the smallest mip");
+
+	residency.remove(texture);
+	Check(residency.add(MipSizes, 2) == texture, "removed ID is reused");
+}
+
+static void CheckPromotionOrder()
+{
+	TextureResidency residency(1000, 1);
+	TextureResidency::TextureID few = residency.add(MipSizes, 2);
+	TextureResidency::TextureID many = residency.add(MipSizes, 2);
+
+	residency.request(few, 1);
+	residency.request(many, 0);
+	const Vector<TextureResidency::Change>& changes = residency.update();
+	Check(changes.size() == 1 && changes[0].m_Texture == many && changes[0].m_TopMip == 0, "texture missing the most mips is streamed in first");
+	Check(residency.getResidentMip(few) == 2, "stream ins are limited per update");
+	Check(residency.getStats().m_RequestedCount == 2 && residency.getStats().m_SatisfiedCount == 1, "satisfied requests are counted");
+
+	residency.request(few, 1);
+	residency.update();
+	Check(residency.getResidentMip(few) == 1, "remaining texture is streamed in on the next update");
+	Check(residency.getResidentMip(many) == 0, "textures that fit the budget are kept after they stop being asked for");
+
+	residency.request(few, 0);
+	residency.request(few, 2);
+	residency.update();
+	Check(residency.getResidentMip(few) == 0, "most detailed request of a frame wins");
+}
+
+static void CheckEviction()
+{
+	// Room for three base mips and two textures with mip 1, but not three
+	TextureResidency residency(62, 4);
+	TextureResidency::TextureID oldest = residency.add(MipSizes, 2);
+	TextureResidency::TextureID older = residency.add(MipSizes, 2);
+	TextureResidency::TextureID latest = residency.add(MipSizes, 2);
+
+	residency.request(oldest, 1);
+	residency.update();
+	residency.request(older, 1);
+	residency.update();
+	residency.request(latest, 1);
+	residency.update();
+	Check(residency.getResidentMip(oldest) == 2, "least recently asked for texture is evicted first");
+	Check(residency.getResidentMip(older) == 1, "more recently asked for texture is kept");
+	Check(residency.getResidentMip(latest) == 1, "asked for texture is streamed in after evicting");
+	Check(residency.getStats().m_ResidentBytes <= 62, "resident bytes stay inside the budget");
+	Check(residency.getStats().m_StreamedInMips == 3 && residency.getStats().m_EvictedMips == 1, "streamed in and evicted mips are counted");
+
+	// Both kept textures are asked for, so nothing can be evicted to fit the whole chain
+	residency.request(older, 1);
+	residency.request(latest, 0);
+	residency.update();
+	Check(residency.getResidentMip(older) == 1, "texture asked for this frame keeps the mips it asked for");
+	Check(residency.getResidentMip(latest) == 1, "texture settles for fewer mips when all of them do not fit");
+
+	residency.setBudget(15);
+	residency.request(latest, 2);
+	residency.update();
+	Check(residency.getResidentMip(latest) == 1, "shrinking the budget alone evicts nothing");
+	residency.request(oldest, 1);
+	residency.update();
+	Check(residency.getResidentMip(oldest) == 2, "texture does not stream in when evicting is not enough");
+	Check(residency.getResidentMip(older) == 2 && residency.getResidentMip(latest) == 2, "textures not asked for this frame are evicted while looking for room");
+}
+
+int main()
+{
+	OS::Initialize();
+
+	CheckAdd();
+	CheckPromotionOrder();
+	CheckEviction();
+
+	return FinishChecks("texture residency");
+}
@@ -0,0 +1,212 @@
+#include "check.h"
+
+#include "core/audio/vorbis_decoder.h"
+
+#include <sstream>
+
+/// Headless check of VorbisDecoder. Decodes benchmark/data/vorbis_check.ogg and compares it with vorbis_check.pcm, the reference PCM
+/// computed by benchmark/data/make_vorbis_check.py, the encoder that made the stream. Then feeds the decoder truncated and corrupt copies of the stream.
+/// Exits with 1 if any check fails.
+
+static const String StreamPath = "benchmark/data/vorbis_check.ogg";
+static const String ReferencePath = "benchmark/data/vorbis_check.pcm";
+static const int Channels = 2;
+static const int SampleRate = 8000;
+
+/// Decode a whole stream in reads of uneven sizes. Returns false if the stream does not open.
+static bool Decode(const String& stream, Vector<short>& pcm)
+{
+	std::istringstream file(stream);
+	VorbisDecoder decoder(file);
+	pcm.clear();
+	if (!decoder.open())
+	{
+		return false;
+	}
+
+	Vector<short> buffer(701 * decoder.getChannels());
+	unsigned int frameCount = 1;
+	while (true)
+	{
+		frameCount = frameCount * 7 % 701 + 1;
+		unsigned int decoded = decoder.read(buffer.data(), frameCount);
+		pcm.insert(pcm.end(), buffer.begin(), buffer.begin() + decoded * decoder.getChannels());
+		if (decoded < frameCount)
+		{
+			return true;
+		}
+	}
+}
+
+/// Largest difference between the samples that both hold.
+static int MaxDifference(const Vector<short>& a, const Vector<short>& b, size_t offset = 0)
+{
+	int difference = 0;
+	for (size_t i = 0; i < a.size() && offset + i < b.size(); i++)
+	{
+		difference = std::max(difference, abs(a[i] - b[offset + i]));
+	}
+	return difference;
+}
+
+static size_t GetPageHeaderSize(const String& stream, size_t page)
+{
+	return 27 + (unsigned char)stream[page + 26];
+}
+
+static size_t GetPageSize(const String& stream, size_t page)
+{
+	size_t size = GetPageHeaderSize(stream, page);
+	for (size_t i = page + 27; i < page + GetPageHeaderSize(stream, page); i++)
+	{
+		size += (unsigned char)stream[i];
+	}
+	return size;
+}
+
+/// Offsets of the pages of a stream, found by walking their headers.
+static Vector<size_t> FindPages(const String& stream)
+{
+	Vector<size_t> pages;
+	for (size_t page = 0; page + 27 <= stream.size(); page += GetPageSize(stream, page))
+	{
+		pages.push_back(page);
+	}
+	return pages;
+}
+
+/// Set the checksums of all pages again, so that corrupt packets get past the page checks to the packet parsing.
+static void FixChecksums(String& stream)
+{
+	for (size_t page : FindPages(stream))
+	{
+		memset(&stream[page + 22], 0, 4);
+		unsigned int crc = 0;
+		for (size_t i = page; i < page + GetPageSize(stream, page); i++)
+		{
+			crc ^= (unsigned int)(unsigned char)stream[i] << 24;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+			}
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			stream[page + 22 + i] = (char)(crc >> (8 * i));
+		}
+	}
+}
+
+static void CheckDecode(const String& stream, const Vector<short>& reference, Vector<short>& pcm)
+{
+	std::istringstream file(stream);
+	VorbisDecoder decoder(file);
+	Check(decoder.open(), "stream opens");
+	Check(decoder.getChannels() == Channels && decoder.getSampleRate() == SampleRate, "channels and sample rate are read");
+	Check(decoder.getFrameCount() == reference.size() / Channels, "frame count is read from the last page");
+
+	Check(Decode(stream, pcm), "stream decodes");
+	Check(pcm.size() == reference.size(), "every frame is decoded");
+	Check(MaxDifference(pcm, reference) <= 1, "decoded PCM is within 1 of the reference");
+
+	Vector<short> decoded(300 * Channels);
+	const unsigned long long frameCount = reference.size() / Channels;
+	for (unsigned long long frame : { 0ull, 1ull, 64ull, 513ull, 777ull, frameCount / 3, frameCount / 2, frameCount - 100, frameCount - 1 })
+	{
+		decoded.resize(300 * Channels);
+		bool isSought = decoder.seek(frame);
+		decoded.resize(decoder.read(decoded.data(), 300) * Channels);
+		Check(isSought && decoded.size() == std::min(300ull, frameCount - frame) * Channels && MaxDifference(decoded, pcm, frame * Channels) == 0,
+		    "seeking to frame " + std::to_string(frame) + " decodes the same frames");
+	}
+
+	decoded.resize(300 * Channels);
+	Check(decoder.rewind() && decoder.read(decoded.data(), 300) == 300 && MaxDifference(decoded, pcm) == 0, "rewinding decodes the same frames");
+}
+
+static void CheckTruncated(const String& stream, const Vector<short>& pcm)
+{
+	const Vector<size_t> pages = FindPages(stream);
+	Vector<short> decoded;
+	for (size_t size : { (size_t)0, (size_t)4, (size_t)27, pages[1] - 1, pages[1], pages[2] + 10, pages[3] - 1 })
+	{
+		Check(!Decode(stream.substr(0, size), decoded), "stream cut to " + std::to_string(size) + " bytes, inside the headers, does not open");
+	}
+
+	// The stream needs a whole audio page to open, and the last two pages of it are long enough to cut
+	for (size_t size : { pages[pages.size() - 2], pages[pages.size() - 2] + 17, pages.back() + 100, stream.size() - 1 })
+	{
+		bool isOpened = Decode(stream.substr(0, size), decoded);
+		Check(isOpened && decoded.size() < pcm.size() && MaxDifference(decoded, pcm) == 0, "stream cut to " + std::to_string(size) + " bytes decodes the frames before the cut");
+	}
+}
+
+static void CheckCorrupt(const String& stream, const Vector<short>& pcm)
+{
+	const Vector<size_t> pages = FindPages(stream);
+	Vector<short> decoded;
+
+	String corrupt = stream;
+	corrupt[pages[2] + 40] ^= 0x10;
+	Check(!Decode(corrupt, decoded), "setup header page with a wrong checksum does not open");
+
+	corrupt = stream;
+	corrupt[pages[pages.size() - 2] + 40] ^= 0x10;
+	Check(Decode(corrupt, decoded) && decoded.size() < pcm.size() && MaxDifference(decoded, pcm) == 0, "audio page with a wrong checksum ends decoding");
+
+	corrupt = stream;
+	memcpy(&corrupt[pages[1]], "OggX", 4);
+	Check(!Decode(corrupt, decoded), "page without a capture pattern does not open");
+
+	// Flip bits in the packets and fix the checksums, so that the decoder has to parse the corrupt headers and audio packets.
+	// These have to be rejected or decoded without reading out of bounds, which only shows up as a crash or under a sanitizer.
+	unsigned int random = 5;
+	int openedCount = 0;
+	for (int i = 0; i < 300; i++)
+	{
+		corrupt = stream;
+		const int flipCount = i % 20 + 1;
+		for (int flip = 0; flip < flipCount; flip++)
+		{
+			random = random * 1103515245 + 12345;
+			const size_t page = pages[(random >> 8) % pages.size()];
+			const size_t headerSize = GetPageHeaderSize(stream, page);
+			const size_t pageSize = GetPageSize(stream, page);
+			if (pageSize > headerSize)
+			{
+				random = random * 1103515245 + 12345;
+				corrupt[page + headerSize + (random >> 8) % (pageSize - headerSize)] ^= 1 << (random >> 28) % 8;
+			}
+		}
+		FixChecksums(corrupt);
+
+		if (Decode(corrupt, decoded))
+		{
+			openedCount++;
+		}
+	}
+	Check(true, "300 streams with corrupt packets are rejected or decoded, " + std::to_string(openedCount) + " of them opened");
+}
+
+int main()
+{
+	OS::Initialize();
+
+	const FileBuffer streamBuffer = OS::LoadFileContents(StreamPath);
+	const FileBuffer referenceBuffer = OS::LoadFileContents(ReferencePath);
+	const String stream(streamBuffer.begin(), streamBuffer.end());
+	Vector<short> reference(referenceBuffer.size() / sizeof(short));
+	memcpy(reference.data(), referenceBuffer.data(), reference.size() * sizeof(short));
+	Check(!stream.empty() && !reference.empty(), "stream and reference are found");
+	if (stream.empty() || reference.empty())
+	{
+		return FinishChecks("Vorbis");
+	}
+
+	Vector<short> pcm;
+	CheckDecode(stream, reference, pcm);
+	CheckTruncated(stream, pcm);
+	CheckCorrupt(stream, pcm);
+
+	return FinishChecks("Vorbis");
+}
@@ -0,0 +1,25 @@
+@echo off
+REM Usage: cook_scripts.bat [configuration]
+REM Without a configuration, the luac.exe of the first built configuration out of Release, RelWithDebInfo, MinSizeRel and Debug is used.
+
+set LUAC=
+if not "%~1" == "" (
+	set LUAC="build/rootex/vendor/Lua/%~1/luac.exe"
+	if not exist "build/rootex/vendor/Lua/%~1/luac.exe" (
+		echo luac.exe was not built in the %~1 configuration
+		exit /b 1
+	)
+	goto cook
+)
+
+for %%c in (Release RelWithDebInfo MinSizeRel Debug) do (
+	if not defined LUAC if exist "build/rootex/vendor/Lua/%%c/luac.exe" set LUAC="build/rootex/vendor/Lua/%%c/luac.exe"
+)
+if not defined LUAC (
+	echo luac.exe was not found under build/rootex/vendor/Lua. Build Rootex first
+	exit /b 1
+)
+
+:cook
+for /R game\assets %%f in (*.lua) do %LUAC% -o "%%~dpnf.luac" "%%f"
+for /R rootex\assets %%f in (*.lua) do %LUAC% -o "%%~dpnf.luac" "%%f"
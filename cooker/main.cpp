@@ -0,0 +1,106 @@
+#include "common/common.h"
+
+#include "core/mesh_cooker.h"
+#include "core/resource_loader.h"
+#include "core/texture_cooker.h"
+#include "os/timer.h"
+
+/// Cooks models into the runtime format that ResourceLoader::CreateModelResourceFile() loads without Assimp,
+/// and images into block compressed textures with mip chains that ResourceLoader::CreateImageResourceFile() loads without decoding.
+/// Usage: Cooker <file or directory>...
+/// Cooked files are written next to their source. Files that did not change since they were last cooked are skipped.
+
+static bool IsCookable(const FilePath& path)
+{
+	String extension = path.extension().string();
+	return IsFileSupported(extension, ResourceFile::Type::Model) || IsFileSupported(extension, ResourceFile::Type::Image);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		OS::Print("Usage: Cooker <file or directory>...");
+		return 1;
+	}
+
+	// Arguments are relative to where the cooker was started, before OS moves into Rootex root
+	FilePath startDirectory = std::filesystem::current_path();
+	if (!OS::Initialize())
+	{
+		return 1;
+	}
+
+	Vector<FilePath> sources;
+	for (int i = 1; i < argc; i++)
+	{
+		FilePath input = std::filesystem::absolute(startDirectory / argv[i]);
+		if (std::filesystem::is_directory(input))
+		{
+			for (auto&& file : std::filesystem::recursive_directory_iterator(input))
+			{
+				if (file.is_regular_file() && IsCookable(file.path()))
+				{
+					sources.push_back(file.path());
+				}
+			}
+		}
+		else if (std::filesystem::is_regular_file(input) && IsCookable(input))
+		{
+			sources.push_back(input);
+		}
+		else
+		{
+			WARN("Skipping input that is not a model, an image or a directory: " + input.generic_string());
+		}
+	}
+
+	StopTimer timer;
+	Assimp::Importer importer;
+	int cookedCount = 0;
+	int upToDateCount = 0;
+	int skippedCount = 0;
+	int failedCount = 0;
+	for (auto& source : sources)
+	{
+		if (IsFileSupported(source.extension().string(), ResourceFile::Type::Model))
+		{
+			switch (MeshCooker::CookFile(importer, source.generic_string()))
+			{
+			case MeshCooker::CookResult::Cooked:
+				OS::Print("Cooked " + source.generic_string());
+				cookedCount++;
+				break;
+			case MeshCooker::CookResult::UpToDate:
+				upToDateCount++;
+				break;
+			case MeshCooker::CookResult::Failed:
+				failedCount++;
+				break;
+			}
+		}
+		else
+		{
+			switch (TextureCooker::CookFile(source.generic_string()))
+			{
+			case TextureCooker::CookResult::Cooked:
+				OS::Print("Cooked " + source.generic_string());
+				cookedCount++;
+				break;
+			case TextureCooker::CookResult::UpToDate:
+				upToDateCount++;
+				break;
+			case TextureCooker::CookResult::Skipped:
+				WARN("Skipping image with a size that is not a multiple of 4: " + source.generic_string());
+				skippedCount++;
+				break;
+			case TextureCooker::CookResult::Failed:
+				failedCount++;
+				break;
+			}
+		}
+	}
+
+	OS::Print(std::to_string(cookedCount) + " cooked, " + std::to_string(upToDateCount) + " up to date, " + std::to_string(skippedCount) + " skipped, " + std::to_string(failedCount) + " failed in " + std::to_string(timer.getTimeMs()) + "ms");
+	return failedCount > 0 ? 1 : 0;
+}
@@ -2,9 +2,12 @@
 
 #include "editor.h"
 
+#include "rootex/app/hot_reloader.h"
 #include "rootex/framework/systems/audio_system.h"
 #include "rootex/core/input/input_manager.h"
+#include "rootex/core/renderer/gpu_profiler.h"
 #include "rootex/core/resource_loader.h"
+#include "rootex/os/metrics.h"
 #include "rootex/framework/systems/render_system.h"
 #include "rootex/framework/systems/render_ui_system.h"
 #include "rootex/framework/systems/ui_system.h"
@@ -57,6 +60,7 @@ void EditorApplication::run()
 {
 	while (true)
 	{
+		PROFILE_SCOPE("Frame");
 		m_FrameTimer.reset();
 		if (((m_ApplicationTimer.Now() - m_PointAtLast10Second).count()) * NS_TO_MS * MS_TO_S > m_AutoSaveDurationS)
 		{
@@ -70,14 +74,19 @@ void EditorApplication::run()
 		}
 
 		UISystem::GetSingleton()->update();
+		GPUProfiler::GetSingleton()->beginFrame();
 		Editor::GetSingleton()->render();
+		GPUProfiler::GetSingleton()->endFrame();
 		AudioSystem::GetSingleton()->update();
 		InputManager::GetSingleton()->update();
 		TransformAnimationSystem::GetSingleton()->update(m_FrameTimer.getFrameTime());
 		EventManager::GetSingleton()->dispatchDeferred();
+		Logger::GetSingleton()->dispatchEvents();
+		HotReloader::GetSingleton()->update();
 
 		m_Window->clearUnboundTarget();
 		m_Window->swapBuffers();
+		Metrics::GetSingleton()->endFrame(m_FrameTimer.getFrameTime());
 	}
 }
 
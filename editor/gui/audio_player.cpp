@@ -49,11 +49,13 @@ ResourceFile* AudioPlayer::load(const FilePath& filePath)
 	m_FractionProgress = 0.0f;
 	m_OpenFile = ResourceLoader::CreateAudioResourceFile(filePath.string());
 
-	m_Buffer.reset(new StaticAudioBuffer(m_OpenFile));
-	m_Source.reset(new StaticAudioSource(m_Buffer));
-
 	PANIC(m_OpenFile == nullptr, "Audio file could not be loaded");
 
+	m_Buffer = StaticAudioBuffer::Create(m_OpenFile);
+	m_Source.reset(new StaticAudioSource(m_Buffer));
+	m_Source->setPriority(INT_MAX);
+	AudioSystem::GetSingleton()->addSource(m_Source);
+
 	return m_OpenFile;
 }
 
@@ -67,6 +69,7 @@ void AudioPlayer::unload()
 		}
 		m_Looping = false;
 		m_Timer.reset();
+		AudioSystem::GetSingleton()->removeSource(m_Source);
 		m_Source.reset();
 		m_Buffer.reset();
 	}
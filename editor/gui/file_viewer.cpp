@@ -20,7 +20,14 @@ void FileViewer::drawFileInfo()
 
 	ImGui::Text("Size");
 	ImGui::NextColumn();
-	float size = m_OpenFile->getData()->getRawDataByteSize();
+	// Loaded data may have been dropped after uploading it, like the data of textures, so the size is read from the disk
+	std::error_code error;
+	float size = std::filesystem::file_size(OS::GetAbsolutePath(m_OpenFile->getPath().string()), error);
+	if (error)
+	{
+		// Files inside archives are not on the disk
+		size = m_OpenFile->getData()->getRawDataByteSize();
+	}
 	float sizeUI = size;
 	String sizeUnitUI = " B";
 	if (sizeUI > 1.0f / B_TO_KB)
@@ -60,7 +67,7 @@ Variant FileViewer::openFile(const Event* event)
 	m_OpenFilePath = Extract(String, event->getData());
 
 	const String& ext = m_OpenFilePath.extension().string();
-	if (ext == ".wav")
+	if (ext == ".wav" || ext == ".ogg")
 	{
 		m_OpenFile = m_AudioPlayer.load(m_OpenFilePath);
 	}
@@ -116,7 +123,7 @@ void FileViewer::draw()
 
 			drawFileInfo();
 			
-			if (m_OpenFilePath.extension() == ".wav")
+			if (m_OpenFilePath.extension() == ".wav" || m_OpenFilePath.extension() == ".ogg")
 			{
 				m_AudioPlayer.draw();
 			}
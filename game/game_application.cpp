@@ -1,8 +1,11 @@
 #include "game_application.h"
 
+#include "app/hot_reloader.h"
 #include "app/level_manager.h"
 #include "core/input/input_manager.h"
+#include "core/renderer/gpu_profiler.h"
 #include "core/resource_loader.h"
+#include "os/metrics.h"
 #include "framework/systems/audio_system.h"
 #include "framework/systems/render_system.h"
 #include "framework/systems/render_ui_system.h"
@@ -52,6 +55,14 @@ Variant GameApplication::onExitEvent(const Event* event)
 GameApplication::GameApplication()
     : Application("game/game.app.json")
 {
+	auto&& simulation = m_ApplicationSettings->find("simulation");
+	if (simulation != m_ApplicationSettings->end())
+	{
+		m_SimulationTimer.setTickRate(simulation->value("tickRate", 60.0f));
+		m_SimulationTimer.setMaxStepsPerFrame(simulation->value("maxTicksPerFrame", 5));
+	}
+	InputManager::GetSingleton()->setTickRate(simulation != m_ApplicationSettings->end() ? simulation->value("tickRate", 60.0f) : 60.0f);
+
 	String levelName = getLevelNameFromCommandLine(GetCommandLine());
 
 	if (levelName == "")
@@ -63,6 +74,21 @@ GameApplication::GameApplication()
 		LevelManager::GetSingleton()->openLevel("game/assets/levels/" + levelName);
 	}
 
+	auto&& input = m_ApplicationSettings->find("input");
+	if (input != m_ApplicationSettings->end())
+	{
+		String replayFile = input->value("replayFile", "");
+		String recordFile = input->value("recordFile", "");
+		if (!replayFile.empty())
+		{
+			InputManager::GetSingleton()->startReplay(replayFile);
+		}
+		else if (!recordFile.empty())
+		{
+			InputManager::GetSingleton()->startRecording(recordFile);
+		}
+	}
+
 	RenderingDevice::GetSingleton()->setBackBufferRenderTarget();
 	AudioSystem::GetSingleton()->begin();
 	TransformAnimationSystem::GetSingleton()->begin();
@@ -77,6 +103,7 @@ void GameApplication::run()
 {
 	while (true)
 	{
+		PROFILE_SCOPE("Frame");
 		m_FrameTimer.reset();
 
 		if (m_Window->processMessages())
@@ -86,23 +113,43 @@ void GameApplication::run()
 
 		m_Window->swapBuffers();
 		m_Window->clearCurrentTarget();
+		GPUProfiler::GetSingleton()->beginFrame();
 
 		AudioSystem::GetSingleton()->update();
 		InputManager::GetSingleton()->update();
-		PhysicsSystem::GetSingleton()->update(m_FrameTimer.getLastFrameTime());
-		ScriptSystem::GetSingleton()->update(m_FrameTimer.getLastFrameTime());
-		TransformAnimationSystem::GetSingleton()->update(m_FrameTimer.getLastFrameTime());
+
+		m_SimulationTimer.accumulate(m_FrameTimer.getLastFrameTime());
+		while (m_SimulationTimer.tick())
+		{
+			tick(m_SimulationTimer.getStepTime());
+		}
+
+		LuaInterpreter::GetSingleton()->stepGarbageCollector();
 		UISystem::GetSingleton()->update();
 		
-		RenderSystem::GetSingleton()->render();
+		RenderSystem::GetSingleton()->render(m_SimulationTimer.getAlpha());
 		RenderUISystem::GetSingleton()->render();
 		UISystem::GetSingleton()->render();
+		GPUProfiler::GetSingleton()->endFrame();
 		
 		EventManager::GetSingleton()->dispatchDeferred();
+		HotReloader::GetSingleton()->update();
+		Metrics::GetSingleton()->endFrame(m_FrameTimer.getFrameTime());
 	}
 }
 
+void GameApplication::tick(float deltaMilliseconds)
+{
+	PROFILE_FUNCTION();
+	InputManager::GetSingleton()->tick();
+	RenderSystem::GetSingleton()->savePreviousTransforms();
+	PhysicsSystem::GetSingleton()->update(deltaMilliseconds);
+	ScriptSystem::GetSingleton()->update(deltaMilliseconds);
+	TransformAnimationSystem::GetSingleton()->update(deltaMilliseconds);
+}
+
 void GameApplication::shutDown()
 {
+	InputManager::GetSingleton()->stopRecording();
 	ScriptSystem::GetSingleton()->end();
 }
@@ -10,11 +10,16 @@ class HierarchyGraph;
 class GameApplication : public Application
 {
 	FrameTimer m_FrameTimer;
+	/// Ticks the simulation systems at a fixed rate independent of the frame rate.
+	FixedStepTimer m_SimulationTimer;
 
 	String getLevelNameFromCommandLine(const char* s);
 
 	Variant onExitEvent(const Event* event);
 
+	/// Advance all simulation systems by one fixed tick.
+	void tick(float deltaMilliseconds);
+
 public:
 	GameApplication();
 	GameApplication(GameApplication&) = delete;
@@ -0,0 +1,81 @@
+#include "common/common.h"
+
+#include "core/pak_archive.h"
+#include "os/timer.h"
+
+/// Packs files and directories into a .pak archive that ResourceLoader::MountArchive() can mount.
+/// Usage: Packer <output.pak> <file or directory>...
+/// Files are stored under their path relative to Rootex root, the same path they are loaded with.
+
+/// Streamed files need random access into their data, so they are never compressed.
+static const Vector<String> UncompressedExtensions = { ".wav" };
+
+bool AddFile(PakWriter& writer, const FilePath& filePath)
+{
+	String path = OS::GetRootRelativePath(filePath.generic_string()).generic_string();
+	if (path.empty() || path.rfind("..", 0) == 0)
+	{
+		WARN("Skipping file outside Rootex root: " + filePath.generic_string());
+		return false;
+	}
+
+	String extension = filePath.extension().string();
+	bool isCompressed = std::find(UncompressedExtensions.begin(), UncompressedExtensions.end(), extension) == UncompressedExtensions.end();
+	writer.add(path, filePath, isCompressed);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		OS::Print("Usage: Packer <output.pak> <file or directory>...");
+		return 1;
+	}
+
+	// Arguments are relative to where the packer was started, before OS moves into Rootex root
+	FilePath startDirectory = std::filesystem::current_path();
+	if (!OS::Initialize())
+	{
+		return 1;
+	}
+
+	StopTimer timer;
+	PakWriter writer;
+	int fileCount = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		FilePath input = std::filesystem::absolute(startDirectory / argv[i]);
+		if (std::filesystem::is_directory(input))
+		{
+			for (auto&& file : std::filesystem::recursive_directory_iterator(input))
+			{
+				if (file.is_regular_file())
+				{
+					fileCount += AddFile(writer, file.path());
+				}
+			}
+		}
+		else if (std::filesystem::is_regular_file(input))
+		{
+			fileCount += AddFile(writer, input);
+		}
+		else
+		{
+			WARN("Skipping input that is not a file or directory: " + input.generic_string());
+		}
+	}
+
+	if (fileCount == 0)
+	{
+		ERR("No files to pack");
+		return 1;
+	}
+
+	if (!writer.write(std::filesystem::absolute(startDirectory / argv[1])))
+	{
+		return 1;
+	}
+	OS::Print("Packing took " + std::to_string(timer.getTimeMs()) + "ms");
+	return 0;
+}
@@ -1,12 +1,19 @@
 #include "application.h"
 
+#include "app/hot_reloader.h"
 #include "framework/systems/audio_system.h"
 #include "core/resource_loader.h"
+#include "core/file_watcher.h"
 #include "core/input/input_manager.h"
+#include "core/renderer/gpu_profiler.h"
 #include "core/renderer/shader_library.h"
 #include "core/renderer/material_library.h"
+#include "core/renderer/rendering_device.h"
+#include "core/renderer/texture_streamer.h"
+#include "os/metrics.h"
 #include "script/interpreter.h"
 #include "systems/physics_system.h"
+#include "systems/script_system.h"
 #include "systems/ui_system.h"
 
 Application* Application::s_Singleton = nullptr;
@@ -34,14 +41,113 @@ Application::Application(const String& settingsFile)
 
 	m_ApplicationSettings.reset(new ApplicationSettings(ResourceLoader::CreateTextResourceFile(settingsFile)));
 
+	auto&& log = m_ApplicationSettings->find("log");
+	if (log != m_ApplicationSettings->end())
+	{
+		Logger::GetSingleton()->setOverflowPolicy(log->value("overflow", "drop") == "block" ? LogOverflowPolicy::Block : LogOverflowPolicy::Drop);
+		auto&& levels = log->find("levels");
+		if (levels != log->end())
+		{
+			for (auto& level : levels->items())
+			{
+				LogCategory category;
+				LogLevel categoryLevel;
+				if (!level.value().is_string() || !Logger::FindCategory(level.key(), category) || !Logger::FindLevel(level.value().get<String>(), categoryLevel))
+				{
+					WARN("Unknown log level " + level.value().dump() + " for category: " + level.key());
+					continue;
+				}
+				Logger::SetLevel(category, categoryLevel);
+			}
+		}
+		String logFile = log->value("file", "");
+		if (!logFile.empty())
+		{
+			Ptr<FileLogSink> sink(new FileLogSink(OS::GetAbsolutePath(logFile).string()));
+			if (sink->isOpen())
+			{
+				Logger::GetSingleton()->addSink(std::move(sink));
+			}
+			else
+			{
+				WARN("Could not open log file: " + logFile);
+			}
+		}
+	}
+
+	auto&& profiler = m_ApplicationSettings->find("profiler");
+	if (profiler != m_ApplicationSettings->end())
+	{
+		Profiler::GetSingleton()->setEventsPerThread(profiler->value("eventsPerThread", 65536));
+		GPUProfiler::GetSingleton()->setEnabled(profiler->value("gpuTimestamps", true));
+		m_TraceFile = profiler->value("traceFile", "");
+	}
+	Profiler::GetSingleton()->setThreadName("Main");
+	if (profiler != m_ApplicationSettings->end() && profiler->value("captureOnStart", false))
+	{
+		Profiler::GetSingleton()->startCapture();
+	}
+
+	auto&& metrics = m_ApplicationSettings->find("metrics");
+	if (metrics != m_ApplicationSettings->end())
+	{
+		Metrics::GetSingleton()->setPeriod(metrics->value("periodFrames", 60));
+		String csvFile = metrics->value("csvFile", "");
+		if (!csvFile.empty())
+		{
+			Metrics::GetSingleton()->setCSVFile(csvFile);
+		}
+		String jsonFile = metrics->value("jsonFile", "");
+		if (!jsonFile.empty())
+		{
+			Metrics::GetSingleton()->setJSONFile(jsonFile);
+		}
+	}
+	Metrics::GetSingleton()->addSampler(ResourceLoader::SampleMetrics);
+
+	auto&& fileWatcher = m_ApplicationSettings->find("fileWatcher");
+	if (fileWatcher != m_ApplicationSettings->end() && fileWatcher->value("enabled", true))
+	{
+		FileWatcher::GetSingleton()->start(OS::s_RootDirectory, fileWatcher->value("coalesceMs", 100));
+		HotReloader::GetSingleton()->setEnabled(fileWatcher->value("hotReload", true));
+	}
+
+	// Settings are always loose, every other file can come from an archive
+	auto&& archives = m_ApplicationSettings->find("archives");
+	if (archives != m_ApplicationSettings->end())
+	{
+		for (auto& archive : *archives)
+		{
+			ResourceLoader::MountArchive(archive);
+		}
+	}
+
+	auto&& audio = m_ApplicationSettings->find("audio");
+	if (audio != m_ApplicationSettings->end())
+	{
+		AudioSystem::GetSingleton()->setBufferUpdateRate(audio->value("bufferUpdateIntervalMs", 10.0f));
+		AudioSystem::GetSingleton()->setMaxVoices(audio->value("maxVoices", 32));
+	}
 	if (!AudioSystem::GetSingleton()->initialize())
 	{
 		ERR("Audio System was not initialized");
 	}
 	
 	LuaInterpreter::GetSingleton();
+	auto&& scripting = m_ApplicationSettings->find("scripting");
+	if (scripting != m_ApplicationSettings->end())
+	{
+		ScriptSystem::GetSingleton()->setParallelGroups(scripting->value("parallelGroups", false));
+		LuaInterpreter::GetSingleton()->setGarbageCollection(
+		    scripting->value("gcStepBudgetMs", 0.0f),
+		    scripting->value("gcPause", 200),
+		    scripting->value("gcStepMultiplier", 200));
+	}
 	
 	JSON::json windowJSON = m_ApplicationSettings->getJSON()["window"];
+	// Headless applications never show their window and do not need a GPU
+	bool isHeadless = windowJSON.value("headless", false);
+	RenderingDevice::GetSingleton()->setSoftware(isHeadless);
 	m_Window.reset(new Window(
 	    windowJSON["x"],
 	    windowJSON["y"],
@@ -53,10 +159,23 @@ Application::Application(const String& settingsFile)
 		windowJSON["fullScreen"]));
 	InputManager::GetSingleton()->initialize(m_Window->getWidth(), m_Window->getHeight());
 
-	ShaderLibrary::MakeShaders();
+	auto&& shaders = m_ApplicationSettings->find("shaders");
+	ShaderLibrary::MakeShaders(shaders == m_ApplicationSettings->end() || shaders->value("permutations", true));
+	auto&& textures = m_ApplicationSettings->find("textures");
+	if (textures != m_ApplicationSettings->end())
+	{
+		TextureStreamer::GetSingleton()->setBudget(textures->value("streamingBudgetMB", 256.0f) * MB_TO_KB * KB_TO_B);
+		TextureStreamer::GetSingleton()->setMaxStreamInsPerFrame(textures->value("streamInsPerFrame", 4));
+	}
 	MaterialLibrary::LoadMaterials();
+	auto&& physics = m_ApplicationSettings->find("physics");
+	if (physics != m_ApplicationSettings->end())
+	{
+		PhysicsSystem::GetSingleton()->setMultithreaded(physics->value("multithreaded", false));
+	}
 	PhysicsSystem::GetSingleton()->initialize();
 	UISystem::GetSingleton()->initialize(m_Window->getWidth(), m_Window->getHeight());
+	UISystem::GetSingleton()->setMetricsOverlay(metrics != m_ApplicationSettings->end() && metrics->value("showOverlay", false));
 
 	auto&& postInitialize = m_ApplicationSettings->find("postInitialize");
 	if (postInitialize != m_ApplicationSettings->end())
@@ -64,11 +183,24 @@ Application::Application(const String& settingsFile)
 		LuaInterpreter::GetSingleton()->getLuaState().script(ResourceLoader::CreateLuaTextResourceFile(*postInitialize)->getString());
 	}
 
-	m_Window->show();
+	if (isHeadless)
+	{
+		m_Window->resetClipCursor();
+	}
+	else
+	{
+		m_Window->show();
+	}
 }
 
 Application::~Application()
 {
+	if (Profiler::IsCapturing() && !m_TraceFile.empty())
+	{
+		Profiler::GetSingleton()->stopCapture();
+		Profiler::GetSingleton()->exportChromeTrace(m_TraceFile);
+	}
+	FileWatcher::GetSingleton()->stop();
 	AudioSystem::GetSingleton()->shutDown();
 	EntityFactory::GetSingleton()->destroyEntities(false);
 	UISystem::GetSingleton()->shutdown();
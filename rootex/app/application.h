@@ -3,6 +3,7 @@
 #include "main/window.h"
 #include "core/event_manager.h"
 #include "os/timer.h"
+#include "os/thread.h"
 #include "entity_factory.h"
 #include "application_settings.h"
 
@@ -14,8 +15,11 @@ class Application
 
 protected:
 	Timer m_ApplicationTimer;
+	ThreadPool m_ThreadPool;
 	Ptr<Window> m_Window;
 	Ptr<ApplicationSettings> m_ApplicationSettings;
+	/// Where the profiler capture is exported when the application closes, if it is still capturing
+	String m_TraceFile;
 	
 public:
 	static Application* GetSingleton();
@@ -28,7 +32,10 @@ public:
 	virtual void shutDown() = 0;
 
 	virtual String getAppTitle() const { return "Rootex Application"; }
+	/// Returned by main after the application shuts down.
+	virtual int getExitCode() const { return 0; }
 	const Timer& getAppTimer() const { return m_ApplicationTimer; };
+	ThreadPool& getThreadPool() { return m_ThreadPool; };
 	Window* getWindow() { return m_Window.get(); };
 	ApplicationSettings* getSettings() { return m_ApplicationSettings.get(); }
 };
@@ -0,0 +1,258 @@
+#include "hot_reloader.h"
+
+#include "core/event_manager.h"
+#include "core/file_watcher.h"
+#include "core/mesh_cooker.h"
+#include "core/resource_graph.h"
+#include "core/resource_loader.h"
+#include "core/texture_cooker.h"
+#include "core/renderer/material_library.h"
+#include "entity_factory.h"
+#include "components/script_component.h"
+#include "os/profiler.h"
+
+/// Names of entities in the ResourceGraph start with this, so they can not be mistaken for paths
+#define HOT_RELOADER_ENTITY_PREFIX "entity:"
+
+HotReloader* HotReloader::GetSingleton()
+{
+	static HotReloader singleton;
+	return &singleton;
+}
+
+String HotReloader::GetEntityName(EntityID entityID)
+{
+	return HOT_RELOADER_ENTITY_PREFIX + std::to_string(entityID);
+}
+
+String HotReloader::GetSourcePath(const String& path)
+{
+	// Cooked files are written next to their source, with an extension appended
+	for (const String& extension : { String(COOKED_MODEL_EXTENSION), String(COOKED_TEXTURE_EXTENSION), String("c") })
+	{
+		if (path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0)
+		{
+			String sourcePath = path.substr(0, path.size() - extension.size());
+			if (ResourceLoader::FindResourceFile(sourcePath))
+			{
+				return sourcePath;
+			}
+		}
+	}
+	return path;
+}
+
+HotReloader::HotReloader()
+    : m_IsEnabled(true)
+    , m_IsBatchPrepared(false)
+{
+	BIND_EVENT_MEMBER_FUNCTION(FILE_WATCHER_CHANGED_EVENT, onFilesChanged);
+}
+
+HotReloader::~HotReloader()
+{
+	if (m_PrepareThread.joinable())
+	{
+		m_PrepareThread.join();
+	}
+}
+
+Variant HotReloader::onFilesChanged(const Event* event)
+{
+	if (!m_IsEnabled)
+	{
+		return true;
+	}
+
+	for (auto& path : Extract(Vector<String>, event->getData()))
+	{
+		String sourcePath = GetSourcePath(path);
+		// Files that nothing is made from and that are not made from anything are left to their users
+		if (ResourceGraph::GetSingleton()->hasNode(sourcePath))
+		{
+			m_ChangedFiles.insert(sourcePath);
+		}
+	}
+	return true;
+}
+
+void HotReloader::update()
+{
+	PROFILE_FUNCTION();
+	if (m_PrepareThread.joinable())
+	{
+		if (!m_IsBatchPrepared)
+		{
+			return;
+		}
+		m_PrepareThread.join();
+		applyBatch();
+	}
+
+	if (!m_ChangedFiles.empty())
+	{
+		startBatch();
+	}
+}
+
+void HotReloader::startBatch()
+{
+	m_BatchChangedFiles = std::move(m_ChangedFiles);
+	m_ChangedFiles.clear();
+
+	m_Batch.clear();
+	for (auto& name : ResourceGraph::GetSingleton()->getReloadOrder(Vector<String>(m_BatchChangedFiles.begin(), m_BatchChangedFiles.end())))
+	{
+		Reload reload;
+		reload.m_Name = name;
+		reload.m_IsChanged = m_BatchChangedFiles.find(name) != m_BatchChangedFiles.end();
+		if (name.rfind(HOT_RELOADER_ENTITY_PREFIX, 0) != 0)
+		{
+			reload.m_File = ResourceLoader::FindResourceFile(name);
+			if (!reload.m_File)
+			{
+				// Not loaded, so it is read fresh whenever it gets loaded
+				continue;
+			}
+		}
+		m_Batch.push_back(std::move(reload));
+	}
+
+	m_IsBatchPrepared = false;
+	m_PrepareThread = std::thread(&HotReloader::prepareBatch, this);
+}
+
+void HotReloader::prepareBatch()
+{
+	for (auto& reload : m_Batch)
+	{
+		if (!reload.m_File || !reload.m_IsChanged)
+		{
+			continue;
+		}
+
+		switch (reload.m_File->getType())
+		{
+		case ResourceFile::Type::Text:
+			reload.m_Data = ResourceLoader::LoadFileContents(reload.m_Name);
+			reload.m_IsPrepared = true;
+			if (FilePath(reload.m_Name).extension() == ".rmat")
+			{
+				// A material file that is being saved can be caught half written, so parse errors only skip this reload
+				reload.m_MaterialData = JSON::json::parse(reload.m_Data.begin(), reload.m_Data.end(), nullptr, false);
+				reload.m_IsPrepared = !reload.m_MaterialData.is_discarded();
+			}
+			break;
+		case ResourceFile::Type::Lua:
+			reload.m_Data = ResourceLoader::LoadFileContents(reload.m_Name);
+			reload.m_IsPrepared = true;
+			break;
+		case ResourceFile::Type::Model:
+			reload.m_IsPrepared = ResourceLoader::ReadModel(reload.m_Name, reload.m_Data);
+			break;
+		default:
+			// Images are mapped and decoded when their textures are made, which has to happen on the main thread
+			reload.m_IsPrepared = true;
+			break;
+		}
+	}
+	m_IsBatchPrepared = true;
+}
+
+void HotReloader::applyBatch()
+{
+	for (auto& reload : m_Batch)
+	{
+		if (reload.m_File)
+		{
+			applyFile(reload);
+		}
+		else
+		{
+			applyEntity(reload);
+		}
+	}
+	m_Batch.clear();
+	m_BatchChangedFiles.clear();
+}
+
+void HotReloader::applyFile(Reload& reload)
+{
+	if (reload.m_IsChanged)
+	{
+		if (!reload.m_IsPrepared)
+		{
+			WARN("Could not reload: " + reload.m_Name);
+			return;
+		}
+
+		switch (reload.m_File->getType())
+		{
+		case ResourceFile::Type::Text:
+			ResourceLoader::Reload((TextResourceFile*)reload.m_File, std::move(reload.m_Data));
+			if (!reload.m_MaterialData.is_null())
+			{
+				MaterialLibrary::ReloadMaterial(FilePath(reload.m_Name).filename().string(), reload.m_MaterialData);
+			}
+			break;
+		case ResourceFile::Type::Lua:
+			ResourceLoader::Reload((LuaTextResourceFile*)reload.m_File, std::move(reload.m_Data));
+			break;
+		case ResourceFile::Type::Model:
+			ResourceLoader::Reload((ModelResourceFile*)reload.m_File, reload.m_Data);
+			break;
+		case ResourceFile::Type::Image:
+			ResourceLoader::Reload((ImageResourceFile*)reload.m_File);
+			break;
+		default:
+			break;
+		}
+		LOG_INFO("Reloaded {}", reload.m_Name);
+	}
+
+	// Materials make their textures again when their images change. Models hold materials that were changed in place, so they have nothing to do.
+	if (FilePath(reload.m_Name).extension() == ".rmat")
+	{
+		auto&& findIt = MaterialLibrary::GetAllMaterials().find(FilePath(reload.m_Name).filename().string());
+		if (findIt == MaterialLibrary::GetAllMaterials().end())
+		{
+			return;
+		}
+		if (Ref<Material> material = findIt->second.second.lock())
+		{
+			for (auto& dependency : material->getDependencies())
+			{
+				if (m_BatchChangedFiles.find(FileWatcher::NormalizePath(dependency)) != m_BatchChangedFiles.end())
+				{
+					material->reloadTextures();
+					break;
+				}
+			}
+		}
+	}
+}
+
+void HotReloader::applyEntity(const Reload& reload)
+{
+	EntityID entityID = std::stoi(reload.m_Name.substr(String(HOT_RELOADER_ENTITY_PREFIX).size()));
+	Ref<Entity> entity = EntityFactory::GetSingleton()->findEntity(entityID);
+	if (!entity)
+	{
+		return;
+	}
+	Ref<ScriptComponent> scriptComponent = entity->getComponent<ScriptComponent>();
+	if (!scriptComponent)
+	{
+		return;
+	}
+
+	// Only the scripts that changed run again
+	for (auto& path : m_BatchChangedFiles)
+	{
+		ResourceFile* file = ResourceLoader::FindResourceFile(path);
+		if (file && file->getType() == ResourceFile::Type::Lua)
+		{
+			scriptComponent->reloadScript((LuaTextResourceFile*)file);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "common/common.h"
+#include "core/event.h"
+
+#include <atomic>
+#include <thread>
+
+class ResourceFile;
+
+/// Reloads what was made from files that changed on disk, following the ResourceGraph so that only dependents of a changed file are touched.
+/// Materials are changed in place, models keep the buffers of unchanged meshes and entities only run their changed scripts again.
+/// Changed files are read and models are imported on a background thread, and everything is swapped in together at a frame boundary.
+/// Files that nothing is made from are left to their users, who can check ResourceFile::isDirty().
+class HotReloader
+{
+	/// A node of the ResourceGraph to reload
+	struct Reload
+	{
+		String m_Name;
+		/// Nullptr for entities
+		ResourceFile* m_File = nullptr;
+		/// If the file itself changed, rather than a file it is made from
+		bool m_IsChanged = false;
+		/// File contents or cooked model, read ahead on the background thread
+		FileBuffer m_Data;
+		JSON::json m_MaterialData;
+		bool m_IsPrepared = false;
+	};
+
+	bool m_IsEnabled;
+	/// Changed files waiting for the current batch to finish
+	HashSet<String> m_ChangedFiles;
+	Vector<Reload> m_Batch;
+	HashSet<String> m_BatchChangedFiles;
+	std::thread m_PrepareThread;
+	std::atomic<bool> m_IsBatchPrepared;
+
+	HotReloader();
+	HotReloader(HotReloader&) = delete;
+	~HotReloader();
+
+	Variant onFilesChanged(const Event* event);
+	void startBatch();
+	/// Runs on the background thread. Must not touch loaded resources.
+	void prepareBatch();
+	void applyBatch();
+	void applyEntity(const Reload& reload);
+	void applyFile(Reload& reload);
+
+public:
+	static HotReloader* GetSingleton();
+	/// Name of an entity in the ResourceGraph.
+	static String GetEntityName(EntityID entityID);
+	/// Path of the source file that a cooked file was made from, or the path itself if it is not a cooked file.
+	static String GetSourcePath(const String& path);
+
+	/// Swap in reloads that are ready and start reloading newly changed files. Call once per frame, between frames.
+	void update();
+
+	void setEnabled(bool enabled) { m_IsEnabled = enabled; }
+	bool isEnabled() const { return m_IsEnabled; }
+};
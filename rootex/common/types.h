@@ -49,6 +49,11 @@ using Map = std::map<P, Q>;
 template <class P, class Q>
 using HashMap = std::unordered_map<P, Q>;
 
+#include <unordered_set>
+/// std::unordered_set
+template <class T>
+using HashSet = std::unordered_set<T>;
+
 #include <utility>
 /// std::tuple
 template <typename...P>
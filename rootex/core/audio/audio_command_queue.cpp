@@ -0,0 +1,33 @@
+#include "audio_command_queue.h"
+
+AudioCommandQueue::AudioCommandQueue()
+    : m_Head(0)
+    , m_Tail(0)
+{
+}
+
+bool AudioCommandQueue::push(AudioCommand& command)
+{
+	const size_t tail = m_Tail.load(std::memory_order_relaxed);
+	if (tail - m_Head.load(std::memory_order_acquire) == s_Capacity)
+	{
+		return false;
+	}
+
+	m_Commands[tail & (s_Capacity - 1)] = std::move(command);
+	m_Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+bool AudioCommandQueue::pop(AudioCommand& command)
+{
+	const size_t head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_Tail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	command = std::move(m_Commands[head & (s_Capacity - 1)]);
+	m_Head.store(head + 1, std::memory_order_release);
+	return true;
+}
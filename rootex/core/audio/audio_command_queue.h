@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/types.h"
+
+#include <atomic>
+
+class AudioSource;
+
+/// A request from the game thread to be carried out on the audio thread.
+struct AudioCommand
+{
+	enum class Type
+	{
+		Play,
+		Pause,
+		Stop,
+		SetPosition,
+		SetLooping,
+		SetModel,
+		SetRolloffFactor,
+		SetReferenceDistance,
+		SetMaxDistance,
+		SetPriority,
+		/// Start tracking a source. Streaming sources are refilled by the audio thread from then on.
+		AddSource,
+		/// Stop tracking a source. The reference carried by the command is the last one dropped on the audio thread.
+		RemoveSource
+	};
+
+	Type m_Type = Type::Play;
+	AudioSource* m_Source = nullptr;
+	/// Keeps the source alive till the audio thread sees the command. Only set for AddSource and RemoveSource.
+	Ref<AudioSource> m_SourceRef;
+	Vector3 m_Position;
+	float m_Value = 0.0f;
+	int m_IntegerValue = 0;
+	bool m_IsEnabled = false;
+};
+
+/// Fixed size lock-free ring buffer of audio commands. Safe for exactly one producer thread and one consumer thread.
+class AudioCommandQueue
+{
+public:
+	/// Must be a power of 2.
+	static const size_t s_Capacity = 4096;
+
+private:
+	AudioCommand m_Commands[s_Capacity];
+
+	/// Next slot to be read. Written only by the consumer.
+	alignas(64) std::atomic<size_t> m_Head;
+	/// Next slot to be written. Written only by the producer.
+	alignas(64) std::atomic<size_t> m_Tail;
+
+public:
+	AudioCommandQueue();
+	AudioCommandQueue(AudioCommandQueue&) = delete;
+	~AudioCommandQueue() = default;
+
+	/// Returns false if the queue is full. Call only from the producer thread.
+	bool push(AudioCommand& command);
+	/// Returns false if the queue is empty. Call only from the consumer thread.
+	bool pop(AudioCommand& command);
+};
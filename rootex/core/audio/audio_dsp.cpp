@@ -0,0 +1,285 @@
+#include "audio_dsp.h"
+
+#include <emmintrin.h>
+
+float AudioDSP::Attenuate(AudioSource::AttenuationModel model, float distance, float referenceDistance, float maxDistance, float rolloffFactor)
+{
+	switch (model)
+	{
+	case AudioSource::AttenuationModel::InverseClamped:
+	case AudioSource::AttenuationModel::LinearClamped:
+	case AudioSource::AttenuationModel::ExponentialClamped:
+		distance = std::max(distance, referenceDistance);
+		distance = std::min(distance, maxDistance);
+		break;
+	case AudioSource::AttenuationModel::Linear:
+		distance = std::min(distance, maxDistance);
+		break;
+	default:
+		break;
+	}
+
+	float gain = 1.0f;
+	switch (model)
+	{
+	case AudioSource::AttenuationModel::Inverse:
+	case AudioSource::AttenuationModel::InverseClamped:
+	{
+		float denominator = referenceDistance + rolloffFactor * (distance - referenceDistance);
+		if (denominator > 0.0f)
+		{
+			gain = referenceDistance / denominator;
+		}
+		break;
+	}
+	case AudioSource::AttenuationModel::Linear:
+	case AudioSource::AttenuationModel::LinearClamped:
+		if (maxDistance > referenceDistance)
+		{
+			gain = 1.0f - rolloffFactor * (distance - referenceDistance) / (maxDistance - referenceDistance);
+		}
+		break;
+	case AudioSource::AttenuationModel::Exponential:
+	case AudioSource::AttenuationModel::ExponentialClamped:
+		if (distance > 0.0f && referenceDistance > 0.0f)
+		{
+			gain = powf(distance / referenceDistance, -rolloffFactor);
+		}
+		break;
+	}
+
+	return std::clamp(gain, 0.0f, 1.0f);
+}
+
+void AudioDSP::Attenuate(AudioSource::AttenuationModel model, const float* distances, const float* referenceDistances, const float* maxDistances, const float* rolloffFactors, float* gains, int count)
+{
+	bool isClamped = model == AudioSource::AttenuationModel::InverseClamped
+	    || model == AudioSource::AttenuationModel::LinearClamped
+	    || model == AudioSource::AttenuationModel::ExponentialClamped;
+	bool isInverse = model == AudioSource::AttenuationModel::Inverse || model == AudioSource::AttenuationModel::InverseClamped;
+	bool isLinear = model == AudioSource::AttenuationModel::Linear || model == AudioSource::AttenuationModel::LinearClamped;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	int i = 0;
+	// There is no SSE pow, so the exponential models only take the scalar path
+	if (isInverse || isLinear)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 distance = _mm_loadu_ps(distances + i);
+			__m128 reference = _mm_loadu_ps(referenceDistances + i);
+			__m128 maximum = _mm_loadu_ps(maxDistances + i);
+			__m128 rolloff = _mm_loadu_ps(rolloffFactors + i);
+
+			if (isClamped)
+			{
+				distance = _mm_min_ps(_mm_max_ps(distance, reference), maximum);
+			}
+			else if (isLinear)
+			{
+				distance = _mm_min_ps(distance, maximum);
+			}
+
+			__m128 gain;
+			if (isInverse)
+			{
+				__m128 denominator = _mm_add_ps(reference, _mm_mul_ps(rolloff, _mm_sub_ps(distance, reference)));
+				__m128 isValid = _mm_cmpgt_ps(denominator, zero);
+				gain = _mm_div_ps(reference, denominator);
+				gain = _mm_or_ps(_mm_and_ps(isValid, gain), _mm_andnot_ps(isValid, one));
+			}
+			else
+			{
+				__m128 range = _mm_sub_ps(maximum, reference);
+				__m128 isValid = _mm_cmpgt_ps(range, zero);
+				gain = _mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(rolloff, _mm_sub_ps(distance, reference)), range));
+				gain = _mm_or_ps(_mm_and_ps(isValid, gain), _mm_andnot_ps(isValid, one));
+			}
+
+			_mm_storeu_ps(gains + i, _mm_min_ps(_mm_max_ps(gain, zero), one));
+		}
+	}
+
+	for (; i < count; i++)
+	{
+		gains[i] = Attenuate(model, distances[i], referenceDistances[i], maxDistances[i], rolloffFactors[i]);
+	}
+}
+
+int AudioDSP::Resample(const float* samples, int frameCount, int channels, double& cursor, double step, bool isLooping, float* output, int outputFrames)
+{
+	int produced = 0;
+	while (produced < outputFrames)
+	{
+		// Interpolate whole vectors while every frame read and the frame after it are inside the sound
+		if (channels == 1)
+		{
+			while (produced + 4 <= outputFrames && (int)(cursor + 3 * step) + 1 < frameCount)
+			{
+				alignas(16) float from[4];
+				alignas(16) float to[4];
+				alignas(16) float fraction[4];
+				for (int k = 0; k < 4; k++)
+				{
+					double position = cursor + k * step;
+					int index = (int)position;
+					from[k] = samples[index];
+					to[k] = samples[index + 1];
+					fraction[k] = (float)(position - index);
+				}
+
+				__m128 a = _mm_load_ps(from);
+				__m128 b = _mm_load_ps(to);
+				_mm_storeu_ps(output + produced, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_load_ps(fraction))));
+				cursor += 4 * step;
+				produced += 4;
+			}
+		}
+		else
+		{
+			while (produced + 2 <= outputFrames && (int)(cursor + step) + 1 < frameCount)
+			{
+				int first = (int)cursor;
+				int second = (int)(cursor + step);
+				float firstFraction = (float)(cursor - first);
+				float secondFraction = (float)(cursor + step - second);
+
+				__m128 a = _mm_set_ps(samples[second * 2 + 1], samples[second * 2], samples[first * 2 + 1], samples[first * 2]);
+				__m128 b = _mm_set_ps(samples[second * 2 + 3], samples[second * 2 + 2], samples[first * 2 + 3], samples[first * 2 + 2]);
+				__m128 fraction = _mm_set_ps(secondFraction, secondFraction, firstFraction, firstFraction);
+				_mm_storeu_ps(output + produced * 2, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fraction)));
+				cursor += 2 * step;
+				produced += 2;
+			}
+		}
+
+		if (produced == outputFrames)
+		{
+			break;
+		}
+
+		// One frame at a time near the end of the sound, wrapping around if looping
+		if (cursor >= frameCount)
+		{
+			if (!isLooping || frameCount == 0)
+			{
+				break;
+			}
+			cursor = fmod(cursor, frameCount);
+		}
+		int index = (int)cursor;
+		int next = index + 1 < frameCount ? index + 1 : (isLooping ? 0 : index);
+		float fraction = (float)(cursor - index);
+		for (int c = 0; c < channels; c++)
+		{
+			float a = samples[index * channels + c];
+			float b = samples[next * channels + c];
+			output[produced * channels + c] = a + (b - a) * fraction;
+		}
+		cursor += step;
+		produced++;
+	}
+	return produced;
+}
+
+void AudioDSP::MixMono(const float* input, int frames, float leftGain, float rightGain, float* output)
+{
+	const __m128 gain = _mm_set_ps(rightGain, leftGain, rightGain, leftGain);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128 samples = _mm_loadu_ps(input + i);
+		__m128 low = _mm_unpacklo_ps(samples, samples);
+		__m128 high = _mm_unpackhi_ps(samples, samples);
+		_mm_storeu_ps(output + i * 2, _mm_add_ps(_mm_loadu_ps(output + i * 2), _mm_mul_ps(low, gain)));
+		_mm_storeu_ps(output + i * 2 + 4, _mm_add_ps(_mm_loadu_ps(output + i * 2 + 4), _mm_mul_ps(high, gain)));
+	}
+	for (; i < frames; i++)
+	{
+		output[i * 2] += input[i] * leftGain;
+		output[i * 2 + 1] += input[i] * rightGain;
+	}
+}
+
+void AudioDSP::MixStereo(const float* input, int frames, float leftGain, float rightGain, float* output)
+{
+	const __m128 gain = _mm_set_ps(rightGain, leftGain, rightGain, leftGain);
+
+	int i = 0;
+	for (; i + 2 <= frames; i += 2)
+	{
+		_mm_storeu_ps(output + i * 2, _mm_add_ps(_mm_loadu_ps(output + i * 2), _mm_mul_ps(_mm_loadu_ps(input + i * 2), gain)));
+	}
+	for (; i < frames; i++)
+	{
+		output[i * 2] += input[i * 2] * leftGain;
+		output[i * 2 + 1] += input[i * 2 + 1] * rightGain;
+	}
+}
+
+void AudioDSP::GetPanGains(float pan, int channels, float& leftGain, float& rightGain)
+{
+	pan = std::clamp(pan, -1.0f, 1.0f);
+	if (channels == 1)
+	{
+		float angle = (pan + 1.0f) * DirectX::XM_PIDIV4;
+		leftGain = cosf(angle);
+		rightGain = sinf(angle);
+	}
+	else
+	{
+		leftGain = std::min(1.0f, 1.0f - pan);
+		rightGain = std::min(1.0f, 1.0f + pan);
+	}
+}
+
+void AudioDSP::ConvertFromPCM16(const short* input, int count, float* output)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i samples = _mm_loadu_si128((const __m128i*)(input + i));
+		// Sign extend by moving each sample to the top half and shifting it back down
+		__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+		__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+		_mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+		_mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+	}
+	for (; i < count; i++)
+	{
+		output[i] = input[i] / 32768.0f;
+	}
+}
+
+void AudioDSP::ConvertFromPCM8(const unsigned char* input, int count, float* output)
+{
+	for (int i = 0; i < count; i++)
+	{
+		output[i] = (input[i] - 128) / 128.0f;
+	}
+}
+
+void AudioDSP::ConvertToPCM16(const float* input, int count, short* output)
+{
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 minimum = _mm_set1_ps(-1.0f);
+	const __m128 maximum = _mm_set1_ps(1.0f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i), minimum), maximum);
+		__m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i + 4), minimum), maximum);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(low, scale)), _mm_cvtps_epi32(_mm_mul_ps(high, scale)));
+		_mm_storeu_si128((__m128i*)(output + i), packed);
+	}
+	for (; i < count; i++)
+	{
+		output[i] = (short)lrintf(std::clamp(input[i], -1.0f, 1.0f) * 32767.0f);
+	}
+}
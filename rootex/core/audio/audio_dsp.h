@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common/types.h"
+#include "audio_source.h"
+
+/// SSE kernels used by the AudioMixer. Every kernel processes blocks of 4 floats and finishes leftover samples one by one.
+/// Stereo audio is interleaved, left sample first.
+class AudioDSP
+{
+public:
+	/// Gain after distance attenuation, computed the same way OpenAL does for each AttenuationModel.
+	static float Attenuate(AudioSource::AttenuationModel model, float distance, float referenceDistance, float maxDistance, float rolloffFactor);
+	/// Attenuate many sources sharing the same model at once.
+	static void Attenuate(AudioSource::AttenuationModel model, const float* distances, const float* referenceDistances, const float* maxDistances, const float* rolloffFactors, float* gains, int count);
+
+	/// Read frames from a sound with linear interpolation, advancing cursor by step source frames per output frame.
+	/// Returns the number of frames written, less than outputFrames only if a sound that is not looping ends.
+	static int Resample(const float* samples, int frameCount, int channels, double& cursor, double step, bool isLooping, float* output, int outputFrames);
+
+	/// Add a mono signal to a stereo signal, with separate left and right gains.
+	static void MixMono(const float* input, int frames, float leftGain, float rightGain, float* output);
+	/// Add a stereo signal to another, with separate left and right gains.
+	static void MixStereo(const float* input, int frames, float leftGain, float rightGain, float* output);
+
+	/// Left and right gains for a pan from -1 (left) to 1 (right). Mono uses a constant power pan law, stereo uses balance.
+	static void GetPanGains(float pan, int channels, float& leftGain, float& rightGain);
+
+	/// Convert signed 16 bit PCM to floats in [-1, 1].
+	static void ConvertFromPCM16(const short* input, int count, float* output);
+	/// Convert unsigned 8 bit PCM to floats in [-1, 1].
+	static void ConvertFromPCM8(const unsigned char* input, int count, float* output);
+	/// Convert floats to signed 16 bit PCM, clipping anything outside [-1, 1].
+	static void ConvertToPCM16(const float* input, int count, short* output);
+};
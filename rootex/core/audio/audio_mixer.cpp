@@ -0,0 +1,271 @@
+#include "audio_mixer.h"
+
+#include "audio_dsp.h"
+#include "core/resource_file.h"
+
+Ref<MixerSound> MixerSound::Create(AudioResourceFile* audioFile)
+{
+	const char* data = audioFile->getAudioData();
+	int sampleCount = audioFile->getAudioDataSize() / (audioFile->getBitDepth() / 8);
+
+	Vector<float> samples(sampleCount);
+	if (audioFile->getBitDepth() == 16)
+	{
+		AudioDSP::ConvertFromPCM16((const short*)data, sampleCount, samples.data());
+	}
+	else
+	{
+		AudioDSP::ConvertFromPCM8((const unsigned char*)data, sampleCount, samples.data());
+	}
+
+	return Ref<MixerSound>(new MixerSound(std::move(samples), audioFile->getChannels(), audioFile->getFrequency()));
+}
+
+MixerSound::MixerSound(Vector<float>&& samples, int channels, float sampleRate)
+    : m_Samples(std::move(samples))
+    , m_Channels(channels)
+    , m_SampleRate(sampleRate)
+{
+}
+
+AudioMixer::AudioMixer(float sampleRate, int blockFrames)
+    : m_SampleRate(sampleRate)
+    , m_BlockFrames(blockFrames)
+    , m_ListenerPosition(0.0f, 0.0f, 0.0f)
+{
+	m_VoiceBuffer.resize(m_BlockFrames * 2);
+	addBus();
+}
+
+AudioMixer::BusID AudioMixer::addBus(float gain)
+{
+	Bus bus;
+	bus.m_Gain = gain;
+	bus.m_Buffer.resize(m_BlockFrames * 2);
+	m_Buses.push_back(bus);
+	return m_Buses.size() - 1;
+}
+
+void AudioMixer::setBusGain(BusID bus, float gain)
+{
+	m_Buses[bus].m_Gain = gain;
+}
+
+AudioMixer::VoiceID AudioMixer::addVoice(Ref<MixerSound> sound, BusID bus)
+{
+	Voice voice;
+	voice.m_Sound = sound;
+	voice.m_Bus = bus;
+
+	if (!m_FreeVoices.empty())
+	{
+		VoiceID id = m_FreeVoices.back();
+		m_FreeVoices.pop_back();
+		m_Voices[id] = voice;
+		return id;
+	}
+	m_Voices.push_back(voice);
+	return m_Voices.size() - 1;
+}
+
+void AudioMixer::removeVoice(VoiceID voice)
+{
+	m_Voices[voice] = Voice();
+	m_FreeVoices.push_back(voice);
+}
+
+void AudioMixer::play(VoiceID voice)
+{
+	m_Voices[voice].m_Cursor = 0.0;
+	m_Voices[voice].m_IsPlaying = m_Voices[voice].m_Sound != nullptr;
+}
+
+void AudioMixer::stop(VoiceID voice)
+{
+	m_Voices[voice].m_IsPlaying = false;
+	m_Voices[voice].m_Cursor = 0.0;
+}
+
+void AudioMixer::setAttenuation(VoiceID voice, AudioSource::AttenuationModel model, float referenceDistance, float maxDistance, float rolloffFactor)
+{
+	Voice& target = m_Voices[voice];
+	target.m_IsAttenuated = true;
+	target.m_Model = model;
+	target.m_ReferenceDistance = referenceDistance;
+	target.m_MaxDistance = maxDistance;
+	target.m_RolloffFactor = rolloffFactor;
+}
+
+int AudioMixer::getPlayingVoiceCount() const
+{
+	int count = 0;
+	for (auto& voice : m_Voices)
+	{
+		count += voice.m_IsPlaying;
+	}
+	return count;
+}
+
+void AudioMixer::updateAttenuation()
+{
+	static const AudioSource::AttenuationModel models[] = {
+		AudioSource::AttenuationModel::Linear,
+		AudioSource::AttenuationModel::Inverse,
+		AudioSource::AttenuationModel::Exponential,
+		AudioSource::AttenuationModel::LinearClamped,
+		AudioSource::AttenuationModel::InverseClamped,
+		AudioSource::AttenuationModel::ExponentialClamped
+	};
+
+	for (AudioSource::AttenuationModel model : models)
+	{
+		m_BatchVoices.clear();
+		m_BatchDistances.clear();
+		m_BatchReferenceDistances.clear();
+		m_BatchMaxDistances.clear();
+		m_BatchRolloffFactors.clear();
+		for (int i = 0; i < m_Voices.size(); i++)
+		{
+			Voice& voice = m_Voices[i];
+			if (!voice.m_IsPlaying || !voice.m_IsAttenuated || voice.m_Model != model)
+			{
+				continue;
+			}
+			m_BatchVoices.push_back(i);
+			m_BatchDistances.push_back(Vector3::Distance(voice.m_Position, m_ListenerPosition));
+			m_BatchReferenceDistances.push_back(voice.m_ReferenceDistance);
+			m_BatchMaxDistances.push_back(voice.m_MaxDistance);
+			m_BatchRolloffFactors.push_back(voice.m_RolloffFactor);
+		}
+		if (m_BatchVoices.empty())
+		{
+			continue;
+		}
+
+		m_BatchGains.resize(m_BatchVoices.size());
+		AudioDSP::Attenuate(
+		    model,
+		    m_BatchDistances.data(),
+		    m_BatchReferenceDistances.data(),
+		    m_BatchMaxDistances.data(),
+		    m_BatchRolloffFactors.data(),
+		    m_BatchGains.data(),
+		    m_BatchVoices.size());
+		for (int i = 0; i < m_BatchVoices.size(); i++)
+		{
+			m_Voices[m_BatchVoices[i]].m_AttenuationGain = m_BatchGains[i];
+		}
+	}
+}
+
+void AudioMixer::renderBlock(float* output, int frames)
+{
+	for (auto& bus : m_Buses)
+	{
+		std::fill(bus.m_Buffer.begin(), bus.m_Buffer.begin() + frames * 2, 0.0f);
+	}
+
+	updateAttenuation();
+
+	for (auto& voice : m_Voices)
+	{
+		if (!voice.m_IsPlaying)
+		{
+			continue;
+		}
+
+		const MixerSound* sound = voice.m_Sound.get();
+		double step = sound->getSampleRate() / m_SampleRate * voice.m_Pitch;
+		int produced = AudioDSP::Resample(sound->getSamples(), sound->getFrameCount(), sound->getChannels(), voice.m_Cursor, step, voice.m_IsLooping, m_VoiceBuffer.data(), frames);
+		if (produced < frames)
+		{
+			voice.m_IsPlaying = false;
+			voice.m_Cursor = 0.0;
+		}
+
+		float gain = voice.m_Gain * (voice.m_IsAttenuated ? voice.m_AttenuationGain : 1.0f);
+		float leftGain;
+		float rightGain;
+		AudioDSP::GetPanGains(voice.m_Pan, sound->getChannels(), leftGain, rightGain);
+
+		float* busBuffer = m_Buses[voice.m_Bus].m_Buffer.data();
+		if (sound->getChannels() == 1)
+		{
+			AudioDSP::MixMono(m_VoiceBuffer.data(), produced, leftGain * gain, rightGain * gain, busBuffer);
+		}
+		else
+		{
+			AudioDSP::MixStereo(m_VoiceBuffer.data(), produced, leftGain * gain, rightGain * gain, busBuffer);
+		}
+	}
+
+	float* masterBuffer = m_Buses[MasterBus].m_Buffer.data();
+	for (int i = 1; i < m_Buses.size(); i++)
+	{
+		AudioDSP::MixStereo(m_Buses[i].m_Buffer.data(), frames, m_Buses[i].m_Gain, m_Buses[i].m_Gain, masterBuffer);
+	}
+
+	std::fill(output, output + frames * 2, 0.0f);
+	AudioDSP::MixStereo(masterBuffer, frames, m_Buses[MasterBus].m_Gain, m_Buses[MasterBus].m_Gain, output);
+}
+
+void AudioMixer::render(float* output, int frames)
+{
+	while (frames > 0)
+	{
+		int blockFrames = std::min(frames, m_BlockFrames);
+		renderBlock(output, blockFrames);
+		output += blockFrames * 2;
+		frames -= blockFrames;
+	}
+}
+
+void AudioMixer::render(Vector<float>& output, float seconds)
+{
+	int frames = seconds * m_SampleRate;
+	output.resize(frames * 2);
+	render(output.data(), frames);
+}
+
+bool AudioMixer::renderToWAV(const String& path, float seconds)
+{
+	Vector<float> mix;
+	render(mix, seconds);
+
+	Vector<short> pcm(mix.size());
+	AudioDSP::ConvertToPCM16(mix.data(), mix.size(), pcm.data());
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		ERR("Could not open file for writing: " + path);
+		return false;
+	}
+
+	const short channels = 2;
+	const short bitDepth = 16;
+	const short blockAlign = channels * bitDepth / 8;
+	const short pcmFormat = 1;
+	const unsigned int formatSize = 16;
+	const unsigned int sampleRate = m_SampleRate;
+	const unsigned int byteRate = sampleRate * blockAlign;
+	const unsigned int dataSize = pcm.size() * sizeof(short);
+	const unsigned int riffSize = 4 + 8 + formatSize + 8 + dataSize;
+
+	file.write("RIFF", 4);
+	file.write((const char*)&riffSize, 4);
+	file.write("WAVE", 4);
+	file.write("fmt ", 4);
+	file.write((const char*)&formatSize, 4);
+	file.write((const char*)&pcmFormat, 2);
+	file.write((const char*)&channels, 2);
+	file.write((const char*)&sampleRate, 4);
+	file.write((const char*)&byteRate, 4);
+	file.write((const char*)&blockAlign, 2);
+	file.write((const char*)&bitDepth, 2);
+	file.write("data", 4);
+	file.write((const char*)&dataSize, 4);
+	file.write((const char*)pcm.data(), dataSize);
+
+	return (bool)file;
+}
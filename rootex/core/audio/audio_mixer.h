@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/common.h"
+#include "audio_source.h"
+
+class AudioResourceFile;
+
+/// Fully decoded audio in floats, ready to be played by an AudioMixer.
+class MixerSound
+{
+	Vector<float> m_Samples;
+	int m_Channels;
+	float m_SampleRate;
+
+public:
+	/// Decode all PCM data of an audio file.
+	static Ref<MixerSound> Create(AudioResourceFile* audioFile);
+
+	MixerSound(Vector<float>&& samples, int channels, float sampleRate);
+	MixerSound(MixerSound&) = delete;
+	~MixerSound() = default;
+
+	const float* getSamples() const { return m_Samples.data(); }
+	int getFrameCount() const { return m_Samples.size() / m_Channels; }
+	int getChannels() const { return m_Channels; }
+	float getSampleRate() const { return m_SampleRate; }
+};
+
+/// Mixes sounds in software into stereo float output, without needing an audio device.
+/// Voices are mixed into buses, and buses into the master bus. Useful for rendering audio offline and for measuring mixing cost.
+class AudioMixer
+{
+public:
+	typedef int VoiceID;
+	typedef int BusID;
+
+	/// Always exists. Voices can be mixed into it directly.
+	static const BusID MasterBus = 0;
+
+private:
+	struct Voice
+	{
+		Ref<MixerSound> m_Sound;
+		BusID m_Bus = MasterBus;
+		/// Position in source frames.
+		double m_Cursor = 0.0;
+		float m_Pitch = 1.0f;
+		float m_Gain = 1.0f;
+		float m_Pan = 0.0f;
+		bool m_IsPlaying = false;
+		bool m_IsLooping = false;
+		bool m_IsAttenuated = false;
+		Vector3 m_Position;
+		AudioSource::AttenuationModel m_Model = AudioSource::AttenuationModel::InverseClamped;
+		float m_ReferenceDistance = 1.0f;
+		float m_MaxDistance = FLT_MAX;
+		float m_RolloffFactor = 1.0f;
+		/// Gain from distance attenuation, updated once per block.
+		float m_AttenuationGain = 1.0f;
+	};
+
+	struct Bus
+	{
+		float m_Gain = 1.0f;
+		Vector<float> m_Buffer;
+	};
+
+	float m_SampleRate;
+	int m_BlockFrames;
+	Vector3 m_ListenerPosition;
+
+	Vector<Voice> m_Voices;
+	Vector<VoiceID> m_FreeVoices;
+	Vector<Bus> m_Buses;
+
+	Vector<float> m_VoiceBuffer;
+	// Attenuation inputs and outputs of voices sharing a model, kept around to avoid allocating per block
+	Vector<VoiceID> m_BatchVoices;
+	Vector<float> m_BatchDistances;
+	Vector<float> m_BatchReferenceDistances;
+	Vector<float> m_BatchMaxDistances;
+	Vector<float> m_BatchRolloffFactors;
+	Vector<float> m_BatchGains;
+
+	void updateAttenuation();
+	void renderBlock(float* output, int frames);
+
+public:
+	AudioMixer(float sampleRate = 48000.0f, int blockFrames = 256);
+	AudioMixer(AudioMixer&) = delete;
+	~AudioMixer() = default;
+
+	/// Add a bus that mixes into the master bus.
+	BusID addBus(float gain = 1.0f);
+	void setBusGain(BusID bus, float gain);
+
+	VoiceID addVoice(Ref<MixerSound> sound, BusID bus = MasterBus);
+	void removeVoice(VoiceID voice);
+
+	/// Play from the start.
+	void play(VoiceID voice);
+	void stop(VoiceID voice);
+	bool isPlaying(VoiceID voice) const { return m_Voices[voice].m_IsPlaying; }
+
+	void setGain(VoiceID voice, float gain) { m_Voices[voice].m_Gain = gain; }
+	/// -1 is fully left, 1 is fully right.
+	void setPan(VoiceID voice, float pan) { m_Voices[voice].m_Pan = pan; }
+	/// Playback speed. Changes pitch as well.
+	void setPitch(VoiceID voice, float pitch) { m_Voices[voice].m_Pitch = pitch; }
+	void setLooping(VoiceID voice, bool enabled) { m_Voices[voice].m_IsLooping = enabled; }
+	void setPosition(VoiceID voice, const Vector3& position) { m_Voices[voice].m_Position = position; }
+	/// Attenuate a voice by its distance from the listener, like OpenAL would.
+	void setAttenuation(VoiceID voice, AudioSource::AttenuationModel model, float referenceDistance, float maxDistance, float rolloffFactor);
+	void setListenerPosition(const Vector3& position) { m_ListenerPosition = position; }
+
+	/// Mix interleaved stereo frames into output, overwriting it.
+	void render(float* output, int frames);
+	/// Mix seconds of audio into output, overwriting it.
+	void render(Vector<float>& output, float seconds);
+	/// Mix seconds of audio and save them as a 16 bit stereo .wav file.
+	bool renderToWAV(const String& path, float seconds);
+
+	float getSampleRate() const { return m_SampleRate; }
+	int getPlayingVoiceCount() const;
+};
@@ -1,129 +1,215 @@
 #include "audio_source.h"
 
 #include "framework/systems/audio_system.h"
+#include "audio_dsp.h"
 #include "static_audio_buffer.h"
 #include "streaming_audio_buffer.h"
 
 AudioSource::AudioSource(bool isStreaming)
-    : m_IsStreaming(isStreaming)
-{
-	AL_CHECK(alGenSources(1, &m_SourceID));
-}
-
-AudioSource::~AudioSource()
+    : m_SourceID(0)
+    , m_IsStreaming(isStreaming)
+    , m_RequestedState(State::Stopped)
+    , m_PlayCount(0)
+    , m_FinishedPlayCount(0)
+    , m_PlaybackOffset(0.0f)
+    , m_State(State::Stopped)
+    , m_PlayingCount(0)
+    , m_IsStarting(false)
+    , m_IsLooping(false)
+    , m_Priority(0)
+    , m_Position(0.0f, 0.0f, 0.0f)
+    , m_Model(AttenuationModel::InverseClamped)
+    , m_RolloffFactor(1.0f)
+    , m_ReferenceDistance(1.0f)
+    , m_MaxDistance(FLT_MAX)
 {
-	AL_CHECK(alDeleteSources(1, &m_SourceID));
 }
 
-void AudioSource::setLooping(bool enabled)
+void AudioSource::send(AudioCommand& command)
 {
-	AL_CHECK(alSourcei(m_SourceID, AL_LOOPING, enabled));
+	command.m_Source = this;
+	AudioSystem::GetSingleton()->pushCommand(command);
 }
 
-void AudioSource::queueNewBuffers()
+void AudioSource::apply(const AudioCommand& command)
 {
-	// Empty
-}
+	switch (command.m_Type)
+	{
+	case AudioCommand::Type::SetPosition:
+		m_Position = command.m_Position;
+		break;
+	case AudioCommand::Type::SetLooping:
+		m_IsLooping = command.m_IsEnabled;
+		break;
+	case AudioCommand::Type::SetModel:
+		m_Model = (AttenuationModel)command.m_IntegerValue;
+		// OpenAL only has a single distance model for all sources
+		AL_CHECK(alDistanceModel((ALenum)m_Model));
+		break;
+	case AudioCommand::Type::SetRolloffFactor:
+		m_RolloffFactor = command.m_Value;
+		break;
+	case AudioCommand::Type::SetReferenceDistance:
+		m_ReferenceDistance = command.m_Value;
+		break;
+	case AudioCommand::Type::SetMaxDistance:
+		m_MaxDistance = command.m_Value;
+		break;
+	case AudioCommand::Type::SetPriority:
+		m_Priority = command.m_IntegerValue;
+		break;
+	default:
+		break;
+	}
 
-void AudioSource::play()
-{
-	AL_CHECK(alSourcePlay(m_SourceID));
+	if (hasVoice())
+	{
+		applyParameters();
+	}
 }
 
-void AudioSource::pause()
+void AudioSource::applyParameters()
 {
-	AL_CHECK(alSourcePause(m_SourceID));
+	AL_CHECK(alSource3f(m_SourceID, AL_POSITION, m_Position.x, m_Position.y, m_Position.z));
+	AL_CHECK(alSourcef(m_SourceID, AL_ROLLOFF_FACTOR, m_RolloffFactor));
+	AL_CHECK(alSourcef(m_SourceID, AL_REFERENCE_DISTANCE, m_ReferenceDistance));
+	AL_CHECK(alSourcef(m_SourceID, AL_MAX_DISTANCE, m_MaxDistance));
+	// Streaming sources loop by requeueing from the start
+	AL_CHECK(alSourcei(m_SourceID, AL_LOOPING, m_IsLooping && !m_IsStreaming));
 }
 
-void AudioSource::stop()
+float AudioSource::getAttenuatedGain(const Vector3& listenerPosition) const
 {
-	AL_CHECK(alSourceStop(m_SourceID));
+	float distance = Vector3::Distance(m_Position, listenerPosition);
+	return AudioDSP::Attenuate(m_Model, distance, m_ReferenceDistance, m_MaxDistance, m_RolloffFactor);
 }
 
-bool AudioSource::isPlaying() const
+void AudioSource::queueNewBuffers()
 {
-	ALenum state;
-	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
-	return state == AL_PLAYING;
+	// Empty
 }
 
-bool AudioSource::isPaused() const
+void AudioSource::setLooping(bool enabled)
 {
-	ALenum state;
-	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
-	return state == AL_PAUSED;
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetLooping;
+	command.m_IsEnabled = enabled;
+	send(command);
 }
 
-bool AudioSource::isStopped() const
+void AudioSource::play()
 {
-	ALenum state;
-	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
-	return state == AL_STOPPED;
+	m_RequestedState = State::Playing;
+	m_PlayCount++;
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::Play;
+	command.m_IntegerValue = m_PlayCount;
+	send(command);
 }
 
-bool AudioSource::isLooping() const
+void AudioSource::pause()
 {
-	ALenum state;
-	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
-	return (state == AL_LOOPING);
+	if (isPlaying())
+	{
+		m_RequestedState = State::Paused;
+	}
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::Pause;
+	send(command);
 }
 
-ALuint AudioSource::getSourceID() const
+void AudioSource::stop()
 {
-	return m_SourceID;
+	m_RequestedState = State::Stopped;
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::Stop;
+	send(command);
 }
 
-void AudioSource::setPosition(Vector3& position)
+void AudioSource::setPosition(const Vector3& position)
 {
-	AL_CHECK(alSource3f(m_SourceID, AL_POSITION, position.x, position.y, position.z));
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetPosition;
+	command.m_Position = position;
+	send(command);
 }
 
 void AudioSource::setRollOffFactor(ALfloat rolloffFactor)
 {
-	AL_CHECK(alSourcef(m_SourceID, AL_ROLLOFF_FACTOR, rolloffFactor));
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetRolloffFactor;
+	command.m_Value = rolloffFactor;
+	send(command);
 }
 
 void AudioSource::setReferenceDistance(ALfloat referenceDistance)
 {
-	AL_CHECK(alSourcef(m_SourceID, AL_REFERENCE_DISTANCE, referenceDistance));
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetReferenceDistance;
+	command.m_Value = referenceDistance;
+	send(command);
 }
 
 void AudioSource::setMaxDistance(ALfloat maxDistance)
 {
-	AL_CHECK(alSourcef(m_SourceID, AL_MAX_DISTANCE, maxDistance));
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetMaxDistance;
+	command.m_Value = maxDistance;
+	send(command);
 }
 
 void AudioSource::setModel(AudioSource::AttenuationModel distanceModel)
 {
-	AL_CHECK(alDistanceModel((ALenum)distanceModel));
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetModel;
+	command.m_IntegerValue = (int)distanceModel;
+	send(command);
+}
+
+void AudioSource::setPriority(int priority)
+{
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::SetPriority;
+	command.m_IntegerValue = priority;
+	send(command);
 }
 
 StaticAudioSource::StaticAudioSource(Ref<StaticAudioBuffer> audio)
     : AudioSource(false)
     , m_StaticAudio(audio)
 {
-	AL_CHECK(alSourcei(m_SourceID, AL_BUFFER, audio->getBuffer()));
 }
 
-StaticAudioSource::~StaticAudioSource()
+void StaticAudioSource::bindVoice(ALuint sourceID)
 {
-	if (isPlaying())
-	{
-		stop();
-		unqueueBuffers();
-	}
+	m_SourceID = sourceID;
+	AL_CHECK(alSourcei(m_SourceID, AL_BUFFER, m_StaticAudio->getBuffer()));
+	applyParameters();
+	AL_CHECK(alSourcef(m_SourceID, AL_SEC_OFFSET, m_PlaybackOffset));
+	AL_CHECK(alSourcePlay(m_SourceID));
 }
 
-float StaticAudioSource::getElapsedTimeS()
+void StaticAudioSource::unbindVoice()
 {
-	float pos = 0;
-	AL_CHECK(alGetSourcef(m_SourceID, AL_SEC_OFFSET, &pos));
-	return pos;
+	ALint state;
+	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
+	if (state == AL_PLAYING)
+	{
+		float offset = 0.0f;
+		AL_CHECK(alGetSourcef(m_SourceID, AL_SEC_OFFSET, &offset));
+		m_PlaybackOffset = offset;
+	}
+
+	AL_CHECK(alSourceStop(m_SourceID));
+	AL_CHECK(alSourcei(m_SourceID, AL_BUFFER, 0));
+	m_SourceID = 0;
 }
 
-void StaticAudioSource::unqueueBuffers()
+bool StaticAudioSource::isVoiceFinished() const
 {
-	AL_CHECK(alSourceUnqueueBuffers(m_SourceID, 1, &m_StaticAudio->getBuffer()));
+	ALint state;
+	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
+	return state == AL_STOPPED;
 }
 
 float StaticAudioSource::getDuration() const
@@ -134,37 +220,64 @@ float StaticAudioSource::getDuration() const
 StreamingAudioSource::StreamingAudioSource(Ref<StreamingAudioBuffer> audio)
     : AudioSource(true)
     , m_StreamingAudio(audio)
-    , m_IsLooping(false)
 {
-	AL_CHECK(alSourceQueueBuffers(m_SourceID, m_StreamingAudio->getBufferQueueLength(), m_StreamingAudio->getBuffers()));
 }
 
-StreamingAudioSource::~StreamingAudioSource()
+void StreamingAudioSource::bindVoice(ALuint sourceID)
 {
-	if (isPlaying())
+	m_SourceID = sourceID;
+	applyParameters();
+
+	m_StreamingAudio->seek(m_PlaybackOffset, m_IsLooping);
+	int numLoaded = m_StreamingAudio->loadNewBuffers(m_StreamingAudio->getBuffers(), BUFFER_COUNT, m_IsLooping);
+	if (numLoaded > 0)
 	{
-		stop();
-		unqueueBuffers();
+		AL_CHECK(alSourceQueueBuffers(m_SourceID, numLoaded, m_StreamingAudio->getBuffers()));
+		AL_CHECK(alSourcePlay(m_SourceID));
 	}
 }
 
-void StreamingAudioSource::setLooping(bool enabled)
+void StreamingAudioSource::unbindVoice()
+{
+	AL_CHECK(alSourceStop(m_SourceID));
+
+	ALint numQueued;
+	AL_CHECK(alGetSourcei(m_SourceID, AL_BUFFERS_QUEUED, &numQueued));
+	ALuint buffers[BUFFER_COUNT];
+	AL_CHECK(alSourceUnqueueBuffers(m_SourceID, numQueued, buffers));
+	m_SourceID = 0;
+}
+
+bool StreamingAudioSource::isVoiceFinished() const
 {
-	m_IsLooping = enabled;
+	// Playback is restarted on underruns while there is audio left
+	ALint state;
+	AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &state));
+	return state != AL_PLAYING;
 }
 
 void StreamingAudioSource::queueNewBuffers()
 {
+	if (!hasVoice())
+	{
+		return;
+	}
+
 	int numUsedUp;
 	AL_CHECK(alGetSourcei(m_SourceID, AL_BUFFERS_PROCESSED, &numUsedUp));
 
 	if (numUsedUp > 0)
 	{
-		AL_CHECK(alSourceUnqueueBuffers(m_SourceID, numUsedUp, m_StreamingAudio->getBuffers()));
-		m_StreamingAudio->loadNewBuffers(numUsedUp, isLooping());
-		AL_CHECK(alSourceQueueBuffers(m_SourceID, numUsedUp, m_StreamingAudio->getBuffers()));
+		ALuint buffers[BUFFER_COUNT];
+		AL_CHECK(alSourceUnqueueBuffers(m_SourceID, numUsedUp, buffers));
+		int numLoaded = m_StreamingAudio->loadNewBuffers(buffers, numUsedUp, m_IsLooping);
+		if (numLoaded == 0)
+		{
+			return;
+		}
+		AL_CHECK(alSourceQueueBuffers(m_SourceID, numLoaded, buffers));
 
-		static ALint val;
+		ALint val;
 		AL_CHECK(alGetSourcei(m_SourceID, AL_SOURCE_STATE, &val));
 		if (val != AL_PLAYING)
 		{
@@ -173,12 +286,7 @@ void StreamingAudioSource::queueNewBuffers()
 	}
 }
 
-void StreamingAudioSource::unqueueBuffers()
-{
-	AL_CHECK(alSourceUnqueueBuffers(m_SourceID, BUFFER_COUNT, m_StreamingAudio->getBuffers()));
-}
-
 float StreamingAudioSource::getDuration() const
 {
 	return m_StreamingAudio->getAudioFile()->getDuration();
-}
\ No newline at end of file
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include "rootex\vendor\OpenAL\include\al.h"
+#include "audio_command_queue.h"
+
+#include <atomic>
 
 class StreamingAudioBuffer;
 class StaticAudioBuffer;
@@ -11,16 +14,10 @@ typedef float ALfloat;
 #define MIN_TO_S 60.0f
 
 /// An interface for an audio source in the game world.
+/// An audio source does not own an OpenAL source. The VoiceManager binds one from its pool while the source is playing and audible enough,
+/// otherwise the source is virtual and only its playback position is tracked.
 class AudioSource
 {
-protected:
-	ALuint m_SourceID;
-
-	/// RTTI for storing if the audio buffer is being streamed
-	bool m_IsStreaming;
-	AudioSource(bool isStreaming);
-	virtual ~AudioSource();
-
 public:
 	/// Defines all attenuation models provided by OpenAL
 	enum class AttenuationModel
@@ -33,29 +30,101 @@ public:
 		ExponentialClamped = AL_EXPONENT_DISTANCE_CLAMPED
 	};
 
-	virtual void setLooping(bool enabled);
-	/// Queue new buffers to the audio card if possible.
+	enum class State
+	{
+		Stopped,
+		Playing,
+		Paused
+	};
+
+protected:
+	/// OpenAL source bound by the VoiceManager. 0 if the source is virtual.
+	ALuint m_SourceID;
+
+	/// RTTI for storing if the audio buffer is being streamed
+	bool m_IsStreaming;
+
+	// Only used on the game thread
+	/// State asked for by the last playback control, so that it reads back before the audio thread gets to the command.
+	State m_RequestedState;
+	/// Number of calls to play, sent along with each Play command.
+	unsigned int m_PlayCount;
+
+	/// Play command whose playback ran out on its own. Written only on the audio thread.
+	std::atomic<unsigned int> m_FinishedPlayCount;
+	/// Seconds played so far. Written only on the audio thread.
+	std::atomic<float> m_PlaybackOffset;
+
+	// Only used on the audio thread
+	State m_State;
+	/// Play command being played.
+	unsigned int m_PlayingCount;
+	/// Set by play, so that the first update does not skip ahead.
+	bool m_IsStarting;
+	bool m_IsLooping;
+	int m_Priority;
+	Vector3 m_Position;
+	AttenuationModel m_Model;
+	ALfloat m_RolloffFactor;
+	ALfloat m_ReferenceDistance;
+	ALfloat m_MaxDistance;
+
+	AudioSource(bool isStreaming);
+
+	void send(AudioCommand& command);
+	/// Apply a parameter change. Called on the audio thread.
+	void apply(const AudioCommand& command);
+	/// Set every parameter on the bound OpenAL source.
+	void applyParameters();
+
+	/// Start playing on an OpenAL source from the tracked playback position.
+	virtual void bindVoice(ALuint sourceID) = 0;
+	/// Stop playing on the bound OpenAL source, keeping the playback position.
+	virtual void unbindVoice() = 0;
+	/// If the bound OpenAL source has run out of audio.
+	virtual bool isVoiceFinished() const = 0;
+
+	/// Gain that OpenAL would apply at a distance, after attenuation.
+	float getAttenuatedGain(const Vector3& listenerPosition) const;
+	/// If the audio thread has played the last play command to its end.
+	bool hasFinished() const { return m_FinishedPlayCount == m_PlayCount; }
+
+	friend class AudioSystem;
+	friend class VoiceManager;
+
+public:
+	virtual ~AudioSource() = default;
+
+	/// Queue new buffers to the audio card if possible. Called on the audio thread.
 	virtual void queueNewBuffers();
 
+	/// Playback controls are sent to the audio thread and take effect on its next update. The state they set reads back right away.
+	void setLooping(bool enabled);
 	void play();
 	void pause();
 	void stop();
 
-	bool isPlaying() const;
-	bool isPaused() const;
-	bool isStopped() const;
-	bool isLooping() const;
-	ALuint getSourceID() const;
+	bool isPlaying() const { return m_RequestedState == State::Playing && !hasFinished(); }
+	bool isPaused() const { return m_RequestedState == State::Paused && !hasFinished(); }
+	bool isStopped() const { return m_RequestedState == State::Stopped || hasFinished(); }
+	bool isStreaming() const { return m_IsStreaming; }
+	/// If the source is bound to an OpenAL source right now.
+	bool hasVoice() const { return m_SourceID != 0; }
 	/// Get audio duration in seconds.
 	virtual float getDuration() const = 0;
+	/// Get seconds played so far.
+	float getElapsedTimeS() const { return m_PlaybackOffset; }
 
-	void setPosition(Vector3& position);
+	/// Sent to the audio thread.
+	void setPosition(const Vector3& position);
 	void setModel(AttenuationModel distanceModel);
 	/// Roll Off Factor: The rate of change of attenuation
 	void setRollOffFactor(ALfloat rolloffFactor);
 	/// Reference Distance: Distance until which clamping occurs
 	void setReferenceDistance(ALfloat referenceDistance);
 	void setMaxDistance(ALfloat maxDistance);
+	/// Sources with higher priority get voices before louder sources with lower priority.
+	void setPriority(int priority);
 };
 
 /// An audio source that uses StaticAudioBuffer.
@@ -63,14 +132,15 @@ class StaticAudioSource : public AudioSource
 {
 	Ref<StaticAudioBuffer> m_StaticAudio;
 
+	void bindVoice(ALuint sourceID) override;
+	void unbindVoice() override;
+	bool isVoiceFinished() const override;
+
 public:
 	StaticAudioSource(Ref<StaticAudioBuffer> audio);
-	~StaticAudioSource();
-
-	void unqueueBuffers();
+	~StaticAudioSource() = default;
 
 	virtual float getDuration() const override;
-	float getElapsedTimeS();
 };
 
 /// An audio source that uses StreamingAudioBuffer.
@@ -78,15 +148,15 @@ class StreamingAudioSource : public AudioSource
 {
 	Ref<StreamingAudioBuffer> m_StreamingAudio;
 
-	bool m_IsLooping;
+	void bindVoice(ALuint sourceID) override;
+	void unbindVoice() override;
+	bool isVoiceFinished() const override;
 
 public:
 	StreamingAudioSource(Ref<StreamingAudioBuffer> audio);
-	~StreamingAudioSource();
+	~StreamingAudioSource() = default;
 
-	void setLooping(bool enabled) override;
 	void queueNewBuffers() override;
-	void unqueueBuffers();
 
 	virtual float getDuration() const override;
 };
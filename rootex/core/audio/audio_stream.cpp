@@ -0,0 +1,96 @@
+#include "audio_stream.h"
+
+#include "core/resource_loader.h"
+
+AudioStream::AudioStream(AudioResourceFile* audioFile)
+    : m_DataOffset(audioFile->getAudioDataOffset())
+    , m_DataSize(audioFile->getAudioDataSize())
+    , m_BlockAlign(audioFile->getBlockAlign())
+    , m_Position(0)
+{
+	m_File = ResourceLoader::OpenStream(audioFile->getPath().generic_string());
+	if (!m_File)
+	{
+		ERR("Could not open audio file for streaming: " + audioFile->getPath().generic_string());
+		m_DataSize = 0;
+		return;
+	}
+	if (audioFile->isVorbis())
+	{
+		m_Vorbis.reset(new VorbisDecoder(*m_File));
+		if (!m_Vorbis->open())
+		{
+			ERR("Could not decode audio file for streaming: " + audioFile->getPath().generic_string());
+			m_Vorbis.reset();
+			m_DataSize = 0;
+			return;
+		}
+	}
+	rewind();
+}
+
+size_t AudioStream::read(char* destination, size_t size)
+{
+	size_t remaining = m_DataSize - m_Position;
+	if (size > remaining)
+	{
+		size = remaining;
+	}
+	if (m_Vorbis)
+	{
+		// Decoding can only stop on a whole frame
+		size -= size % m_BlockAlign;
+	}
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	size_t readSize = 0;
+	if (m_Vorbis)
+	{
+		readSize = m_Vorbis->read((short*)destination, size / m_BlockAlign) * m_BlockAlign;
+	}
+	else
+	{
+		m_File->read(destination, size);
+		readSize = m_File->gcount();
+	}
+	if (readSize < size)
+	{
+		WARN("Audio file ended before its data chunk did");
+		m_File->clear();
+		m_Position = m_DataSize;
+		return readSize;
+	}
+
+	m_Position += readSize;
+	return readSize;
+}
+
+void AudioStream::rewind()
+{
+	seek(0);
+}
+
+void AudioStream::seek(unsigned int position)
+{
+	if (position > m_DataSize)
+	{
+		position = m_DataSize;
+	}
+	if (!m_File)
+	{
+		return;
+	}
+	if (m_Vorbis)
+	{
+		position -= position % m_BlockAlign;
+		m_Vorbis->seek(position / m_BlockAlign);
+		m_Position = position;
+		return;
+	}
+	m_File->clear();
+	m_File->seekg(m_DataOffset + position);
+	m_Position = position;
+}
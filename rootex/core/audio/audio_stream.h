@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/common.h"
+#include "vorbis_decoder.h"
+
+#include <istream>
+
+class AudioResourceFile;
+
+/// Reads the PCM data of an audio file from disk or an archive in chunks, without ever holding the whole file in memory.
+/// .ogg files are decoded to 16 bit PCM as they are read, so positions and sizes are always in bytes of PCM data.
+class AudioStream
+{
+	Ptr<std::istream> m_File;
+	/// Decoder of .ogg files, reading from m_File. Null for .wav files.
+	Ptr<VorbisDecoder> m_Vorbis;
+	unsigned int m_DataOffset;
+	unsigned int m_DataSize;
+	unsigned int m_BlockAlign;
+	/// Bytes of PCM data already read.
+	unsigned int m_Position;
+
+public:
+	AudioStream(AudioResourceFile* audioFile);
+	AudioStream(AudioStream&) = delete;
+	~AudioStream() = default;
+
+	/// Read up to size bytes into destination. Returns the number of bytes read.
+	size_t read(char* destination, size_t size);
+	/// Seek back to the start of the PCM data.
+	void rewind();
+	/// Seek to a byte offset inside the PCM data.
+	void seek(unsigned int position);
+
+	/// If all PCM data has been read.
+	bool isEnd() const { return m_Position >= m_DataSize; }
+	unsigned int getDataSize() const { return m_DataSize; }
+};
@@ -3,6 +3,19 @@
 #include "framework/systems/audio_system.h"
 #include "resource_data.h"
 
+HashMap<AudioResourceFile*, std::weak_ptr<StaticAudioBuffer>> StaticAudioBuffer::s_Buffers;
+
+Ref<StaticAudioBuffer> StaticAudioBuffer::Create(AudioResourceFile* audioFile)
+{
+	Ref<StaticAudioBuffer> buffer = s_Buffers[audioFile].lock();
+	if (!buffer)
+	{
+		buffer.reset(new StaticAudioBuffer(audioFile));
+		s_Buffers[audioFile] = buffer;
+	}
+	return buffer;
+}
+
 void StaticAudioBuffer::initializeBuffers()
 {
 	PANIC(m_AudioFile->getType() != ResourceFile::Type::Audio, "AudioSystem: Trying to load a non-WAV file in a sound buffer");
@@ -11,7 +24,7 @@ void StaticAudioBuffer::initializeBuffers()
 	AL_CHECK(alBufferData(
 	    m_BufferID,
 	    m_AudioFile->getFormat(),
-	    m_AudioFile->getData()->getRawData()->data(),
+	    m_AudioFile->getAudioData(),
 	    m_AudioFile->getAudioDataSize(),
 	    m_AudioFile->getFrequency()));
 }
@@ -3,15 +3,23 @@
 #include "audio_buffer.h"
 
 /// An audio buffer that is sent entirely at once to the audio card. Preferable for smaller audio files. Larger files may be slow to start.
+/// Shared between all sources playing the same file, see Create().
 class StaticAudioBuffer : public AudioBuffer
 {
+	/// Buffers alive right now, one per file.
+	static HashMap<AudioResourceFile*, std::weak_ptr<StaticAudioBuffer>> s_Buffers;
+
 	ALuint m_BufferID;
 
 	void initializeBuffers() override;
 	void destroyBuffers() override;
 
-public:
 	StaticAudioBuffer(AudioResourceFile* audioFile);
+
+public:
+	/// Returns the buffer already sent to the audio card for a file, or sends a new one.
+	static Ref<StaticAudioBuffer> Create(AudioResourceFile* audioFile);
+
 	~StaticAudioBuffer();
 
 	ALuint& getBuffer();
@@ -8,37 +8,12 @@ void StreamingAudioBuffer::initializeBuffers()
 {
 	PANIC(m_AudioFile->getType() != ResourceFile::Type::Audio, "AudioSystem: Trying to load a non-WAV file in a sound buffer");
 
-	ResourceData* fileStream = m_AudioFile->getData();
-	FileBuffer* fileBuffer = fileStream->getRawData();
-
 	AL_CHECK(alGenBuffers(BUFFER_COUNT, m_Buffers));
 
-	ALsizei blockAlign = m_AudioFile->getChannels() * (m_AudioFile->getBitDepth() / 8.0);
-
-	m_BufferSize = m_AudioFile->getAudioDataSize() / BUFFER_COUNT;
-	m_BufferSize -= (m_BufferSize % blockAlign);
-	m_BufferCursor = m_AudioFile->getData()->getRawData()->data();
-	m_BufferEnd = m_BufferCursor + m_AudioFile->getAudioDataSize();
-
-	int i = 0;
-	while (i < MAX_BUFFER_QUEUE_LENGTH)
-	{
-		if (m_BufferCursor > m_AudioFile->getData()->getRawData()->data() + m_AudioFile->getAudioDataSize())
-		{
-			break;
-		}
-		AL_CHECK(alBufferData(
-		    m_Buffers[i],
-		    m_AudioFile->getFormat(),
-		    (const ALvoid*)m_BufferCursor,
-		    (ALsizei)m_BufferSize,
-		    m_AudioFile->getFrequency()));
-
-		m_BufferCursor += m_BufferSize;
-		i++;
-	}
-
-	m_BufferQueueLength = i;
+	size_t blockAlign = m_AudioFile->getBlockAlign();
+	size_t chunkSize = m_AudioFile->getFrequency() * BUFFER_LENGTH_S * blockAlign;
+	chunkSize -= chunkSize % blockAlign;
+	m_ReadAhead.resize(chunkSize > blockAlign ? chunkSize : blockAlign);
 }
 
 void StreamingAudioBuffer::destroyBuffers()
@@ -46,42 +21,67 @@ void StreamingAudioBuffer::destroyBuffers()
 	AL_CHECK(alDeleteBuffers(BUFFER_COUNT, m_Buffers));
 }
 
-void StreamingAudioBuffer::loadNewBuffers(int count, bool isLooping)
+void StreamingAudioBuffer::readAhead(bool isLooping)
 {
-	for (int i = 0; i < count; i++)
+	m_ReadAheadSize = 0;
+	while (m_ReadAheadSize < m_ReadAhead.size())
 	{
-		m_BufferEnd = m_BufferCursor + m_BufferSize;
-
-		if (m_BufferCursor == m_AudioFile->getData()->getRawData()->data() + m_AudioFile->getAudioDataSize()) // Data has exhausted
+		if (m_Stream.isEnd())
 		{
-			if (isLooping) // Re-queue if looping
-			{
-				m_BufferCursor = m_AudioFile->getData()->getRawData()->data();
-			}
-			else
+			if (!isLooping || m_Stream.getDataSize() == 0)
 			{
 				break;
 			}
+			m_Stream.rewind();
 		}
+		m_ReadAheadSize += m_Stream.read(m_ReadAhead.data() + m_ReadAheadSize, m_ReadAhead.size() - m_ReadAheadSize);
+	}
+}
 
-		if (m_BufferEnd >= m_AudioFile->getData()->getRawData()->data() + m_AudioFile->getAudioDataSize()) // Data not left enough to entirely fill the next buffer
+int StreamingAudioBuffer::loadNewBuffers(ALuint* buffers, int count, bool isLooping)
+{
+	int loaded = 0;
+	while (loaded < count)
+	{
+		if (m_ReadAheadSize == 0)
 		{
-			m_BufferEnd = m_AudioFile->getData()->getRawData()->data() + m_AudioFile->getAudioDataSize(); // Only take what you can
+			// Looping may have been turned on after the audio ran out
+			readAhead(isLooping);
+			if (m_ReadAheadSize == 0)
+			{
+				break;
+			}
 		}
 
 		AL_CHECK(alBufferData(
-		    m_Buffers[i],
+		    buffers[loaded],
 		    m_AudioFile->getFormat(),
-		    m_BufferCursor,
-		    m_BufferEnd - m_BufferCursor,
+		    m_ReadAhead.data(),
+		    (ALsizei)m_ReadAheadSize,
 		    m_AudioFile->getFrequency()));
+		loaded++;
 
-		m_BufferCursor = m_BufferEnd;
+		readAhead(isLooping);
 	}
+	return loaded;
+}
+
+void StreamingAudioBuffer::seek(float seconds, bool isLooping)
+{
+	unsigned int blockAlign = m_AudioFile->getBlockAlign();
+	unsigned int position = (unsigned int)(seconds * m_AudioFile->getFrequency()) * blockAlign;
+	if (isLooping && m_Stream.getDataSize() > 0)
+	{
+		position %= m_Stream.getDataSize();
+	}
+	m_Stream.seek(position);
+	readAhead(isLooping);
 }
 
 StreamingAudioBuffer::StreamingAudioBuffer(AudioResourceFile* audioFile)
     : AudioBuffer(audioFile)
+    , m_Stream(audioFile)
+    , m_ReadAheadSize(0)
 {
 	initializeBuffers();
 }
@@ -95,8 +95,3 @@ ALuint* StreamingAudioBuffer::getBuffers()
 {
 	return m_Buffers;
 }
-
-int StreamingAudioBuffer::getBufferQueueLength()
-{
-	return m_BufferQueueLength;
-}
@@ -1,32 +1,38 @@
 #pragma once
 
-/// Number of equal slices that an audio buffer is cut down into.
-#define BUFFER_COUNT 50
-/// Maximum number of buffers queued at once.
-#define MAX_BUFFER_QUEUE_LENGTH BUFFER_COUNT / 25
+/// Number of buffers cycled through the audio card while streaming.
+#define BUFFER_COUNT 4
+/// Seconds of audio held by each streaming buffer.
+#define BUFFER_LENGTH_S 0.25f
 
 #include "audio_buffer.h"
+#include "audio_stream.h"
 #include "framework/systems/audio_system.h"
 
-/// An audio buffer that is streamed to the audio card instead of sent entirely at once. Allows faster startup for large audio files.
+/// An audio buffer that is streamed from disk to the audio card in small chunks instead of sent entirely at once.
+/// Memory used stays the same no matter how long the audio is. Allows faster startup for large audio files.
 class StreamingAudioBuffer : public AudioBuffer
 {
 	ALuint m_Buffers[BUFFER_COUNT];
-	ALsizei m_BufferSize;
 
-	const char* m_BufferCursor;
-	int m_BufferQueueLength;
-	const char* m_BufferEnd;
+	AudioStream m_Stream;
+	/// The next chunk of audio, read before it is needed so that refilling a buffer never waits on disk.
+	Vector<char> m_ReadAhead;
+	size_t m_ReadAheadSize;
 
 	void initializeBuffers() override;
 	void destroyBuffers() override;
 
+	void readAhead(bool isLooping);
+
 public:
 	StreamingAudioBuffer(AudioResourceFile* audioFile);
 	~StreamingAudioBuffer();
 
-	void loadNewBuffers(int count, bool isLooping);
+	/// Fill buffers with the next chunks of audio. Returns the number of buffers filled, less than count only if the audio has ended.
+	int loadNewBuffers(ALuint* buffers, int count, bool isLooping);
+	/// Continue streaming from a point in time, in seconds.
+	void seek(float seconds, bool isLooping);
 
 	ALuint* getBuffers();
-	int getBufferQueueLength();
 };
@@ -0,0 +1,118 @@
+#include "voice_manager.h"
+
+#include "audio_source.h"
+#include "framework/systems/audio_system.h"
+#include "os/metrics.h"
+
+VoiceManager::VoiceManager(int voiceCount)
+    : m_VirtualCount(0)
+{
+	for (int i = 0; i < voiceCount; i++)
+	{
+		ALuint voice;
+		alGenSources(1, &voice);
+		if (alGetError() != AL_NO_ERROR)
+		{
+			WARN("Audio device ran out of sources after " + std::to_string(i) + " voices");
+			break;
+		}
+		m_Voices.push_back(voice);
+	}
+	m_FreeVoices = m_Voices;
+}
+
+VoiceManager::~VoiceManager()
+{
+	AL_CHECK(alDeleteSources(m_Voices.size(), m_Voices.data()));
+}
+
+void VoiceManager::bind(AudioSource* source)
+{
+	ALuint voice = m_FreeVoices.back();
+	m_FreeVoices.pop_back();
+	source->bindVoice(voice);
+}
+
+void VoiceManager::release(AudioSource* source)
+{
+	if (source->hasVoice())
+	{
+		m_FreeVoices.push_back(source->m_SourceID);
+		source->unbindVoice();
+	}
+}
+
+void VoiceManager::update(Vector<Ref<AudioSource>>& sources, float deltaSeconds)
+{
+	Vector3 listenerPosition;
+	AL_CHECK(alGetListener3f(AL_POSITION, &listenerPosition.x, &listenerPosition.y, &listenerPosition.z));
+
+	m_Candidates.clear();
+	for (auto& sourceRef : sources)
+	{
+		AudioSource* source = sourceRef.get();
+		if (source->m_State != AudioSource::State::Playing)
+		{
+			continue;
+		}
+
+		source->queueNewBuffers();
+
+		float duration = source->getDuration();
+		float offset = source->m_PlaybackOffset + (source->m_IsStarting ? 0.0f : deltaSeconds);
+		source->m_IsStarting = false;
+		if (source->hasVoice() ? source->isVoiceFinished() : (!source->m_IsLooping && offset >= duration))
+		{
+			release(source);
+			source->m_PlaybackOffset = 0.0f;
+			source->m_State = AudioSource::State::Stopped;
+			source->m_FinishedPlayCount = source->m_PlayingCount;
+			continue;
+		}
+		if (source->m_IsLooping && duration > 0.0f)
+		{
+			offset = fmodf(offset, duration);
+		}
+		source->m_PlaybackOffset = offset;
+
+		float gain = source->getAttenuatedGain(listenerPosition);
+		if (gain < s_AudibleGain)
+		{
+			release(source);
+			continue;
+		}
+		m_Candidates.push_back({ source, gain });
+	}
+
+	std::sort(m_Candidates.begin(), m_Candidates.end(), [](const Candidate& a, const Candidate& b) {
+		if (a.m_Source->m_Priority != b.m_Source->m_Priority)
+		{
+			return a.m_Source->m_Priority > b.m_Source->m_Priority;
+		}
+		return a.m_Gain > b.m_Gain;
+	});
+
+	// Take voices back from the losers first so the winners can use them
+	size_t voiceCount = std::min(m_Candidates.size(), m_Voices.size());
+	for (size_t i = voiceCount; i < m_Candidates.size(); i++)
+	{
+		release(m_Candidates[i].m_Source);
+	}
+	for (size_t i = 0; i < voiceCount; i++)
+	{
+		if (!m_Candidates[i].m_Source->hasVoice())
+		{
+			bind(m_Candidates[i].m_Source);
+		}
+	}
+
+	// Playing sources left without a voice, including the ones too quiet to be candidates
+	int virtualCount = 0;
+	for (auto& sourceRef : sources)
+	{
+		virtualCount += sourceRef->m_State == AudioSource::State::Playing && !sourceRef->hasVoice();
+	}
+	m_VirtualCount = virtualCount;
+	METRIC_GAUGE("Audio/Voices", voiceCount, MetricUnit::Count);
+	METRIC_GAUGE("Audio/Virtual Voices", m_VirtualCount, MetricUnit::Count);
+}
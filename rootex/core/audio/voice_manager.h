@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/common.h"
+
+#include <atomic>
+
+class AudioSource;
+
+typedef unsigned int ALuint;
+
+/// Owns a fixed pool of OpenAL sources, called voices, and lends them to the audio sources most worth hearing.
+/// Playing sources are ranked by priority, then by their gain at the listener after attenuation. Sources that do not get a voice are virtual:
+/// their playback position keeps moving so they pick up where they should once they get a voice again. Only used on the audio thread.
+class VoiceManager
+{
+	/// Sources quieter than this after attenuation are never given a voice.
+	static constexpr float s_AudibleGain = 0.001f;
+
+	struct Candidate
+	{
+		AudioSource* m_Source;
+		float m_Gain;
+	};
+
+	Vector<ALuint> m_Voices;
+	Vector<ALuint> m_FreeVoices;
+	Vector<Candidate> m_Candidates;
+
+	std::atomic<int> m_VirtualCount;
+
+	void bind(AudioSource* source);
+
+public:
+	VoiceManager(int voiceCount);
+	VoiceManager(VoiceManager&) = delete;
+	~VoiceManager();
+
+	/// Advance playback positions and hand out voices again.
+	void update(Vector<Ref<AudioSource>>& sources, float deltaSeconds);
+	/// Take back the voice of a source, if it has one.
+	void release(AudioSource* source);
+
+	int getVoiceCount() const { return m_Voices.size(); }
+	/// Number of sources that were playing without a voice after the last update.
+	int getVirtualCount() const { return m_VirtualCount; }
+};
@@ -0,0 +1,1541 @@
+#include "vorbis_decoder.h"
+
+static const double Pi = 3.14159265358979323846;
+
+/// Largest Ogg page, with its header and a full segment table.
+#define OGG_MAX_PAGE_SIZE (27 + 255 + 255 * 255)
+
+static unsigned int ReadLE32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+static unsigned long long ReadLE64(const unsigned char* data)
+{
+	return ReadLE32(data) | ((unsigned long long)ReadLE32(data + 4) << 32);
+}
+
+/// Lookup table of the Ogg page checksum, a CRC-32 with polynomial 0x04c11db7 that is not reflected.
+struct OggCRCTable
+{
+	unsigned int m_Values[256];
+
+	OggCRCTable()
+	{
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			unsigned int value = i << 24;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = (value & 0x80000000) ? (value << 1) ^ 0x04c11db7 : value << 1;
+			}
+			m_Values[i] = value;
+		}
+	}
+};
+
+static unsigned int OggCRC(unsigned int crc, const unsigned char* data, size_t size)
+{
+	static const OggCRCTable table;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = (crc << 8) ^ table.m_Values[((crc >> 24) ^ data[i]) & 0xff];
+	}
+	return crc;
+}
+
+/// Number of bits needed to hold value.
+static int ILog(unsigned int value)
+{
+	int bits = 0;
+	while (value)
+	{
+		bits++;
+		value >>= 1;
+	}
+	return bits;
+}
+
+static float Float32Unpack(unsigned int value)
+{
+	double mantissa = value & 0x1fffff;
+	int exponent = (value & 0x7fe00000) >> 21;
+	if (value & 0x80000000)
+	{
+		mantissa = -mantissa;
+	}
+	return (float)ldexp(mantissa, exponent - 788);
+}
+
+/// Largest value whose dimensions-th power is no more than entries.
+static unsigned int Lookup1Values(unsigned int entries, unsigned int dimensions)
+{
+	unsigned int values = (unsigned int)floor(pow(entries, 1.0 / dimensions));
+	while (pow(values + 1, dimensions) <= entries)
+	{
+		values++;
+	}
+	while (values > 0 && pow(values, dimensions) > entries)
+	{
+		values--;
+	}
+	return values;
+}
+
+static int RenderPoint(int x0, int y0, int x1, int y1, int x)
+{
+	int dy = y1 - y0;
+	int offset = abs(dy) * (x - x0) / (x1 - x0);
+	return dy < 0 ? y0 - offset : y0 + offset;
+}
+
+/// Draw a line of floor values from x0 up to but not including x1, clipped to size.
+static void RenderLine(int x0, int y0, int x1, int y1, int* curve, int size)
+{
+	int dy = y1 - y0;
+	int adx = x1 - x0;
+	int base = dy / adx;
+	int sy = dy < 0 ? base - 1 : base + 1;
+	int ady = abs(dy) - abs(base) * adx;
+	int y = y0;
+	int error = 0;
+	if (x0 < size)
+	{
+		curve[x0] = y;
+	}
+	for (int x = x0 + 1; x < x1 && x < size; x++)
+	{
+		error += ady;
+		if (error >= adx)
+		{
+			error -= adx;
+			y += sy;
+		}
+		else
+		{
+			y += base;
+		}
+		curve[x] = y;
+	}
+}
+
+/// Amplitudes of the 256 floor values, from -140 dB up to 0 dB.
+static const float* GetInverseDBTable()
+{
+	static float table[256];
+	static bool isInitialized = false;
+	if (!isInitialized)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			table[i] = (float)exp(log(1.0649863e-07) * (255 - i) / 255.0);
+		}
+		isInitialized = true;
+	}
+	return table;
+}
+
+VorbisDecoder::VorbisDecoder(std::istream& file)
+    : m_File(file)
+    , m_Serial(0)
+    , m_PageOffset(0)
+    , m_SegmentCount(0)
+    , m_SegmentIndex(0)
+    , m_LastPacketSegment(-1)
+    , m_SegmentOffset(0)
+    , m_PageGranule(-1)
+    , m_IsLastPage(false)
+    , m_IsSkippingPacket(false)
+    , m_PacketGranule(-1)
+    , m_BitPosition(0)
+    , m_IsPacketEnd(false)
+    , m_Channels(0)
+    , m_SampleRate(0)
+    , m_FrameCount(0)
+    , m_AudioPageOffset(0)
+    , m_AudioSegmentIndex(0)
+    , m_ClassificationStride(0)
+    , m_OverlapSize(0)
+    , m_IsOverlapReady(false)
+    , m_OutputStart(0)
+    , m_OutputEnd(0)
+    , m_Position(0)
+    , m_IsPositionKnown(false)
+{
+	m_Page.resize(255 * 255);
+}
+
+bool VorbisDecoder::readPage(bool& isContinued)
+{
+	while (!m_IsLastPage)
+	{
+		m_PageOffset = m_File.tellg();
+		unsigned char header[27];
+		m_File.read((char*)header, sizeof(header));
+		if (m_File.gcount() != sizeof(header))
+		{
+			return false;
+		}
+		if (memcmp(header, "OggS", 4) != 0 || header[4] != 0)
+		{
+			WARN("Ogg Vorbis stream has a corrupt page");
+			return false;
+		}
+
+		m_SegmentCount = header[26];
+		m_File.read((char*)m_Segments, m_SegmentCount);
+		size_t pageSize = 0;
+		for (int i = 0; i < m_SegmentCount; i++)
+		{
+			pageSize += m_Segments[i];
+		}
+		m_File.read((char*)m_Page.data(), pageSize);
+		if (!m_File)
+		{
+			return false;
+		}
+
+		// The checksum is computed with its own field set to 0
+		const unsigned int checksum = ReadLE32(header + 22);
+		memset(header + 22, 0, 4);
+		unsigned int crc = OggCRC(0, header, sizeof(header));
+		crc = OggCRC(crc, m_Segments, m_SegmentCount);
+		if (OggCRC(crc, m_Page.data(), pageSize) != checksum)
+		{
+			WARN("Ogg Vorbis stream has a page with a wrong checksum");
+			return false;
+		}
+
+		// Pages of other logical streams multiplexed in the file
+		if (ReadLE32(header + 14) != m_Serial)
+		{
+			continue;
+		}
+
+		isContinued = header[5] & 1;
+		m_IsLastPage = header[5] & 4;
+		m_PageGranule = (long long)ReadLE64(header + 6);
+		m_SegmentIndex = 0;
+		m_SegmentOffset = 0;
+		m_LastPacketSegment = -1;
+		for (int i = 0; i < m_SegmentCount; i++)
+		{
+			if (m_Segments[i] < 255)
+			{
+				m_LastPacketSegment = i;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+bool VorbisDecoder::readPacket()
+{
+	m_Packet.clear();
+	m_PacketGranule = -1;
+	while (true)
+	{
+		if (m_SegmentIndex >= m_SegmentCount)
+		{
+			bool isContinued = false;
+			if (!readPage(isContinued))
+			{
+				return false;
+			}
+			if (isContinued && m_Packet.empty())
+			{
+				m_IsSkippingPacket = true;
+			}
+			else if (!isContinued)
+			{
+				// A packet left unfinished by a lost page is dropped
+				m_Packet.clear();
+				m_IsSkippingPacket = false;
+			}
+		}
+
+		unsigned char lacing = m_Segments[m_SegmentIndex];
+		if (!m_IsSkippingPacket)
+		{
+			m_Packet.insert(m_Packet.end(), m_Page.data() + m_SegmentOffset, m_Page.data() + m_SegmentOffset + lacing);
+		}
+		m_SegmentOffset += lacing;
+		m_SegmentIndex++;
+
+		if (lacing < 255)
+		{
+			if (m_IsSkippingPacket)
+			{
+				m_IsSkippingPacket = false;
+				continue;
+			}
+			if (m_SegmentIndex - 1 == m_LastPacketSegment)
+			{
+				m_PacketGranule = m_PageGranule;
+			}
+			m_BitPosition = 0;
+			m_IsPacketEnd = false;
+			return true;
+		}
+	}
+}
+
+unsigned int VorbisDecoder::readBits(int count)
+{
+	if (m_BitPosition + count > m_Packet.size() * 8)
+	{
+		m_BitPosition = m_Packet.size() * 8;
+		m_IsPacketEnd = true;
+		return 0;
+	}
+
+	unsigned int value = 0;
+	int bitsRead = 0;
+	while (bitsRead < count)
+	{
+		int bit = m_BitPosition & 7;
+		int bitCount = std::min(8 - bit, count - bitsRead);
+		unsigned int bits = (m_Packet[m_BitPosition >> 3] >> bit) & ((1 << bitCount) - 1);
+		value |= bits << bitsRead;
+		bitsRead += bitCount;
+		m_BitPosition += bitCount;
+	}
+	return value;
+}
+
+int VorbisDecoder::decodeEntry(const Codebook& codebook)
+{
+	int node = 0;
+	while (m_BitPosition < m_Packet.size() * 8)
+	{
+		int bit = (m_Packet[m_BitPosition >> 3] >> (m_BitPosition & 7)) & 1;
+		m_BitPosition++;
+		int child = codebook.m_Tree[node * 2 + bit];
+		if (child < 0)
+		{
+			return -child - 1;
+		}
+		if (child == 0)
+		{
+			break;
+		}
+		node = child;
+	}
+	// Running out of packet and codewords that are not in the codebook both end the packet
+	m_IsPacketEnd = true;
+	return -1;
+}
+
+const float* VorbisDecoder::decodeVector(const Codebook& codebook)
+{
+	int entry = decodeEntry(codebook);
+	if (entry < 0)
+	{
+		return nullptr;
+	}
+	return codebook.m_Values.data() + entry * codebook.m_Dimensions;
+}
+
+bool VorbisDecoder::readHeaderType(unsigned int type)
+{
+	if (readBits(8) != type)
+	{
+		return false;
+	}
+	for (const char* signature = "vorbis"; *signature; signature++)
+	{
+		if (readBits(8) != (unsigned char)*signature)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VorbisDecoder::readIdentificationHeader()
+{
+	if (m_Packet.size() >= 8 && memcmp(m_Packet.data(), "OpusHead", 8) == 0)
+	{
+		WARN("Ogg Opus files are not supported");
+		return false;
+	}
+	if (!readHeaderType(1) || readBits(32) != 0)
+	{
+		return false;
+	}
+	m_Channels = readBits(8);
+	m_SampleRate = readBits(32);
+	readBits(32);
+	readBits(32);
+	readBits(32);
+	int shortSize = 1 << readBits(4);
+	int longSize = 1 << readBits(4);
+	if (!readBits(1) || m_IsPacketEnd)
+	{
+		return false;
+	}
+	if (m_Channels == 0 || m_SampleRate == 0 || shortSize < 64 || longSize > 8192 || shortSize > longSize)
+	{
+		return false;
+	}
+
+	initializeBlock(m_Blocks[0], shortSize);
+	initializeBlock(m_Blocks[1], longSize);
+	return true;
+}
+
+bool VorbisDecoder::readCodebook(Codebook& codebook)
+{
+	if (readBits(24) != 0x564342)
+	{
+		return false;
+	}
+	codebook.m_Dimensions = readBits(16);
+	codebook.m_Entries = readBits(24);
+
+	Vector<unsigned char> lengths(codebook.m_Entries, 0);
+	if (readBits(1))
+	{
+		// Ordered codebooks list how many entries have each length, from the shortest
+		unsigned int entry = 0;
+		unsigned int length = readBits(5) + 1;
+		while (entry < codebook.m_Entries)
+		{
+			unsigned int count = readBits(ILog(codebook.m_Entries - entry));
+			if (m_IsPacketEnd || length > 32 || count > codebook.m_Entries - entry)
+			{
+				return false;
+			}
+			memset(lengths.data() + entry, length, count);
+			entry += count;
+			length++;
+		}
+	}
+	else
+	{
+		bool isSparse = readBits(1);
+		for (auto& length : lengths)
+		{
+			if (!isSparse || readBits(1))
+			{
+				length = readBits(5) + 1;
+			}
+		}
+	}
+	if (m_IsPacketEnd)
+	{
+		return false;
+	}
+
+	// Codewords are handed out in the order of the entries, each taking the first free codeword of its length
+	unsigned int usedCount = 0;
+	unsigned int lastUsed = 0;
+	for (unsigned int entry = 0; entry < codebook.m_Entries; entry++)
+	{
+		if (lengths[entry])
+		{
+			usedCount++;
+			lastUsed = entry;
+		}
+	}
+	codebook.m_Tree.assign(2, 0);
+	if (usedCount == 1)
+	{
+		// A single entry is decoded from a single bit of either value
+		codebook.m_Tree[0] = codebook.m_Tree[1] = -(int)lastUsed - 1;
+	}
+	else
+	{
+		unsigned int markers[33] = {};
+		for (unsigned int entry = 0; entry < codebook.m_Entries; entry++)
+		{
+			int length = lengths[entry];
+			if (length == 0)
+			{
+				continue;
+			}
+
+			unsigned int codeword = markers[length];
+			if (length < 32 && (codeword >> length))
+			{
+				return false;
+			}
+			for (int j = length; j > 0; j--)
+			{
+				if (markers[j] & 1)
+				{
+					markers[j] = j == 1 ? markers[1] + 1 : markers[j - 1] << 1;
+					break;
+				}
+				markers[j]++;
+			}
+			unsigned int taken = codeword;
+			for (int j = length + 1; j < 33; j++)
+			{
+				if ((markers[j] >> 1) != taken)
+				{
+					break;
+				}
+				taken = markers[j];
+				markers[j] = markers[j - 1] << 1;
+			}
+
+			// Codewords are read from their highest bit
+			int node = 0;
+			for (int bit = length - 1; bit >= 0; bit--)
+			{
+				int child = node * 2 + ((codeword >> bit) & 1);
+				if (codebook.m_Tree[child] < 0 || (bit == 0 && codebook.m_Tree[child] != 0))
+				{
+					return false;
+				}
+				if (bit == 0)
+				{
+					codebook.m_Tree[child] = -(int)entry - 1;
+				}
+				else
+				{
+					if (codebook.m_Tree[child] == 0)
+					{
+						codebook.m_Tree[child] = (int)codebook.m_Tree.size() / 2;
+						codebook.m_Tree.resize(codebook.m_Tree.size() + 2, 0);
+					}
+					node = codebook.m_Tree[child];
+				}
+			}
+		}
+	}
+
+	unsigned int lookupType = readBits(4);
+	if (lookupType == 0)
+	{
+		return !m_IsPacketEnd;
+	}
+	if (lookupType > 2 || codebook.m_Dimensions == 0)
+	{
+		return false;
+	}
+
+	float minimum = Float32Unpack(readBits(32));
+	float delta = Float32Unpack(readBits(32));
+	int valueBits = readBits(4) + 1;
+	bool isSequence = readBits(1);
+	unsigned long long valueCount = (unsigned long long)codebook.m_Entries * codebook.m_Dimensions;
+	if (valueCount > (1 << 24))
+	{
+		return false;
+	}
+	unsigned int lookupCount = lookupType == 1 ? Lookup1Values(codebook.m_Entries, codebook.m_Dimensions) : (unsigned int)valueCount;
+	if (lookupCount == 0 && codebook.m_Entries > 0)
+	{
+		return false;
+	}
+	Vector<unsigned int> multiplicands(lookupCount);
+	for (auto& multiplicand : multiplicands)
+	{
+		multiplicand = readBits(valueBits);
+	}
+	if (m_IsPacketEnd)
+	{
+		return false;
+	}
+
+	// Every vector is unpacked up front, since entries are looked up for each residue value
+	codebook.m_Values.resize(valueCount);
+	for (unsigned int entry = 0; entry < codebook.m_Entries; entry++)
+	{
+		float last = 0.0f;
+		unsigned int divisor = 1;
+		for (unsigned int i = 0; i < codebook.m_Dimensions; i++)
+		{
+			unsigned int offset = lookupType == 1 ? (entry / divisor) % lookupCount : entry * codebook.m_Dimensions + i;
+			float value = multiplicands[offset] * delta + minimum + last;
+			codebook.m_Values[entry * codebook.m_Dimensions + i] = value;
+			if (isSequence)
+			{
+				last = value;
+			}
+			divisor *= lookupCount;
+		}
+	}
+	return true;
+}
+
+bool VorbisDecoder::readFloor(Floor& floor)
+{
+	floor.m_PartitionClasses.resize(readBits(5));
+	int maxClass = -1;
+	for (auto& partitionClass : floor.m_PartitionClasses)
+	{
+		partitionClass = readBits(4);
+		maxClass = std::max(maxClass, partitionClass);
+	}
+	for (int i = 0; i <= maxClass; i++)
+	{
+		floor.m_ClassDimensions[i] = readBits(3) + 1;
+		floor.m_ClassSubclasses[i] = readBits(2);
+		floor.m_ClassMasterbooks[i] = floor.m_ClassSubclasses[i] ? readBits(8) : -1;
+		if (floor.m_ClassMasterbooks[i] >= (int)m_Codebooks.size())
+		{
+			return false;
+		}
+		for (int j = 0; j < (1 << floor.m_ClassSubclasses[i]); j++)
+		{
+			floor.m_SubclassBooks[i][j] = (int)readBits(8) - 1;
+			if (floor.m_SubclassBooks[i][j] >= (int)m_Codebooks.size())
+			{
+				return false;
+			}
+		}
+	}
+	floor.m_Multiplier = readBits(2) + 1;
+	int rangeBits = readBits(4);
+
+	floor.m_X = { 0, 1 << rangeBits };
+	for (int partitionClass : floor.m_PartitionClasses)
+	{
+		for (int j = 0; j < floor.m_ClassDimensions[partitionClass]; j++)
+		{
+			floor.m_X.push_back(readBits(rangeBits));
+		}
+	}
+	if (m_IsPacketEnd)
+	{
+		return false;
+	}
+
+	int count = floor.m_X.size();
+	floor.m_Sorted.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		floor.m_Sorted[i] = i;
+	}
+	std::sort(floor.m_Sorted.begin(), floor.m_Sorted.end(), [&floor](int a, int b) {
+		return floor.m_X[a] < floor.m_X[b];
+	});
+	for (int i = 1; i < count; i++)
+	{
+		if (floor.m_X[floor.m_Sorted[i]] == floor.m_X[floor.m_Sorted[i - 1]])
+		{
+			return false;
+		}
+	}
+
+	floor.m_LowNeighbors.assign(count, 0);
+	floor.m_HighNeighbors.assign(count, 1);
+	for (int i = 2; i < count; i++)
+	{
+		for (int j = 0; j < i; j++)
+		{
+			if (floor.m_X[j] < floor.m_X[i] && floor.m_X[j] > floor.m_X[floor.m_LowNeighbors[i]])
+			{
+				floor.m_LowNeighbors[i] = j;
+			}
+			if (floor.m_X[j] > floor.m_X[i] && floor.m_X[j] < floor.m_X[floor.m_HighNeighbors[i]])
+			{
+				floor.m_HighNeighbors[i] = j;
+			}
+		}
+	}
+	return true;
+}
+
+bool VorbisDecoder::readResidue(Residue& residue)
+{
+	residue.m_Begin = readBits(24);
+	residue.m_End = readBits(24);
+	residue.m_PartitionSize = readBits(24) + 1;
+	residue.m_Classifications = readBits(6) + 1;
+	residue.m_Classbook = readBits(8);
+	if (residue.m_Classbook >= (int)m_Codebooks.size() || m_Codebooks[residue.m_Classbook].m_Dimensions == 0)
+	{
+		return false;
+	}
+
+	int cascades[64];
+	for (int i = 0; i < residue.m_Classifications; i++)
+	{
+		int lowBits = readBits(3);
+		int highBits = readBits(1) ? readBits(5) : 0;
+		cascades[i] = highBits * 8 + lowBits;
+	}
+	for (int i = 0; i < residue.m_Classifications; i++)
+	{
+		for (int pass = 0; pass < 8; pass++)
+		{
+			residue.m_Books[i][pass] = -1;
+			if (cascades[i] & (1 << pass))
+			{
+				residue.m_Books[i][pass] = readBits(8);
+				if (residue.m_Books[i][pass] >= (int)m_Codebooks.size() || m_Codebooks[residue.m_Books[i][pass]].m_Values.empty())
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return !m_IsPacketEnd;
+}
+
+bool VorbisDecoder::readMapping(Mapping& mapping)
+{
+	if (readBits(16) != 0)
+	{
+		return false;
+	}
+	int submapCount = readBits(1) ? readBits(4) + 1 : 1;
+	if (readBits(1))
+	{
+		int steps = readBits(8) + 1;
+		int channelBits = ILog(m_Channels - 1);
+		for (int i = 0; i < steps; i++)
+		{
+			int magnitude = readBits(channelBits);
+			int angle = readBits(channelBits);
+			if (magnitude == angle || magnitude >= m_Channels || angle >= m_Channels)
+			{
+				return false;
+			}
+			mapping.m_Magnitudes.push_back(magnitude);
+			mapping.m_Angles.push_back(angle);
+		}
+	}
+	if (readBits(2) != 0)
+	{
+		return false;
+	}
+
+	mapping.m_Mux.assign(m_Channels, 0);
+	if (submapCount > 1)
+	{
+		for (auto& mux : mapping.m_Mux)
+		{
+			mux = readBits(4);
+			if (mux >= submapCount)
+			{
+				return false;
+			}
+		}
+	}
+	for (int i = 0; i < submapCount; i++)
+	{
+		readBits(8);
+		int floor = readBits(8);
+		int residue = readBits(8);
+		if (floor >= (int)m_Floors.size() || residue >= (int)m_Residues.size())
+		{
+			return false;
+		}
+		mapping.m_SubmapFloors.push_back(floor);
+		mapping.m_SubmapResidues.push_back(residue);
+	}
+	return !m_IsPacketEnd;
+}
+
+bool VorbisDecoder::readSetupHeader()
+{
+	if (!readHeaderType(5))
+	{
+		return false;
+	}
+
+	m_Codebooks.resize(readBits(8) + 1);
+	for (auto& codebook : m_Codebooks)
+	{
+		if (!readCodebook(codebook))
+		{
+			return false;
+		}
+	}
+
+	// Time domain transforms are placeholders that must be 0
+	int timeCount = readBits(6) + 1;
+	for (int i = 0; i < timeCount; i++)
+	{
+		if (readBits(16) != 0)
+		{
+			return false;
+		}
+	}
+
+	m_Floors.resize(readBits(6) + 1);
+	for (auto& floor : m_Floors)
+	{
+		unsigned int type = readBits(16);
+		if (type == 0)
+		{
+			WARN("Ogg Vorbis files with floor type 0 are not supported");
+			return false;
+		}
+		if (type != 1 || !readFloor(floor))
+		{
+			return false;
+		}
+	}
+
+	m_Residues.resize(readBits(6) + 1);
+	for (auto& residue : m_Residues)
+	{
+		residue.m_Type = readBits(16);
+		if (residue.m_Type > 2 || !readResidue(residue))
+		{
+			return false;
+		}
+	}
+
+	m_Mappings.resize(readBits(6) + 1);
+	for (auto& mapping : m_Mappings)
+	{
+		if (!readMapping(mapping))
+		{
+			return false;
+		}
+	}
+
+	m_Modes.resize(readBits(6) + 1);
+	for (auto& mode : m_Modes)
+	{
+		mode.m_IsLong = readBits(1);
+		int windowType = readBits(16);
+		int transformType = readBits(16);
+		mode.m_Mapping = readBits(8);
+		if (windowType != 0 || transformType != 0 || mode.m_Mapping >= (int)m_Mappings.size())
+		{
+			return false;
+		}
+	}
+
+	return readBits(1) && !m_IsPacketEnd;
+}
+
+void VorbisDecoder::initializeBlock(Block& block, int size)
+{
+	block.m_Size = size;
+	int half = size / 2;
+	int quarter = size / 4;
+
+	block.m_Slope.resize(half);
+	for (int i = 0; i < half; i++)
+	{
+		double x = sin((i + 0.5) / half * Pi / 2.0);
+		block.m_Slope[i] = (float)sin(Pi / 2.0 * x * x);
+	}
+
+	block.m_Twiddles.resize(quarter);
+	for (int i = 0; i < quarter; i++)
+	{
+		double angle = -Pi * (8 * i + 1) / (8.0 * half);
+		block.m_Twiddles[i] = std::complex<float>((float)cos(angle), (float)sin(angle));
+	}
+	block.m_Roots.resize(quarter / 2);
+	for (int i = 0; i < quarter / 2; i++)
+	{
+		double angle = -2.0 * Pi * i / quarter;
+		block.m_Roots[i] = std::complex<float>((float)cos(angle), (float)sin(angle));
+	}
+
+	int bits = ILog(quarter - 1);
+	block.m_BitReverse.resize(quarter);
+	for (int i = 0; i < quarter; i++)
+	{
+		int reversed = 0;
+		for (int bit = 0; bit < bits; bit++)
+		{
+			reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+		}
+		block.m_BitReverse[i] = reversed;
+	}
+}
+
+bool VorbisDecoder::findFrameCount()
+{
+	m_File.clear();
+	m_File.seekg(0, std::ios::end);
+	std::streamoff fileSize = m_File.tellg();
+	std::streamoff tailSize = std::min<std::streamoff>(fileSize, OGG_MAX_PAGE_SIZE);
+	Vector<unsigned char> tail(tailSize);
+	m_File.seekg(fileSize - tailSize);
+	m_File.read((char*)tail.data(), tailSize);
+	if (!m_File)
+	{
+		return false;
+	}
+
+	// The granule position of the last page is the number of frames in the stream
+	for (std::streamoff i = tailSize - 27; i >= 0; i--)
+	{
+		const unsigned char* header = tail.data() + i;
+		long long granule = (long long)ReadLE64(header + 6);
+		if (memcmp(header, "OggS", 4) == 0 && header[4] == 0 && ReadLE32(header + 14) == m_Serial && granule >= 0)
+		{
+			m_FrameCount = granule;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool VorbisDecoder::open()
+{
+	unsigned char header[27];
+	m_File.read((char*)header, sizeof(header));
+	if (m_File.gcount() != sizeof(header) || memcmp(header, "OggS", 4) != 0)
+	{
+		return false;
+	}
+	m_Serial = ReadLE32(header + 14);
+	m_File.clear();
+	m_File.seekg(0);
+
+	if (!readPacket() || !readIdentificationHeader())
+	{
+		return false;
+	}
+	if (!readPacket() || !readHeaderType(3))
+	{
+		return false;
+	}
+	if (!readPacket() || !readSetupHeader())
+	{
+		return false;
+	}
+
+	// Audio packets start on the page after the setup header, or on the rest of its page
+	if (m_SegmentIndex < m_SegmentCount)
+	{
+		m_AudioPageOffset = m_PageOffset;
+		m_AudioSegmentIndex = m_SegmentIndex;
+	}
+	else
+	{
+		m_AudioPageOffset = m_File.tellg();
+		m_AudioSegmentIndex = 0;
+	}
+
+	int longSize = m_Blocks[1].m_Size;
+	m_Spectrums.assign(m_Channels, Vector<float>(longSize));
+	m_Overlaps.assign(m_Channels, Vector<float>(longSize / 2));
+	size_t maxFloorValues = 0;
+	for (auto& floor : m_Floors)
+	{
+		maxFloorValues = std::max(maxFloorValues, floor.m_X.size());
+	}
+	m_FloorValues.assign(m_Channels, Vector<int>(maxFloorValues));
+	m_FloorCurve.resize(longSize / 2);
+	m_IsFloorUsed.resize(m_Channels);
+	m_IsResidueSkipped.resize(m_Channels);
+	m_SubmapVectors.resize(m_Channels);
+	m_SubmapSkipped.resize(m_Channels);
+	m_Interleaved.resize(m_Channels * longSize / 2);
+	m_DCT.resize(longSize / 2);
+	m_FFT.resize(longSize / 4);
+	m_Output.resize(m_Channels * longSize / 2);
+
+	unsigned int maxPartitions = 0;
+	for (auto& residue : m_Residues)
+	{
+		unsigned int size = residue.m_Type == 2 ? m_Channels * longSize / 2 : longSize / 2;
+		unsigned int begin = std::min(residue.m_Begin, size);
+		unsigned int end = std::min(residue.m_End, size);
+		unsigned int partitions = end > begin ? (end - begin) / residue.m_PartitionSize : 0;
+		maxPartitions = std::max(maxPartitions, partitions + m_Codebooks[residue.m_Classbook].m_Dimensions);
+	}
+	m_ClassificationStride = maxPartitions;
+	m_Classifications.resize(m_Channels * maxPartitions);
+
+	if (!findFrameCount())
+	{
+		return false;
+	}
+	return rewind();
+}
+
+bool VorbisDecoder::decodeFloor(const Floor& floor, Vector<int>& values)
+{
+	static const int Ranges[] = { 256, 128, 86, 64 };
+
+	if (!readBits(1))
+	{
+		return false;
+	}
+	int rangeBits = ILog(Ranges[floor.m_Multiplier - 1] - 1);
+	values[0] = readBits(rangeBits);
+	values[1] = readBits(rangeBits);
+
+	int offset = 2;
+	for (int partitionClass : floor.m_PartitionClasses)
+	{
+		int dimensions = floor.m_ClassDimensions[partitionClass];
+		int subclassBits = floor.m_ClassSubclasses[partitionClass];
+		int subclassMask = (1 << subclassBits) - 1;
+		int classValue = 0;
+		if (subclassBits > 0)
+		{
+			classValue = decodeEntry(m_Codebooks[floor.m_ClassMasterbooks[partitionClass]]);
+		}
+		for (int j = 0; j < dimensions; j++)
+		{
+			int book = floor.m_SubclassBooks[partitionClass][classValue & subclassMask];
+			classValue >>= subclassBits;
+			values[offset + j] = book >= 0 ? decodeEntry(m_Codebooks[book]) : 0;
+		}
+		offset += dimensions;
+	}
+	// A floor cut short by the end of the packet is unused
+	return !m_IsPacketEnd;
+}
+
+void VorbisDecoder::renderFloor(const Floor& floor, const Vector<int>& values, float* spectrum, int size)
+{
+	static const int Ranges[] = { 256, 128, 86, 64 };
+
+	int range = Ranges[floor.m_Multiplier - 1];
+	int count = floor.m_X.size();
+	int finalY[256];
+	bool isUsed[256];
+	finalY[0] = values[0];
+	finalY[1] = values[1];
+	isUsed[0] = true;
+	isUsed[1] = true;
+
+	// Each value is stored relative to the line between its neighbours
+	for (int i = 2; i < count; i++)
+	{
+		int low = floor.m_LowNeighbors[i];
+		int high = floor.m_HighNeighbors[i];
+		int predicted = RenderPoint(floor.m_X[low], finalY[low], floor.m_X[high], finalY[high], floor.m_X[i]);
+		int value = values[i];
+		int highRoom = range - predicted;
+		int lowRoom = predicted;
+		int room = highRoom < lowRoom ? highRoom * 2 : lowRoom * 2;
+		isUsed[i] = value != 0;
+		if (value == 0)
+		{
+			finalY[i] = predicted;
+			continue;
+		}
+
+		isUsed[low] = true;
+		isUsed[high] = true;
+		if (value >= room)
+		{
+			finalY[i] = highRoom > lowRoom ? value - lowRoom + predicted : predicted - value + highRoom - 1;
+		}
+		else
+		{
+			finalY[i] = (value & 1) ? predicted - (value + 1) / 2 : predicted + value / 2;
+		}
+	}
+
+	int* curve = m_FloorCurve.data();
+	int lastX = 0;
+	int lastY = finalY[0] * floor.m_Multiplier;
+	for (int i = 1; i < count; i++)
+	{
+		int index = floor.m_Sorted[i];
+		if (isUsed[index])
+		{
+			int y = finalY[index] * floor.m_Multiplier;
+			RenderLine(lastX, lastY, floor.m_X[index], y, curve, size);
+			lastX = floor.m_X[index];
+			lastY = y;
+		}
+	}
+	if (lastX < size)
+	{
+		RenderLine(lastX, lastY, size, lastY, curve, size);
+	}
+
+	const float* inverseDB = GetInverseDBTable();
+	for (int i = 0; i < size; i++)
+	{
+		spectrum[i] *= inverseDB[std::clamp(curve[i], 0, 255)];
+	}
+}
+
+void VorbisDecoder::decodeResidue(const Residue& residue, float** vectors, const char* isSkipped, int count, int size)
+{
+	for (int i = 0; i < count; i++)
+	{
+		memset(vectors[i], 0, size * sizeof(float));
+	}
+
+	// Type 2 decodes all channels as one interleaved vector
+	float** channelVectors = vectors;
+	int channelCount = count;
+	int channelSize = size;
+	float* interleaved = m_Interleaved.data();
+	const char isInterleavedSkipped = 0;
+	if (residue.m_Type == 2)
+	{
+		if (std::all_of(isSkipped, isSkipped + count, [](char skipped) { return skipped; }))
+		{
+			return;
+		}
+		memset(interleaved, 0, count * size * sizeof(float));
+		vectors = &interleaved;
+		isSkipped = &isInterleavedSkipped;
+		size *= count;
+		count = 1;
+	}
+
+	const Codebook& classbook = m_Codebooks[residue.m_Classbook];
+	int classwords = classbook.m_Dimensions;
+	unsigned int begin = std::min(residue.m_Begin, (unsigned int)size);
+	unsigned int end = std::min(residue.m_End, (unsigned int)size);
+	int partitionCount = end > begin ? (end - begin) / residue.m_PartitionSize : 0;
+
+	for (int pass = 0; pass < 8 && !m_IsPacketEnd; pass++)
+	{
+		int partition = 0;
+		while (partition < partitionCount && !m_IsPacketEnd)
+		{
+			if (pass == 0)
+			{
+				for (int j = 0; j < count; j++)
+				{
+					if (isSkipped[j])
+					{
+						continue;
+					}
+					int classes = decodeEntry(classbook);
+					int* classifications = m_Classifications.data() + j * m_ClassificationStride + partition;
+					for (int i = classwords - 1; i >= 0; i--)
+					{
+						classifications[i] = classes >= 0 ? classes % residue.m_Classifications : 0;
+						classes /= residue.m_Classifications;
+					}
+				}
+			}
+
+			for (int i = 0; i < classwords && partition < partitionCount && !m_IsPacketEnd; i++, partition++)
+			{
+				for (int j = 0; j < count && !m_IsPacketEnd; j++)
+				{
+					if (isSkipped[j])
+					{
+						continue;
+					}
+					int book = residue.m_Books[m_Classifications[j * m_ClassificationStride + partition]][pass];
+					if (book < 0)
+					{
+						continue;
+					}
+
+					const Codebook& codebook = m_Codebooks[book];
+					float* output = vectors[j] + begin + partition * residue.m_PartitionSize;
+					if (residue.m_Type == 0)
+					{
+						// Type 0 interleaves the values of each vector across the partition
+						int step = residue.m_PartitionSize / codebook.m_Dimensions;
+						for (int k = 0; k < step; k++)
+						{
+							const float* values = decodeVector(codebook);
+							if (!values)
+							{
+								break;
+							}
+							for (unsigned int d = 0; d < codebook.m_Dimensions; d++)
+							{
+								output[k + d * step] += values[d];
+							}
+						}
+					}
+					else
+					{
+						for (unsigned int k = 0; k < residue.m_PartitionSize;)
+						{
+							const float* values = decodeVector(codebook);
+							if (!values)
+							{
+								break;
+							}
+							for (unsigned int d = 0; d < codebook.m_Dimensions && k < residue.m_PartitionSize; d++, k++)
+							{
+								output[k] += values[d];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (residue.m_Type == 2)
+	{
+		for (int i = 0; i < channelSize; i++)
+		{
+			for (int j = 0; j < channelCount; j++)
+			{
+				channelVectors[j][i] = interleaved[i * channelCount + j];
+			}
+		}
+	}
+}
+
+void VorbisDecoder::inverseMDCT(float* data, const Block& block)
+{
+	int n = block.m_Size;
+	int half = n / 2;
+	int quarter = n / 4;
+	std::complex<float>* fft = m_FFT.data();
+
+	// The DCT-IV of the half block of coefficients is a complex FFT of a quarter block, between two twiddles
+	for (int i = 0; i < quarter; i++)
+	{
+		fft[i] = std::complex<float>(data[2 * i], data[half - 1 - 2 * i]) * block.m_Twiddles[i];
+	}
+
+	for (int i = 0; i < quarter; i++)
+	{
+		int j = block.m_BitReverse[i];
+		if (i < j)
+		{
+			std::swap(fft[i], fft[j]);
+		}
+	}
+	for (int length = 2; length <= quarter; length *= 2)
+	{
+		int step = quarter / length;
+		for (int start = 0; start < quarter; start += length)
+		{
+			for (int i = 0; i < length / 2; i++)
+			{
+				std::complex<float> odd = fft[start + i + length / 2] * block.m_Roots[i * step];
+				fft[start + i + length / 2] = fft[start + i] - odd;
+				fft[start + i] += odd;
+			}
+		}
+	}
+
+	float* dct = m_DCT.data();
+	for (int i = 0; i < quarter; i++)
+	{
+		std::complex<float> value = fft[i] * block.m_Twiddles[i];
+		dct[2 * i] = value.real();
+		dct[half - 1 - 2 * i] = -value.imag();
+	}
+
+	// The block is the DCT-IV shifted by a quarter block, extended by its odd and even symmetries
+	for (int i = 0; i < n; i++)
+	{
+		int j = i + quarter;
+		data[i] = j < half ? dct[j] : (j < n ? -dct[n - 1 - j] : -dct[j - n]);
+	}
+}
+
+bool VorbisDecoder::decodeAudioPacket()
+{
+	if (readBits(1) != 0)
+	{
+		return false;
+	}
+	unsigned int modeNumber = readBits(ILog(m_Modes.size() - 1));
+	if (m_IsPacketEnd || modeNumber >= m_Modes.size())
+	{
+		return false;
+	}
+	const Mode& mode = m_Modes[modeNumber];
+	const Mapping& mapping = m_Mappings[mode.m_Mapping];
+	const Block& block = m_Blocks[mode.m_IsLong ? 1 : 0];
+	int n = block.m_Size;
+	int half = n / 2;
+	bool isPreviousLong = false;
+	bool isNextLong = false;
+	if (mode.m_IsLong)
+	{
+		isPreviousLong = readBits(1);
+		isNextLong = readBits(1);
+	}
+	if (m_IsPacketEnd)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < m_Channels; i++)
+	{
+		const Floor& floor = m_Floors[mapping.m_SubmapFloors[mapping.m_Mux[i]]];
+		m_IsFloorUsed[i] = decodeFloor(floor, m_FloorValues[i]);
+		m_IsResidueSkipped[i] = !m_IsFloorUsed[i];
+	}
+	// Coupled channels need both residues if either has a floor
+	for (size_t i = 0; i < mapping.m_Magnitudes.size(); i++)
+	{
+		if (!m_IsResidueSkipped[mapping.m_Magnitudes[i]] || !m_IsResidueSkipped[mapping.m_Angles[i]])
+		{
+			m_IsResidueSkipped[mapping.m_Magnitudes[i]] = false;
+			m_IsResidueSkipped[mapping.m_Angles[i]] = false;
+		}
+	}
+
+	for (int submap = 0; submap < (int)mapping.m_SubmapResidues.size(); submap++)
+	{
+		int count = 0;
+		for (int i = 0; i < m_Channels; i++)
+		{
+			if (mapping.m_Mux[i] == submap)
+			{
+				m_SubmapVectors[count] = m_Spectrums[i].data();
+				m_SubmapSkipped[count] = m_IsResidueSkipped[i];
+				count++;
+			}
+		}
+		decodeResidue(m_Residues[mapping.m_SubmapResidues[submap]], m_SubmapVectors.data(), m_SubmapSkipped.data(), count, half);
+	}
+
+	for (int i = (int)mapping.m_Magnitudes.size() - 1; i >= 0; i--)
+	{
+		float* magnitudes = m_Spectrums[mapping.m_Magnitudes[i]].data();
+		float* angles = m_Spectrums[mapping.m_Angles[i]].data();
+		for (int j = 0; j < half; j++)
+		{
+			float magnitude = magnitudes[j];
+			float angle = angles[j];
+			if (magnitude > 0.0f)
+			{
+				magnitudes[j] = angle > 0.0f ? magnitude : magnitude + angle;
+				angles[j] = angle > 0.0f ? magnitude - angle : magnitude;
+			}
+			else
+			{
+				magnitudes[j] = angle > 0.0f ? magnitude : magnitude - angle;
+				angles[j] = angle > 0.0f ? magnitude + angle : magnitude;
+			}
+		}
+	}
+
+	for (int i = 0; i < m_Channels; i++)
+	{
+		float* spectrum = m_Spectrums[i].data();
+		if (m_IsFloorUsed[i])
+		{
+			renderFloor(m_Floors[mapping.m_SubmapFloors[mapping.m_Mux[i]]], m_FloorValues[i], spectrum, half);
+		}
+		else
+		{
+			memset(spectrum, 0, half * sizeof(float));
+		}
+	}
+
+	// Long blocks next to short blocks use the short slope on that side, centered on their quarter points
+	const Block& leftSlope = mode.m_IsLong && !isPreviousLong ? m_Blocks[0] : block;
+	const Block& rightSlope = mode.m_IsLong && !isNextLong ? m_Blocks[0] : block;
+	int leftSize = leftSlope.m_Size / 2;
+	int rightSize = rightSlope.m_Size / 2;
+	int leftStart = n / 4 - leftSize / 2;
+	int rightStart = n * 3 / 4 - rightSize / 2;
+	for (int i = 0; i < m_Channels; i++)
+	{
+		float* data = m_Spectrums[i].data();
+		inverseMDCT(data, block);
+		for (int j = 0; j < leftStart; j++)
+		{
+			data[j] = 0.0f;
+		}
+		for (int j = 0; j < leftSize; j++)
+		{
+			data[leftStart + j] *= leftSlope.m_Slope[j];
+		}
+		for (int j = 0; j < rightSize; j++)
+		{
+			data[rightStart + j] *= rightSlope.m_Slope[rightSize - 1 - j];
+		}
+		for (int j = rightStart + rightSize; j < n; j++)
+		{
+			data[j] = 0.0f;
+		}
+	}
+
+	// Frames are finished from the center of the last block to the center of this one
+	int frameCount = 0;
+	if (m_IsOverlapReady)
+	{
+		frameCount = m_OverlapSize / 2 + n / 4;
+		int offset = n / 4 - m_OverlapSize / 2;
+		for (int i = 0; i < m_Channels; i++)
+		{
+			const float* overlap = m_Overlaps[i].data();
+			const float* data = m_Spectrums[i].data();
+			short* output = m_Output.data() + i;
+			for (int j = 0; j < frameCount; j++)
+			{
+				float sample = (j < m_OverlapSize ? overlap[j] : 0.0f) + (j + offset >= 0 ? data[j + offset] : 0.0f);
+				sample = std::clamp(sample * 32768.0f, -32768.0f, 32767.0f);
+				output[j * m_Channels] = (short)floorf(sample + 0.5f);
+			}
+		}
+	}
+
+	for (int i = 0; i < m_Channels; i++)
+	{
+		memcpy(m_Overlaps[i].data(), m_Spectrums[i].data() + half, half * sizeof(float));
+	}
+	m_OverlapSize = half;
+	m_IsOverlapReady = true;
+
+	m_OutputStart = 0;
+	m_OutputEnd = frameCount;
+	return true;
+}
+
+bool VorbisDecoder::decodeNextPacket()
+{
+	while ((!m_IsPositionKnown || m_Position < m_FrameCount) && readPacket())
+	{
+		if (!decodeAudioPacket())
+		{
+			continue;
+		}
+
+		if (!m_IsPositionKnown && m_PacketGranule >= 0)
+		{
+			// The granule position is the frame just after the last one this packet finished
+			unsigned long long granule = m_PacketGranule;
+			if (granule < (unsigned long long)m_OutputEnd)
+			{
+				m_OutputStart = m_OutputEnd - (int)granule;
+			}
+			m_Position = granule - (m_OutputEnd - m_OutputStart);
+			m_IsPositionKnown = true;
+		}
+		if (!m_IsPositionKnown)
+		{
+			m_OutputStart = m_OutputEnd;
+			continue;
+		}
+
+		// The last page can end partway through its last block
+		if (m_Position + (m_OutputEnd - m_OutputStart) > m_FrameCount)
+		{
+			m_OutputEnd = m_OutputStart + (int)(m_FrameCount - std::min(m_Position, m_FrameCount));
+		}
+		if (m_OutputStart < m_OutputEnd)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int VorbisDecoder::read(short* destination, unsigned int frameCount)
+{
+	unsigned int readCount = 0;
+	while (readCount < frameCount)
+	{
+		if (m_OutputStart == m_OutputEnd && !decodeNextPacket())
+		{
+			break;
+		}
+		unsigned int count = std::min(frameCount - readCount, (unsigned int)(m_OutputEnd - m_OutputStart));
+		memcpy(destination + readCount * m_Channels, m_Output.data() + m_OutputStart * m_Channels, count * m_Channels * sizeof(short));
+		m_OutputStart += count;
+		m_Position += count;
+		readCount += count;
+	}
+	return readCount;
+}
+
+bool VorbisDecoder::restartFrom(std::streamoff pageOffset, int segmentIndex)
+{
+	m_File.clear();
+	m_File.seekg(pageOffset);
+	m_IsLastPage = false;
+	m_SegmentIndex = 0;
+	m_SegmentCount = 0;
+	m_Packet.clear();
+	m_IsSkippingPacket = false;
+	m_IsOverlapReady = false;
+	m_OutputStart = 0;
+	m_OutputEnd = 0;
+	m_IsPositionKnown = false;
+
+	bool isContinued = false;
+	if (!readPage(isContinued))
+	{
+		return false;
+	}
+	m_IsSkippingPacket = isContinued && segmentIndex == 0;
+	for (; m_SegmentIndex < segmentIndex; m_SegmentIndex++)
+	{
+		m_SegmentOffset += m_Segments[m_SegmentIndex];
+	}
+	return true;
+}
+
+bool VorbisDecoder::rewind()
+{
+	if (!restartFrom(m_AudioPageOffset, m_AudioSegmentIndex))
+	{
+		return false;
+	}
+	m_Position = 0;
+	m_IsPositionKnown = true;
+	return true;
+}
+
+bool VorbisDecoder::seek(unsigned long long frame)
+{
+	frame = std::min(frame, m_FrameCount);
+	if (frame == 0)
+	{
+		return rewind();
+	}
+
+	// Skip through the page headers to the last 2 pages that finish before the frame.
+	// Decoding from the first of them finds the position by the end of the second, without going past the frame.
+	m_File.clear();
+	m_File.seekg(m_AudioPageOffset);
+	std::streamoff secondToLastOffset = -1;
+	std::streamoff lastOffset = -1;
+	while (true)
+	{
+		std::streamoff offset = m_File.tellg();
+		unsigned char header[27];
+		m_File.read((char*)header, sizeof(header));
+		if (m_File.gcount() != sizeof(header) || memcmp(header, "OggS", 4) != 0)
+		{
+			break;
+		}
+		m_File.read((char*)m_Segments, header[26]);
+		std::streamoff pageSize = 0;
+		for (int i = 0; i < header[26]; i++)
+		{
+			pageSize += m_Segments[i];
+		}
+		m_File.seekg(pageSize, std::ios::cur);
+
+		long long granule = (long long)ReadLE64(header + 6);
+		if (ReadLE32(header + 14) != m_Serial || granule < 0)
+		{
+			continue;
+		}
+		if ((unsigned long long)granule > frame || (header[5] & 4))
+		{
+			break;
+		}
+		secondToLastOffset = lastOffset;
+		lastOffset = offset;
+	}
+
+	bool isRestarted = secondToLastOffset < 0 ? rewind() : restartFrom(secondToLastOffset, 0);
+	if (!isRestarted)
+	{
+		return false;
+	}
+	while (!m_IsPositionKnown || m_Position + (m_OutputEnd - m_OutputStart) <= frame)
+	{
+		m_Position += m_OutputEnd - m_OutputStart;
+		m_OutputStart = m_OutputEnd;
+		if (!decodeNextPacket())
+		{
+			return m_IsPositionKnown;
+		}
+	}
+	if (m_Position < frame)
+	{
+		m_OutputStart += (int)(frame - m_Position);
+		m_Position = frame;
+	}
+	return true;
+}
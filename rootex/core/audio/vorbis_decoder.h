@@ -0,0 +1,188 @@
+#pragma once
+
+#include "common/common.h"
+
+#include <complex>
+#include <istream>
+
+/// Decodes an Ogg Vorbis stream to interleaved 16 bit PCM, one packet at a time, from any seekable stream.
+/// Follows the Vorbis I specification. Floor type 0, which only encoders from before 2004 used, and Opus streams are not supported.
+/// Every decode buffer is sized for the longest block of the stream when it is opened, so decoding does not allocate.
+class VorbisDecoder
+{
+	struct Codebook
+	{
+		unsigned int m_Dimensions;
+		unsigned int m_Entries;
+		/// Binary decode tree with 2 children per node. 0 is an unused child, a negative child is the leaf of entry -child - 1.
+		Vector<int> m_Tree;
+		/// m_Dimensions values for each entry. Empty for codebooks without a vector lookup.
+		Vector<float> m_Values;
+	};
+
+	struct Floor
+	{
+		Vector<int> m_PartitionClasses;
+		int m_ClassDimensions[16];
+		int m_ClassSubclasses[16];
+		int m_ClassMasterbooks[16];
+		int m_SubclassBooks[16][8];
+		int m_Multiplier;
+		Vector<int> m_X;
+		/// Indices of m_X in ascending order of their X.
+		Vector<int> m_Sorted;
+		Vector<int> m_LowNeighbors;
+		Vector<int> m_HighNeighbors;
+	};
+
+	struct Residue
+	{
+		int m_Type;
+		unsigned int m_Begin;
+		unsigned int m_End;
+		unsigned int m_PartitionSize;
+		int m_Classifications;
+		int m_Classbook;
+		int m_Books[64][8];
+	};
+
+	struct Mapping
+	{
+		Vector<int> m_Magnitudes;
+		Vector<int> m_Angles;
+		/// Submap of each channel.
+		Vector<int> m_Mux;
+		Vector<int> m_SubmapFloors;
+		Vector<int> m_SubmapResidues;
+	};
+
+	struct Mode
+	{
+		bool m_IsLong;
+		int m_Mapping;
+	};
+
+	/// Tables of the inverse MDCT and the window of a block size.
+	struct Block
+	{
+		int m_Size;
+		/// Rising half of the window of a block of this size.
+		Vector<float> m_Slope;
+		/// Twiddle factors applied before and after the FFT.
+		Vector<std::complex<float>> m_Twiddles;
+		Vector<std::complex<float>> m_Roots;
+		Vector<int> m_BitReverse;
+	};
+
+	std::istream& m_File;
+
+	// Ogg pages
+	unsigned int m_Serial;
+	std::streamoff m_PageOffset;
+	Vector<unsigned char> m_Page;
+	unsigned char m_Segments[255];
+	int m_SegmentCount;
+	int m_SegmentIndex;
+	/// Index of the segment that finishes the last packet of the page, -1 if no packet finishes on the page.
+	int m_LastPacketSegment;
+	/// Offset of the current segment in m_Page.
+	size_t m_SegmentOffset;
+	long long m_PageGranule;
+	bool m_IsLastPage;
+	/// Skipping the end of a packet that started before the page decoding began from.
+	bool m_IsSkippingPacket;
+
+	// Packets
+	Vector<unsigned char> m_Packet;
+	/// Granule position of the page the packet finished on, if it is the last packet finished on that page, otherwise -1.
+	long long m_PacketGranule;
+	size_t m_BitPosition;
+	bool m_IsPacketEnd;
+
+	// Headers
+	int m_Channels;
+	int m_SampleRate;
+	unsigned long long m_FrameCount;
+	Block m_Blocks[2];
+	Vector<Codebook> m_Codebooks;
+	Vector<Floor> m_Floors;
+	Vector<Residue> m_Residues;
+	Vector<Mapping> m_Mappings;
+	Vector<Mode> m_Modes;
+	std::streamoff m_AudioPageOffset;
+	int m_AudioSegmentIndex;
+
+	// Decoding state, sized on open
+	Vector<Vector<float>> m_Spectrums;
+	/// Right half of the last block of each channel, after windowing, waiting to be overlapped with the next block.
+	Vector<Vector<float>> m_Overlaps;
+	Vector<Vector<int>> m_FloorValues;
+	Vector<char> m_IsFloorUsed;
+	Vector<char> m_IsResidueSkipped;
+	Vector<float*> m_SubmapVectors;
+	Vector<char> m_SubmapSkipped;
+	/// Classifications of each channel of a residue, one row of m_ClassificationStride for each channel.
+	Vector<int> m_Classifications;
+	int m_ClassificationStride;
+	Vector<float> m_Interleaved;
+	Vector<float> m_DCT;
+	Vector<std::complex<float>> m_FFT;
+	Vector<int> m_FloorCurve;
+	int m_OverlapSize;
+	bool m_IsOverlapReady;
+
+	/// Decoded frames, interleaved, that have not been read yet.
+	Vector<short> m_Output;
+	int m_OutputStart;
+	int m_OutputEnd;
+	/// Frames decoded since the start of the stream, counting frames skipped while seeking.
+	unsigned long long m_Position;
+	/// If m_Position is known. Decoding restarted from the middle of the stream only knows its position once a page with a granule position ends.
+	bool m_IsPositionKnown;
+
+	bool readPage(bool& isContinued);
+	bool readPacket();
+	unsigned int readBits(int count);
+	int decodeEntry(const Codebook& codebook);
+	const float* decodeVector(const Codebook& codebook);
+
+	/// Read the packet type and the "vorbis" signature that start every header.
+	bool readHeaderType(unsigned int type);
+	bool readIdentificationHeader();
+	bool readSetupHeader();
+	bool readCodebook(Codebook& codebook);
+	bool readFloor(Floor& floor);
+	bool readResidue(Residue& residue);
+	bool readMapping(Mapping& mapping);
+	void initializeBlock(Block& block, int size);
+	bool findFrameCount();
+
+	/// Decode the packet read last. Returns false if the packet is not an audio packet that can be decoded.
+	bool decodeAudioPacket();
+	/// Decode packets till one has frames to read. Returns false at the end of the stream.
+	bool decodeNextPacket();
+	bool decodeFloor(const Floor& floor, Vector<int>& values);
+	void renderFloor(const Floor& floor, const Vector<int>& values, float* spectrum, int size);
+	void decodeResidue(const Residue& residue, float** vectors, const char* isSkipped, int count, int size);
+	void inverseMDCT(float* data, const Block& block);
+	/// Restart decoding from the start of the page at offset, with the position unknown till a page ends.
+	bool restartFrom(std::streamoff pageOffset, int segmentIndex);
+
+public:
+	VorbisDecoder(std::istream& file);
+	VorbisDecoder(VorbisDecoder&) = delete;
+	~VorbisDecoder() = default;
+
+	/// Read the headers of the stream. Returns false if it is not an Ogg Vorbis stream that can be decoded.
+	bool open();
+	/// Decode up to frameCount frames into destination. Returns the number of frames decoded, less than frameCount only at the end of the stream.
+	unsigned int read(short* destination, unsigned int frameCount);
+	/// Continue decoding from a frame, found by its page and then by decoding up to it.
+	bool seek(unsigned long long frame);
+	bool rewind();
+
+	int getChannels() const { return m_Channels; }
+	int getSampleRate() const { return m_SampleRate; }
+	/// Frames in the stream, read from the granule position of its last page.
+	unsigned long long getFrameCount() const { return m_FrameCount; }
+};
@@ -0,0 +1,61 @@
+#include "content_hash.h"
+
+static const unsigned long long Prime1 = 0x9E3779B185EBCA87ull;
+static const unsigned long long Prime2 = 0xC2B2AE3D27D4EB4Full;
+static const unsigned long long Prime3 = 0x165667B19E3779F9ull;
+
+static unsigned long long RotateLeft(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static unsigned long long Mix(unsigned long long hash, unsigned long long value)
+{
+	value *= Prime2;
+	value = RotateLeft(value, 31);
+	value *= Prime1;
+	hash ^= value;
+	return RotateLeft(hash, 27) * Prime1 + Prime3;
+}
+
+unsigned long long ContentHash::Hash(const char* data, size_t size, unsigned long long seed)
+{
+	// 4 independent lanes of 8 bytes each keep the multipliers busy
+	unsigned long long lanes[4] = { seed + Prime1, seed + Prime2, seed, seed - Prime1 };
+	size_t position = 0;
+	for (; position + 32 <= size; position += 32)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			unsigned long long word;
+			memcpy(&word, data + position + i * 8, 8);
+			lanes[i] = Mix(lanes[i], word);
+		}
+	}
+
+	unsigned long long hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+	hash = Mix(hash, size);
+	for (; position + 8 <= size; position += 8)
+	{
+		unsigned long long word;
+		memcpy(&word, data + position, 8);
+		hash = Mix(hash, word);
+	}
+	for (; position < size; position++)
+	{
+		hash = Mix(hash, (unsigned char)data[position]);
+	}
+
+	// Avalanche so that every input bit affects every output bit
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+unsigned long long ContentHash::Combine(unsigned long long hash, unsigned long long value)
+{
+	return Mix(hash, value);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Fast 64 bit hash of file contents, used to tell if a source file changed since it was last cooked. Not cryptographic.
+class ContentHash
+{
+public:
+	static unsigned long long Hash(const char* data, size_t size, unsigned long long seed = 0);
+	/// Mix a value into a hash, to key cooked data by its import settings as well.
+	static unsigned long long Combine(unsigned long long hash, unsigned long long value);
+};
@@ -1,6 +1,7 @@
 #include "event_manager.h"
 
 #include "entity.h"
+#include "os/profiler.h"
 
 EventManager::EventManager()
 {
@@ -84,21 +85,9 @@ void EventManager::call(const String& eventName, const Event::Type& eventType, c
 
 void EventManager::deferredCall(Ref<Event> event)
 {
-	if (!(m_ActiveQueue >= 0 && m_ActiveQueue < EVENTMANAGER_NUM_QUEUES))
-	{
-		WARN("Event left unhandled: " + event->getName());
-	}
-
-	auto&& findIt = m_EventListeners.find(event->getType());
-	if (findIt != m_EventListeners.end())
-	{
-		m_Queues[m_ActiveQueue].push_back(event);
-		return;
-	}
-	else
-	{
-		WARN("Event left unhandled: " + event->getName());
-	}
+	// Listeners are only looked up on dispatch, because they can be added on the main thread while other threads defer events
+	std::lock_guard<std::mutex> lock(m_QueueMutex);
+	m_Queues[m_ActiveQueue].push_back(event);
 }
 
 void EventManager::deferredCall(const String& eventName, const Event::Type& eventType, const Variant& data)
@@ -109,9 +98,14 @@ void EventManager::deferredCall(const String& eventName, const Event::Type& even
 
 bool EventManager::dispatchDeferred(unsigned long maxMillis)
 {
-	int queueToProcess = m_ActiveQueue;
-	m_ActiveQueue = (m_ActiveQueue + 1) % EVENTMANAGER_NUM_QUEUES;
-	m_Queues[m_ActiveQueue].clear();
+	PROFILE_FUNCTION();
+	int queueToProcess;
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		queueToProcess = m_ActiveQueue;
+		m_ActiveQueue = (m_ActiveQueue + 1) % EVENTMANAGER_NUM_QUEUES;
+		m_Queues[m_ActiveQueue].clear();
+	}
 
 	while (!m_Queues[queueToProcess].empty())
 	{
@@ -129,6 +123,10 @@ bool EventManager::dispatchDeferred(unsigned long maxMillis)
 				listener(event.get());
 			}
 		}
+		else
+		{
+			WARN("Event left unhandled: " + event->getName());
+		}
 
 		// check to see if time ran out
 		// currMs = GetTickCount();
@@ -143,6 +141,7 @@ bool EventManager::dispatchDeferred(unsigned long maxMillis)
 	bool queueFlushed = (m_Queues[queueToProcess].empty());
 	if (!queueFlushed)
 	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
 		while (!m_Queues[queueToProcess].empty())
 		{
 			Ref<Event> pEvent = m_Queues[queueToProcess].back();
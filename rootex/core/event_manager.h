@@ -3,6 +3,8 @@
 #include "common/common.h"
 #include "event.h"
 
+#include <mutex>
+
 /// Bind a member function of a class to an event.
 #define BIND_EVENT_FUNCTION(stringEventType, function) EventManager::GetSingleton()->addListener(stringEventType, function)
 /// Bind a global function to an event.
@@ -20,6 +22,8 @@ class EventManager
 	HashMap<Event::Type, Vector<EventFunction>> m_EventListeners;
 	Vector<Ref<Event>> m_Queues[EVENTMANAGER_NUM_QUEUES];
 	unsigned int m_ActiveQueue;
+	/// Guards the deferred queues so that events can be deferred from worker threads. Listeners are only used on the main thread.
+	std::mutex m_QueueMutex;
 
 	EventManager();
 	~EventManager();
@@ -43,7 +47,8 @@ public:
 	Variant returnCall(const String& eventName, const Event::Type& eventType, const Variant& data);
 	void call(const Event& event);
 	void call(const String& eventName, const Event::Type& eventType, const Variant& data);
-	/// Publish an event that gets evaluated the end of the current frame.
+	/// Publish an event that gets evaluated the end of the current frame. Safe to call from worker threads, as it only touches the deferred queues.
+	/// Events that nobody listens to are warned about when they are dispatched.
 	void deferredCall(Ref<Event> event);
 	void deferredCall(const String& eventName, const Event::Type& eventType, const Variant& data);
 	/// Dispatch deferred events collected so far.
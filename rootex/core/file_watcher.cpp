@@ -0,0 +1,255 @@
+#include "file_watcher.h"
+
+#include "event_manager.h"
+#include "os/timer.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // _WIN32
+
+FileWatcher* FileWatcher::GetSingleton()
+{
+	static FileWatcher singleton;
+	return &singleton;
+}
+
+String FileWatcher::NormalizePath(const String& path)
+{
+	return FilePath(path).lexically_normal().generic_string();
+}
+
+FileWatcher::FileWatcher()
+    : m_IsRunning(false)
+    , m_HasOverflowed(false)
+    , m_CoalesceMilliseconds(100)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	stop();
+}
+
+bool FileWatcher::start(const FilePath& directory, unsigned int coalesceMilliseconds)
+{
+	stop();
+	// Changes are sent even if nothing listens for them yet
+	EventManager::GetSingleton()->addEvent(FILE_WATCHER_CHANGED_EVENT);
+
+	m_Directory = directory;
+	m_CoalesceMilliseconds = coalesceMilliseconds;
+	m_HasOverflowed = false;
+	m_IsRunning = true;
+	m_Thread = std::thread(&FileWatcher::run, this);
+	return true;
+}
+
+void FileWatcher::stop()
+{
+	if (m_Thread.joinable())
+	{
+		m_IsRunning = false;
+		m_Thread.join();
+	}
+}
+
+bool FileWatcher::isDirty(const String& path)
+{
+	std::lock_guard<std::mutex> lock(m_DirtyMutex);
+	return m_DirtyFiles.find(NormalizePath(path)) != m_DirtyFiles.end();
+}
+
+void FileWatcher::markClean(const String& path)
+{
+	std::lock_guard<std::mutex> lock(m_DirtyMutex);
+	m_DirtyFiles.erase(NormalizePath(path));
+}
+
+bool FileWatcher::shouldFlush(const HashSet<String>& changes, const StopTimer& quietTimer, const StopTimer& pendingTimer) const
+{
+	// Files that keep changing still get sent out after a while
+	return !changes.empty() && (quietTimer.getTimeMs() >= m_CoalesceMilliseconds || pendingTimer.getTimeMs() >= FILE_WATCHER_MAX_DELAY_FACTOR * m_CoalesceMilliseconds);
+}
+
+void FileWatcher::flush(HashSet<String>& changes)
+{
+	Vector<String> changedFiles(changes.begin(), changes.end());
+	changes.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_DirtyMutex);
+		m_DirtyFiles.insert(changedFiles.begin(), changedFiles.end());
+	}
+	EventManager::GetSingleton()->deferredCall("FileWatcher", FILE_WATCHER_CHANGED_EVENT, changedFiles);
+}
+
+#ifdef _WIN32
+void FileWatcher::run()
+{
+	HANDLE directory = CreateFileA(m_Directory.string().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (directory == INVALID_HANDLE_VALUE)
+	{
+		WARN("Could not watch directory: " + m_Directory.string());
+		m_IsRunning = false;
+		return;
+	}
+
+	OVERLAPPED overlapped = {};
+	overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	// Notifications are DWORD aligned records
+	Vector<DWORD> buffer(16 * 1024);
+	const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+	HashSet<String> changes;
+	StopTimer quietTimer;
+	StopTimer pendingTimer;
+	bool isReading = false;
+	while (m_IsRunning)
+	{
+		if (!isReading)
+		{
+			if (!ReadDirectoryChangesW(directory, buffer.data(), buffer.size() * sizeof(DWORD), TRUE, filter, nullptr, &overlapped, nullptr))
+			{
+				WARN("Stopped watching directory: " + m_Directory.string());
+				m_HasOverflowed = true;
+				break;
+			}
+			isReading = true;
+		}
+
+		// Waking up regularly lets stop() end the thread and lets changes get flushed once they settle
+		if (WaitForSingleObject(overlapped.hEvent, m_CoalesceMilliseconds) == WAIT_OBJECT_0)
+		{
+			isReading = false;
+			DWORD bytes = 0;
+			GetOverlappedResult(directory, &overlapped, &bytes, FALSE);
+			ResetEvent(overlapped.hEvent);
+			if (bytes == 0)
+			{
+				// The buffer overflowed and the changes are lost
+				WARN("Too many file changes to keep track of, falling back to checking the disk");
+				m_HasOverflowed = true;
+				continue;
+			}
+
+			const char* record = (const char*)buffer.data();
+			while (true)
+			{
+				const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)record;
+				std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+				if (changes.empty())
+				{
+					pendingTimer.reset();
+				}
+				changes.insert(NormalizePath(FilePath(name).generic_string()));
+				if (info->NextEntryOffset == 0)
+				{
+					break;
+				}
+				record += info->NextEntryOffset;
+			}
+			quietTimer.reset();
+		}
+		if (shouldFlush(changes, quietTimer, pendingTimer))
+		{
+			flush(changes);
+		}
+	}
+
+	CancelIo(directory);
+	if (isReading)
+	{
+		DWORD bytes = 0;
+		GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+	}
+	CloseHandle(overlapped.hEvent);
+	CloseHandle(directory);
+}
+#else
+void FileWatcher::run()
+{
+	int notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notifier < 0)
+	{
+		WARN("Could not watch directory: " + m_Directory.string());
+		m_IsRunning = false;
+		return;
+	}
+
+	// inotify does not watch subdirectories, so every directory gets its own watch
+	const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+	HashMap<int, String> watchedDirectories;
+	auto watch = [&](const FilePath& directory) {
+		std::error_code error;
+		Vector<FilePath> directories = { directory };
+		for (auto& entry : std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, error))
+		{
+			if (entry.is_directory(error))
+			{
+				directories.push_back(entry.path());
+			}
+		}
+		for (auto& path : directories)
+		{
+			int watchID = inotify_add_watch(notifier, path.c_str(), mask);
+			if (watchID >= 0)
+			{
+				watchedDirectories[watchID] = NormalizePath(std::filesystem::relative(path, m_Directory, error).generic_string());
+			}
+		}
+	};
+	watch(m_Directory);
+
+	HashSet<String> changes;
+	StopTimer quietTimer;
+	StopTimer pendingTimer;
+	alignas(inotify_event) char buffer[16 * 1024];
+	while (m_IsRunning)
+	{
+		// Waking up regularly lets stop() end the thread and lets changes get flushed once they settle
+		pollfd pollNotifier = { notifier, POLLIN, 0 };
+		if (poll(&pollNotifier, 1, m_CoalesceMilliseconds) > 0)
+		{
+			ssize_t bytes = 0;
+			while ((bytes = read(notifier, buffer, sizeof(buffer))) > 0)
+			{
+				for (const char* record = buffer; record < buffer + bytes;)
+				{
+					const inotify_event* info = (const inotify_event*)record;
+					record += sizeof(inotify_event) + info->len;
+					if (info->mask & IN_Q_OVERFLOW)
+					{
+						WARN("Too many file changes to keep track of, falling back to checking the disk");
+						m_HasOverflowed = true;
+						continue;
+					}
+					auto&& directory = watchedDirectories.find(info->wd);
+					if (directory == watchedDirectories.end() || info->len == 0)
+					{
+						continue;
+					}
+
+					FilePath path = FilePath(directory->second) / info->name;
+					if ((info->mask & (IN_CREATE | IN_MOVED_TO)) && (info->mask & IN_ISDIR))
+					{
+						watch(m_Directory / path);
+					}
+					if (changes.empty())
+					{
+						pendingTimer.reset();
+					}
+					changes.insert(NormalizePath(path.generic_string()));
+				}
+			}
+			quietTimer.reset();
+		}
+		if (shouldFlush(changes, quietTimer, pendingTimer))
+		{
+			flush(changes);
+		}
+	}
+
+	close(notifier);
+}
+#endif // _WIN32
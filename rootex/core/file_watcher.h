@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/common.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+class StopTimer;
+
+/// Event type sent with the paths of files that changed on disk, relative to Rootex root.
+#define FILE_WATCHER_CHANGED_EVENT "FileWatcherFilesChanged"
+/// Changes are sent at most this many coalescing intervals after they happen, even if files keep changing
+#define FILE_WATCHER_MAX_DELAY_FACTOR 10
+
+/// Watches a directory tree for changed files on a background thread, so that checking a file for changes does not touch the disk.
+/// Changes are collected until no more arrive for a while, and are then sent together as one deferred event.
+/// Uses ReadDirectoryChangesW on Windows and inotify elsewhere.
+class FileWatcher
+{
+	std::thread m_Thread;
+	std::atomic<bool> m_IsRunning;
+	/// Set if the OS dropped changes, after which changes can only be found by checking the disk
+	std::atomic<bool> m_HasOverflowed;
+	FilePath m_Directory;
+	unsigned int m_CoalesceMilliseconds;
+
+	std::mutex m_DirtyMutex;
+	/// Files that changed since they were last read, relative to Rootex root
+	HashSet<String> m_DirtyFiles;
+
+	FileWatcher();
+	FileWatcher(FileWatcher&) = delete;
+	~FileWatcher();
+
+	void run();
+	bool shouldFlush(const HashSet<String>& changes, const StopTimer& quietTimer, const StopTimer& pendingTimer) const;
+	/// Mark changes dirty and send them out with an event.
+	void flush(HashSet<String>& changes);
+
+public:
+	static FileWatcher* GetSingleton();
+	/// Path of a file the way FileWatcher stores it, relative to Rootex root with forward slashes.
+	static String NormalizePath(const String& path);
+
+	/// Start watching a directory and everything inside it. Changes are sent once no more arrive for coalesceMilliseconds.
+	bool start(const FilePath& directory, unsigned int coalesceMilliseconds);
+	void stop();
+
+	/// If changes found by the watcher can be trusted. Check the disk for changes otherwise.
+	bool isWatching() const { return m_IsRunning && !m_HasOverflowed; }
+	/// If a file changed since it was last marked clean.
+	bool isDirty(const String& path);
+	/// Forget changes to a file, after it has been read again.
+	void markClean(const String& path);
+};
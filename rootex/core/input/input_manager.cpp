@@ -1,5 +1,6 @@
 #include "input_manager.h"
 #include "event_manager.h"
+#include "os/profiler.h"
 
 #include <functional>
 
@@ -115,6 +116,10 @@ void InputManager::unmap(const Event::Type& action)
 
 bool InputManager::isPressed(const Event::Type& action)
 {
+	if (m_Replay)
+	{
+		return m_TickedInputs[action].m_Value != 0.0f;
+	}
 	if (m_IsEnabled)
 	{
 		return m_GainputMap.GetBool((gainput::UserButtonId)m_InputEventNameIDs[action]);
@@ -124,15 +129,20 @@ bool InputManager::isPressed(const Event::Type& action)
 
 bool InputManager::wasPressed(const Event::Type& action)
 {
-	if (m_IsEnabled)
+	// Gainput keeps previous values per frame, which would differ between recording and replaying when a frame runs more or less than one tick
+	if (m_Replay || m_IsEnabled)
 	{
-		return m_GainputMap.GetBoolWasDown((gainput::UserButtonId)m_InputEventNameIDs[action]);
+		return getPreviousValue(action) != 0.0f;
 	}
 	return false;
 }
 
 float InputManager::getFloat(const Event::Type& action)
 {
+	if (m_Replay)
+	{
+		return m_TickedInputs[action].m_Value;
+	}
 	if (m_IsEnabled)
 	{
 		return m_GainputMap.GetFloat((gainput::UserButtonId)m_InputEventNameIDs[action]);
@@ -142,16 +152,120 @@ float InputManager::getFloat(const Event::Type& action)
 
 float InputManager::getFloatDelta(const Event::Type& action)
 {
-	if (m_IsEnabled)
+	if (m_Replay || m_IsEnabled)
 	{
-		return m_GainputMap.GetFloatDelta((gainput::UserButtonId)m_InputEventNameIDs[action]);
+		return m_TickedInputs[action].m_Value - getPreviousValue(action);
 	}
 	return 0;
 }
 
 void InputManager::update()
 {
-	m_GainputManager.Update();
+	PROFILE_FUNCTION();
+	if (!m_Replay)
+	{
+		m_GainputManager.Update();
+	}
+}
+
+void InputManager::tick()
+{
+	if (m_Replay)
+	{
+		// Changes are sent at the start of the tick they were recorded before, so the simulation sees them at the same point
+		const Vector<InputChange>& changes = m_Replay->getChanges();
+		while (m_ReplayPosition < changes.size() && changes[m_ReplayPosition].m_Tick <= m_Tick)
+		{
+			const InputChange& change = changes[m_ReplayPosition++];
+			dispatch(m_Replay->getAction(change.m_Action), change.m_IsFloat, change.m_OldValue, change.m_NewValue);
+		}
+		if (m_ReplayPosition == changes.size() && !changes.empty() && changes.back().m_Tick == m_Tick)
+		{
+			PRINT("Input replay has no more changes after tick " + std::to_string(m_Tick));
+		}
+	}
+	m_Tick++;
+}
+
+void InputManager::startRecording(const String& path)
+{
+	if (m_Replay)
+	{
+		WARN("Can not record input while replaying it");
+		return;
+	}
+	stopRecording();
+	m_Recording.reset(new InputRecording(m_TickRate));
+	m_RecordingPath = path;
+	m_Tick = 0;
+	for (auto& [action, input] : m_TickedInputs)
+	{
+		input.m_PreviousValue = input.m_Value;
+		input.m_ChangeTick = 0;
+	}
+	PRINT("Recording input to " + path);
+}
+
+void InputManager::stopRecording()
+{
+	if (m_Recording)
+	{
+		m_Recording->save(m_RecordingPath);
+		m_Recording.reset();
+	}
+}
+
+bool InputManager::startReplay(const String& path)
+{
+	stopRecording();
+	Ptr<InputRecording> replay = InputRecording::Load(path);
+	if (!replay)
+	{
+		return false;
+	}
+	if (replay->getTickRate() != m_TickRate)
+	{
+		WARN("Input recording was made at " + std::to_string(replay->getTickRate()) + " ticks per second, replaying at " + std::to_string(m_TickRate) + " will not be deterministic: " + path);
+	}
+
+	m_Replay = std::move(replay);
+	m_ReplayPosition = 0;
+	m_TickedInputs.clear();
+	m_Tick = 0;
+	PRINT("Replaying " + std::to_string(m_Replay->getChanges().size()) + " input changes from " + path);
+	return true;
+}
+
+void InputManager::stopReplay()
+{
+	m_Replay.reset();
+	m_TickedInputs.clear();
+}
+
+void InputManager::dispatch(const Event::Type& action, bool isFloat, float oldValue, float newValue)
+{
+	if (m_Recording)
+	{
+		m_Recording->add(m_Tick, action, isFloat, oldValue, newValue);
+	}
+
+	// Live changes are sent by update() and replayed ones by tick(), both stamped with the same tick before the simulation tick that sees them
+	TickedInput& input = m_TickedInputs[action];
+	if (input.m_ChangeTick != m_Tick)
+	{
+		input.m_PreviousValue = input.m_Value;
+		input.m_ChangeTick = m_Tick;
+	}
+	input.m_Value = newValue;
+
+	EventManager::GetSingleton()->call(isFloat ? "FloatInputEvent" : "BoolInputEvent", action, Vector2(oldValue, newValue));
+}
+
+float InputManager::getPreviousValue(const Event::Type& action)
+{
+	// tick() counts a tick before the simulation runs it, so changes stamped with the last counted tick are new to the current one
+	const TickedInput& input = m_TickedInputs[action];
+	return input.m_ChangeTick + 1 == m_Tick ? input.m_PreviousValue : input.m_Value;
 }
 
 unsigned int InputManager::getNextID()
@@ -172,6 +286,12 @@ void InputManager::RegisterAPI(sol::state& rootex)
 	inputManager["getFloat"] = &InputManager::getFloat;
 	inputManager["getFloatDelta"] = &InputManager::getFloatDelta;
 	inputManager["unmap"] = &InputManager::unmap;
+	inputManager["startRecording"] = &InputManager::startRecording;
+	inputManager["stopRecording"] = &InputManager::stopRecording;
+	inputManager["isRecording"] = &InputManager::isRecording;
+	inputManager["startReplay"] = &InputManager::startReplay;
+	inputManager["stopReplay"] = &InputManager::stopReplay;
+	inputManager["isReplaying"] = &InputManager::isReplaying;
 }
 
 InputManager* InputManager::GetSingleton()
@@ -182,13 +302,13 @@ InputManager* InputManager::GetSingleton()
 
 bool InputManager::BoolListen(int userButton, bool oldValue, bool newValue)
 {
-	EventManager::GetSingleton()->call("BoolInputEvent", GetSingleton()->m_InputEventIDNames[userButton], Vector2(oldValue, newValue));
+	GetSingleton()->dispatch(GetSingleton()->m_InputEventIDNames[userButton], false, oldValue, newValue);
 	return true;
 }
 
 bool InputManager::FloatListen(int userButton, float oldValue, float newValue)
 {
-	EventManager::GetSingleton()->call("FloatInputEvent", GetSingleton()->m_InputEventIDNames[userButton], Vector2(oldValue, newValue));
+	GetSingleton()->dispatch(GetSingleton()->m_InputEventIDNames[userButton], true, oldValue, newValue);
 	return true;
 }
 
@@ -197,10 +317,16 @@ InputManager::InputManager()
     , m_Listener(BoolListen, FloatListen)
     , m_Width(0)
     , m_Height(0)
+    , m_Tick(0)
+    , m_TickRate(0.0f)
+    , m_ReplayPosition(0)
 {
 }
 
 void InputManager::forwardMessage(const MSG& msg)
 {
-	m_GainputManager.HandleMessage(msg);
+	if (!m_Replay)
+	{
+		m_GainputManager.HandleMessage(msg);
+	}
 }
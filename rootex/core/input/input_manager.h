@@ -3,6 +3,7 @@
 #include "common/common.h"
 #include "event.h"
 #include "input_listener.h"
+#include "input_recording.h"
 
 #include "vendor/Gainput/include/gainput/gainput.h"
 
@@ -43,8 +44,19 @@ struct InputButtonBindingData
 /// Allows detecting inputs through Event dispatch. 
 /// Event data for boolean buttons consists of a Vector2 where Vector2.x and Vector2.y carry the old and new values for the input event respectively.
 /// Float buttons should be queried directly by invoking InputManager.
+/// Changes of mapped inputs can be recorded by simulation tick, and replayed through the same events and queries without any device.
 class InputManager
 {
+	/// Value of an input as of the last change sent for it. Kept the same way while playing live and while replaying.
+	struct TickedInput
+	{
+		float m_Value = 0.0f;
+		/// Value before the first change sent with m_ChangeTick
+		float m_PreviousValue = 0.0f;
+		/// Tick the last change was stamped with
+		unsigned int m_ChangeTick = 0;
+	};
+
 	/// Callback from Gainput's internals. Called when a key with bool value is activated.
 	static bool BoolListen(int userButton, bool oldValue, bool newValue);
 	/// Callback from Gainput's internals. Called when a key with float value is activated.
@@ -64,6 +76,15 @@ class InputManager
 	unsigned int m_Width;
 	unsigned int m_Height;
 
+	/// Simulation ticks run since recording or replaying started
+	unsigned int m_Tick;
+	float m_TickRate;
+	Ptr<InputRecording> m_Recording;
+	String m_RecordingPath;
+	Ptr<InputRecording> m_Replay;
+	size_t m_ReplayPosition;
+	HashMap<Event::Type, TickedInput> m_TickedInputs;
+
 	InputManager();
 	InputManager(InputManager&) = delete;
 	~InputManager() = default;
@@ -73,6 +94,10 @@ class InputManager
 	friend class Window;
 
 	unsigned int getNextID();
+	/// Value of an input at the start of the current simulation tick.
+	float getPreviousValue(const Event::Type& action);
+	/// Send an input change as an event, recording it if a recording is running.
+	void dispatch(const Event::Type& action, bool isFloat, float oldValue, float newValue);
 
 public:
 	static void RegisterAPI(sol::state& rootex);
@@ -94,11 +119,26 @@ public:
 	void unmap(const Event::Type& action);
 
 	bool isPressed(const Event::Type& action);
+	/// If the input was pressed at the start of the current simulation tick.
 	bool wasPressed(const Event::Type& action);
 	float getFloat(const Event::Type& action);
+	/// Change of the input since the start of the current simulation tick.
 	float getFloatDelta(const Event::Type& action);
 
 	void update();
+	/// Call at the start of every simulation tick. Sends the replayed changes of the tick.
+	void tick();
+
+	/// Rate of the simulation ticks that changes are stamped with. Saved with recordings, so that replays can check it.
+	void setTickRate(float ticksPerSecond) { m_TickRate = ticksPerSecond; }
+	/// Record every change of a mapped input until stopRecording, which saves the recording to path.
+	void startRecording(const String& path);
+	void stopRecording();
+	bool isRecording() const { return m_Recording != nullptr; }
+	/// Ignore devices and send the changes of a recording instead, each before the tick it was recorded at.
+	bool startReplay(const String& path);
+	void stopReplay();
+	bool isReplaying() const { return m_Replay != nullptr; }
 
 	const gainput::InputMap& getMap() const { return m_GainputMap; }
 	gainput::InputDeviceMouse* getMouse() { return static_cast<gainput::InputDeviceMouse*>(m_GainputManager.GetDevice(DeviceIDs[Device::Mouse])); }
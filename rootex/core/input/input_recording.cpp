@@ -0,0 +1,179 @@
+#include "input_recording.h"
+
+static void WriteVarint(String& output, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		output += (char)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	output += (char)value;
+}
+
+static bool ReadVarint(const FileBuffer& input, size_t& position, unsigned int& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 32 && position < input.size(); shift += 7)
+	{
+		unsigned char byte = input[position++];
+		value |= (unsigned int)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ReadBytes(const FileBuffer& input, size_t& position, void* data, size_t size)
+{
+	if (position + size > input.size())
+	{
+		return false;
+	}
+	memcpy(data, input.data() + position, size);
+	position += size;
+	return true;
+}
+
+Ptr<InputRecording> InputRecording::Load(const String& path)
+{
+	if (!OS::IsExists(path))
+	{
+		WARN("Input recording not found: " + path);
+		return nullptr;
+	}
+
+	FileBuffer input = OS::LoadFileContents(path);
+	size_t position = 0;
+	InputRecordingHeader header;
+	if (!ReadBytes(input, position, &header, sizeof(header)) || strncmp(header.m_Magic, INPUT_RECORDING_MAGIC, 4) != 0 || header.m_Version != INPUT_RECORDING_VERSION)
+	{
+		ERR("Not a version " + std::to_string(INPUT_RECORDING_VERSION) + " input recording: " + path);
+		return nullptr;
+	}
+
+	// Each action name takes at least its length byte
+	if (header.m_ActionCount > input.size() - position)
+	{
+		ERR("Input recording has more actions than fit in the file: " + path);
+		return nullptr;
+	}
+	Ptr<InputRecording> recording(new InputRecording(header.m_TickRate));
+	recording->m_Actions.resize(header.m_ActionCount);
+	for (auto& action : recording->m_Actions)
+	{
+		unsigned int size = 0;
+		if (!ReadVarint(input, position, size) || position + size > input.size())
+		{
+			ERR("Input recording actions are corrupt: " + path);
+			return nullptr;
+		}
+		action.assign(input.data() + position, size);
+		position += size;
+	}
+
+	// Each change takes at least a tick, an action and a byte of values, so a corrupt count can not make a huge allocation
+	if (header.m_ChangeCount > (input.size() - position) / 3)
+	{
+		ERR("Input recording has more changes than fit in the file: " + path);
+		return nullptr;
+	}
+	unsigned int tick = 0;
+	recording->m_Changes.resize(header.m_ChangeCount);
+	for (auto& change : recording->m_Changes)
+	{
+		unsigned int tickDelta = 0;
+		unsigned int action = 0;
+		if (!ReadVarint(input, position, tickDelta) || !ReadVarint(input, position, action) || (action >> 1) >= header.m_ActionCount)
+		{
+			ERR("Input recording changes are corrupt: " + path);
+			return nullptr;
+		}
+		tick += tickDelta;
+		change.m_Tick = tick;
+		change.m_Action = action >> 1;
+		change.m_IsFloat = action & 1;
+
+		bool isRead = false;
+		if (change.m_IsFloat)
+		{
+			isRead = ReadBytes(input, position, &change.m_OldValue, sizeof(float)) && ReadBytes(input, position, &change.m_NewValue, sizeof(float));
+		}
+		else
+		{
+			unsigned char values = 0;
+			isRead = ReadBytes(input, position, &values, 1);
+			change.m_OldValue = values & 1;
+			change.m_NewValue = (values >> 1) & 1;
+		}
+		if (!isRead)
+		{
+			ERR("Input recording changes are corrupt: " + path);
+			return nullptr;
+		}
+	}
+
+	return recording;
+}
+
+InputRecording::InputRecording(float tickRate)
+    : m_TickRate(tickRate)
+{
+}
+
+void InputRecording::add(unsigned int tick, const String& action, bool isFloat, float oldValue, float newValue)
+{
+	auto&& index = m_ActionIndices.find(action);
+	if (index == m_ActionIndices.end())
+	{
+		index = m_ActionIndices.emplace(action, m_Actions.size()).first;
+		m_Actions.push_back(action);
+	}
+	m_Changes.push_back({ tick, index->second, isFloat, oldValue, newValue });
+}
+
+bool InputRecording::save(const String& path) const
+{
+	InputRecordingHeader header;
+	memcpy(header.m_Magic, INPUT_RECORDING_MAGIC, 4);
+	header.m_Version = INPUT_RECORDING_VERSION;
+	header.m_TickRate = m_TickRate;
+	header.m_ActionCount = m_Actions.size();
+	header.m_ChangeCount = m_Changes.size();
+
+	String output((const char*)&header, sizeof(header));
+	for (auto& action : m_Actions)
+	{
+		WriteVarint(output, action.size());
+		output += action;
+	}
+
+	unsigned int tick = 0;
+	for (auto& change : m_Changes)
+	{
+		WriteVarint(output, change.m_Tick - tick);
+		WriteVarint(output, change.m_Action << 1 | (change.m_IsFloat ? 1 : 0));
+		tick = change.m_Tick;
+
+		if (change.m_IsFloat)
+		{
+			output.append((const char*)&change.m_OldValue, sizeof(float));
+			output.append((const char*)&change.m_NewValue, sizeof(float));
+		}
+		else
+		{
+			output += (char)((change.m_OldValue != 0.0f ? 1 : 0) | (change.m_NewValue != 0.0f ? 2 : 0));
+		}
+	}
+
+	std::ofstream file(OS::GetAbsolutePath(path), std::ios::binary);
+	if (!file)
+	{
+		ERR("Could not open input recording for writing: " + path);
+		return false;
+	}
+	file.write(output.data(), output.size());
+	PRINT("Saved " + std::to_string(m_Changes.size()) + " input changes over " + std::to_string(tick) + " ticks to " + path);
+	return true;
+}
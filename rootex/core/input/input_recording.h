@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Identifies a Rootex input recording
+#define INPUT_RECORDING_MAGIC "RINP"
+#define INPUT_RECORDING_VERSION 1
+
+/// Starts a .rinput file. Followed by the action names and then the changes, both as variable length records.
+struct InputRecordingHeader
+{
+	char m_Magic[4];
+	unsigned int m_Version;
+	/// Simulation ticks per second the changes were stamped at
+	float m_TickRate;
+	unsigned int m_ActionCount;
+	unsigned int m_ChangeCount;
+};
+
+/// A change in the value of a mapped input
+struct InputChange
+{
+	/// Simulation ticks run before the change happened
+	unsigned int m_Tick;
+	/// Index of the input event name in the recording
+	unsigned int m_Action;
+	bool m_IsFloat;
+	float m_OldValue;
+	float m_NewValue;
+};
+
+/// Changes of mapped inputs in the order they happened, stamped by simulation tick.
+/// Saved as a compact binary log, where ticks are stored as varint deltas and bool changes take a single byte for their values.
+class InputRecording
+{
+	float m_TickRate;
+	Vector<String> m_Actions;
+	HashMap<String, unsigned int> m_ActionIndices;
+	Vector<InputChange> m_Changes;
+
+public:
+	/// Returns nullptr if the file is missing or is not a recording.
+	static Ptr<InputRecording> Load(const String& path);
+
+	InputRecording(float tickRate);
+	InputRecording(InputRecording&) = delete;
+	~InputRecording() = default;
+
+	/// Changes must be added in the order of their ticks.
+	void add(unsigned int tick, const String& action, bool isFloat, float oldValue, float newValue);
+	bool save(const String& path) const;
+
+	float getTickRate() const { return m_TickRate; }
+	const String& getAction(unsigned int index) const { return m_Actions[index]; }
+	const Vector<InputChange>& getChanges() const { return m_Changes; }
+};
@@ -0,0 +1,225 @@
+#include "lz4_codec.h"
+
+static const size_t MinMatch = 4;
+/// The last bytes of a block are always literals.
+static const size_t LastLiterals = 5;
+/// A match can not start in the last bytes of a block.
+static const size_t MatchFindLimit = 12;
+static const size_t MaxOffset = 65535;
+static const int HashBits = 16;
+/// Literal runs up to this long are copied in one go, writing past their end.
+static const ptrdiff_t WildCopySize = 16;
+
+static unsigned int Read32(const unsigned char* data)
+{
+	unsigned int value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static unsigned int Hash(unsigned int sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+/// Write the remainder of a length that did not fit in its 4 bits of the token.
+static unsigned char* WriteLength(unsigned char* output, size_t length)
+{
+	while (length >= 255)
+	{
+		*output++ = 255;
+		length -= 255;
+	}
+	*output++ = (unsigned char)length;
+	return output;
+}
+
+size_t LZ4::GetCompressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t LZ4::Compress(const char* source, size_t sourceSize, char* destination, size_t capacity)
+{
+	const unsigned char* input = (const unsigned char*)source;
+	unsigned char* output = (unsigned char*)destination;
+	unsigned char* outputEnd = output + capacity;
+
+	// Positions are stored off by one so that 0 can mean empty
+	Vector<unsigned int> table(1 << HashBits, 0);
+	size_t anchor = 0;
+	size_t position = 0;
+
+	if (sourceSize >= MatchFindLimit)
+	{
+		const size_t matchLimit = sourceSize - LastLiterals;
+		const size_t searchLimit = sourceSize - MatchFindLimit;
+		while (position <= searchLimit)
+		{
+			unsigned int sequence = Read32(input + position);
+			unsigned int& entry = table[Hash(sequence)];
+			size_t candidate = entry;
+			entry = (unsigned int)position + 1;
+
+			if (candidate == 0 || position - (candidate - 1) > MaxOffset || Read32(input + candidate - 1) != sequence)
+			{
+				position++;
+				continue;
+			}
+			size_t reference = candidate - 1;
+
+			size_t matchLength = MinMatch;
+			while (position + matchLength < matchLimit && input[reference + matchLength] == input[position + matchLength])
+			{
+				matchLength++;
+			}
+
+			size_t literalLength = position - anchor;
+			if ((size_t)(outputEnd - output) < 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1)
+			{
+				return 0;
+			}
+
+			unsigned char* token = output++;
+			*token = (unsigned char)(std::min<size_t>(literalLength, 15) << 4);
+			if (literalLength >= 15)
+			{
+				output = WriteLength(output, literalLength - 15);
+			}
+			memcpy(output, input + anchor, literalLength);
+			output += literalLength;
+
+			size_t offset = position - reference;
+			*output++ = (unsigned char)(offset & 0xFF);
+			*output++ = (unsigned char)(offset >> 8);
+
+			*token |= (unsigned char)std::min<size_t>(matchLength - MinMatch, 15);
+			if (matchLength - MinMatch >= 15)
+			{
+				output = WriteLength(output, matchLength - MinMatch - 15);
+			}
+
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	size_t literalLength = sourceSize - anchor;
+	if ((size_t)(outputEnd - output) < 1 + literalLength / 255 + 1 + literalLength)
+	{
+		return 0;
+	}
+	*output++ = (unsigned char)(std::min<size_t>(literalLength, 15) << 4);
+	if (literalLength >= 15)
+	{
+		output = WriteLength(output, literalLength - 15);
+	}
+	memcpy(output, input + anchor, literalLength);
+	output += literalLength;
+
+	return output - (unsigned char*)destination;
+}
+
+bool LZ4::Decompress(const char* source, size_t sourceSize, char* destination, size_t destinationSize)
+{
+	const unsigned char* input = (const unsigned char*)source;
+	const unsigned char* inputEnd = input + sourceSize;
+	unsigned char* output = (unsigned char*)destination;
+	unsigned char* outputEnd = output + destinationSize;
+
+	while (input < inputEnd)
+	{
+		unsigned char token = *input++;
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15)
+		{
+			unsigned char extra;
+			do
+			{
+				if (input == inputEnd)
+				{
+					return false;
+				}
+				extra = *input++;
+				literalLength += extra;
+			} while (extra == 255);
+		}
+		if (literalLength > (size_t)(inputEnd - input) || literalLength > (size_t)(outputEnd - output))
+		{
+			return false;
+		}
+		// Short runs are copied with a fixed size copy when there is room to write past them
+		if (literalLength <= WildCopySize && inputEnd - input >= WildCopySize && outputEnd - output >= WildCopySize)
+		{
+			memcpy(output, input, WildCopySize);
+		}
+		else
+		{
+			memcpy(output, input, literalLength);
+		}
+		input += literalLength;
+		output += literalLength;
+
+		// The last sequence has no match
+		if (input == inputEnd)
+		{
+			break;
+		}
+
+		if (inputEnd - input < 2)
+		{
+			return false;
+		}
+		size_t offset = input[0] | (input[1] << 8);
+		input += 2;
+		if (offset == 0 || offset > (size_t)(output - (unsigned char*)destination))
+		{
+			return false;
+		}
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			unsigned char extra;
+			do
+			{
+				if (input == inputEnd)
+				{
+					return false;
+				}
+				extra = *input++;
+				matchLength += extra;
+			} while (extra == 255);
+		}
+		matchLength += MinMatch;
+		if (matchLength > (size_t)(outputEnd - output))
+		{
+			return false;
+		}
+
+		// Matches at least 8 bytes back can be copied 8 bytes at a time even when they overlap the bytes they write.
+		// Closer matches repeat a short pattern and are copied one byte at a time.
+		const unsigned char* match = output - offset;
+		unsigned char* matchEnd = output + matchLength;
+		if (offset >= 8 && (size_t)(outputEnd - output) >= matchLength + 8)
+		{
+			while (output < matchEnd)
+			{
+				memcpy(output, match, 8);
+				output += 8;
+				match += 8;
+			}
+		}
+		else
+		{
+			while (output < matchEnd)
+			{
+				*output++ = *match++;
+			}
+		}
+		output = matchEnd;
+	}
+
+	return output == outputEnd;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Compresses and decompresses data in the LZ4 block format. Decompression is fast enough to be done while loading assets.
+class LZ4
+{
+public:
+	/// Largest size that compressing size bytes can take in the worst case.
+	static size_t GetCompressBound(size_t size);
+	/// Compress source into destination. Returns the compressed size, or 0 if it did not fit in capacity.
+	static size_t Compress(const char* source, size_t sourceSize, char* destination, size_t capacity);
+	/// Decompress source into destination, which must be exactly the size of the original data. Returns false on corrupt data.
+	static bool Decompress(const char* source, size_t sourceSize, char* destination, size_t destinationSize);
+};
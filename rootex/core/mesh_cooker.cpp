@@ -0,0 +1,382 @@
+#include "mesh_cooker.h"
+
+#include "content_hash.h"
+
+#include <assimp/DefaultIOSystem.h>
+
+/// Reads values out of a cooked model, failing instead of reading past the end.
+class CookedReader
+{
+	const char* m_Data;
+	size_t m_Size;
+	size_t m_Position;
+	bool m_IsValid;
+
+public:
+	CookedReader(const char* data, size_t size)
+	    : m_Data(data)
+	    , m_Size(size)
+	    , m_Position(0)
+	    , m_IsValid(true)
+	{
+	}
+
+	const char* readBytes(size_t size)
+	{
+		if (!m_IsValid || size > m_Size - m_Position)
+		{
+			m_IsValid = false;
+			return nullptr;
+		}
+		const char* bytes = m_Data + m_Position;
+		m_Position += size;
+		return bytes;
+	}
+
+	template <class T>
+	T read()
+	{
+		T value = {};
+		if (const char* bytes = readBytes(sizeof(T)))
+		{
+			memcpy(&value, bytes, sizeof(T));
+		}
+		return value;
+	}
+
+	String readString()
+	{
+		unsigned int size = read<unsigned int>();
+		const char* bytes = readBytes(size);
+		return bytes ? String(bytes, size) : String();
+	}
+
+	void align()
+	{
+		readBytes(((m_Position + 3) & ~3) - m_Position);
+	}
+
+	bool isValid() const { return m_IsValid; }
+};
+
+/// Records the files Assimp opens besides the model it imports, like the material libraries of .obj files.
+class DependencyIOSystem : public Assimp::DefaultIOSystem
+{
+	FilePath m_SourcePath;
+	Vector<String> m_Dependencies;
+
+public:
+	DependencyIOSystem(const FilePath& sourcePath)
+	    : m_SourcePath(sourcePath.lexically_normal())
+	{
+	}
+
+	Assimp::IOStream* Open(const char* file, const char* mode) override
+	{
+		Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+		const FilePath path = FilePath(file).lexically_normal();
+		if (stream && path != m_SourcePath)
+		{
+			const String dependency = path.lexically_relative(m_SourcePath.parent_path()).generic_string();
+			if (!dependency.empty() && std::find(m_Dependencies.begin(), m_Dependencies.end(), dependency) == m_Dependencies.end())
+			{
+				m_Dependencies.push_back(dependency);
+			}
+		}
+		return stream;
+	}
+
+	const Vector<String>& getDependencies() const { return m_Dependencies; }
+};
+
+template <class T>
+static void Write(FileBuffer& cooked, const T& value)
+{
+	const char* bytes = (const char*)&value;
+	cooked.insert(cooked.end(), bytes, bytes + sizeof(T));
+}
+
+static void WriteString(FileBuffer& cooked, const String& value)
+{
+	Write<unsigned int>(cooked, value.size());
+	cooked.insert(cooked.end(), value.begin(), value.end());
+}
+
+/// Blobs are 4 byte aligned so that they can be used in place
+static void Align(FileBuffer& cooked)
+{
+	cooked.resize((cooked.size() + 3) & ~3, 0);
+}
+
+String MeshCooker::GetCookedPath(const String& sourcePath)
+{
+	return sourcePath + COOKED_MODEL_EXTENSION;
+}
+
+unsigned long long MeshCooker::GetSettingsHash()
+{
+	unsigned long long hash = ContentHash::Combine(COOKED_MODEL_VERSION, ImportFlags);
+	return ContentHash::Combine(hash, sizeof(VertexData));
+}
+
+String MeshCooker::GetDependencyPath(const String& sourcePath, const String& dependency)
+{
+	return (FilePath(sourcePath).parent_path() / dependency).generic_string();
+}
+
+unsigned long long MeshCooker::GetSourceHash(const String& sourcePath, const FileBuffer& source, const Vector<String>& dependencies)
+{
+	unsigned long long hash = ContentHash::Hash(source.data(), source.size());
+	for (const String& dependency : dependencies)
+	{
+		hash = ContentHash::Combine(hash, ContentHash::Hash(dependency.data(), dependency.size()));
+		const String dependencyPath = GetDependencyPath(sourcePath, dependency);
+		if (!OS::IsExists(dependencyPath))
+		{
+			// A deleted dependency has to change the hash even if it was empty
+			hash = ContentHash::Combine(hash, ~0ull);
+			continue;
+		}
+		FileBuffer contents = OS::LoadFileContents(dependencyPath);
+		hash = ContentHash::Combine(hash, ContentHash::Hash(contents.data(), contents.size()));
+	}
+	return hash;
+}
+
+void MeshCooker::Cook(const aiScene* scene, unsigned long long sourceHash, const Vector<String>& dependencies, FileBuffer& cooked)
+{
+	CookedModelHeader header;
+	memcpy(header.m_Magic, COOKED_MODEL_MAGIC, 4);
+	header.m_Version = COOKED_MODEL_VERSION;
+	header.m_SourceHash = sourceHash;
+	header.m_SettingsHash = GetSettingsHash();
+	header.m_MeshCount = scene->mNumMeshes;
+	header.m_TextureCount = scene->mNumTextures;
+	header.m_DependencyCount = dependencies.size();
+	cooked.clear();
+	Write(cooked, header);
+
+	for (const String& dependency : dependencies)
+	{
+		WriteString(cooked, dependency);
+	}
+	Align(cooked);
+
+	for (unsigned int i = 0; i < scene->mNumTextures; i++)
+	{
+		const aiTexture* texture = scene->mTextures[i];
+		// A height of 0 means the texture is a whole image file, with its size in bytes as the width
+		if (texture->mHeight != 0)
+		{
+			WARN("Skipping uncompressed embedded texture " + std::to_string(i));
+			Write<unsigned int>(cooked, 0);
+			continue;
+		}
+		Write<unsigned int>(cooked, texture->mWidth);
+		cooked.insert(cooked.end(), (const char*)texture->pcData, (const char*)texture->pcData + texture->mWidth);
+		Align(cooked);
+	}
+
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	{
+		const aiMesh* mesh = scene->mMeshes[i];
+
+		Vector<VertexData> vertices(mesh->mNumVertices);
+		ZeroMemory(vertices.data(), vertices.size() * sizeof(VertexData));
+		Vector3 boundsMin(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector3 boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++)
+		{
+			VertexData& vertex = vertices[v];
+			vertex.m_Position = { mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z };
+			boundsMin = Vector3::Min(boundsMin, vertex.m_Position);
+			boundsMax = Vector3::Max(boundsMax, vertex.m_Position);
+
+			if (mesh->mNormals)
+			{
+				vertex.m_Normal = { mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z };
+			}
+			// Only the first set of texture coordinates is used
+			if (mesh->mTextureCoords[0])
+			{
+				vertex.m_TextureCoord = { mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y };
+			}
+		}
+		if (mesh->mNumVertices == 0)
+		{
+			boundsMin = boundsMax = Vector3::Zero;
+		}
+
+		// 16 bit indices are enough for most meshes and take half the memory
+		unsigned int indexSize = mesh->mNumVertices > USHRT_MAX ? 4 : 2;
+		unsigned int indexCount = mesh->mNumFaces * 3;
+
+		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		aiColor3D color(0.0f, 0.0f, 0.0f);
+		if (AI_SUCCESS != material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+		{
+			WARN("Material does not have color: " + String(material->GetName().C_Str()));
+		}
+
+		Write<unsigned int>(cooked, mesh->mNumVertices);
+		Write<unsigned int>(cooked, indexCount);
+		Write<unsigned int>(cooked, indexSize);
+		Write(cooked, boundsMin);
+		Write(cooked, boundsMax);
+		WriteString(cooked, material->GetName().C_Str());
+		Write(cooked, Color(color.r, color.g, color.b, 1.0f));
+
+		unsigned int textureCount = material->GetTextureCount(aiTextureType_DIFFUSE);
+		Write<unsigned int>(cooked, textureCount);
+		for (unsigned int t = 0; t < textureCount; t++)
+		{
+			aiString path;
+			material->GetTexture(aiTextureType_DIFFUSE, t, &path);
+			// Embedded textures are referred to as * followed by their index
+			bool isEmbedded = path.C_Str()[0] == '*';
+			Write<int>(cooked, isEmbedded ? atoi(path.C_Str() + 1) : -1);
+			WriteString(cooked, isEmbedded ? "" : path.C_Str());
+		}
+
+		Align(cooked);
+		const char* vertexBytes = (const char*)vertices.data();
+		cooked.insert(cooked.end(), vertexBytes, vertexBytes + vertices.size() * sizeof(VertexData));
+
+		// Faces are already triangles because of aiProcess_Triangulate
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int index = mesh->mFaces[f].mIndices[k];
+				if (indexSize == 2)
+				{
+					Write<unsigned short>(cooked, index);
+				}
+				else
+				{
+					Write<unsigned int>(cooked, index);
+				}
+			}
+		}
+		Align(cooked);
+	}
+}
+
+bool MeshCooker::Read(const char* data, size_t size, CookedModel& model)
+{
+	CookedReader reader(data, size);
+	CookedModelHeader header = reader.read<CookedModelHeader>();
+	if (!reader.isValid() || strncmp(header.m_Magic, COOKED_MODEL_MAGIC, 4) != 0 || header.m_Version != COOKED_MODEL_VERSION || header.m_SettingsHash != GetSettingsHash())
+	{
+		return false;
+	}
+
+	model.m_SourceHash = header.m_SourceHash;
+	model.m_Dependencies.clear();
+	for (unsigned int i = 0; i < header.m_DependencyCount && reader.isValid(); i++)
+	{
+		model.m_Dependencies.push_back(reader.readString());
+	}
+	reader.align();
+
+	model.m_EmbeddedTextures.clear();
+	for (unsigned int i = 0; i < header.m_TextureCount; i++)
+	{
+		CookedTexture texture;
+		texture.m_Size = reader.read<unsigned int>();
+		texture.m_Data = reader.readBytes(texture.m_Size);
+		reader.align();
+		model.m_EmbeddedTextures.push_back(texture);
+	}
+
+	model.m_Meshes.clear();
+	for (unsigned int i = 0; i < header.m_MeshCount && reader.isValid(); i++)
+	{
+		CookedMesh mesh;
+		mesh.m_VertexCount = reader.read<unsigned int>();
+		mesh.m_IndexCount = reader.read<unsigned int>();
+		mesh.m_IndexSize = reader.read<unsigned int>();
+		Vector3 boundsMin = reader.read<Vector3>();
+		Vector3 boundsMax = reader.read<Vector3>();
+		DirectX::BoundingBox::CreateFromPoints(mesh.m_Bounds, boundsMin, boundsMax);
+
+		mesh.m_Material.m_Name = reader.readString();
+		mesh.m_Material.m_Color = reader.read<Color>();
+		unsigned int textureCount = reader.read<unsigned int>();
+		for (unsigned int t = 0; t < textureCount && reader.isValid(); t++)
+		{
+			CookedMaterial::TextureRef texture;
+			texture.m_EmbeddedIndex = reader.read<int>();
+			texture.m_Path = reader.readString();
+			if (texture.m_EmbeddedIndex >= (int)header.m_TextureCount)
+			{
+				return false;
+			}
+			mesh.m_Material.m_DiffuseTextures.push_back(texture);
+		}
+
+		if (mesh.m_IndexSize != 2 && mesh.m_IndexSize != 4)
+		{
+			return false;
+		}
+		reader.align();
+		mesh.m_Vertices = (const VertexData*)reader.readBytes((size_t)mesh.m_VertexCount * sizeof(VertexData));
+		mesh.m_Indices = reader.readBytes((size_t)mesh.m_IndexCount * mesh.m_IndexSize);
+		reader.align();
+		model.m_Meshes.push_back(mesh);
+	}
+
+	return reader.isValid();
+}
+
+MeshCooker::CookResult MeshCooker::CookFile(Assimp::Importer& importer, const String& sourcePath)
+{
+	FileBuffer source = OS::LoadFileContents(sourcePath);
+	const String cookedPath = GetCookedPath(sourcePath);
+
+	if (OS::IsExists(cookedPath))
+	{
+		// Dependencies are only found by importing, so the ones found when the model was last cooked are hashed
+		FileBuffer cooked = OS::LoadFileContents(cookedPath);
+		CookedModel model;
+		if (Read(cooked.data(), cooked.size(), model) && model.m_SourceHash == GetSourceHash(sourcePath, source, model.m_Dependencies))
+		{
+			// The engine trusts cooked files that are newer than their source and dependencies, which may have only been touched
+			FileTimePoint lastChangedTime = OS::GetFileLastChangedTime(sourcePath);
+			for (const String& dependency : model.m_Dependencies)
+			{
+				lastChangedTime = std::max(lastChangedTime, OS::GetFileLastChangedTime(GetDependencyPath(sourcePath, dependency)));
+			}
+			if (OS::GetFileLastChangedTime(cookedPath) < lastChangedTime)
+			{
+				std::filesystem::last_write_time(OS::GetAbsolutePath(cookedPath), lastChangedTime);
+			}
+			return CookResult::UpToDate;
+		}
+	}
+
+	// The importer only uses the dependency recorder for this model, and does not take ownership of it
+	DependencyIOSystem ioSystem(OS::GetAbsolutePath(sourcePath));
+	importer.SetIOHandler(&ioSystem);
+	const aiScene* scene = importer.ReadFile(OS::GetAbsolutePath(sourcePath).generic_string(), ImportFlags);
+	importer.SetIOHandler(nullptr);
+	if (!scene)
+	{
+		ERR("Model could not be cooked: " + sourcePath);
+		ERR("Assimp: " + String(importer.GetErrorString()));
+		return CookResult::Failed;
+	}
+
+	FileBuffer cooked;
+	Cook(scene, GetSourceHash(sourcePath, source, ioSystem.getDependencies()), ioSystem.getDependencies(), cooked);
+	importer.FreeScene();
+
+	std::ofstream cookedFile(OS::GetAbsolutePath(cookedPath), std::ios::binary);
+	cookedFile.write(cooked.data(), cooked.size());
+	if (!cookedFile)
+	{
+		ERR("Could not write cooked model: " + cookedPath);
+		return CookResult::Failed;
+	}
+	return CookResult::Cooked;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "common/common.h"
+#include "core/renderer/vertex_data.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+/// Identifies a cooked model file
+#define COOKED_MODEL_MAGIC "RMDL"
+/// Bump when the cooked format or the way models are cooked changes, so that old cooked files get rebuilt
+#define COOKED_MODEL_VERSION 2
+/// Cooked models are written next to their source, with this appended to the source file name
+#define COOKED_MODEL_EXTENSION ".rmodel"
+
+/// Starts a cooked model. Followed by the paths of its dependencies, the embedded textures, then the meshes.
+struct CookedModelHeader
+{
+	char m_Magic[4];
+	unsigned int m_Version;
+	/// Content hash of the source model file and its dependencies
+	unsigned long long m_SourceHash;
+	/// Hash of the import settings and cooked format
+	unsigned long long m_SettingsHash;
+	unsigned int m_MeshCount;
+	unsigned int m_TextureCount;
+	unsigned int m_DependencyCount;
+};
+
+/// Material a cooked mesh is drawn with. Only used to create the material if the material library does not have it yet.
+struct CookedMaterial
+{
+	struct TextureRef
+	{
+		/// Index into the embedded textures of the model, or -1 if the texture is a file
+		int m_EmbeddedIndex;
+		/// Path of the texture file relative to the model
+		String m_Path;
+	};
+
+	String m_Name;
+	Color m_Color;
+	Vector<TextureRef> m_DiffuseTextures;
+};
+
+/// A mesh inside a cooked model. Vertex and index data point into the cooked file, ready to be uploaded as they are.
+struct CookedMesh
+{
+	const VertexData* m_Vertices;
+	unsigned int m_VertexCount;
+	const char* m_Indices;
+	unsigned int m_IndexCount;
+	/// 2 for 16 bit indices, 4 for 32 bit indices
+	unsigned int m_IndexSize;
+	DirectX::BoundingBox m_Bounds;
+	CookedMaterial m_Material;
+};
+
+/// Image file embedded in a model, pointing into the cooked file.
+struct CookedTexture
+{
+	const char* m_Data;
+	unsigned int m_Size;
+};
+
+/// Views into a cooked model file.
+struct CookedModel
+{
+	unsigned long long m_SourceHash;
+	/// Other files the model was imported from, like the material libraries of .obj files, relative to the model
+	Vector<String> m_Dependencies;
+	Vector<CookedTexture> m_EmbeddedTextures;
+	Vector<CookedMesh> m_Meshes;
+};
+
+/// Converts models into a runtime format that loads without Assimp: interleaved vertex blobs, index blobs, bounds and material references.
+/// Cooked models are keyed by a content hash of their source and the import settings, so that only changed models get cooked again.
+class MeshCooker
+{
+public:
+	/// Assimp post processing applied to every model, cooked or not
+	static const unsigned int ImportFlags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes;
+
+	enum class CookResult
+	{
+		Cooked,
+		UpToDate,
+		Failed
+	};
+
+	static String GetCookedPath(const String& sourcePath);
+	static unsigned long long GetSettingsHash();
+	/// Path of a dependency of a model, from the path of the model and the dependency path stored in its cooked model.
+	static String GetDependencyPath(const String& sourcePath, const String& dependency);
+	/// Hash a model file together with the contents of its dependencies.
+	static unsigned long long GetSourceHash(const String& sourcePath, const FileBuffer& source, const Vector<String>& dependencies);
+
+	/// Serialize an imported scene into the cooked format.
+	static void Cook(const aiScene* scene, unsigned long long sourceHash, const Vector<String>& dependencies, FileBuffer& cooked);
+	/// Read a cooked model. Returns false if the data is not a cooked model or was cooked with other settings.
+	static bool Read(const char* data, size_t size, CookedModel& model);
+
+	/// Cook a model file on disk unless its cooked file is up to date with its contents and the import settings.
+	static CookResult CookFile(Assimp::Importer& importer, const String& sourcePath);
+};
@@ -0,0 +1,309 @@
+#include "pak_archive.h"
+
+#include "lz4_codec.h"
+#include "resource_data.h"
+#include "os/memory_mapped_file.h"
+
+/// Reads an entry out of memory, keeping the memory alive for as long as the stream is.
+class PakEntryStream : public std::istream
+{
+	class Buffer : public std::streambuf
+	{
+	public:
+		void set(const char* data, size_t size)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+		{
+			char* base = direction == std::ios_base::beg ? eback() : (direction == std::ios_base::cur ? gptr() : egptr());
+			char* target = base + offset;
+			if (target < eback() || target > egptr())
+			{
+				return pos_type(off_type(-1));
+			}
+			setg(eback(), target, egptr());
+			return pos_type(target - eback());
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+	};
+
+	Ref<MemoryMappedFile> m_MappedFile;
+	FileBuffer m_Data;
+	Buffer m_Buffer;
+
+public:
+	PakEntryStream(Ref<MemoryMappedFile> mappedFile, const char* data, size_t size)
+	    : std::istream(nullptr)
+	    , m_MappedFile(mappedFile)
+	{
+		m_Buffer.set(data, size);
+		rdbuf(&m_Buffer);
+	}
+
+	PakEntryStream(FileBuffer&& data)
+	    : std::istream(nullptr)
+	    , m_Data(std::move(data))
+	{
+		m_Buffer.set(m_Data.data(), m_Data.size());
+		rdbuf(&m_Buffer);
+	}
+};
+
+static unsigned long long AlignUp(unsigned long long value)
+{
+	return (value + PAK_ALIGNMENT - 1) / PAK_ALIGNMENT * PAK_ALIGNMENT;
+}
+
+String PakArchive::NormalizePath(const String& path)
+{
+	return FilePath(path).lexically_normal().generic_string();
+}
+
+unsigned long long PakArchive::HashPath(const String& normalizedPath)
+{
+	// 64 bit FNV-1a
+	unsigned long long hash = 14695981039346656037ull;
+	for (char c : normalizedPath)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+Ptr<PakArchive> PakArchive::Open(const String& path)
+{
+	Ref<MemoryMappedFile> mappedFile = OS::MapFileContents(path);
+	if (!mappedFile)
+	{
+		return nullptr;
+	}
+
+	const char* data = mappedFile->getData();
+	size_t size = mappedFile->getSize();
+	if (size < sizeof(PakHeader))
+	{
+		ERR("Archive is too small to be a pak file: " + path);
+		return nullptr;
+	}
+
+	const PakHeader* header = (const PakHeader*)data;
+	if (strncmp(header->m_Magic, PAK_MAGIC, 4) != 0 || header->m_Version != PAK_VERSION)
+	{
+		ERR("Not a version " + std::to_string(PAK_VERSION) + " pak file: " + path);
+		return nullptr;
+	}
+
+	// Bounds are checked as offset > size - length, so that a corrupt offset can not wrap around
+	unsigned long long entriesEnd = sizeof(PakHeader) + (unsigned long long)header->m_EntryCount * sizeof(PakEntry);
+	if (entriesEnd > size || header->m_PathsOffset < entriesEnd || header->m_PathsSize > size || header->m_PathsOffset > size - header->m_PathsSize)
+	{
+		ERR("Pak file table of contents is corrupt: " + path);
+		return nullptr;
+	}
+
+	const PakEntry* entries = (const PakEntry*)(data + sizeof(PakHeader));
+	for (unsigned int i = 0; i < header->m_EntryCount; i++)
+	{
+		const PakEntry& entry = entries[i];
+		if (entry.m_StoredSize > size || entry.m_Offset > size - entry.m_StoredSize || (unsigned long long)entry.m_PathOffset + entry.m_PathSize > header->m_PathsSize)
+		{
+			ERR("Pak file entry " + std::to_string(i) + " is out of bounds: " + path);
+			return nullptr;
+		}
+		// Uncompressed entries are read m_Size bytes at a time straight out of the mapping. LZ4 can not shrink data by more than 255 times.
+		bool isSizeValid = false;
+		switch (entry.m_Compression)
+		{
+		case PakEntry::Compression::None:
+			isSizeValid = entry.m_Size == entry.m_StoredSize;
+			break;
+		case PakEntry::Compression::LZ4:
+			isSizeValid = entry.m_Size / 255 <= entry.m_StoredSize;
+			break;
+		default:
+			ERR("Pak file entry " + std::to_string(i) + " has an unknown compression: " + path);
+			return nullptr;
+		}
+		if (!isSizeValid)
+		{
+			ERR("Pak file entry " + std::to_string(i) + " has a size that does not match its stored size: " + path);
+			return nullptr;
+		}
+	}
+
+	Ptr<PakArchive> archive(new PakArchive());
+	archive->m_MappedFile = mappedFile;
+	archive->m_Path = path;
+	archive->m_LastChangedTime = OS::GetFileLastChangedTime(path);
+	archive->m_Header = header;
+	archive->m_Entries = entries;
+	archive->m_Paths = data + header->m_PathsOffset;
+	return archive;
+}
+
+const PakEntry* PakArchive::find(const String& path) const
+{
+	String normalizedPath = NormalizePath(path);
+	unsigned long long hash = HashPath(normalizedPath);
+
+	const PakEntry* end = m_Entries + m_Header->m_EntryCount;
+	const PakEntry* entry = std::lower_bound(m_Entries, end, hash, [](const PakEntry& entry, unsigned long long hash) {
+		return entry.m_PathHash < hash;
+	});
+	for (; entry != end && entry->m_PathHash == hash; entry++)
+	{
+		if (normalizedPath.compare(0, String::npos, m_Paths + entry->m_PathOffset, entry->m_PathSize) == 0)
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+void PakArchive::load(const PakEntry* entry, ResourceData* resData) const
+{
+	if (entry->m_Compression == PakEntry::Compression::None)
+	{
+		resData->setData(m_MappedFile, entry->m_Offset, entry->m_Size);
+		return;
+	}
+	resData->setData(load(entry));
+}
+
+FileBuffer PakArchive::load(const PakEntry* entry) const
+{
+	const char* storedData = m_MappedFile->getData() + entry->m_Offset;
+	if (entry->m_Compression == PakEntry::Compression::None)
+	{
+		return FileBuffer(storedData, storedData + entry->m_Size);
+	}
+
+	FileBuffer buffer(entry->m_Size);
+	if (!LZ4::Decompress(storedData, entry->m_StoredSize, buffer.data(), buffer.size()))
+	{
+		ERR("Could not decompress " + getEntryPath(entry) + " from " + m_Path.generic_string());
+		return FileBuffer();
+	}
+	return buffer;
+}
+
+Ptr<std::istream> PakArchive::openStream(const PakEntry* entry) const
+{
+	if (entry->m_Compression == PakEntry::Compression::None)
+	{
+		return Ptr<std::istream>(new PakEntryStream(m_MappedFile, m_MappedFile->getData() + entry->m_Offset, entry->m_Size));
+	}
+	return Ptr<std::istream>(new PakEntryStream(load(entry)));
+}
+
+void PakWriter::add(const String& path, const FilePath& filePath, bool isCompressed)
+{
+	m_Files.push_back({ PakArchive::NormalizePath(path), filePath, isCompressed });
+}
+
+bool PakWriter::write(const FilePath& outputPath)
+{
+	std::sort(m_Files.begin(), m_Files.end(), [](const File& a, const File& b) {
+		unsigned long long hashA = PakArchive::HashPath(a.m_Path);
+		unsigned long long hashB = PakArchive::HashPath(b.m_Path);
+		return hashA != hashB ? hashA < hashB : a.m_Path < b.m_Path;
+	});
+	auto duplicates = std::unique(m_Files.begin(), m_Files.end(), [](const File& a, const File& b) {
+		return a.m_Path == b.m_Path;
+	});
+	if (duplicates != m_Files.end())
+	{
+		WARN("Skipping files added more than once to " + outputPath.generic_string());
+		m_Files.erase(duplicates, m_Files.end());
+	}
+
+	Vector<PakEntry> entries(m_Files.size());
+	String paths;
+	for (int i = 0; i < m_Files.size(); i++)
+	{
+		entries[i] = {};
+		entries[i].m_PathHash = PakArchive::HashPath(m_Files[i].m_Path);
+		entries[i].m_PathOffset = paths.size();
+		entries[i].m_PathSize = m_Files[i].m_Path.size();
+		paths += m_Files[i].m_Path;
+	}
+
+	PakHeader header;
+	memcpy(header.m_Magic, PAK_MAGIC, 4);
+	header.m_Version = PAK_VERSION;
+	header.m_EntryCount = entries.size();
+	header.m_Reserved = 0;
+	header.m_PathsOffset = sizeof(PakHeader) + entries.size() * sizeof(PakEntry);
+	header.m_PathsSize = paths.size();
+
+	std::ofstream output(outputPath, std::ios::binary);
+	if (!output)
+	{
+		ERR("Could not open archive for writing: " + outputPath.generic_string());
+		return false;
+	}
+
+	unsigned long long offset = AlignUp(header.m_PathsOffset + header.m_PathsSize);
+	unsigned long long totalSize = 0;
+	unsigned long long totalStoredSize = 0;
+	const char padding[PAK_ALIGNMENT] = {};
+	for (int i = 0; i < m_Files.size(); i++)
+	{
+		FileBuffer data = OS::LoadFileContents(m_Files[i].m_FilePath.generic_string());
+		PakEntry& entry = entries[i];
+		entry.m_Offset = offset;
+		entry.m_Size = data.size();
+		entry.m_StoredSize = data.size();
+		entry.m_Compression = PakEntry::Compression::None;
+
+		FileBuffer compressed;
+		if (m_Files[i].m_IsCompressed && !data.empty())
+		{
+			compressed.resize(LZ4::GetCompressBound(data.size()));
+			size_t compressedSize = LZ4::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+			// Barely compressed entries are not worth losing zero copy loading over
+			if (compressedSize > 0 && compressedSize < data.size() - data.size() / 8)
+			{
+				compressed.resize(compressedSize);
+				entry.m_StoredSize = compressedSize;
+				entry.m_Compression = PakEntry::Compression::LZ4;
+			}
+		}
+		const FileBuffer& stored = entry.m_Compression == PakEntry::Compression::None ? data : compressed;
+
+		output.seekp(offset);
+		output.write(stored.data(), stored.size());
+		offset = AlignUp(offset + stored.size());
+		totalSize += entry.m_Size;
+		totalStoredSize += entry.m_StoredSize;
+	}
+	// Pad the last entry too, so that every entry can be mapped in whole pages
+	if (offset > output.tellp())
+	{
+		output.write(padding, offset - output.tellp());
+	}
+
+	output.seekp(0);
+	output.write((const char*)&header, sizeof(header));
+	output.write((const char*)entries.data(), entries.size() * sizeof(PakEntry));
+	output.write(paths.data(), paths.size());
+
+	if (!output)
+	{
+		ERR("Could not write archive: " + outputPath.generic_string());
+		return false;
+	}
+
+	PRINT("Packed " + std::to_string(entries.size()) + " files into " + outputPath.generic_string() + ": "
+	    + std::to_string(totalSize * B_TO_KB) + " KB stored as " + std::to_string(totalStoredSize * B_TO_KB) + " KB");
+	return true;
+}
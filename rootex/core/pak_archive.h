@@ -0,0 +1,109 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/os.h"
+
+#include <istream>
+
+class MemoryMappedFile;
+class ResourceData;
+
+/// Identifies a Rootex pak archive
+#define PAK_MAGIC "RPAK"
+#define PAK_VERSION 1
+/// Entry data is aligned to pages so that uncompressed entries can be read straight out of the mapped archive
+#define PAK_ALIGNMENT 4096
+
+/// Starts a .pak file. Followed by the table of contents, then the entry paths, then the page aligned entry data.
+struct PakHeader
+{
+	char m_Magic[4];
+	unsigned int m_Version;
+	unsigned int m_EntryCount;
+	unsigned int m_Reserved;
+	unsigned long long m_PathsOffset;
+	unsigned long long m_PathsSize;
+};
+
+/// A file inside a .pak file. Entries are sorted by path hash, then by path, so that they can be binary searched.
+struct PakEntry
+{
+	enum class Compression : unsigned int
+	{
+		None = 0,
+		LZ4 = 1
+	};
+
+	unsigned long long m_PathHash;
+	unsigned long long m_Offset;
+	unsigned long long m_StoredSize;
+	unsigned long long m_Size;
+	unsigned int m_PathOffset;
+	unsigned int m_PathSize;
+	Compression m_Compression;
+	unsigned int m_Reserved;
+};
+
+/// Read-only archive of many files packed into one memory mapped .pak file.
+/// Finding a file is a binary search over the table of contents, instead of a filesystem lookup.
+class PakArchive
+{
+	Ref<MemoryMappedFile> m_MappedFile;
+	FilePath m_Path;
+	FileTimePoint m_LastChangedTime;
+	const PakHeader* m_Header;
+	const PakEntry* m_Entries;
+	const char* m_Paths;
+
+	PakArchive() = default;
+
+public:
+	/// Path of a file as it is stored in archives, relative to Rootex root with forward slashes.
+	static String NormalizePath(const String& path);
+	static unsigned long long HashPath(const String& normalizedPath);
+
+	/// Map a .pak file and check its table of contents. Returns nullptr if it is not a valid archive.
+	static Ptr<PakArchive> Open(const String& path);
+
+	PakArchive(PakArchive&) = delete;
+	~PakArchive() = default;
+
+	/// Returns nullptr if the archive does not have the file.
+	const PakEntry* find(const String& path) const;
+	/// Point the data of a resource to the entry. Uncompressed entries are not copied.
+	void load(const PakEntry* entry, ResourceData* resData) const;
+	/// Copy or decompress the data of an entry.
+	FileBuffer load(const PakEntry* entry) const;
+	/// Stream the data of an entry. Uncompressed entries are read straight from the mapping.
+	Ptr<std::istream> openStream(const PakEntry* entry) const;
+
+	int getEntryCount() const { return m_Header->m_EntryCount; }
+	const PakEntry* getEntry(int index) const { return &m_Entries[index]; }
+	String getEntryPath(const PakEntry* entry) const { return String(m_Paths + entry->m_PathOffset, entry->m_PathSize); }
+	const FilePath& getPath() const { return m_Path; }
+	/// Archives are never modified in place, so all entries share the change time of the archive.
+	const FileTimePoint& getLastChangedTime() const { return m_LastChangedTime; }
+};
+
+/// Builds .pak files out of loose files.
+class PakWriter
+{
+	struct File
+	{
+		String m_Path;
+		FilePath m_FilePath;
+		bool m_IsCompressed;
+	};
+
+	Vector<File> m_Files;
+
+public:
+	PakWriter() = default;
+	PakWriter(PakWriter&) = delete;
+	~PakWriter() = default;
+
+	/// Add a file on disk to the archive under a path. Compressed files are stored uncompressed if compressing does not save space.
+	void add(const String& path, const FilePath& filePath, bool isCompressed);
+	/// Write all added files into a .pak file at an absolute path.
+	bool write(const FilePath& outputPath);
+};
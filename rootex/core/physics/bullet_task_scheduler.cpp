@@ -0,0 +1,104 @@
+#include "bullet_task_scheduler.h"
+
+// Defined in btThreads.cpp but not exposed in its header. Lets btThreadsAreRunning() detect nested parallel loops.
+void btPushThreadsAreRunning();
+void btPopThreadsAreRunning();
+
+void BulletRangeTask::execute()
+{
+	if (m_ForBody)
+	{
+		m_ForBody->forLoop(m_Begin, m_End);
+	}
+	else
+	{
+		m_Sum = m_SumBody->sumLoop(m_Begin, m_End);
+	}
+}
+
+BulletTaskScheduler::BulletTaskScheduler(ThreadPool& threadPool)
+    : btITaskScheduler("Rootex")
+    , m_ThreadPool(threadPool)
+{
+	if (m_ThreadPool.getThreadCount() + 1 > (int)BT_MAX_THREAD_COUNT)
+	{
+		WARN("Thread pool has more threads than Bullet supports (" + std::to_string(BT_MAX_THREAD_COUNT - 1) + "). Physics loops will run on the main thread");
+	}
+	setNumThreads(getMaxNumThreads());
+}
+
+int BulletTaskScheduler::getMaxNumThreads() const
+{
+	// Any pool thread may pick up a slice, and Bullet hands out colliding thread indices past its maximum
+	if (m_ThreadPool.getThreadCount() + 1 > (int)BT_MAX_THREAD_COUNT)
+	{
+		return 1;
+	}
+	return m_ThreadPool.getThreadCount() + 1;
+}
+
+void BulletTaskScheduler::setNumThreads(int numThreads)
+{
+	m_ThreadCount = std::max(1, std::min(numThreads, getMaxNumThreads()));
+
+	m_RangeTasks.clear();
+	for (int i = 0; i < m_ThreadCount - 1; i++)
+	{
+		m_RangeTasks.push_back(std::make_shared<BulletRangeTask>());
+	}
+	m_Batch.reserve(m_RangeTasks.size());
+}
+
+bool BulletTaskScheduler::dispatch(int iBegin, int iEnd, int grainSize, const btIParallelForBody* forBody, const btIParallelSumBody* sumBody)
+{
+	const int count = iEnd - iBegin;
+	// Nested loops would block a worker on the pool it is running on
+	if (m_RangeTasks.empty() || count <= grainSize || btThreadsAreRunning())
+	{
+		return false;
+	}
+
+	// The main thread only waits, so one task per remaining Bullet thread
+	const int workers = std::min((int)m_RangeTasks.size(), std::min(getNumThreads(), (int)BT_MAX_THREAD_COUNT) - 1);
+	const int sliceSize = std::max(std::max(grainSize, 1), (count + workers - 1) / workers);
+
+	m_Batch.clear();
+	for (int begin = iBegin; begin < iEnd && (int)m_Batch.size() < workers; begin += sliceSize)
+	{
+		BulletRangeTask* task = m_RangeTasks[m_Batch.size()].get();
+		task->m_ForBody = forBody;
+		task->m_SumBody = sumBody;
+		task->m_Begin = begin;
+		task->m_End = (int)m_Batch.size() + 1 == workers ? iEnd : std::min(begin + sliceSize, iEnd);
+		task->m_Sum = 0;
+		m_Batch.push_back(m_RangeTasks[m_Batch.size()]);
+	}
+
+	btPushThreadsAreRunning();
+	m_ThreadPool.submit(m_Batch);
+	btPopThreadsAreRunning();
+	return true;
+}
+
+void BulletTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+{
+	if (!dispatch(iBegin, iEnd, grainSize, &body, nullptr))
+	{
+		body.forLoop(iBegin, iEnd);
+	}
+}
+
+btScalar BulletTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body)
+{
+	if (!dispatch(iBegin, iEnd, grainSize, nullptr, &body))
+	{
+		return body.sumLoop(iBegin, iEnd);
+	}
+
+	btScalar sum = 0;
+	for (auto& task : m_Batch)
+	{
+		sum += ((BulletRangeTask*)task.get())->m_Sum;
+	}
+	return sum;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/thread.h"
+#include "Bullet3D/src/LinearMath/btThreads.h"
+
+/// Runs a slice of a Bullet parallel loop on a worker thread.
+class BulletRangeTask : public Task
+{
+public:
+	const btIParallelForBody* m_ForBody = nullptr;
+	const btIParallelSumBody* m_SumBody = nullptr;
+	int m_Begin = 0;
+	int m_End = 0;
+	btScalar m_Sum = 0;
+
+	void execute() override;
+};
+
+/// Bullet task scheduler that dispatches the parallel loops of the multithreaded dynamics world to the engine ThreadPool.
+class BulletTaskScheduler : public btITaskScheduler
+{
+	ThreadPool& m_ThreadPool;
+	/// Number of threads that loops are split over, including the waiting main thread.
+	int m_ThreadCount;
+	/// One task per worker thread, reused by every loop.
+	Vector<Ref<BulletRangeTask>> m_RangeTasks;
+	Vector<Ref<Task>> m_Batch;
+
+	/// Split the range into grain sized slices over at most getNumThreads() - 1 worker threads and run them. Returns false if the loop should run inline.
+	bool dispatch(int iBegin, int iEnd, int grainSize, const btIParallelForBody* forBody, const btIParallelSumBody* sumBody);
+
+public:
+	BulletTaskScheduler(ThreadPool& threadPool);
+	BulletTaskScheduler(BulletTaskScheduler&) = delete;
+	~BulletTaskScheduler() = default;
+
+	/// Worker threads and the main thread, which Bullet always indexes as thread 0. Only the main thread if the pool has more workers than Bullet has thread indices for.
+	int getMaxNumThreads() const override;
+	/// Bullet sizes its per-thread data with this. Any pool thread may pick up a slice, so this is always the maximum.
+	int getNumThreads() const override { return getMaxNumThreads(); }
+	/// Limit the number of slices loops are split into.
+	void setNumThreads(int numThreads) override;
+	int getParallelism() const { return m_ThreadCount; }
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+};
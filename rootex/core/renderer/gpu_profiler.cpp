@@ -0,0 +1,143 @@
+#include "gpu_profiler.h"
+
+#include "rendering_device.h"
+
+GPUProfiler* GPUProfiler::GetSingleton()
+{
+	static GPUProfiler singleton;
+	return &singleton;
+}
+
+GPUProfiler::GPUProfiler()
+    : m_FrameIndex(0)
+    , m_IsEnabled(true)
+    , m_IsFrameOpen(false)
+    , m_Thread(nullptr)
+{
+	for (auto& frame : m_Frames)
+	{
+		frame.m_CPUBegin = 0;
+		frame.m_ScopeCount = 0;
+		frame.m_IsPending = false;
+	}
+}
+
+bool GPUProfiler::resolve(Frame& frame)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	if (!RenderingDevice::GetSingleton()->getQueryData(frame.m_Disjoint.Get(), &disjoint, sizeof(disjoint)))
+	{
+		return false;
+	}
+	frame.m_IsPending = false;
+	if (disjoint.Disjoint)
+	{
+		// The GPU clock changed frequency during the frame, so its timestamps can not be compared
+		return true;
+	}
+
+	UINT64 frameBegin = 0;
+	if (!RenderingDevice::GetSingleton()->getQueryData(frame.m_Begin.Get(), &frameBegin, sizeof(frameBegin)))
+	{
+		return true;
+	}
+	const double nanosecondsPerTick = 1e9 / disjoint.Frequency;
+	for (unsigned int i = 0; i < frame.m_ScopeCount; i++)
+	{
+		Scope& scope = frame.m_Scopes[i];
+		UINT64 begin = 0;
+		UINT64 end = 0;
+		if (RenderingDevice::GetSingleton()->getQueryData(scope.m_Begin.Get(), &begin, sizeof(begin))
+		    && RenderingDevice::GetSingleton()->getQueryData(scope.m_End.Get(), &end, sizeof(end)))
+		{
+			Profiler::GetSingleton()->record(
+			    m_Thread,
+			    scope.m_Name,
+			    frame.m_CPUBegin + (long long)((begin - frameBegin) * nanosecondsPerTick),
+			    frame.m_CPUBegin + (long long)((end - frameBegin) * nanosecondsPerTick));
+		}
+	}
+	return true;
+}
+
+void GPUProfiler::beginFrame()
+{
+	m_IsFrameOpen = m_IsEnabled && Profiler::IsCapturing();
+	if (!m_IsFrameOpen)
+	{
+		return;
+	}
+
+	if (!m_Thread)
+	{
+		m_Thread = Profiler::GetSingleton()->addThread("GPU");
+	}
+
+	Frame& frame = m_Frames[m_FrameIndex];
+	if (frame.m_IsPending)
+	{
+		// The GPU is GPU_PROFILER_FRAME_LATENCY frames behind, so the timings of this frame are dropped if they are not ready yet
+		resolve(frame);
+		frame.m_IsPending = false;
+	}
+	if (!frame.m_Disjoint)
+	{
+		frame.m_Disjoint = RenderingDevice::GetSingleton()->createQuery(D3D11_QUERY_TIMESTAMP_DISJOINT);
+		frame.m_Begin = RenderingDevice::GetSingleton()->createQuery(D3D11_QUERY_TIMESTAMP);
+		frame.m_Scopes.resize(GPU_PROFILER_MAX_SCOPES);
+	}
+
+	frame.m_ScopeCount = 0;
+	frame.m_CPUBegin = Profiler::Now();
+	RenderingDevice::GetSingleton()->beginQuery(frame.m_Disjoint.Get());
+	RenderingDevice::GetSingleton()->endQuery(frame.m_Begin.Get());
+}
+
+void GPUProfiler::endFrame()
+{
+	if (m_IsFrameOpen)
+	{
+		Frame& frame = m_Frames[m_FrameIndex];
+		RenderingDevice::GetSingleton()->endQuery(frame.m_Disjoint.Get());
+		frame.m_IsPending = true;
+		m_FrameIndex = (m_FrameIndex + 1) % GPU_PROFILER_FRAME_LATENCY;
+		m_IsFrameOpen = false;
+	}
+
+	// Frames are finished by the GPU in order, so reading back stops at the first unfinished one
+	for (unsigned int i = 0; i < GPU_PROFILER_FRAME_LATENCY; i++)
+	{
+		Frame& frame = m_Frames[(m_FrameIndex + i) % GPU_PROFILER_FRAME_LATENCY];
+		if (frame.m_IsPending && !resolve(frame))
+		{
+			break;
+		}
+	}
+}
+
+int GPUProfiler::beginScope(const char* name)
+{
+	Frame& frame = m_Frames[m_FrameIndex];
+	if (!m_IsFrameOpen || frame.m_ScopeCount == GPU_PROFILER_MAX_SCOPES)
+	{
+		return -1;
+	}
+
+	Scope& scope = frame.m_Scopes[frame.m_ScopeCount];
+	if (!scope.m_Begin)
+	{
+		scope.m_Begin = RenderingDevice::GetSingleton()->createQuery(D3D11_QUERY_TIMESTAMP);
+		scope.m_End = RenderingDevice::GetSingleton()->createQuery(D3D11_QUERY_TIMESTAMP);
+	}
+	scope.m_Name = name;
+	RenderingDevice::GetSingleton()->endQuery(scope.m_Begin.Get());
+	return frame.m_ScopeCount++;
+}
+
+void GPUProfiler::endScope(int scope)
+{
+	if (m_IsFrameOpen)
+	{
+		RenderingDevice::GetSingleton()->endQuery(m_Frames[m_FrameIndex].m_Scopes[scope].m_End.Get());
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/profiler.h"
+
+/// Frames in flight before their timestamps are read back
+#define GPU_PROFILER_FRAME_LATENCY 4
+/// Scopes timed in a frame, later scopes in the frame are not timed
+#define GPU_PROFILER_MAX_SCOPES 64
+
+/// Record the GPU time taken by the commands issued in the enclosing scope while capturing. name should be a string literal.
+#define PROFILE_GPU_SCOPE(name) GPUProfileScope PROFILER_CONCAT(gpuProfileScope, __LINE__)(name)
+
+/// Times GPU work with timestamp queries while the Profiler is capturing, and records the timings into a GPU track of the trace.
+/// Timestamps are read back a few frames later without stalling, and are placed on the CPU timeline relative to the start of their frame.
+class GPUProfiler
+{
+	struct Scope
+	{
+		const char* m_Name;
+		Microsoft::WRL::ComPtr<ID3D11Query> m_Begin;
+		Microsoft::WRL::ComPtr<ID3D11Query> m_End;
+	};
+
+	struct Frame
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query> m_Disjoint;
+		Microsoft::WRL::ComPtr<ID3D11Query> m_Begin;
+		/// Profiler time when the frame was started on the CPU
+		long long m_CPUBegin;
+		Vector<Scope> m_Scopes;
+		unsigned int m_ScopeCount;
+		/// If the timestamps of the frame are still to be read back
+		bool m_IsPending;
+	};
+
+	Frame m_Frames[GPU_PROFILER_FRAME_LATENCY];
+	unsigned int m_FrameIndex;
+	bool m_IsEnabled;
+	bool m_IsFrameOpen;
+	ProfilerThread* m_Thread;
+
+	GPUProfiler();
+	GPUProfiler(GPUProfiler&) = delete;
+	~GPUProfiler() = default;
+
+	/// Read back the timestamps of a finished frame. Returns false if the GPU has not reached the end of the frame yet.
+	bool resolve(Frame& frame);
+
+public:
+	static GPUProfiler* GetSingleton();
+
+	void setEnabled(bool enabled) { m_IsEnabled = enabled; }
+	bool isEnabled() const { return m_IsEnabled; }
+
+	/// Call before issuing the rendering commands of a frame.
+	void beginFrame();
+	/// Call after issuing the rendering commands of a frame, before presenting it.
+	void endFrame();
+
+	/// Returns an index to end the scope with, or -1 if it is not timed.
+	int beginScope(const char* name);
+	void endScope(int scope);
+};
+
+/// Times GPU work issued between its construction and destruction. Use through PROFILE_GPU_SCOPE.
+class GPUProfileScope
+{
+	int m_Scope;
+
+public:
+	GPUProfileScope(const char* name)
+	    : m_Scope(Profiler::IsCapturing() ? GPUProfiler::GetSingleton()->beginScope(name) : -1)
+	{
+	}
+	GPUProfileScope(GPUProfileScope&) = delete;
+	~GPUProfileScope()
+	{
+		if (m_Scope != -1)
+		{
+			GPUProfiler::GetSingleton()->endScope(m_Scope);
+		}
+	}
+};
@@ -15,6 +15,8 @@ protected:
 public:
 	IndexBuffer(const Vector<unsigned short>& indices);
 	IndexBuffer(const Vector<int>& indices);
+	IndexBuffer(const unsigned short* indices, unsigned int count);
+	IndexBuffer(const int* indices, unsigned int count);
 	~IndexBuffer() = default;
 
 	void bind() const;
@@ -1,6 +1,8 @@
 #include "material.h"
 
 #include "shader_library.h"
+#include "material_library.h"
+#include "core/resource_graph.h"
 
 void Material::bind()
 {
@@ -20,6 +22,21 @@ Material::Material(Shader* shader, const String& typeName)
 {
 }
 
+void Material::setFileName(const String& fileName)
+{
+	m_FileName = fileName;
+	updateDependencies();
+}
+
+void Material::updateDependencies()
+{
+	// Materials without a file, like the default material, are never reloaded
+	if (!m_FileName.empty() && m_FileName != "DefaultMaterial")
+	{
+		ResourceGraph::GetSingleton()->setDependencies(MaterialLibrary::GetMaterialPath(m_FileName), getDependencies());
+	}
+}
+
 #ifdef ROOTEX_EDITOR
 #include "imgui.h"
 void Material::draw(const String& id)
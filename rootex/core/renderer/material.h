@@ -14,6 +14,9 @@ protected:
 
 	Material(Shader* shader, const String& typeName);
 
+	/// Let the ResourceGraph know which files this material is made from.
+	void updateDependencies();
+
 public:
 	template <typename T>
 	static void setPSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& pointer, UINT slot);
@@ -24,13 +27,21 @@ public:
 	virtual ~Material() = default;
 
 	virtual void bind();
+	/// Ask for enough texture detail to draw this material screenSize pixels tall
+	virtual void requestTextureDetail(float screenSize) {}
 	
 	String getFileName() { return m_FileName; };
 	String getTypeName() { return m_TypeName; };
 	String getFullName() { return m_FileName + " - " + m_TypeName; };
 	virtual JSON::json getJSON() const;
-	
-	void setFileName(const String& fileName) { m_FileName = fileName; };
+	/// Apply the settings from a material file in place.
+	virtual void setJSON(const JSON::json& materialData) {}
+	/// Paths of the files this material is made from, other than its material file.
+	virtual Vector<String> getDependencies() const { return {}; }
+	/// Make the textures again from their image files, after the image files changed.
+	virtual void reloadTextures() {}
+
+	void setFileName(const String& fileName);
 	
 #ifdef ROOTEX_EDITOR
 	virtual void draw(const String& id);
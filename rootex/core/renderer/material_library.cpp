@@ -98,12 +98,38 @@ void MaterialLibrary::CreateNewMaterialFile(const String& materialName, const St
 			materialFile->putString(material->getJSON().dump(4));
 			ResourceLoader::SaveResourceFile(materialFile);
 			s_Materials[materialFileName] = { materialType, {} };
-			PRINT("Created Material: " + materialFileName + " - " + materialType);
+			LOG_INFO("Created Material: {} - {}", materialFileName, materialType);
 			return;
 		}
 	}
 }
 
+String MaterialLibrary::GetMaterialPath(const String& materialName)
+{
+	return "game/assets/materials/" + materialName;
+}
+
+void MaterialLibrary::ReloadMaterial(const String& materialName, const JSON::json& materialData)
+{
+	auto&& findIt = s_Materials.find(materialName);
+	if (findIt == s_Materials.end())
+	{
+		return;
+	}
+
+	// Materials that are not loaded read the changed file when they are next asked for
+	if (Ref<Material> lockedMaterial = findIt->second.second.lock())
+	{
+		if (materialData.value("type", "") != lockedMaterial->getTypeName())
+		{
+			WARN("Cannot change the type of a loaded material: " + materialName);
+			return;
+		}
+		lockedMaterial->setJSON(materialData);
+		PRINT("Reloaded material: " + materialName);
+	}
+}
+
 bool MaterialLibrary::IsExists(const String& materialName)
 {
 	return OS::IsExists("game/assets/materials/" + materialName);
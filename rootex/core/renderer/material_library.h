@@ -22,6 +22,10 @@ public:
 	static void LoadMaterials();
 	static void CreateNewMaterialFile(const String& materialName, const String& materialType);
 	static bool IsExists(const String& materialName);
+	/// Path of the file a material is stored in.
+	static String GetMaterialPath(const String& materialName);
+	/// Apply a changed material file to the material in place, if it is loaded, so that everything drawn with it picks up the change.
+	static void ReloadMaterial(const String& materialName, const JSON::json& materialData);
 
 	static Ref<Material> GetMaterial(const String& materialName);
 	static Ref<Material> GetDefaultMaterial();
@@ -6,6 +6,7 @@
 #include "framework/systems/render_system.h"
 #include "renderer/shader_library.h"
 #include "renderer/texture.h"
+#include "renderer/texture_streamer.h"
 
 #include "renderer/shaders/register_locations_pixel_shader.h"
 #include "renderer/shaders/register_locations_vertex_shader.h"
@@ -66,6 +67,9 @@ Material* BasicMaterial::Create(const JSON::json& materialData)
 
 void BasicMaterial::bind()
 {
+	// Materials switch permutations when they change features, and use the uber shader while a permutation compiles
+	m_BasicShader = ShaderLibrary::GetBasicShader(m_IsLit ? (unsigned int)ShaderFeature::Lit : (unsigned int)ShaderFeature::None);
+	m_Shader = m_BasicShader;
 	Material::bind();
 	m_BasicShader->set(m_DiffuseTexture.get());
 	setVSConstantBuffer(VSDiffuseConstantBuffer(RenderSystem::GetSingleton()->getCurrentMatrix()));
@@ -92,11 +96,64 @@ JSON::json BasicMaterial::getJSON() const
 	return j;
 }
 
+void BasicMaterial::setJSON(const JSON::json& materialData)
+{
+	m_Color = Color((float)materialData["color"]["r"], (float)materialData["color"]["g"], (float)materialData["color"]["b"], (float)materialData["color"]["a"]);
+	m_IsLit = materialData["isLit"];
+	if (m_IsLit)
+	{
+		m_SpecularIntensity = (float)materialData["specularIntensity"];
+		m_SpecularPower = (float)materialData["specularPower"];
+	}
+
+	const String imagePath = materialData["imageFile"];
+	if (!m_ImageFile || FilePath(imagePath) != m_ImageFile->getPath())
+	{
+		if (ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(imagePath))
+		{
+			setTexture(image);
+		}
+		else
+		{
+			WARN("Could not set material diffuse texture: " + imagePath);
+		}
+	}
+#ifdef ROOTEX_EDITOR
+	m_ImagePathUI = imagePath;
+#endif // ROOTEX_EDITOR
+}
+
+Vector<String> BasicMaterial::getDependencies() const
+{
+	if (!m_ImageFile)
+	{
+		return {};
+	}
+	return { m_ImageFile->getPath().generic_string() };
+}
+
+void BasicMaterial::reloadTextures()
+{
+	if (m_ImageFile)
+	{
+		setTexture(m_ImageFile);
+	}
+}
+
 void BasicMaterial::setTexture(ImageResourceFile* image)
 {
-	Ref<Texture> texture(new Texture(image));
+	Ref<Texture> texture(new Texture(image, true));
 	m_ImageFile = image;
 	m_DiffuseTexture = texture;
+	updateDependencies();
+}
+
+void BasicMaterial::requestTextureDetail(float screenSize)
+{
+	if (m_DiffuseTexture)
+	{
+		TextureStreamer::GetSingleton()->request(m_DiffuseTexture.get(), screenSize);
+	}
 }
 
 void BasicMaterial::setTextureInternal(Ref<Texture> texture)
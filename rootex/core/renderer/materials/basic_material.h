@@ -50,7 +50,11 @@ public:
 	static Material* Create(const JSON::json& materialData);
 
 	void bind() override;
+	void requestTextureDetail(float screenSize) override;
 	JSON::json getJSON() const override;
+	void setJSON(const JSON::json& materialData) override;
+	Vector<String> getDependencies() const override;
+	void reloadTextures() override;
 
 #ifdef ROOTEX_EDITOR
 	void draw(const String& id) override;
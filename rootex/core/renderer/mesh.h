@@ -9,6 +9,10 @@ struct Mesh
 {
 	Ref<VertexBuffer> m_VertexBuffer;
 	Ref<IndexBuffer> m_IndexBuffer;
+	/// Axis aligned bounds of the vertices, in model space
+	DirectX::BoundingBox m_Bounds;
+	/// Hash of the vertex and index data, to keep the buffers of unchanged meshes when a model is reloaded
+	unsigned long long m_ContentHash = 0;
 
 	Mesh() = default;
 	Mesh(const Mesh&) = default;
@@ -2,10 +2,15 @@
 
 #include "common/common.h"
 #include "dxgi_debug_interface.h"
+#include "os/metrics.h"
 
+#include "core/texture_cooker.h"
+
+#include "vendor/DirectXTK/Inc/DDSTextureLoader.h"
 #include "vendor/DirectXTK/Inc/WICTextureLoader.h"
 
 RenderingDevice::RenderingDevice()
+    : m_IsSoftware(false)
 {
 	GFX_ERR_CHECK(CoInitialize(nullptr));
 }
@@ -32,7 +37,7 @@ void RenderingDevice::initialize(HWND hWnd, int width, int height, bool MSAA)
 	D3D_FEATURE_LEVEL featureLevel = {};
 
 	HRESULT hr = D3D11CreateDevice(0, // Default adapter
-	    D3D_DRIVER_TYPE_HARDWARE,
+	    m_IsSoftware ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE,
 	    0, // No software device
 	    createDeviceFlags,
 	    0,
@@ -238,9 +243,9 @@ void RenderingDevice::initialize(HWND hWnd, int width, int height, bool MSAA)
 	m_FontBatch.reset(new DirectX::SpriteBatch(m_Context.Get()));
 }
 
-Ref<DirectX::SpriteFont> RenderingDevice::createFont(FileBuffer* fontFileBuffer)
+Ref<DirectX::SpriteFont> RenderingDevice::createFont(const char* fontFileData, size_t size)
 {
-	return Ref<DirectX::SpriteFont>(new DirectX::SpriteFont(m_Device.Get(), (const uint8_t*)fontFileBuffer->data(), fontFileBuffer->size()));
+	return Ref<DirectX::SpriteFont>(new DirectX::SpriteFont(m_Device.Get(), (const uint8_t*)fontFileData, size));
 }
 
 Microsoft::WRL::ComPtr<ID3DBlob> RenderingDevice::createBlob(LPCWSTR path)
@@ -250,6 +255,14 @@ Microsoft::WRL::ComPtr<ID3DBlob> RenderingDevice::createBlob(LPCWSTR path)
 	return pBlob;
 }
 
+Microsoft::WRL::ComPtr<ID3DBlob> RenderingDevice::createBlob(const FileBuffer& data)
+{
+	Microsoft::WRL::ComPtr<ID3DBlob> pBlob = nullptr;
+	GFX_ERR_CHECK(D3DCreateBlob(data.size(), &pBlob));
+	memcpy(pBlob->GetBufferPointer(), data.data(), data.size());
+	return pBlob;
+}
+
 void RenderingDevice::createRenderTextureTarget(int width, int height)
 {
 	D3D11_TEXTURE2D_DESC textureDesc;
@@ -298,11 +311,13 @@ void RenderingDevice::enableSkyDepthStencilState()
 	m_Device->CreateDepthStencilState(&DSDesc, &m_NewSkyDepthStencilState);
 	//DXUT_SetDebugName(m_pSkyboxDepthStencilState, SkyboxDepthStencil );
 	m_Context->OMGetDepthStencilState(&m_OldSkyDepthStencilState, &m_StencilRef);
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetDepthStencilState(m_NewSkyDepthStencilState.Get(), 0);
 }
 
 void RenderingDevice::disableSkyDepthStencilState()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetDepthStencilState(m_OldSkyDepthStencilState.Get(), m_StencilRef);
 }
 
@@ -367,7 +382,7 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTexture(
 	Microsoft::WRL::ComPtr<ID3D11Resource> textureResource;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView;
 
-	if (FAILED(DirectX::CreateWICTextureFromMemory(m_Device.Get(), (const uint8_t*)imageRes->getData()->getRawData()->data(), (size_t)imageRes->getData()->getRawDataByteSize(), textureResource.GetAddressOf(), textureView.GetAddressOf())))
+	if (FAILED(createTextureFromMemory(imageRes->getData()->getView(), imageRes->getData()->getRawDataByteSize(), textureResource, textureView)))
 	{
 		ERR("Could not create texture: " + imageRes->getPath().generic_string());
 	}
@@ -380,7 +395,7 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTexture(
 	Microsoft::WRL::ComPtr<ID3D11Resource> textureResource;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView;
 
-	if (FAILED(DirectX::CreateWICTextureFromMemory(m_Device.Get(), (const uint8_t*)imageFileData, size, textureResource.GetAddressOf(), textureView.GetAddressOf())))
+	if (FAILED(createTextureFromMemory(imageFileData, size, textureResource, textureView)))
 	{
 		ERR("Could not create texture of size: " + std::to_string(size));
 	}
@@ -388,6 +403,57 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTexture(
 	return textureView;
 }
 
+HRESULT RenderingDevice::createTextureFromMemory(const char* imageFileData, size_t size, Microsoft::WRL::ComPtr<ID3D11Resource>& textureResource, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& textureView)
+{
+	// Cooked textures are uploaded as they are, with their mip chain. Other images are decoded by WIC
+	if (TextureCooker::IsCooked(imageFileData, size))
+	{
+		return DirectX::CreateDDSTextureFromMemory(m_Device.Get(), (const uint8_t*)imageFileData, size, textureResource.GetAddressOf(), textureView.GetAddressOf());
+	}
+	return DirectX::CreateWICTextureFromMemory(m_Device.Get(), (const uint8_t*)imageFileData, size, textureResource.GetAddressOf(), textureView.GetAddressOf());
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTexture(const CookedTextureMips& mips, unsigned int topMip)
+{
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+
+	textureDesc.Width = mips.m_Mips[topMip].m_Width;
+	textureDesc.Height = mips.m_Mips[topMip].m_Height;
+	textureDesc.MipLevels = mips.m_Mips.size() - topMip;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = mips.m_HasAlpha ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	Vector<D3D11_SUBRESOURCE_DATA> data(textureDesc.MipLevels);
+	for (unsigned int i = 0; i < textureDesc.MipLevels; i++)
+	{
+		data[i].pSysMem = mips.m_Mips[topMip + i].m_Data;
+		data[i].SysMemPitch = mips.m_Mips[topMip + i].m_RowPitch;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture2D;
+	if (FAILED(m_Device->CreateTexture2D(&textureDesc, data.data(), &texture2D)))
+	{
+		ERR("Could not create streamed texture 2D");
+		return nullptr;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = textureDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureSRV;
+	m_Device->CreateShaderResourceView(texture2D.Get(), &srvDesc, &textureSRV);
+
+	return textureSRV;
+}
+
 struct Texel
 {
 	char m_Red;
@@ -443,26 +509,31 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTextureF
 
 void RenderingDevice::bind(ID3D11Buffer* vertexBuffer, const unsigned int* stride, const unsigned int* offset)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->IASetVertexBuffers(0u, 1u, &vertexBuffer, stride, offset);
 }
 
 void RenderingDevice::bind(ID3D11Buffer* indexBuffer, DXGI_FORMAT format)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->IASetIndexBuffer(indexBuffer, format, 0u);
 }
 
 void RenderingDevice::bind(ID3D11VertexShader* vertexShader)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->VSSetShader(vertexShader, nullptr, 0u);
 }
 
 void RenderingDevice::bind(ID3D11PixelShader* pixelShader)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->PSSetShader(pixelShader, nullptr, 0u);
 }
 
 void RenderingDevice::bind(ID3D11InputLayout* inputLayout)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->IASetInputLayout(inputLayout);
 }
 
@@ -483,21 +554,25 @@ void RenderingDevice::unmapBuffer(ID3D11Buffer* buffer)
 
 void RenderingDevice::setInPixelShader(unsigned int slot, unsigned int number, ID3D11ShaderResourceView* texture)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->PSSetShaderResources(slot, number, &texture);
 }
 
 void RenderingDevice::setInPixelShader(ID3D11SamplerState* samplerState)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->PSSetSamplers(0, 1, &samplerState);
 }
 
 void RenderingDevice::setVSConstantBuffer(ID3D11Buffer* constantBuffer, UINT slot)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->VSSetConstantBuffers(slot, 1u, &constantBuffer);
 }
 
 void RenderingDevice::setPSConstantBuffer(ID3D11Buffer* constantBuffer, UINT slot)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->PSSetConstantBuffers(slot, 1u, &constantBuffer);
 }
 
@@ -510,17 +585,20 @@ void RenderingDevice::unbindShaderResources()
 void RenderingDevice::setAlphaBlendState()
 {
 	static float blendFactors[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetBlendState(m_AlphaBlendState.Get(), blendFactors, 0xffffffff);
 }
 
 void RenderingDevice::setDefaultBlendState()
 {
 	static float blendFactors[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetBlendState(m_DefaultBlendState.Get(), blendFactors, 0xffffffff);
 }
 
 void RenderingDevice::setCurrentRasterizerState()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->RSSetState(*m_CurrentRasterizerState);
 }
 
@@ -548,11 +626,13 @@ void RenderingDevice::setRasterizerState(RasterizerState rs)
 
 void RenderingDevice::setTemporaryUIRasterizerState()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->RSSetState(m_UIRasterizerState.Get());
 }
 
 void RenderingDevice::setTemporaryUIScissoredRasterizerState()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->RSSetState(m_UIScissoredRasterizerState.Get());
 }
 
@@ -569,11 +649,13 @@ void RenderingDevice::setScissorRectangle(int x, int y, int width, int height)
 
 void RenderingDevice::setDepthStencilState()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetDepthStencilState(m_DepthStencilState.Get(), m_StencilRef);
 }
 
 void RenderingDevice::setTextureRenderTarget()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetRenderTargets(1, m_RenderTargetTextureView.GetAddressOf(), m_DepthStencilView.Get());
 	m_CurrentRenderTarget = m_RenderTargetTextureView.GetAddressOf();
 	m_UnboundRenderTarget = m_RenderTargetBackBufferView.GetAddressOf();
@@ -581,6 +663,7 @@ void RenderingDevice::setTextureRenderTarget()
 
 void RenderingDevice::setBackBufferRenderTarget()
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->OMSetRenderTargets(1, m_RenderTargetBackBufferView.GetAddressOf(), m_DepthStencilView.Get());
 	m_CurrentRenderTarget = m_RenderTargetBackBufferView.GetAddressOf();
 	m_UnboundRenderTarget = m_RenderTargetTextureView.GetAddressOf();
@@ -598,6 +681,7 @@ Ref<DirectX::SpriteBatch> RenderingDevice::getUIBatch()
 
 void RenderingDevice::setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY pt)
 {
+	METRIC_COUNT("State Changes", 1);
 	m_Context->IASetPrimitiveTopology(pt);
 }
 
@@ -632,8 +716,32 @@ Microsoft::WRL::ComPtr<ID3D11SamplerState> RenderingDevice::createSamplerState()
 	return samplerState;
 }
 
+Microsoft::WRL::ComPtr<ID3D11Query> RenderingDevice::createQuery(D3D11_QUERY type)
+{
+	D3D11_QUERY_DESC queryDesc = { type, 0 };
+	Microsoft::WRL::ComPtr<ID3D11Query> query;
+	GFX_ERR_CHECK(m_Device->CreateQuery(&queryDesc, &query));
+	return query;
+}
+
+void RenderingDevice::beginQuery(ID3D11Query* query)
+{
+	m_Context->Begin(query);
+}
+
+void RenderingDevice::endQuery(ID3D11Query* query)
+{
+	m_Context->End(query);
+}
+
+bool RenderingDevice::getQueryData(ID3D11Query* query, void* data, unsigned int size)
+{
+	return m_Context->GetData(query, data, size, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+}
+
 void RenderingDevice::drawIndexed(UINT number)
 {
+	METRIC_COUNT("Draw Calls", 1);
 	m_Context->DrawIndexed(number, 0u, 0u);
 }
 
@@ -12,6 +12,8 @@
 #include "vendor/DirectXTK/Inc/SpriteBatch.h"
 #include "vendor/DirectXTK/Inc/SpriteFont.h"
 
+struct CookedTextureMips;
+
 /// The boss of all rendering, all DirectX API calls requiring the Device or Context go through this
 class RenderingDevice
 {
@@ -49,6 +51,8 @@ class RenderingDevice
 	Microsoft::WRL::ComPtr<IDXGISwapChain> m_SwapChain;
 	bool m_MSAA;
 	unsigned int m_4XMSQuality;
+	/// Use the WARP software rasterizer instead of the GPU
+	bool m_IsSoftware;
 
 	RenderingDevice();
 	RenderingDevice(RenderingDevice&) = delete;
@@ -56,6 +60,8 @@ class RenderingDevice
 
 	/// Should only be called by Window class
 	void swapBuffers();
+	/// Upload a cooked .dds texture as it is, or decode any other image file.
+	HRESULT createTextureFromMemory(const char* imageFileData, size_t size, Microsoft::WRL::ComPtr<ID3D11Resource>& textureResource, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& textureView);
 
 	friend class Window;
 
@@ -77,6 +83,8 @@ public:
 	static RenderingDevice* GetSingleton();
 
 	void initialize(HWND hWnd, int width, int height, bool MSAA);
+	/// Make the device on the WARP software rasterizer, so that it can be made on machines without a GPU. Call before initialize.
+	void setSoftware(bool enabled) { m_IsSoftware = enabled; }
 	void setScreenState(bool fullscreen);
 
 	void enableSkyDepthStencilState();
@@ -89,15 +97,24 @@ public:
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> createVertexShader(ID3DBlob* blob);
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> createVertexLayout(ID3DBlob* vertexShaderBlob, const D3D11_INPUT_ELEMENT_DESC* ied, UINT size);
 	
-	Ref<DirectX::SpriteFont> createFont(FileBuffer* fontFileBuffer);
+	Ref<DirectX::SpriteFont> createFont(const char* fontFileData, size_t size);
 	/// To hold shader blobs loaded from the compiled shader files
 	Microsoft::WRL::ComPtr<ID3DBlob> createBlob(LPCWSTR path);
+	Microsoft::WRL::ComPtr<ID3DBlob> createBlob(const FileBuffer& data);
 	/// To render the game onto a texture in case of Editor
 	void createRenderTextureTarget(int width, int height);
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createTexture(ImageResourceFile* imageRes);
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createTexture(const char* imageFileData, size_t size);
+	/// Upload the mips of a cooked texture from topMip down
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createTexture(const CookedTextureMips& mips, unsigned int topMip);
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createTextureFromPixels(const char* imageRawData, unsigned int width, unsigned int height);
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> createSamplerState();
+	Microsoft::WRL::ComPtr<ID3D11Query> createQuery(D3D11_QUERY type);
+
+	void beginQuery(ID3D11Query* query);
+	void endQuery(ID3D11Query* query);
+	/// Read the result of a query without waiting for it. Returns false if the GPU has not finished it yet.
+	bool getQueryData(ID3D11Query* query, void* data, unsigned int size);
 
 	void bind(ID3D11Buffer* vertexBuffer, const unsigned int* stride, const unsigned int* offset);
 	void bind(ID3D11Buffer* indexBuffer, DXGI_FORMAT format);
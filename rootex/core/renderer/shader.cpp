@@ -11,14 +11,27 @@ Shader::Shader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const Buffer
 	{
 		ERR("Vertex Shader not found");
 	}
-	m_VertexShader = RenderingDevice::GetSingleton()->createVertexShader(vertexShaderBlob.Get());
 
 	Microsoft::WRL::ComPtr<ID3DBlob> pixelShaderBlob = RenderingDevice::GetSingleton()->createBlob(pixelPath);
 	if (!pixelShaderBlob)
 	{
 		ERR("Pixel Shader not found");
 	}
-	m_PixelShader = RenderingDevice::GetSingleton()->createPixelShader(pixelShaderBlob.Get());
+
+	create(vertexShaderBlob.Get(), pixelShaderBlob.Get(), vertexBufferFormat);
+}
+
+Shader::Shader(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat)
+    : m_VertexPath(nullptr)
+    , m_PixelPath(nullptr)
+{
+	create(vertexShaderBlob, pixelShaderBlob, vertexBufferFormat);
+}
+
+void Shader::create(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat)
+{
+	m_VertexShader = RenderingDevice::GetSingleton()->createVertexShader(vertexShaderBlob);
+	m_PixelShader = RenderingDevice::GetSingleton()->createPixelShader(pixelShaderBlob);
 
 	const Vector<VertexBufferElement>& elements = vertexBufferFormat.getElements();
 
@@ -34,7 +47,7 @@ Shader::Shader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const Buffer
 	}
 
 	m_InputLayout = RenderingDevice::GetSingleton()->createVertexLayout(
-	    vertexShaderBlob.Get(),
+	    vertexShaderBlob,
 	    vertexDescArray.data(),
 	    vertexDescArray.size());
 }
@@ -61,6 +74,12 @@ BasicShader::BasicShader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, co
 	m_SamplerState = RenderingDevice::GetSingleton()->createSamplerState();
 }
 
+BasicShader::BasicShader(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat)
+    : Shader(vertexShaderBlob, pixelShaderBlob, vertexBufferFormat)
+{
+	m_SamplerState = RenderingDevice::GetSingleton()->createSamplerState();
+}
+
 void BasicShader::set(const Texture* texture)
 {
 	RenderingDevice::GetSingleton()->setInPixelShader(0, 1, texture->getTextureResourceView());
@@ -24,6 +24,10 @@ protected:
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> m_InputLayout;
 
 	Shader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const BufferFormat& vertexBufferFormat);
+	/// Make a shader out of compiled bytecode, like a permutation compiled at runtime.
+	Shader(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat);
+
+	void create(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat);
 
 	friend class ShaderLibrary;
 
@@ -48,6 +52,7 @@ class BasicShader : public Shader
 
 public:
 	BasicShader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const BufferFormat& vertexBufferFormat);
+	BasicShader(ID3DBlob* vertexShaderBlob, ID3DBlob* pixelShaderBlob, const BufferFormat& vertexBufferFormat);
 	BasicShader(BasicShader&) = delete;
 	~BasicShader() = default;
 
@@ -0,0 +1,189 @@
+#include "shader_cache.h"
+
+#include "core/content_hash.h"
+
+#include <d3dcompiler.h>
+#include <sstream>
+
+/// Hashes a file and, recursively, the files it includes, skipping files that were already hashed.
+static bool HashSource(const FilePath& path, HashSet<String>& visited, unsigned long long& hash)
+{
+	if (!visited.insert(path.lexically_normal().generic_string()).second)
+	{
+		return true;
+	}
+	if (!OS::IsExists(path.generic_string()))
+	{
+		return false;
+	}
+
+	FileBuffer source = OS::LoadFileContents(path.generic_string());
+	hash = ContentHash::Combine(hash, ContentHash::Hash(source.data(), source.size()));
+
+	std::istringstream lines(String(source.begin(), source.end()));
+	String line;
+	while (std::getline(lines, line))
+	{
+		size_t directive = line.find("#include");
+		if (directive == String::npos)
+		{
+			continue;
+		}
+		size_t start = line.find('"', directive);
+		size_t end = line.find('"', start + 1);
+		if (start == String::npos || end == String::npos)
+		{
+			// System includes are not part of the shader sources
+			continue;
+		}
+		if (!HashSource(path.parent_path() / line.substr(start + 1, end - start - 1), visited, hash))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned long long ShaderCache::GetSourceHash(const String& sourcePath)
+{
+	HashSet<String> visited;
+	unsigned long long hash = SHADER_CACHE_VERSION;
+	if (!HashSource(sourcePath, visited, hash))
+	{
+		return 0;
+	}
+	return hash;
+}
+
+unsigned long long ShaderCache::GetPermutationHash(const ShaderPermutationDesc& desc)
+{
+	Vector<String> defines = desc.m_Defines;
+	std::sort(defines.begin(), defines.end());
+
+	String key = desc.m_SourcePath + ";" + desc.m_EntryPoint + ";" + desc.m_Target;
+	for (auto& define : defines)
+	{
+		key += ";" + define;
+	}
+	return ContentHash::Hash(key.data(), key.size(), SHADER_CACHE_VERSION);
+}
+
+String ShaderCache::GetCachePath(const ShaderPermutationDesc& desc)
+{
+	std::stringstream name;
+	name << FilePath(desc.m_SourcePath).stem().generic_string() << "_" << std::hex << GetPermutationHash(desc) << ".cso";
+	return SHADER_CACHE_DIRECTORY + name.str();
+}
+
+bool ShaderCache::Load(const ShaderPermutationDesc& desc, unsigned long long sourceHash, FileBuffer& bytecode)
+{
+	const String cachePath = GetCachePath(desc);
+	if (!OS::IsExists(cachePath))
+	{
+		return false;
+	}
+
+	FileBuffer cached = OS::LoadFileContents(cachePath);
+	ShaderCacheHeader header = {};
+	if (cached.size() <= sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, cached.data(), sizeof(header));
+	// Permutations whose hashes collide in the file name are told apart here as well
+	if (strncmp(header.m_Magic, SHADER_CACHE_MAGIC, 4) != 0 || header.m_Version != SHADER_CACHE_VERSION
+	    || header.m_SourceHash != sourceHash || header.m_PermutationHash != GetPermutationHash(desc))
+	{
+		return false;
+	}
+
+	bytecode.assign(cached.begin() + sizeof(header), cached.end());
+	return true;
+}
+
+bool ShaderCache::Store(const ShaderPermutationDesc& desc, unsigned long long sourceHash, const FileBuffer& bytecode)
+{
+	ShaderCacheHeader header;
+	memcpy(header.m_Magic, SHADER_CACHE_MAGIC, 4);
+	header.m_Version = SHADER_CACHE_VERSION;
+	header.m_SourceHash = sourceHash;
+	header.m_PermutationHash = GetPermutationHash(desc);
+
+	const String cachePath = GetCachePath(desc);
+	std::filesystem::create_directories(OS::GetAbsolutePath(SHADER_CACHE_DIRECTORY));
+	std::ofstream cacheFile(OS::GetAbsolutePath(cachePath), std::ios::binary);
+	cacheFile.write((const char*)&header, sizeof(header));
+	cacheFile.write(bytecode.data(), bytecode.size());
+	if (!cacheFile)
+	{
+		WARN("Could not write shader cache: " + cachePath);
+		return false;
+	}
+	return true;
+}
+
+bool ShaderCache::Compile(const ShaderPermutationDesc& desc, FileBuffer& bytecode, String& errors)
+{
+	Vector<D3D_SHADER_MACRO> macros;
+	for (auto& define : desc.m_Defines)
+	{
+		macros.push_back({ define.c_str(), "1" });
+	}
+	macros.push_back({ nullptr, nullptr });
+
+#ifdef _DEBUG
+	const UINT flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	const UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif // _DEBUG
+
+	Microsoft::WRL::ComPtr<ID3DBlob> code;
+	Microsoft::WRL::ComPtr<ID3DBlob> errorMessages;
+	HRESULT result = D3DCompileFromFile(
+	    OS::GetAbsolutePath(desc.m_SourcePath).wstring().c_str(),
+	    macros.data(),
+	    D3D_COMPILE_STANDARD_FILE_INCLUDE,
+	    desc.m_EntryPoint.c_str(),
+	    desc.m_Target.c_str(),
+	    flags,
+	    0,
+	    &code,
+	    &errorMessages);
+
+	if (errorMessages)
+	{
+		errors.assign((const char*)errorMessages->GetBufferPointer(), errorMessages->GetBufferSize());
+	}
+	if (FAILED(result) || !code)
+	{
+		return false;
+	}
+
+	const char* data = (const char*)code->GetBufferPointer();
+	bytecode.assign(data, data + code->GetBufferSize());
+	return true;
+}
+
+bool ShaderCache::LoadOrCompile(const ShaderPermutationDesc& desc, FileBuffer& bytecode)
+{
+	unsigned long long sourceHash = GetSourceHash(desc.m_SourcePath);
+	if (sourceHash == 0)
+	{
+		ERR("Shader source not found: " + desc.m_SourcePath);
+		return false;
+	}
+	if (Load(desc, sourceHash, bytecode))
+	{
+		return true;
+	}
+
+	String errors;
+	if (!Compile(desc, bytecode, errors))
+	{
+		ERR("Shader could not be compiled: " + GetCachePath(desc));
+		ERR(errors);
+		return false;
+	}
+	Store(desc, sourceHash, bytecode);
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Identifies a cached shader file
+#define SHADER_CACHE_MAGIC "RSHD"
+/// Bump when the cache format or the compile flags change, so that old cached shaders get compiled again
+#define SHADER_CACHE_VERSION 1
+/// Compiled shader permutations are written here, relative to Rootex root
+#define SHADER_CACHE_DIRECTORY "rootex/assets/shaders/cache/"
+
+/// Starts a cached shader file. Followed by the compiled shader bytecode.
+struct ShaderCacheHeader
+{
+	char m_Magic[4];
+	unsigned int m_Version;
+	/// Hash of the shader source and every file it includes
+	unsigned long long m_SourceHash;
+	/// Hash of the defines, entry point and target it was compiled with
+	unsigned long long m_PermutationHash;
+};
+
+/// A shader source compiled with a set of defines.
+struct ShaderPermutationDesc
+{
+	/// Path of the HLSL source relative to Rootex root
+	String m_SourcePath;
+	String m_EntryPoint;
+	/// Shader model to compile for, like ps_4_0
+	String m_Target;
+	/// Defined as 1 while compiling
+	Vector<String> m_Defines;
+};
+
+/// Compiles shader permutations from their HLSL sources and caches the compiled bytecode on disk.
+/// Each permutation gets its own cache file named by a hash of its defines. The file stores a hash of the source and the files it includes,
+/// so editing a shader or any of its includes compiles its permutations again the next time they are asked for.
+/// Only touches files and the compiler, so it is safe to use from any thread.
+class ShaderCache
+{
+public:
+	/// Hash of the source and every file it includes with #include "...", relative to the including file. 0 if the source can not be read.
+	static unsigned long long GetSourceHash(const String& sourcePath);
+	/// Hash of what the source is compiled with. The order of defines does not matter.
+	static unsigned long long GetPermutationHash(const ShaderPermutationDesc& desc);
+	static String GetCachePath(const ShaderPermutationDesc& desc);
+
+	/// Read a cached permutation. Returns false if it is missing or was compiled from another version of the source.
+	static bool Load(const ShaderPermutationDesc& desc, unsigned long long sourceHash, FileBuffer& bytecode);
+	static bool Store(const ShaderPermutationDesc& desc, unsigned long long sourceHash, const FileBuffer& bytecode);
+
+	/// Compile a permutation from its source. Compiler errors are returned in errors.
+	static bool Compile(const ShaderPermutationDesc& desc, FileBuffer& bytecode, String& errors);
+	/// Load a permutation from the cache, compiling and caching it if it is not up to date.
+	static bool LoadOrCompile(const ShaderPermutationDesc& desc, FileBuffer& bytecode);
+};
@@ -1,6 +1,20 @@
 #include "shader_library.h"
 
+/// Compile time switches for each ShaderFeature, defined while compiling permutations
+static const Vector<Pair<ShaderFeature, String>> ShaderFeatureDefines = {
+	{ ShaderFeature::Lit, "LIT" }
+};
+
 HashMap<ShaderLibrary::ShaderType, Ptr<Shader>> ShaderLibrary::s_Shaders;
+HashMap<unsigned int, Ptr<ShaderLibrary::Permutation>> ShaderLibrary::s_BasicPermutations;
+BufferFormat ShaderLibrary::s_BasicBufferFormat;
+Microsoft::WRL::ComPtr<ID3DBlob> ShaderLibrary::s_BasicVertexShaderBlob;
+bool ShaderLibrary::s_IsPermutationsEnabled = false;
+std::thread ShaderLibrary::s_CompileThread;
+std::mutex ShaderLibrary::s_CompileMutex;
+std::condition_variable ShaderLibrary::s_CompileCondition;
+Vector<ShaderLibrary::Permutation*> ShaderLibrary::s_CompileQueue;
+bool ShaderLibrary::s_IsCompileThreadRunning = false;
 
 Shader* ShaderLibrary::MakeShader(ShaderType shaderType, const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const BufferFormat& vertexBufferFormat)
 {
@@ -27,7 +41,28 @@ Shader* ShaderLibrary::MakeShader(ShaderType shaderType, const LPCWSTR& vertexPa
 	return newShader;
 }
 
-void ShaderLibrary::MakeShaders()
+void ShaderLibrary::CompilePermutations()
+{
+	while (true)
+	{
+		Permutation* permutation = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(s_CompileMutex);
+			s_CompileCondition.wait(lock, []() { return !s_CompileQueue.empty() || !s_IsCompileThreadRunning; });
+			if (!s_IsCompileThreadRunning)
+			{
+				return;
+			}
+			permutation = s_CompileQueue.front();
+			s_CompileQueue.erase(s_CompileQueue.begin());
+		}
+
+		permutation->m_HasFailed = !ShaderCache::LoadOrCompile(permutation->m_Desc, permutation->m_Bytecode);
+		permutation->m_IsCompiled = true;
+	}
+}
+
+void ShaderLibrary::MakeShaders(bool isPermutationsEnabled)
 {
 	if (s_Shaders.size() > 1)
 	{
@@ -35,16 +70,38 @@ void ShaderLibrary::MakeShaders()
 		return;
 	}
 	{
-		BufferFormat basicBufferFormat;
-		basicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "POSITION");
-		basicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "NORMAL");
-		basicBufferFormat.push(VertexBufferElement::Type::FloatFloat, "TEXCOORD");
-		MakeShader(ShaderType::Basic, L"rootex/assets/shaders/basic_vertex_shader.cso", L"rootex/assets/shaders/basic_pixel_shader.cso", basicBufferFormat);
+		s_BasicBufferFormat = BufferFormat();
+		s_BasicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "POSITION");
+		s_BasicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "NORMAL");
+		s_BasicBufferFormat.push(VertexBufferElement::Type::FloatFloat, "TEXCOORD");
+		MakeShader(ShaderType::Basic, L"rootex/assets/shaders/basic_vertex_shader.cso", L"rootex/assets/shaders/basic_pixel_shader.cso", s_BasicBufferFormat);
+	}
+
+	s_IsPermutationsEnabled = isPermutationsEnabled;
+	if (s_IsPermutationsEnabled)
+	{
+		s_BasicVertexShaderBlob = RenderingDevice::GetSingleton()->createBlob(L"rootex/assets/shaders/basic_vertex_shader.cso");
+		s_IsCompileThreadRunning = true;
+		s_CompileThread = std::thread(CompilePermutations);
 	}
 }
 
 void ShaderLibrary::DestroyShaders()
 {
+	if (s_CompileThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_CompileMutex);
+			s_IsCompileThreadRunning = false;
+			s_CompileQueue.clear();
+		}
+		s_CompileCondition.notify_one();
+		s_CompileThread.join();
+	}
+
+	s_IsPermutationsEnabled = false;
+	s_BasicPermutations.clear();
+	s_BasicVertexShaderBlob.Reset();
 	s_Shaders.clear();
 }
 
@@ -52,3 +109,48 @@ BasicShader* ShaderLibrary::GetBasicShader()
 {
 	return reinterpret_cast<BasicShader*>(s_Shaders[ShaderType::Basic].get());
 }
+
+BasicShader* ShaderLibrary::GetBasicShader(unsigned int features)
+{
+	if (!s_IsPermutationsEnabled)
+	{
+		return GetBasicShader();
+	}
+
+	Ptr<Permutation>& permutation = s_BasicPermutations[features];
+	if (!permutation)
+	{
+		permutation.reset(new Permutation());
+		permutation->m_Desc.m_SourcePath = "rootex/core/renderer/shaders/basic_pixel_shader.hlsl";
+		permutation->m_Desc.m_EntryPoint = "main";
+		permutation->m_Desc.m_Target = "ps_4_0";
+		permutation->m_Desc.m_Defines.push_back("PERMUTATION");
+		for (auto& [feature, define] : ShaderFeatureDefines)
+		{
+			if (features & (unsigned int)feature)
+			{
+				permutation->m_Desc.m_Defines.push_back(define);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(s_CompileMutex);
+			s_CompileQueue.push_back(permutation.get());
+		}
+		s_CompileCondition.notify_one();
+	}
+
+	if (permutation->m_Shader)
+	{
+		return permutation->m_Shader.get();
+	}
+	if (permutation->m_IsCompiled && !permutation->m_HasFailed)
+	{
+		// Shader objects are made on the main thread, where the rest of the rendering resources are made
+		permutation->m_Shader.reset(new BasicShader(s_BasicVertexShaderBlob.Get(), RenderingDevice::GetSingleton()->createBlob(permutation->m_Bytecode).Get(), s_BasicBufferFormat));
+		permutation->m_Bytecode.clear();
+		permutation->m_Bytecode.shrink_to_fit();
+		return permutation->m_Shader.get();
+	}
+	return GetBasicShader();
+}
@@ -2,6 +2,19 @@
 
 #include "common/common.h"
 #include "shader.h"
+#include "shader_cache.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// Features materials ask shaders for. Each combination of features is compiled into its own permutation of a shader.
+enum class ShaderFeature : unsigned int
+{
+	None = 0,
+	Lit = 1 << 0
+};
 
 /// Does Shader caching
 class ShaderLibrary
@@ -11,18 +24,48 @@ class ShaderLibrary
 		Basic
 	};
 
+	/// A shader compiled with a combination of features
+	struct Permutation
+	{
+		ShaderPermutationDesc m_Desc;
+		/// Filled by the compile thread
+		FileBuffer m_Bytecode;
+		bool m_HasFailed = false;
+		/// Set by the compile thread once it is done with this permutation
+		std::atomic<bool> m_IsCompiled { false };
+		Ptr<BasicShader> m_Shader;
+	};
+
 private:
 	/// New shaders are stored in this hash map, existing once are retrieved
 	static HashMap<ShaderType, Ptr<Shader>> s_Shaders;
 
+	/// Permutations of the basic shader by their features
+	static HashMap<unsigned int, Ptr<Permutation>> s_BasicPermutations;
+	static BufferFormat s_BasicBufferFormat;
+	/// Permutations only replace the pixel shader
+	static Microsoft::WRL::ComPtr<ID3DBlob> s_BasicVertexShaderBlob;
+	static bool s_IsPermutationsEnabled;
+
+	static std::thread s_CompileThread;
+	static std::mutex s_CompileMutex;
+	static std::condition_variable s_CompileCondition;
+	static Vector<Permutation*> s_CompileQueue;
+	static bool s_IsCompileThreadRunning;
+
 	/// Deals with the hash map
 	static Shader* MakeShader(ShaderType shaderType, const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const BufferFormat& vertexBufferFormat);
+	/// Loads queued permutations from the shader cache, compiling the ones that are missing or out of date.
+	static void CompilePermutations();
 
 public:
-	/// Load all shaders
-	static void MakeShaders();
+	/// Load all shaders. Permutations are compiled on a background thread if enabled, and the uber shaders are used otherwise.
+	static void MakeShaders(bool isPermutationsEnabled = true);
 	/// Unload all shaders
 	static void DestroyShaders();
 
 	static BasicShader* GetBasicShader();
+	/// The basic shader compiled for a combination of ShaderFeature flags.
+	/// The uber shader, which branches on features at runtime, is returned until the permutation is compiled.
+	static BasicShader* GetBasicShader(unsigned int features);
 };
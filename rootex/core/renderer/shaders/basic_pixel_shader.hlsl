@@ -65,10 +65,17 @@ cbuffer Material : register(PER_OBJECT_PS_HLSL)
 float4 main(PixelInputType input) : SV_TARGET
 {    
     float4 materialColor = ShaderTexture.Sample(SampleType, input.tex) * color;
+#ifdef PERMUTATION
+    // Permutations are compiled for their features, so they do not branch on them
+#ifndef LIT
+    return materialColor;
+#endif
+#else
     if (isLit == 0)
     {
         return materialColor;
     }
+#endif
     
     input.normal = normalize(input.normal);
 
@@ -2,14 +2,26 @@
 
 #include "rendering_device.h"
 #include "resource_loader.h"
+#include "texture_streamer.h"
+#include "core/texture_cooker.h"
 
-Texture::Texture(ImageResourceFile* imageFile)
+Texture::Texture(ImageResourceFile* imageFile, bool isStreamable)
     : m_ImageFile(imageFile)
+    , m_Width(0)
+    , m_Height(0)
+    , m_MipLevels(0)
+    , m_IsStreamable(isStreamable)
+    , m_StreamingID(-1)
+    , m_ResidentMip(0)
 {
 	loadTexture();
 }
 
 Texture::Texture(const char* imageData, int width, int height)
+    : m_ImageFile(nullptr)
+    , m_IsStreamable(false)
+    , m_StreamingID(-1)
+    , m_ResidentMip(0)
 {
 	m_TextureView = RenderingDevice::GetSingleton()->createTextureFromPixels(imageData, width, height);
 
@@ -27,6 +39,9 @@ Texture::Texture(const char* imageData, int width, int height)
 
 Texture::Texture(const char* imageFileData, size_t size)
     : m_ImageFile(nullptr)
+    , m_IsStreamable(false)
+    , m_StreamingID(-1)
+    , m_ResidentMip(0)
 {
 	m_TextureView = RenderingDevice::GetSingleton()->createTexture(imageFileData, size);
 
@@ -42,6 +57,14 @@ Texture::Texture(const char* imageFileData, size_t size)
 	m_MipLevels = textureDesc.MipLevels;
 }
 
+Texture::~Texture()
+{
+	if (isStreamed())
+	{
+		TextureStreamer::GetSingleton()->remove(m_StreamingID);
+	}
+}
+
 void Texture::reload()
 {
 	m_TextureView.Reset();
@@ -58,16 +81,81 @@ void Texture::reload()
 
 void Texture::loadTexture()
 {
-	m_TextureView = RenderingDevice::GetSingleton()->createTexture(m_ImageFile);
+	if (isStreamed())
+	{
+		TextureStreamer::GetSingleton()->remove(m_StreamingID);
+		m_StreamingID = -1;
+	}
+	m_ResidentMip = 0;
+
+	if (m_ImageFile->getData()->getRawDataByteSize() == 0)
+	{
+		ResourceLoader::LoadImageData(m_ImageFile);
+	}
+
+	CookedTextureMips mips;
+	unsigned int baseMip = 0;
+	if (m_IsStreamable && TextureCooker::ReadMips(m_ImageFile->getData()->getView(), m_ImageFile->getData()->getRawDataByteSize(), mips))
+	{
+		baseMip = TextureStreamer::GetBaseMip(mips);
+	}
+
+	// Only the low mips of streamed textures get uploaded for now. The TextureStreamer asks for the rest when they are seen up close
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView = baseMip > 0
+	    ? RenderingDevice::GetSingleton()->createTexture(mips, baseMip)
+	    : RenderingDevice::GetSingleton()->createTexture(m_ImageFile);
+	if (!textureView)
+	{
+		ERR("Could not create texture: " + m_ImageFile->getPath().generic_string());
+		m_ImageFile->getData()->setData(FileBuffer());
+		return;
+	}
+	setTextureView(textureView);
+
+	if (baseMip > 0)
+	{
+		m_Width = mips.m_Width;
+		m_Height = mips.m_Height;
+		m_MipLevels = mips.m_Mips.size();
+		m_ResidentMip = baseMip;
+		m_StreamingID = TextureStreamer::GetSingleton()->add(this, mips, baseMip);
+	}
+	else
+	{
+		CD3D11_TEXTURE2D_DESC textureDesc;
+		m_Texture->GetDesc(&textureDesc);
+
+		m_Width = textureDesc.Width;
+		m_Height = textureDesc.Height;
+		m_MipLevels = textureDesc.MipLevels;
+	}
+
+	// The GPU has its own copy now. The data is read again if another texture is made from the same image
+	m_ImageFile->getData()->setData(FileBuffer());
+}
+
+void Texture::setResidentMip(unsigned int topMip, const CookedTextureMips& mips)
+{
+	if (!isStreamed() || topMip == m_ResidentMip || topMip >= mips.m_Mips.size())
+	{
+		return;
+	}
+
+	// D3D11 textures cannot change their mip count, so the texture is made again with the mips that should be resident
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView = RenderingDevice::GetSingleton()->createTexture(mips, topMip);
+	if (textureView)
+	{
+		setTextureView(textureView);
+		m_ResidentMip = topMip;
+	}
+}
+
+void Texture::setTextureView(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView)
+{
+	m_TextureView = textureView;
+	m_Texture.Reset();
 
 	Microsoft::WRL::ComPtr<ID3D11Resource> res;
 	m_TextureView->GetResource(&res);
 	res->QueryInterface<ID3D11Texture2D>(&m_Texture);
-
-	CD3D11_TEXTURE2D_DESC textureDesc;
-	m_Texture->GetDesc(&textureDesc);
-
-	m_Width = textureDesc.Width;
-	m_Height = textureDesc.Height;
-	m_MipLevels = textureDesc.MipLevels;
 }
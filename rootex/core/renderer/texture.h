@@ -3,6 +3,7 @@
 #include <d3d11.h>
 
 class ImageResourceFile;
+struct CookedTextureMips;
 
 /// Encapsulates all Texture related functionalities, uses DirectXTK behind the scenes
 class Texture
@@ -13,22 +14,36 @@ class Texture
 	unsigned int m_Width;
 	unsigned int m_Height;
 	unsigned int m_MipLevels;
+	bool m_IsStreamable;
+	/// ID in the TextureStreamer, or -1 if every mip is resident
+	int m_StreamingID;
+	unsigned int m_ResidentMip;
+
+	friend class TextureStreamer;
 
 	void loadTexture();
+	void setTextureView(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView);
 
 public:
-	Texture(ImageResourceFile* imageFile);
+	/// Streamable textures made from cooked images only keep their low mips resident until the TextureStreamer streams in more.
+	Texture(ImageResourceFile* imageFile, bool isStreamable = false);
 	Texture(const char* imageData, int width, int height);
 	Texture(const char* imageFileData, size_t size);
 	Texture(Texture&) = delete;
 	Texture& operator=(Texture&) = delete;
-	~Texture() = default;
+	~Texture();
 
 	void reload();
+	/// Rebuild the GPU texture with the mips from topMip down, out of mips read from the cooked image. Only for streamed textures.
+	void setResidentMip(unsigned int topMip, const CookedTextureMips& mips);
 
 	ID3D11ShaderResourceView* getTextureResourceView() const { return m_TextureView.Get(); }
 	ID3D11Texture2D* getD3D11Texture2D() const { return m_Texture.Get(); }
 	unsigned int getWidth() const { return m_Width; }
 	unsigned int getHeight() const { return m_Height; }
 	unsigned int getMipLevels() const { return m_MipLevels; }
+	bool isStreamed() const { return m_StreamingID != -1; }
+	int getStreamingID() const { return m_StreamingID; }
+	/// Most detailed mip that is resident
+	unsigned int getResidentMip() const { return m_ResidentMip; }
 };
@@ -0,0 +1,193 @@
+#include "texture_residency.h"
+
+TextureResidency::TextureResidency(size_t budgetBytes, unsigned int maxStreamInsPerUpdate)
+    : m_BudgetBytes(budgetBytes)
+    , m_MaxStreamInsPerUpdate(maxStreamInsPerUpdate)
+    , m_Frame(1)
+{
+}
+
+TextureResidency::TextureID TextureResidency::add(const Vector<size_t>& mipSizes, unsigned int baseMip)
+{
+	if (mipSizes.empty())
+	{
+		return -1;
+	}
+
+	TextureID texture;
+	if (!m_FreeIDs.empty())
+	{
+		texture = m_FreeIDs.back();
+		m_FreeIDs.pop_back();
+	}
+	else
+	{
+		texture = m_Entries.size();
+		m_Entries.emplace_back();
+	}
+
+	Entry& entry = m_Entries[texture];
+	entry = Entry();
+	entry.m_IsUsed = true;
+	entry.m_BytesFrom.resize(mipSizes.size() + 1, 0);
+	for (int mip = (int)mipSizes.size() - 1; mip >= 0; mip--)
+	{
+		entry.m_BytesFrom[mip] = entry.m_BytesFrom[mip + 1] + mipSizes[mip];
+	}
+	entry.m_BaseMip = std::min(baseMip, (unsigned int)mipSizes.size() - 1);
+	entry.m_ResidentMip = entry.m_BaseMip;
+	entry.m_RequestedMip = entry.m_BaseMip;
+
+	m_Stats.m_ResidentBytes += entry.m_BytesFrom[entry.m_ResidentMip];
+	m_Stats.m_TextureCount++;
+	return texture;
+}
+
+void TextureResidency::remove(TextureID texture)
+{
+	Entry& entry = m_Entries[texture];
+	m_Stats.m_ResidentBytes -= entry.m_BytesFrom[entry.m_ResidentMip];
+	m_Stats.m_TextureCount--;
+	entry = Entry();
+	m_FreeIDs.push_back(texture);
+
+	// Drop changes that are no longer valid, in case the texture is removed while applying them
+	m_Changes.erase(std::remove_if(m_Changes.begin(), m_Changes.end(), [texture](const Change& change) { return change.m_Texture == texture; }), m_Changes.end());
+}
+
+void TextureResidency::request(TextureID texture, unsigned int topMip)
+{
+	Entry& entry = m_Entries[texture];
+	topMip = std::min(topMip, entry.m_BaseMip);
+	if (isRequested(entry))
+	{
+		entry.m_RequestedMip = std::min(entry.m_RequestedMip, topMip);
+	}
+	else
+	{
+		entry.m_RequestedMip = topMip;
+		entry.m_LastRequestedFrame = m_Frame;
+	}
+}
+
+void TextureResidency::setResidentMip(TextureID texture, unsigned int topMip)
+{
+	Entry& entry = m_Entries[texture];
+	m_Stats.m_ResidentBytes -= entry.m_BytesFrom[entry.m_ResidentMip];
+	m_Stats.m_ResidentBytes += entry.m_BytesFrom[topMip];
+	if (topMip < entry.m_ResidentMip)
+	{
+		m_Stats.m_StreamedInMips += entry.m_ResidentMip - topMip;
+	}
+	else
+	{
+		m_Stats.m_EvictedMips += topMip - entry.m_ResidentMip;
+	}
+	entry.m_ResidentMip = topMip;
+
+	for (auto& change : m_Changes)
+	{
+		if (change.m_Texture == texture)
+		{
+			change.m_TopMip = topMip;
+			return;
+		}
+	}
+	m_Changes.push_back({ texture, topMip });
+}
+
+bool TextureResidency::makeRoom(size_t bytes)
+{
+	if (m_Stats.m_ResidentBytes + bytes <= m_BudgetBytes)
+	{
+		return true;
+	}
+
+	// Textures that were not asked for this frame lose every streamed mip, least recently asked for first.
+	// After them, textures asked for this frame lose the mips they have beyond what they asked for.
+	m_Candidates.clear();
+	for (TextureID texture = 0; texture < m_Entries.size(); texture++)
+	{
+		const Entry& entry = m_Entries[texture];
+		if (!entry.m_IsUsed)
+		{
+			continue;
+		}
+		unsigned int keptMip = isRequested(entry) ? entry.m_RequestedMip : entry.m_BaseMip;
+		if (entry.m_ResidentMip < keptMip)
+		{
+			m_Candidates.push_back(texture);
+		}
+	}
+	std::sort(m_Candidates.begin(), m_Candidates.end(), [this](TextureID a, TextureID b) {
+		return m_Entries[a].m_LastRequestedFrame < m_Entries[b].m_LastRequestedFrame;
+	});
+
+	for (TextureID texture : m_Candidates)
+	{
+		const Entry& entry = m_Entries[texture];
+		setResidentMip(texture, isRequested(entry) ? entry.m_RequestedMip : entry.m_BaseMip);
+		if (m_Stats.m_ResidentBytes + bytes <= m_BudgetBytes)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+const Vector<TextureResidency::Change>& TextureResidency::update()
+{
+	m_Changes.clear();
+
+	// Textures missing the most mips get streamed in first
+	Vector<TextureID> upgrades;
+	m_Stats.m_RequestedCount = 0;
+	m_Stats.m_SatisfiedCount = 0;
+	for (TextureID texture = 0; texture < m_Entries.size(); texture++)
+	{
+		const Entry& entry = m_Entries[texture];
+		if (!entry.m_IsUsed || !isRequested(entry))
+		{
+			continue;
+		}
+		m_Stats.m_RequestedCount++;
+		if (entry.m_RequestedMip < entry.m_ResidentMip)
+		{
+			upgrades.push_back(texture);
+		}
+	}
+	std::stable_sort(upgrades.begin(), upgrades.end(), [this](TextureID a, TextureID b) {
+		return m_Entries[a].m_ResidentMip - m_Entries[a].m_RequestedMip > m_Entries[b].m_ResidentMip - m_Entries[b].m_RequestedMip;
+	});
+	if (upgrades.size() > m_MaxStreamInsPerUpdate)
+	{
+		upgrades.resize(m_MaxStreamInsPerUpdate);
+	}
+
+	for (TextureID texture : upgrades)
+	{
+		const Entry& entry = m_Entries[texture];
+		unsigned int topMip = entry.m_RequestedMip;
+		// Settle for fewer mips if all of them do not fit
+		while (topMip < entry.m_ResidentMip && !makeRoom(entry.m_BytesFrom[topMip] - entry.m_BytesFrom[entry.m_ResidentMip]))
+		{
+			topMip++;
+		}
+		if (topMip < entry.m_ResidentMip)
+		{
+			setResidentMip(texture, topMip);
+		}
+	}
+
+	for (auto& entry : m_Entries)
+	{
+		if (entry.m_IsUsed && isRequested(entry) && entry.m_ResidentMip <= entry.m_RequestedMip)
+		{
+			m_Stats.m_SatisfiedCount++;
+		}
+	}
+	m_Stats.m_BudgetBytes = m_BudgetBytes;
+
+	m_Frame++;
+	return m_Changes;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Counters describing how much of the streamed textures is resident.
+struct TextureResidencyStats
+{
+	/// Bytes of all resident mips, including the low mips that are always resident
+	size_t m_ResidentBytes = 0;
+	size_t m_BudgetBytes = 0;
+	unsigned int m_TextureCount = 0;
+	/// Textures asked for in the last update that have all the mips they asked for
+	unsigned int m_SatisfiedCount = 0;
+	/// Textures asked for in the last update
+	unsigned int m_RequestedCount = 0;
+	/// Mips streamed in and evicted since the residency was created
+	unsigned long long m_StreamedInMips = 0;
+	unsigned long long m_EvictedMips = 0;
+};
+
+/// Decides which mips of streamed textures are resident, without touching the GPU.
+/// Every texture always keeps the mips from its base mip down resident. More detailed mips are streamed in when a texture asks for them,
+/// as long as resident bytes stay inside the budget. When the budget runs out, mips of textures that were asked for least recently are evicted first.
+/// Mips are counted from the most detailed, so a lower top mip means more detail.
+class TextureResidency
+{
+public:
+	typedef int TextureID;
+
+	/// A texture that needs its GPU copy rebuilt with a new top mip
+	struct Change
+	{
+		TextureID m_Texture;
+		unsigned int m_TopMip;
+	};
+
+private:
+	struct Entry
+	{
+		/// Bytes of the mips from each mip down to the smallest, with an extra 0 at the end
+		Vector<size_t> m_BytesFrom;
+		unsigned int m_BaseMip = 0;
+		unsigned int m_ResidentMip = 0;
+		unsigned int m_RequestedMip = 0;
+		unsigned long long m_LastRequestedFrame = 0;
+		bool m_IsUsed = false;
+	};
+
+	Vector<Entry> m_Entries;
+	Vector<TextureID> m_FreeIDs;
+	Vector<Change> m_Changes;
+	Vector<TextureID> m_Candidates;
+	size_t m_BudgetBytes;
+	unsigned int m_MaxStreamInsPerUpdate;
+	/// Starts at 1 so that new textures do not count as asked for
+	unsigned long long m_Frame;
+	TextureResidencyStats m_Stats;
+
+	bool isRequested(const Entry& entry) const { return entry.m_LastRequestedFrame == m_Frame; }
+	void setResidentMip(TextureID texture, unsigned int topMip);
+	/// Evict mips until bytes more fit in the budget. Returns false if they do not fit even after evicting everything possible.
+	bool makeRoom(size_t bytes);
+
+public:
+	TextureResidency(size_t budgetBytes, unsigned int maxStreamInsPerUpdate);
+	TextureResidency(TextureResidency&) = delete;
+	~TextureResidency() = default;
+
+	/// Start tracking a texture with the sizes of its mips, keeping the mips from baseMip down resident. Returns -1 if there are no mips.
+	TextureID add(const Vector<size_t>& mipSizes, unsigned int baseMip);
+	void remove(TextureID texture);
+
+	/// Ask for a texture to have the mips from topMip down resident. The most detailed request since the last update wins.
+	void request(TextureID texture, unsigned int topMip);
+	/// Decide what to stream in and evict, and start the next frame of requests. Returns textures whose resident mips changed.
+	const Vector<Change>& update();
+
+	void setBudget(size_t budgetBytes) { m_BudgetBytes = budgetBytes; }
+	/// Limits how many textures get more detail in one update, to spread the cost of uploads over frames.
+	void setMaxStreamInsPerUpdate(unsigned int count) { m_MaxStreamInsPerUpdate = count; }
+
+	unsigned int getResidentMip(TextureID texture) const { return m_Entries[texture].m_ResidentMip; }
+	const TextureResidencyStats& getStats() const { return m_Stats; }
+};
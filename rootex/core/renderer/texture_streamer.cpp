@@ -0,0 +1,214 @@
+#include "texture_streamer.h"
+
+#include "core/resource_data.h"
+#include "core/resource_loader.h"
+#include "texture.h"
+#include "os/metrics.h"
+#include "os/profiler.h"
+
+TextureStreamer* TextureStreamer::GetSingleton()
+{
+	static TextureStreamer singleton;
+	return &singleton;
+}
+
+TextureStreamer::TextureStreamer()
+    : m_Residency(256 * MB_TO_KB * KB_TO_B, 4)
+    , m_CameraPosition(0.0f, 0.0f, 0.0f)
+    , m_ProjectionScale(0.0f)
+    , m_IsLoaded(false)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	if (m_LoadThread.joinable())
+	{
+		m_LoadThread.join();
+	}
+
+	// Textures held by static resources are destroyed after the streamer
+	for (auto& texture : m_Textures)
+	{
+		if (texture)
+		{
+			texture->m_StreamingID = -1;
+		}
+	}
+}
+
+void TextureStreamer::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<TextureResidencyStats> textureResidencyStats = rootex.new_usertype<TextureResidencyStats>("TextureResidencyStats");
+	textureResidencyStats["residentBytes"] = sol::readonly(&TextureResidencyStats::m_ResidentBytes);
+	textureResidencyStats["budgetBytes"] = sol::readonly(&TextureResidencyStats::m_BudgetBytes);
+	textureResidencyStats["textureCount"] = sol::readonly(&TextureResidencyStats::m_TextureCount);
+	textureResidencyStats["satisfiedCount"] = sol::readonly(&TextureResidencyStats::m_SatisfiedCount);
+	textureResidencyStats["requestedCount"] = sol::readonly(&TextureResidencyStats::m_RequestedCount);
+	textureResidencyStats["streamedInMips"] = sol::readonly(&TextureResidencyStats::m_StreamedInMips);
+	textureResidencyStats["evictedMips"] = sol::readonly(&TextureResidencyStats::m_EvictedMips);
+
+	sol::usertype<TextureStreamer> textureStreamer = rootex.new_usertype<TextureStreamer>("TextureStreamer");
+	textureStreamer["Get"] = &TextureStreamer::GetSingleton;
+	textureStreamer["getStats"] = &TextureStreamer::getStats;
+	textureStreamer["setBudget"] = &TextureStreamer::setBudget;
+	textureStreamer["setMaxStreamInsPerFrame"] = &TextureStreamer::setMaxStreamInsPerFrame;
+}
+
+unsigned int TextureStreamer::GetBaseMip(const CookedTextureMips& mips)
+{
+	// Block compressed textures need every side of their top mip to be a multiple of 4
+	unsigned int baseMip = 0;
+	while (baseMip + 1 < mips.m_Mips.size()
+	    && std::max(mips.m_Mips[baseMip].m_Width, mips.m_Mips[baseMip].m_Height) > TEXTURE_STREAMING_BASE_SIZE
+	    && mips.m_Mips[baseMip + 1].m_Width % 4 == 0
+	    && mips.m_Mips[baseMip + 1].m_Height % 4 == 0)
+	{
+		baseMip++;
+	}
+	return baseMip;
+}
+
+TextureResidency::TextureID TextureStreamer::add(Texture* texture, const CookedTextureMips& mips, unsigned int baseMip)
+{
+	Vector<size_t> mipSizes;
+	for (auto& mip : mips.m_Mips)
+	{
+		mipSizes.push_back(mip.m_Size);
+	}
+
+	TextureResidency::TextureID id = m_Residency.add(mipSizes, baseMip);
+	if (id == -1)
+	{
+		WARN("Texture has no mips to stream");
+		return id;
+	}
+	if (id >= m_Textures.size())
+	{
+		m_Textures.resize(id + 1, nullptr);
+	}
+	m_Textures[id] = texture;
+	return id;
+}
+
+void TextureStreamer::remove(TextureResidency::TextureID texture)
+{
+	m_Residency.remove(texture);
+	m_Textures[texture] = nullptr;
+
+	// The ID can be reused before the loads in flight finish
+	m_PendingMips.erase(texture);
+	for (auto& load : m_Loads)
+	{
+		if (load.m_Texture == texture)
+		{
+			load.m_IsCancelled = true;
+		}
+	}
+}
+
+void TextureStreamer::setCamera(const Vector3& position, const Matrix& projection, float viewportHeight)
+{
+	m_CameraPosition = position;
+	// The projection scales y by the cotangent of half the vertical field of view, and the viewport maps [-1, 1] to its height
+	m_ProjectionScale = projection._22 * viewportHeight * 0.5f;
+}
+
+float TextureStreamer::getScreenSize(const DirectX::BoundingBox& worldBounds) const
+{
+	float radius = Vector3(worldBounds.Extents).Length();
+	float distance = Vector3::Distance(worldBounds.Center, m_CameraPosition);
+	if (distance <= radius)
+	{
+		// Inside the bounds, the texture could be right in front of the camera
+		return FLT_MAX;
+	}
+	return 2.0f * radius / distance * m_ProjectionScale;
+}
+
+void TextureStreamer::request(Texture* texture, float screenSize)
+{
+	if (!texture->isStreamed())
+	{
+		return;
+	}
+
+	// Each mip halves the size, so the mip with about one texel per pixel is enough
+	float texelsPerPixel = std::max(texture->getWidth(), texture->getHeight()) / std::max(screenSize, 1.0f);
+	unsigned int topMip = texelsPerPixel > 1.0f ? (unsigned int)log2f(texelsPerPixel) : 0;
+	m_Residency.request(texture->getStreamingID(), topMip);
+}
+
+void TextureStreamer::startLoads()
+{
+	m_Loads.clear();
+	for (auto& [id, topMip] : m_PendingMips)
+	{
+		Texture* texture = m_Textures[id];
+		if (texture && texture->getResidentMip() != topMip)
+		{
+			MipLoad load;
+			load.m_Texture = id;
+			load.m_TopMip = topMip;
+			load.m_Path = ResourceLoader::GetImageDataPath(texture->m_ImageFile);
+			m_Loads.push_back(std::move(load));
+		}
+	}
+	m_PendingMips.clear();
+
+	if (!m_Loads.empty())
+	{
+		m_IsLoaded = false;
+		m_LoadThread = std::thread(&TextureStreamer::readLoads, this);
+	}
+}
+
+void TextureStreamer::readLoads()
+{
+	for (auto& load : m_Loads)
+	{
+		load.m_Data = ResourceLoader::LoadFileContents(load.m_Path);
+		load.m_IsRead = TextureCooker::ReadMips(load.m_Data.data(), load.m_Data.size(), load.m_Mips) && load.m_TopMip < load.m_Mips.m_Mips.size();
+	}
+	m_IsLoaded = true;
+}
+
+void TextureStreamer::applyLoads()
+{
+	for (auto& load : m_Loads)
+	{
+		Texture* texture = m_Textures.size() > load.m_Texture ? m_Textures[load.m_Texture] : nullptr;
+		if (load.m_IsCancelled || !texture)
+		{
+			continue;
+		}
+		if (!load.m_IsRead)
+		{
+			WARN("Could not stream mips of texture: " + load.m_Path);
+			continue;
+		}
+		texture->setResidentMip(load.m_TopMip, load.m_Mips);
+	}
+	m_Loads.clear();
+}
+
+void TextureStreamer::update()
+{
+	PROFILE_FUNCTION();
+	if (m_LoadThread.joinable() && m_IsLoaded)
+	{
+		m_LoadThread.join();
+		applyLoads();
+	}
+
+	// Changes decided while a load is in flight wait for it, and only the latest change of each texture is read
+	for (auto& change : m_Residency.update())
+	{
+		m_PendingMips[change.m_Texture] = change.m_TopMip;
+	}
+	if (!m_LoadThread.joinable() && !m_PendingMips.empty())
+	{
+		startLoads();
+	}
+	METRIC_GAUGE("Textures/Resident Memory", getStats().m_ResidentBytes, MetricUnit::Bytes);
+}
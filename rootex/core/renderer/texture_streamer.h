@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/common.h"
+#include "core/texture_cooker.h"
+#include "texture_residency.h"
+
+#include <atomic>
+#include <thread>
+
+/// Cooked textures start streaming with their base mip on top, which is the largest mip at most this many pixels on a side
+#define TEXTURE_STREAMING_BASE_SIZE 64
+
+class Texture;
+
+/// Streams mips of cooked textures in and out of video memory, following how large the textures appear on screen.
+/// Screen sizes are estimated on the CPU from the bounds of the meshes drawn with each texture and the camera.
+/// Which mips are resident is decided by a TextureResidency, that keeps resident bytes inside a budget.
+/// Cooked images are read on a background thread, and only the textures are made again on the render thread.
+class TextureStreamer
+{
+	/// Mips of a texture being read on the background thread
+	struct MipLoad
+	{
+		TextureResidency::TextureID m_Texture;
+		unsigned int m_TopMip;
+		String m_Path;
+		FileBuffer m_Data;
+		/// Points into m_Data
+		CookedTextureMips m_Mips;
+		bool m_IsRead = false;
+		/// Set on the render thread if the texture is removed while its mips are read
+		bool m_IsCancelled = false;
+	};
+
+	TextureResidency m_Residency;
+	/// Streamed textures, indexed by their TextureResidency::TextureID
+	Vector<Texture*> m_Textures;
+	Vector3 m_CameraPosition;
+	/// Pixels on screen covered by 1 unit at a distance of 1 unit
+	float m_ProjectionScale;
+
+	/// Most detailed mip decided for each texture, waiting for the loads in flight to finish
+	Map<TextureResidency::TextureID, unsigned int> m_PendingMips;
+	Vector<MipLoad> m_Loads;
+	std::thread m_LoadThread;
+	std::atomic<bool> m_IsLoaded;
+
+	TextureStreamer();
+	TextureStreamer(TextureStreamer&) = delete;
+	~TextureStreamer();
+
+	void startLoads();
+	/// Runs on the background thread. Must not touch textures or image files.
+	void readLoads();
+	void applyLoads();
+
+public:
+	static TextureStreamer* GetSingleton();
+	static void RegisterAPI(sol::state& rootex);
+
+	/// Mip that a cooked texture starts streaming from. Returns 0 if the texture is too small to be streamed.
+	static unsigned int GetBaseMip(const CookedTextureMips& mips);
+
+	/// Start streaming a texture that has the mips from baseMip down resident. Returns its ID in the TextureResidency, or -1 if it can not be streamed.
+	TextureResidency::TextureID add(Texture* texture, const CookedTextureMips& mips, unsigned int baseMip);
+	void remove(TextureResidency::TextureID texture);
+
+	/// Use a camera for screen size estimates. viewportHeight is in pixels.
+	void setCamera(const Vector3& position, const Matrix& projection, float viewportHeight);
+	/// Estimated height in pixels of bounds on screen, as seen by the camera.
+	float getScreenSize(const DirectX::BoundingBox& worldBounds) const;
+	/// Ask for enough mips to draw a texture screenSize pixels tall.
+	void request(Texture* texture, float screenSize);
+	/// Swap in the mips read since the last update, and start reading the mips decided by the requests since then. Call once per frame on the render thread.
+	void update();
+
+	void setBudget(size_t budgetBytes) { m_Residency.setBudget(budgetBytes); }
+	void setMaxStreamInsPerFrame(unsigned int count) { m_Residency.setMaxStreamInsPerUpdate(count); }
+	const TextureResidencyStats& getStats() const { return m_Residency.getStats(); }
+};
@@ -3,18 +3,23 @@
 #include "rendering_device.h"
 
 VertexBuffer::VertexBuffer(const Vector<VertexData>& buffer)
+    : VertexBuffer(buffer.data(), buffer.size())
+{
+}
+
+VertexBuffer::VertexBuffer(const VertexData* buffer, unsigned int count)
     : m_Stride(sizeof(VertexData))
-    , m_Count(buffer.size())
+    , m_Count(count)
 {
 	D3D11_BUFFER_DESC vbd = { 0 };
 	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vbd.Usage = D3D11_USAGE_DYNAMIC;
 	vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	vbd.MiscFlags = 0u;
-	vbd.ByteWidth = sizeof(VertexData) * buffer.size();
+	vbd.ByteWidth = sizeof(VertexData) * count;
 	vbd.StructureByteStride = sizeof(VertexData);
 	D3D11_SUBRESOURCE_DATA vsd = { 0 };
-	vsd.pSysMem = buffer.data();
+	vsd.pSysMem = buffer;
 	
 	const UINT offset = 0u;
 	m_VertexBuffer = RenderingDevice::GetSingleton()->createVertexBuffer(&vbd, &vsd, &m_Stride, &offset);
@@ -1,5 +1,7 @@
 #include "core/resource_data.h"
 
+#include "os/memory_mapped_file.h"
+
 unsigned int ResourceData::s_Count = 0;
 
 unsigned int ResourceData::getID()
@@ -12,16 +14,54 @@ FilePath ResourceData::getPath()
 	return m_Path;
 }
 
+const char* ResourceData::getView() const
+{
+	if (m_MappedFile)
+	{
+		return m_MappedFile->getData() + m_MappedOffset;
+	}
+	return m_FileBuffer.data();
+}
+
 FileBuffer* ResourceData::getRawData()
 {
+	if (m_MappedFile)
+	{
+		const char* view = getView();
+		m_FileBuffer.assign(view, view + m_MappedSize);
+		m_MappedFile.reset();
+	}
 	return &m_FileBuffer;
 }
 
-unsigned int ResourceData::getRawDataByteSize()
+unsigned int ResourceData::getRawDataByteSize() const
 {
+	if (m_MappedFile)
+	{
+		return m_MappedSize;
+	}
 	return m_FileBuffer.size();
 }
 
+void ResourceData::setData(FileBuffer&& data)
+{
+	m_FileBuffer = std::move(data);
+	m_MappedFile.reset();
+}
+
+void ResourceData::setData(Ref<MemoryMappedFile> mappedFile)
+{
+	setData(mappedFile, 0, mappedFile->getSize());
+}
+
+void ResourceData::setData(Ref<MemoryMappedFile> mappedFile, size_t offset, size_t size)
+{
+	m_MappedFile = mappedFile;
+	m_MappedOffset = offset;
+	m_MappedSize = size;
+	m_FileBuffer = FileBuffer();
+}
+
 void ResourceData::setPath(String path)
 {
 	m_Path = path;
@@ -31,9 +71,9 @@ ResourceData& ResourceData::operator>>(char& fillIn)
 {
 	if (m_StreamStart != m_StreamEnd)
 	{
+		fillIn = *m_StreamStart;
 		m_StreamStart++;
 	}
-	fillIn = *m_StreamStart;
 
 	return *this;
 }
@@ -45,8 +85,8 @@ ResourceData::operator bool() const
 
 void ResourceData::startStream()
 {
-	m_StreamStart = &m_FileBuffer.front();
-	m_StreamEnd = &m_FileBuffer.back();
+	m_StreamStart = getView();
+	m_StreamEnd = m_StreamStart + getRawDataByteSize();
 }
 
 bool ResourceData::isEndOfFile()
@@ -56,13 +96,29 @@ bool ResourceData::isEndOfFile()
 
 void ResourceData::resetStream()
 {
-	m_StreamStart = &m_FileBuffer.front();
+	startStream();
+}
+
+ResourceData::ResourceData(FilePath path, FileBuffer&& data)
+    : m_ID(s_Count)
+    , m_FileBuffer(std::move(data))
+    , m_MappedOffset(0)
+    , m_MappedSize(0)
+    , m_Path(path)
+    , m_StreamStart(nullptr)
+    , m_StreamEnd(nullptr)
+{
+	s_Count++;
 }
 
-ResourceData::ResourceData(FilePath path, FileBuffer& data)
+ResourceData::ResourceData(FilePath path, Ref<MemoryMappedFile> mappedFile)
     : m_ID(s_Count)
-    , m_FileBuffer(data)
+    , m_MappedFile(mappedFile)
+    , m_MappedOffset(0)
+    , m_MappedSize(mappedFile->getSize())
     , m_Path(path)
+    , m_StreamStart(nullptr)
+    , m_StreamEnd(nullptr)
 {
 	s_Count++;
 }
@@ -16,7 +16,10 @@
 /// Convert megabytes to gigabytes
 #define MB_TO_GB (1.0f / GB_TO_MB)
 
+class MemoryMappedFile;
+
 /// Representation of a ResourceFile data buffer. Contains a faceless collection of bytes loaded from disk.
+/// The bytes are either owned in a buffer or viewed through a memory mapping of the file, which avoids copying large files.
 class ResourceData
 {
 	static unsigned int s_Count;
@@ -24,28 +27,43 @@ class ResourceData
 protected:
 	unsigned int m_ID;
 	FileBuffer m_FileBuffer;
+	Ref<MemoryMappedFile> m_MappedFile;
+	/// Range of the mapping that holds the data, for files that are only a part of a mapped file
+	size_t m_MappedOffset;
+	size_t m_MappedSize;
 	FilePath m_Path;
 
-	char* m_StreamStart;
+	const char* m_StreamStart;
 	const char* m_StreamEnd;
 
 public:
-	ResourceData(FilePath path, FileBuffer& data);
+	ResourceData(FilePath path, FileBuffer&& data);
+	ResourceData(FilePath path, Ref<MemoryMappedFile> mappedFile);
 	~ResourceData() = default;
 
 	unsigned int getID();
 	FilePath getPath();
-	/// Get the collection of bytes in a file
+	/// Get the bytes in a file without copying them, whether they are owned or mapped
+	const char* getView() const;
+	/// Get the collection of bytes in a file, for changing them. Mapped data gets copied into an owned buffer first.
 	FileBuffer* getRawData();
 	/// Get the number of bytes in a file
-	unsigned int getRawDataByteSize();
+	unsigned int getRawDataByteSize() const;
+	bool isMapped() const { return m_MappedFile != nullptr; }
+
+	/// Replace the data with a buffer, dropping any mapping
+	void setData(FileBuffer&& data);
+	/// Replace the data with a mapping, dropping any owned buffer
+	void setData(Ref<MemoryMappedFile> mappedFile);
+	/// Replace the data with a range of a mapping, dropping any owned buffer
+	void setData(Ref<MemoryMappedFile> mappedFile, size_t offset, size_t size);
 
 	/// Set the path of file loaded. Potentially dangerous to use if you don't know what gets effected.
 	void setPath(String path);
 
 	/// Stream-like operator to get the file data byte-by-byte
 	ResourceData& operator>>(char& fillIn);
-	/// Returns false if data is empty
+	/// Returns false if the stream has reached the end of the data
 	operator bool() const;
 	/// Begin stream-like access
 	void startStream();
@@ -4,9 +4,12 @@
 #include <sstream>
 
 #include "resource_loader.h"
+#include "file_watcher.h"
+#include "audio/audio_stream.h"
 #include "framework/systems/audio_system.h"
 #include "renderer/rendering_device.h"
 #include "interpreter.h"
+#include "os/timer.h"
 
 ResourceFile::ResourceFile(const Type& type, ResourceData* resData)
     : m_Type(type)
@@ -14,7 +17,8 @@ ResourceFile::ResourceFile(const Type& type, ResourceData* resData)
 {
 	PANIC(resData == nullptr, "Null resource found. Resource of this type has not been loaded correctly: " + std::to_string((int)type));
 	m_LastReadTime = OS::s_FileSystemClock.now();
-	m_LastChangedTime = OS::GetFileLastChangedTime(getPath().string());
+	m_LastChangedTime = ResourceLoader::GetFileLastChangedTime(getPath().string());
+	FileWatcher::GetSingleton()->markClean(getPath().generic_string());
 }
 
 void ResourceFile::RegisterAPI(sol::state& rootex)
@@ -58,21 +62,31 @@ ResourceData* ResourceFile::getData()
 
 const FileTimePoint& ResourceFile::getLastChangedTime()
 {
-	m_LastChangedTime = OS::GetFileLastChangedTime(getPath().string());
+	// The disk only needs to be checked once the file watcher has seen the file change
+	if (!FileWatcher::GetSingleton()->isWatching() || FileWatcher::GetSingleton()->isDirty(getPath().generic_string()))
+	{
+		m_LastChangedTime = ResourceLoader::GetFileLastChangedTime(getPath().string());
+	}
 	return m_LastChangedTime;
 }
 
 bool ResourceFile::isDirty()
 {
+	if (FileWatcher::GetSingleton()->isWatching())
+	{
+		return FileWatcher::GetSingleton()->isDirty(getPath().generic_string());
+	}
 	return getLastReadTime() < getLastChangedTime();
 }
 
 AudioResourceFile::AudioResourceFile(ResourceData* resData)
     : ResourceFile(Type::Audio, resData)
     , m_AudioDataSize(0)
+    , m_AudioDataOffset(0)
+    , m_IsVorbis(false)
     , m_BitDepth(0)
     , m_Channels(0)
-    , m_DecompressedAudioBuffer(nullptr)
+    , m_Duration(0)
     , m_Format(0)
     , m_Frequency(0)
 {
@@ -82,6 +96,18 @@ AudioResourceFile::~AudioResourceFile()
 {
 }
 
+const char* AudioResourceFile::getAudioData()
+{
+	FileBuffer* audioData = m_ResourceData->getRawData();
+	if (audioData->empty() && m_AudioDataSize > 0)
+	{
+		AudioStream stream(this);
+		audioData->resize(m_AudioDataSize);
+		audioData->resize(stream.read(audioData->data(), m_AudioDataSize));
+	}
+	return audioData->data();
+}
+
 void AudioResourceFile::RegisterAPI(sol::state& rootex)
 {
 	sol::usertype<AudioResourceFile> audioResourceFile = rootex.new_usertype<AudioResourceFile>(
@@ -129,9 +155,7 @@ void TextResourceFile::append(const String& add)
 
 String TextResourceFile::getString() const
 {
-	return String(
-	    m_ResourceData->getRawData()->begin(),
-	    m_ResourceData->getRawData()->end());
+	return String(m_ResourceData->getView(), m_ResourceData->getRawDataByteSize());
 }
 
 LuaTextResourceFile::LuaTextResourceFile(ResourceData* resData)
@@ -143,6 +167,40 @@ LuaTextResourceFile::~LuaTextResourceFile()
 {
 }
 
+static int WriteBytecode(lua_State* state, const void* data, size_t size, void* userData)
+{
+	((String*)userData)->append((const char*)data, size);
+	return 0;
+}
+
+void LuaTextResourceFile::compile()
+{
+	Timer compileTimer;
+	m_Bytecode.clear();
+
+	lua_State* state = LuaInterpreter::GetSingleton()->getLuaState().lua_state();
+	const String& source = getString();
+	if (luaL_loadbuffer(state, source.data(), source.size(), getChunkName().c_str()) != LUA_OK)
+	{
+		WARN("Could not compile Lua file: " + String(lua_tostring(state, -1)));
+		lua_pop(state, 1);
+		return;
+	}
+	lua_dump(state, WriteBytecode, &m_Bytecode, 0);
+	lua_pop(state, 1);
+
+	LOG_INFO("Compiled {} in {}ms", getPath(), compileTimer.getTimeMs());
+}
+
+const String& LuaTextResourceFile::getBytecode()
+{
+	if (m_Bytecode.empty())
+	{
+		compile();
+	}
+	return m_Bytecode;
+}
+
 void LuaTextResourceFile::RegisterAPI(sol::state& rootex)
 {
 	sol::usertype<LuaTextResourceFile> luaTextResourceFile = rootex.new_usertype<LuaTextResourceFile>(
@@ -194,7 +252,7 @@ FontResourceFile::~FontResourceFile()
 
 void FontResourceFile::regenerateFont()
 {
-	m_Font = RenderingDevice::GetSingleton()->createFont(m_ResourceData->getRawData());
+	m_Font = RenderingDevice::GetSingleton()->createFont(m_ResourceData->getView(), m_ResourceData->getRawDataByteSize());
 	m_Font->SetDefaultCharacter('X');
 }
 
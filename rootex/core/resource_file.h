@@ -42,7 +42,7 @@ public:
 
 	/// If the file was correctly loaded and set up. Should not return false without ResourceLoader showing an error.
 	bool isValid();
-	/// If the file has been changed on disk.
+	/// If the file has been changed on disk. Only checks the disk when the FileWatcher is not running.
 	bool isDirty();
 	/// If the file data has been loaded properly.
 	bool isOpen();
@@ -77,24 +77,35 @@ public:
 	String getString() const;
 };
 
-/// Representation of a text file that has Lua code.
+/// Representation of a text file that has Lua code. Caches the compiled chunk so that the source is compiled only once.
 class LuaTextResourceFile : public TextResourceFile
 {
+	/// Compiled Lua chunk. Empty till the file is compiled or if compilation failed.
+	String m_Bytecode;
+
 	explicit LuaTextResourceFile(ResourceData* resData);
 	~LuaTextResourceFile();
 
 	friend class ResourceLoader;
 
+	void compile();
+
 public:
 	static void RegisterAPI(sol::state& rootex);
 	explicit LuaTextResourceFile(TextResourceFile&) = delete;
 	explicit LuaTextResourceFile(TextResourceFile&&) = delete;
+
+	/// Get the compiled Lua chunk of this file, compiling the source on first use. Returns an empty string if the source does not compile.
+	const String& getBytecode();
+	/// Name of the chunk used in Lua error messages.
+	String getChunkName() const { return "@" + getPath().generic_string(); }
 };
 
 typedef int ALsizei;
 typedef int ALenum;
 
-/// Representation of an audio file. Only .wav files are supported.
+/// Representation of an audio file. PCM .wav and Ogg Vorbis .ogg files are supported.
+/// Only the header is read on load. The PCM data, decoded to 16 bit for .ogg files, is either streamed from disk with AudioStream or loaded whole on first use by getAudioData().
 class AudioResourceFile : public ResourceFile
 {
 	ALenum m_Format;
@@ -103,8 +114,10 @@ class AudioResourceFile : public ResourceFile
 	int m_Channels;
 	float m_Duration;
 
-	const char* m_DecompressedAudioBuffer;
+	/// Offset of the PCM data from the start of the file. 0 for .ogg files.
+	unsigned int m_AudioDataOffset;
 	ALsizei m_AudioDataSize;
+	bool m_IsVorbis;
 
 	explicit AudioResourceFile(ResourceData* resData);
 	~AudioResourceFile();
@@ -116,8 +129,15 @@ public:
 	explicit AudioResourceFile(AudioResourceFile&) = delete;
 	explicit AudioResourceFile(AudioResourceFile&&) = delete;
 
+	/// Load all PCM data into memory, if not loaded already. Prefer AudioStream for long audio.
+	const char* getAudioData();
 	/// Get size of decompressed audio data.
 	ALsizei getAudioDataSize() const { return m_AudioDataSize; }
+	unsigned int getAudioDataOffset() const { return m_AudioDataOffset; }
+	/// If the file is Ogg Vorbis, which has to be decoded to get its PCM data.
+	bool isVorbis() const { return m_IsVorbis; }
+	/// Size of one sample frame across all channels, in bytes.
+	int getBlockAlign() const { return m_Channels * m_BitDepth / 8; }
 	/// Returns the same enum value that OpenAL uses.
 	ALenum getFormat() const { return m_Format; }
 	float getFrequency() const { return m_Frequency; }
@@ -149,6 +169,7 @@ public:
 };
 
 /// Representation of an image file. Supports BMP, JPEG, PNG, TIFF, GIF, HD Photo, or other WIC supported file containers
+/// Loads the cooked .dds texture of the image instead, if it is up to date.
 class ImageResourceFile : public ResourceFile
 {
 	explicit ImageResourceFile(ResourceData* resData);
@@ -0,0 +1,140 @@
+#include "resource_graph.h"
+
+#include "common/common.h"
+#include "file_watcher.h"
+
+ResourceGraph* ResourceGraph::GetSingleton()
+{
+	static ResourceGraph singleton;
+	return &singleton;
+}
+
+void ResourceGraph::setDependencies(const String& dependent, const Vector<String>& dependencies)
+{
+	removeDependent(dependent);
+
+	// Paths are compared the way the file watcher reports them
+	HashSet<String>& nodeDependencies = m_Dependencies[FileWatcher::NormalizePath(dependent)];
+	for (auto& dependency : dependencies)
+	{
+		String node = FileWatcher::NormalizePath(dependency);
+		nodeDependencies.insert(node);
+		m_Dependents[node].insert(FileWatcher::NormalizePath(dependent));
+	}
+}
+
+void ResourceGraph::removeDependent(const String& dependent)
+{
+	String node = FileWatcher::NormalizePath(dependent);
+	auto&& findIt = m_Dependencies.find(node);
+	if (findIt == m_Dependencies.end())
+	{
+		return;
+	}
+
+	for (auto& dependency : findIt->second)
+	{
+		auto&& dependents = m_Dependents.find(dependency);
+		dependents->second.erase(node);
+		if (dependents->second.empty())
+		{
+			m_Dependents.erase(dependents);
+		}
+	}
+	m_Dependencies.erase(findIt);
+}
+
+bool ResourceGraph::hasNode(const String& node) const
+{
+	String normalized = FileWatcher::NormalizePath(node);
+	return m_Dependencies.find(normalized) != m_Dependencies.end() || m_Dependents.find(normalized) != m_Dependents.end();
+}
+
+Vector<String> ResourceGraph::getDependents(const String& dependency) const
+{
+	auto&& findIt = m_Dependents.find(FileWatcher::NormalizePath(dependency));
+	if (findIt == m_Dependents.end())
+	{
+		return {};
+	}
+	return Vector<String>(findIt->second.begin(), findIt->second.end());
+}
+
+Vector<String> ResourceGraph::getReloadOrder(const Vector<String>& changed) const
+{
+	// Find everything made from the changed nodes
+	HashSet<String> affected;
+	Vector<String> toVisit;
+	for (auto& node : changed)
+	{
+		String normalized = FileWatcher::NormalizePath(node);
+		if (affected.insert(normalized).second)
+		{
+			toVisit.push_back(normalized);
+		}
+	}
+	while (!toVisit.empty())
+	{
+		String node = toVisit.back();
+		toVisit.pop_back();
+		for (auto& dependent : getDependents(node))
+		{
+			if (affected.insert(dependent).second)
+			{
+				toVisit.push_back(dependent);
+			}
+		}
+	}
+
+	// Sort topologically, counting only dependencies that are affected as well
+	HashMap<String, int> waitingOn;
+	Vector<String> ready;
+	for (auto& node : affected)
+	{
+		int count = 0;
+		auto&& dependencies = m_Dependencies.find(node);
+		if (dependencies != m_Dependencies.end())
+		{
+			for (auto& dependency : dependencies->second)
+			{
+				count += affected.count(dependency);
+			}
+		}
+		waitingOn[node] = count;
+		if (count == 0)
+		{
+			ready.push_back(node);
+		}
+	}
+	// Changed nodes are visited in a stable order, so reloads happen in the same order every time
+	std::sort(ready.begin(), ready.end());
+
+	Vector<String> order;
+	order.reserve(affected.size());
+	for (int i = 0; i < ready.size(); i++)
+	{
+		order.push_back(ready[i]);
+		Vector<String> dependents = getDependents(ready[i]);
+		std::sort(dependents.begin(), dependents.end());
+		for (auto& dependent : dependents)
+		{
+			if (--waitingOn[dependent] == 0)
+			{
+				ready.push_back(dependent);
+			}
+		}
+	}
+
+	if (order.size() < affected.size())
+	{
+		WARN("Resources depend on each other in a cycle, reloading them in any order");
+		for (auto& node : affected)
+		{
+			if (waitingOn[node] > 0)
+			{
+				order.push_back(node);
+			}
+		}
+	}
+	return order;
+}
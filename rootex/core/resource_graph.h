@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Keeps track of which resources are made from which files, so that a changed file only reloads what was made from it.
+/// Nodes are paths relative to Rootex root, or names of things made from files that are not files themselves, like entities.
+/// Only used from the main thread.
+class ResourceGraph
+{
+	/// Nodes made from each node
+	HashMap<String, HashSet<String>> m_Dependents;
+	/// Nodes each node is made from
+	HashMap<String, HashSet<String>> m_Dependencies;
+
+	ResourceGraph() = default;
+	ResourceGraph(ResourceGraph&) = delete;
+	~ResourceGraph() = default;
+
+public:
+	static ResourceGraph* GetSingleton();
+
+	/// Replace what a node is made from.
+	void setDependencies(const String& dependent, const Vector<String>& dependencies);
+	/// Forget a node that is no longer made from anything, like a destroyed entity.
+	void removeDependent(const String& dependent);
+
+	bool hasNode(const String& node) const;
+	/// Nodes made directly from a node.
+	Vector<String> getDependents(const String& dependency) const;
+	/// Changed nodes and every node made from them, directly or not. Each node comes after every affected node it is made from.
+	Vector<String> getReloadOrder(const Vector<String>& changed) const;
+};
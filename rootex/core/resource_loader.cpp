@@ -5,6 +5,7 @@
 #include "common/common.h"
 
 #include "framework/systems/audio_system.h"
+#include "core/audio/vorbis_decoder.h"
 #include "core/renderer/mesh.h"
 #include "core/renderer/vertex_buffer.h"
 #include "core/renderer/index_buffer.h"
@@ -12,6 +13,14 @@
 #include "core/renderer/vertex_data.h"
 #include "script/interpreter.h"
 #include "core/renderer/material_library.h"
+#include "core/mesh_cooker.h"
+#include "core/texture_cooker.h"
+#include "core/file_watcher.h"
+#include "core/resource_graph.h"
+#include "core/content_hash.h"
+#include "os/timer.h"
+#include "os/metrics.h"
+#include "os/memory_mapped_file.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -19,7 +28,7 @@
 
 HashMap<Ptr<ResourceData>, Ptr<ResourceFile>> ResourceLoader::s_ResourcesDataFiles;
 HashMap<ResourceFile::Type, Vector<ResourceFile*>> ResourceLoader::s_ResourceFileLibrary;
-Assimp::Importer ResourceLoader::s_ModelLoader;
+Vector<Ptr<PakArchive>> ResourceLoader::s_Archives;
 
 bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileType)
 {
@@ -32,115 +41,134 @@ bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileTy
 	return false;
 }
 
-void ResourceLoader::LoadAssimp(ModelResourceFile* file)
+void ResourceLoader::LoadModel(ModelResourceFile* file)
 {
-	const aiScene* scene = s_ModelLoader.ReadFile(
-	    file->getPath().generic_string(),
-	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes);
-
-	if (!scene)
+	FileBuffer cooked;
+	if (!ReadModel(file->getPath().generic_string(), cooked))
 	{
-		ERR("Model could not be loaded: " + OS::GetAbsolutePath(file->m_ResourceData->getPath().string()).generic_string());
-		ERR("Assimp: " + s_ModelLoader.GetErrorString());
 		return;
 	}
 
-	file->m_Textures.clear();
-	file->m_Textures.resize(scene->mNumTextures, nullptr);
-	file->m_Meshes.clear();
-	file->m_Meshes.reserve(scene->mNumMeshes);
-	for (int i = 0; i < scene->mNumMeshes; i++)
-	{
-		const aiMesh* mesh = scene->mMeshes[i];
-
-		Vector<VertexData> vertices;
-		vertices.reserve(mesh->mNumVertices);
+	CookedModel model;
+	MeshCooker::Read(cooked.data(), cooked.size(), model);
+	LoadCookedModel(file, model);
+}
 
-		VertexData vertex;
-		ZeroMemory(&vertex, sizeof(VertexData));
-		for (unsigned int v = 0; v < mesh->mNumVertices; v++)
+bool ResourceLoader::ReadModel(const String& path, FileBuffer& cooked)
+{
+	// Cooked models are written next to the source by the cooker, and are only used while they are not older than the source and its dependencies
+	const String cookedPath = MeshCooker::GetCookedPath(path);
+	if (IsExists(cookedPath) && !(GetFileLastChangedTime(cookedPath) < GetFileLastChangedTime(path)))
+	{
+		Timer loadTimer;
+		cooked = LoadFileContents(cookedPath);
+		CookedModel model;
+		if (MeshCooker::Read(cooked.data(), cooked.size(), model))
 		{
-			vertex.m_Position.x = mesh->mVertices[v].x;
-			vertex.m_Position.y = mesh->mVertices[v].y;
-			vertex.m_Position.z = mesh->mVertices[v].z;
-
-			if (mesh->mNormals)
+			bool isUpToDate = true;
+			for (const String& dependency : model.m_Dependencies)
 			{
-				vertex.m_Normal.x = mesh->mNormals[v].x;
-				vertex.m_Normal.y = mesh->mNormals[v].y;
-				vertex.m_Normal.z = mesh->mNormals[v].z;
-			}
-
-			if (mesh->mTextureCoords)
-			{
-				if (mesh->mTextureCoords[0])
+				const String dependencyPath = MeshCooker::GetDependencyPath(path, dependency);
+				if (!IsExists(dependencyPath) || GetFileLastChangedTime(cookedPath) < GetFileLastChangedTime(dependencyPath))
 				{
-					// Assuming the model has texture coordinates and taking only the first texture coordinate in case of multiple texture coordinates
-					vertex.m_TextureCoord.x = mesh->mTextureCoords[0][v].x;
-					vertex.m_TextureCoord.y = mesh->mTextureCoords[0][v].y;
+					isUpToDate = false;
+					break;
 				}
 			}
-
-			vertices.push_back(vertex);
+			if (isUpToDate)
+			{
+				LOG_INFO("Loaded cooked {} in {}ms", cookedPath, loadTimer.getTimeMs());
+				return true;
+			}
 		}
-
-		std::vector<unsigned short> indices;
-
-		aiFace* face = nullptr;
-		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+		else
 		{
-			face = &mesh->mFaces[f];
-			//Model already triangulated by aiProcess_Triangulate so no need to check
-			indices.push_back(face->mIndices[0]);
-			indices.push_back(face->mIndices[1]);
-			indices.push_back(face->mIndices[2]);
+			WARN("Ignoring cooked model that is corrupt or was cooked with other settings: " + cookedPath);
 		}
+	}
+
+	// Every call gets its own importer, so that models can be imported on more than one thread
+	Assimp::Importer importer;
+	const aiScene* scene = nullptr;
+	PakArchive* archive = nullptr;
+	if (FindInArchives(path, archive))
+	{
+		// Assimp can only see the model file itself, so materials in separate files do not get loaded from archives
+		FileBuffer source = LoadFileContents(path);
+		scene = importer.ReadFileFromMemory(
+		    source.data(),
+		    source.size(),
+		    MeshCooker::ImportFlags,
+		    FilePath(path).extension().string().substr(1).c_str());
+	}
+	else
+	{
+		scene = importer.ReadFile(path, MeshCooker::ImportFlags);
+	}
+
+	if (!scene)
+	{
+		ERR("Model could not be loaded: " + OS::GetAbsolutePath(path).generic_string());
+		ERR("Assimp: " + String(importer.GetErrorString()));
+		return false;
+	}
 
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+	// Uncooked models are cooked in memory, so that both take the same path to the GPU
+	MeshCooker::Cook(scene, 0, {}, cooked);
+	return true;
+}
 
-		aiColor3D color(0.0f, 0.0f, 0.0f);
-		if (AI_SUCCESS != material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+void ResourceLoader::LoadCookedModel(ModelResourceFile* file, const CookedModel& model)
+{
+	// Unchanged meshes keep their buffers when a model is reloaded
+	HashMap<unsigned long long, Mesh> loadedMeshes;
+	for (auto& [material, meshes] : file->m_Meshes)
+	{
+		for (auto& mesh : meshes)
 		{
-			WARN("Material does not have color: " + String(material->GetName().C_Str()));
+			loadedMeshes[mesh.m_ContentHash] = mesh;
 		}
+	}
+
+	file->m_Textures.clear();
+	file->m_Textures.resize(model.m_EmbeddedTextures.size(), nullptr);
+	HashMap<Ref<Material>, Vector<Mesh>> extractedMeshes;
+	extractedMeshes.reserve(model.m_Meshes.size());
+	HashSet<String> materialPaths;
+	unsigned int reusedMeshCount = 0;
+	for (auto& mesh : model.m_Meshes)
+	{
+		const CookedMaterial& material = mesh.m_Material;
 
 		Ref<BasicMaterial> extractedMaterial;
-		if (MaterialLibrary::IsExists(material->GetName().C_Str()))
+		if (MaterialLibrary::IsExists(material.m_Name))
 		{
-			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(material->GetName().C_Str() + String(".rmat")));
+			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(material.m_Name + String(".rmat")));
 		}
 		else
 		{
-			MaterialLibrary::CreateNewMaterialFile(material->GetName().C_Str(), "BasicMaterial");
-			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(material->GetName().C_Str() + String(".rmat")));
-			extractedMaterial->setColor({ color.r, color.g, color.b, 1.0f });
+			MaterialLibrary::CreateNewMaterialFile(material.m_Name, "BasicMaterial");
+			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(material.m_Name + String(".rmat")));
+			extractedMaterial->setColor(material.m_Color);
 
-			for (int i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
+			for (auto& texture : material.m_DiffuseTextures)
 			{
-				aiString str;
-				material->GetTexture(aiTextureType_DIFFUSE, i, &str);
-				char embeddedAsterisk = *str.C_Str();
-
-				if (embeddedAsterisk == '*')
+				if (texture.m_EmbeddedIndex >= 0)
 				{
 					// Texture is embedded
-					int textureID = atoi(str.C_Str() + 1);
-
-					if (!file->m_Textures[textureID])
+					const CookedTexture& embeddedTexture = model.m_EmbeddedTextures[texture.m_EmbeddedIndex];
+					if (!file->m_Textures[texture.m_EmbeddedIndex])
 					{
-						aiTexture* texture = scene->mTextures[textureID];
-						size_t size = scene->mTextures[textureID]->mWidth;
-						PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
-						file->m_Textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
+						PANIC(embeddedTexture.m_Size == 0, "Compressed texture found but expected embedded texture");
+						file->m_Textures[texture.m_EmbeddedIndex].reset(new Texture(embeddedTexture.m_Data, embeddedTexture.m_Size));
 					}
 
-					extractedMaterial->setTextureInternal(file->m_Textures[textureID]);
+					extractedMaterial->setTextureInternal(file->m_Textures[texture.m_EmbeddedIndex]);
 				}
 				else
 				{
 					// Texture is given as a path
-					String texturePath = str.C_Str();
-					ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
+					ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texture.m_Path);
 
 					if (image)
 					{
@@ -148,55 +176,236 @@ void ResourceLoader::LoadAssimp(ModelResourceFile* file)
 					}
 					else
 					{
-						WARN("Could not set material diffuse texture: " + texturePath);
+						WARN("Could not set material diffuse texture: " + texture.m_Path);
 					}
 				}
 			}
 		}
 
+		materialPaths.insert(MaterialLibrary::GetMaterialPath(extractedMaterial->getFileName()));
+
+		unsigned long long contentHash = ContentHash::Hash((const char*)mesh.m_Vertices, mesh.m_VertexCount * sizeof(VertexData));
+		contentHash = ContentHash::Hash(mesh.m_Indices, mesh.m_IndexCount * mesh.m_IndexSize, contentHash);
+
 		Mesh extractedMesh;
-		extractedMesh.m_VertexBuffer.reset(new VertexBuffer(vertices));
-		extractedMesh.m_IndexBuffer.reset(new IndexBuffer(indices));
-		
-		file->m_Meshes[extractedMaterial].push_back(extractedMesh);
+		auto&& loadedMesh = loadedMeshes.find(contentHash);
+		if (loadedMesh != loadedMeshes.end())
+		{
+			extractedMesh = loadedMesh->second;
+			reusedMeshCount++;
+		}
+		else
+		{
+			extractedMesh.m_VertexBuffer.reset(new VertexBuffer(mesh.m_Vertices, mesh.m_VertexCount));
+			if (mesh.m_IndexSize == sizeof(unsigned short))
+			{
+				extractedMesh.m_IndexBuffer.reset(new IndexBuffer((const unsigned short*)mesh.m_Indices, mesh.m_IndexCount));
+			}
+			else
+			{
+				extractedMesh.m_IndexBuffer.reset(new IndexBuffer((const int*)mesh.m_Indices, mesh.m_IndexCount));
+			}
+			extractedMesh.m_ContentHash = contentHash;
+		}
+		extractedMesh.m_Bounds = mesh.m_Bounds;
+
+		extractedMeshes[extractedMaterial].push_back(extractedMesh);
+	}
+	file->m_Meshes = std::move(extractedMeshes);
+
+	if (reusedMeshCount > 0)
+	{
+		LOG_INFO("Kept {} unchanged meshes of {}", reusedMeshCount, file->getPath());
+	}
+	ResourceGraph::GetSingleton()->setDependencies(file->getPath().generic_string(), Vector<String>(materialPaths.begin(), materialPaths.end()));
+}
+
+void ResourceLoader::LoadCookedLua(LuaTextResourceFile* file)
+{
+	// Cooked bytecode is written next to the source as .luac, and is only used while it is newer than the source
+	const String cookedPath = file->getPath().generic_string() + "c";
+	if (!IsExists(cookedPath) || GetFileLastChangedTime(cookedPath) < file->getLastChangedTime())
+	{
+		return;
+	}
+
+	Timer loadTimer;
+	FileBuffer buffer = LoadFileContents(cookedPath);
+	if (buffer.size() < sizeof(LUA_SIGNATURE) - 1 || String(buffer.begin(), buffer.begin() + sizeof(LUA_SIGNATURE) - 1) != LUA_SIGNATURE)
+	{
+		WARN("Ignoring cooked Lua file that is not Lua bytecode: " + cookedPath);
+		return;
 	}
+	file->m_Bytecode.assign(buffer.begin(), buffer.end());
+	LOG_INFO("Loaded cooked {} in {}ms", cookedPath, loadTimer.getTimeMs());
 }
 
-void ResourceLoader::LoadALUT(AudioResourceFile* audioRes, const char* audioBuffer, int format, int size, float frequency)
+bool ResourceLoader::LoadWAVHeader(AudioResourceFile* audioRes)
 {
-	audioRes->m_DecompressedAudioBuffer = audioBuffer;
-	audioRes->m_Format = format;
-	audioRes->m_AudioDataSize = size;
-	audioRes->m_Frequency = frequency;
+	Ptr<std::istream> stream = OpenStream(audioRes->getPath().generic_string());
+	if (!stream)
+	{
+		ERR("Could not open audio file: " + audioRes->getPath().generic_string());
+		return false;
+	}
+	std::istream& file = *stream;
+
+	char riff[4];
+	unsigned int riffSize;
+	char wave[4];
+	file.read(riff, 4);
+	file.read((char*)&riffSize, 4);
+	file.read(wave, 4);
+	if (!file || strncmp(riff, "RIFF", 4) != 0 || strncmp(wave, "WAVE", 4) != 0)
+	{
+		ERR("Not a RIFF WAVE file: " + audioRes->getPath().generic_string());
+		return false;
+	}
 
-	switch (audioRes->getFormat())
+	short audioFormat = 0;
+	short channels = 0;
+	unsigned int sampleRate = 0;
+	short bitDepth = 0;
+	bool isFormatFound = false;
+	while (file)
 	{
-	case AL_FORMAT_MONO8:
-		audioRes->m_Channels = 1;
-		audioRes->m_BitDepth = 8;
-		break;
+		char chunkID[4];
+		unsigned int chunkSize;
+		file.read(chunkID, 4);
+		file.read((char*)&chunkSize, 4);
+		if (!file)
+		{
+			break;
+		}
 
-	case AL_FORMAT_MONO16:
-		audioRes->m_Channels = 1;
-		audioRes->m_BitDepth = 16;
-		break;
+		if (strncmp(chunkID, "fmt ", 4) == 0)
+		{
+			unsigned int byteRate;
+			short blockAlign;
+			file.read((char*)&audioFormat, 2);
+			file.read((char*)&channels, 2);
+			file.read((char*)&sampleRate, 4);
+			file.read((char*)&byteRate, 4);
+			file.read((char*)&blockAlign, 2);
+			file.read((char*)&bitDepth, 2);
+			file.seekg(chunkSize - 16 + (chunkSize & 1), std::ios::cur);
+			isFormatFound = true;
+		}
+		else if (strncmp(chunkID, "data", 4) == 0)
+		{
+			if (!isFormatFound)
+			{
+				break;
+			}
+			audioRes->m_AudioDataOffset = (unsigned int)file.tellg();
+			audioRes->m_AudioDataSize = chunkSize;
+			break;
+		}
+		else
+		{
+			// Chunks are padded to an even size
+			file.seekg(chunkSize + (chunkSize & 1), std::ios::cur);
+		}
+	}
+
+	if (!isFormatFound || audioRes->m_AudioDataOffset == 0)
+	{
+		ERR("WAV file is missing its format or data chunk: " + audioRes->getPath().generic_string());
+		return false;
+	}
 
-	case AL_FORMAT_STEREO8:
-		audioRes->m_Channels = 2;
-		audioRes->m_BitDepth = 8;
-		break;
+	// 1 is uncompressed PCM, the only encoding OpenAL can take directly
+	if (audioFormat != 1)
+	{
+		ERR("Only PCM WAV files are supported: " + audioRes->getPath().generic_string());
+		return false;
+	}
 
-	case AL_FORMAT_STEREO16:
-		audioRes->m_Channels = 2;
-		audioRes->m_BitDepth = 16;
-		break;
+	audioRes->m_IsVorbis = false;
+	audioRes->m_Channels = channels;
+	audioRes->m_BitDepth = bitDepth;
+	audioRes->m_Frequency = sampleRate;
 
-	default:
+	if (channels == 1 && bitDepth == 8)
+	{
+		audioRes->m_Format = AL_FORMAT_MONO8;
+	}
+	else if (channels == 1 && bitDepth == 16)
+	{
+		audioRes->m_Format = AL_FORMAT_MONO16;
+	}
+	else if (channels == 2 && bitDepth == 8)
+	{
+		audioRes->m_Format = AL_FORMAT_STEREO8;
+	}
+	else if (channels == 2 && bitDepth == 16)
+	{
+		audioRes->m_Format = AL_FORMAT_STEREO16;
+	}
+	else
+	{
 		ERR("Unknown channels and bit depth in WAV data");
+		return false;
+	}
+
+	audioRes->m_Duration = audioRes->m_AudioDataSize / (float)(audioRes->getBlockAlign() * sampleRate);
+	return true;
+}
+
+bool ResourceLoader::LoadVorbisHeader(AudioResourceFile* audioRes)
+{
+	Ptr<std::istream> stream = OpenStream(audioRes->getPath().generic_string());
+	if (!stream)
+	{
+		ERR("Could not open audio file: " + audioRes->getPath().generic_string());
+		return false;
+	}
+
+	VorbisDecoder decoder(*stream);
+	if (!decoder.open())
+	{
+		ERR("Not an Ogg Vorbis file that can be decoded: " + audioRes->getPath().generic_string());
+		return false;
+	}
+
+	// Vorbis is always decoded to 16 bit samples
+	audioRes->m_IsVorbis = true;
+	audioRes->m_Channels = decoder.getChannels();
+	audioRes->m_BitDepth = 16;
+	audioRes->m_Frequency = decoder.getSampleRate();
+	if (decoder.getChannels() == 1)
+	{
+		audioRes->m_Format = AL_FORMAT_MONO16;
+	}
+	else if (decoder.getChannels() == 2)
+	{
+		audioRes->m_Format = AL_FORMAT_STEREO16;
+	}
+	else
+	{
+		ERR("Only mono and stereo Ogg Vorbis files are supported: " + audioRes->getPath().generic_string());
+		return false;
 	}
 
-	audioRes->m_Duration = size * 8 / (audioRes->m_Channels * audioRes->m_BitDepth);
-	audioRes->m_Duration /= frequency;
+	unsigned long long dataSize = decoder.getFrameCount() * audioRes->getBlockAlign();
+	if (dataSize > INT_MAX)
+	{
+		ERR("Ogg Vorbis file is too long to decode: " + audioRes->getPath().generic_string());
+		return false;
+	}
+	audioRes->m_AudioDataOffset = 0;
+	audioRes->m_AudioDataSize = (ALsizei)dataSize;
+	audioRes->m_Duration = decoder.getFrameCount() / (float)decoder.getSampleRate();
+	return true;
+}
+
+bool ResourceLoader::LoadAudioHeader(AudioResourceFile* audioRes)
+{
+	if (audioRes->getPath().extension() == ".ogg")
+	{
+		return LoadVorbisHeader(audioRes);
+	}
+	return LoadWAVHeader(audioRes);
 }
 
 void ResourceLoader::RegisterAPI(sol::state& rootex)
@@ -209,6 +418,7 @@ void ResourceLoader::RegisterAPI(sol::state& rootex)
 	resourceLoader["CreateText"] = &ResourceLoader::CreateTextResourceFile;
 	resourceLoader["CreateNewText"] = &ResourceLoader::CreateNewTextResourceFile;
 	resourceLoader["CreateVisualModel"] = &ResourceLoader::CreateModelResourceFile;
+	resourceLoader["MountArchive"] = &ResourceLoader::MountArchive;
 }
 
 TextResourceFile* ResourceLoader::CreateTextResourceFile(const String& path)
@@ -221,15 +431,14 @@ TextResourceFile* ResourceLoader::CreateTextResourceFile(const String& path)
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 
 	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
+	ResourceData* resData = new ResourceData(path, LoadFileContents(path));
 	TextResourceFile* textRes = new TextResourceFile(ResourceFile::Type::Text, resData);
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(textRes);
@@ -239,7 +448,7 @@ TextResourceFile* ResourceLoader::CreateTextResourceFile(const String& path)
 
 TextResourceFile* ResourceLoader::CreateNewTextResourceFile(const String& path)
 {
-	if (!OS::IsExists(path))
+	if (!IsExists(path))
 	{
 		OS::CreateFileName(path);
 	}
@@ -256,16 +465,16 @@ LuaTextResourceFile* ResourceLoader::CreateLuaTextResourceFile(const String& pat
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 
 	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
+	ResourceData* resData = new ResourceData(path, LoadFileContents(path));
 	LuaTextResourceFile* luaRes = new LuaTextResourceFile(resData);
+	LoadCookedLua(luaRes);
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(luaRes);
 	s_ResourceFileLibrary[ResourceFile::Type::Lua].push_back(luaRes);
@@ -283,32 +492,22 @@ AudioResourceFile* ResourceLoader::CreateAudioResourceFile(const String& path)
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 
-	// File not found in cache, load it only once
-	const char* audioBuffer;
-	int format;
-	int size;
-	float frequency;
-	ALUT_CHECK(audioBuffer = (const char*)alutLoadMemoryFromFile(
-	               OS::GetAbsolutePath(path).generic_string().c_str(),
-	               &format,
-	               &size,
-	               &frequency));
-
-	Vector<char> dataArray;
-	dataArray.insert(
-	    dataArray.begin(),
-	    audioBuffer,
-	    audioBuffer + size);
-	ResourceData* resData = new ResourceData(path, dataArray);
+	// File not found in cache, load it only once. PCM data is left on disk till it is streamed or asked for.
+	ResourceData* resData = new ResourceData(path, FileBuffer());
 
 	AudioResourceFile* audioRes = new AudioResourceFile(resData);
-	LoadALUT(audioRes, audioBuffer, format, size, frequency);
+	if (!LoadAudioHeader(audioRes))
+	{
+		delete audioRes;
+		delete resData;
+		return nullptr;
+	}
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(audioRes);
 	s_ResourceFileLibrary[ResourceFile::Type::Audio].push_back(audioRes);
@@ -326,17 +525,17 @@ ModelResourceFile* ResourceLoader::CreateModelResourceFile(const String& path)
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 	
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
+	// Models are read from their cooked file or imported by path, so their own data is never loaded
+	ResourceData* resData = new ResourceData(path, FileBuffer());
 	ModelResourceFile* visualRes = new ModelResourceFile(resData);
 	
-	LoadAssimp(visualRes);
+	LoadModel(visualRes);
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(visualRes);
 	s_ResourceFileLibrary[ResourceFile::Type::Model].push_back(visualRes);
@@ -354,15 +553,14 @@ ImageResourceFile* ResourceLoader::CreateImageResourceFile(const String& path)
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
+	// File not found in cache. The data is only read when a texture is made from it, which releases it again.
+	ResourceData* resData = new ResourceData(path, FileBuffer());
 	ImageResourceFile* imageRes = new ImageResourceFile(resData);
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(imageRes);
@@ -381,16 +579,17 @@ FontResourceFile* ResourceLoader::CreateFontResourceFile(const String& path)
 		}
 	}
 
-	if (OS::IsExists(path) == false)
+	if (IsExists(path) == false)
 	{
 		ERR("File not found: " + path);
 		return nullptr;
 	}
 
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
+	// File not found in cache, load it only once. The font keeps its own copy of what it needs, so the mapping is released right away.
+	ResourceData* resData = new ResourceData(path, FileBuffer());
+	ReadResourceData(resData, true);
 	FontResourceFile* fontRes = new FontResourceFile(resData);
+	resData->setData(FileBuffer());
 
 	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(fontRes);
 	s_ResourceFileLibrary[ResourceFile::Type::Font].push_back(fontRes);
@@ -404,15 +603,145 @@ void ResourceLoader::SaveResourceFile(ResourceFile* resourceFile)
 	PANIC(saved == false, "Old resource could not be located for saving file: " + resourceFile->getPath().generic_string());
 }
 
-void ResourceLoader::ReloadResourceData(const String& path)
+const PakEntry* ResourceLoader::FindInArchives(const String& path, PakArchive*& archive)
+{
+	for (auto it = s_Archives.rbegin(); it != s_Archives.rend(); it++)
+	{
+		if (const PakEntry* entry = (*it)->find(path))
+		{
+			archive = it->get();
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool ResourceLoader::MountArchive(const String& path)
+{
+	Ptr<PakArchive> archive = PakArchive::Open(path);
+	if (!archive)
+	{
+		ERR("Could not mount archive: " + path);
+		return false;
+	}
+	PRINT("Mounted archive " + path + " with " + std::to_string(archive->getEntryCount()) + " files");
+	s_Archives.push_back(std::move(archive));
+	return true;
+}
+
+bool ResourceLoader::IsExists(const String& path)
+{
+	PakArchive* archive = nullptr;
+	return FindInArchives(path, archive) || OS::IsExists(path);
+}
+
+FileBuffer ResourceLoader::LoadFileContents(const String& path)
+{
+	PakArchive* archive = nullptr;
+	if (const PakEntry* entry = FindInArchives(path, archive))
+	{
+		return archive->load(entry);
+	}
+	return OS::LoadFileContents(path);
+}
+
+Ptr<std::istream> ResourceLoader::OpenStream(const String& path)
+{
+	PakArchive* archive = nullptr;
+	if (const PakEntry* entry = FindInArchives(path, archive))
+	{
+		return archive->openStream(entry);
+	}
+
+	Ptr<std::istream> stream(new std::ifstream(OS::GetAbsolutePath(path).generic_string(), std::ios::binary));
+	if (!*stream)
+	{
+		return nullptr;
+	}
+	return stream;
+}
+
+ResourceFile* ResourceLoader::FindResourceFile(const String& path)
+{
+	const String normalizedPath = FileWatcher::NormalizePath(path);
+	for (auto& [resData, resFile] : s_ResourcesDataFiles)
+	{
+		if (FileWatcher::NormalizePath(resData->getPath().generic_string()) == normalizedPath)
+		{
+			return resFile.get();
+		}
+	}
+	return nullptr;
+}
+
+FileTimePoint ResourceLoader::GetFileLastChangedTime(const String& path)
+{
+	PakArchive* archive = nullptr;
+	if (FindInArchives(path, archive))
+	{
+		return archive->getLastChangedTime();
+	}
+	return OS::GetFileLastChangedTime(path);
+}
+
+void ResourceLoader::ReadResourceData(ResourceData* resData, bool isMapped)
+{
+	ReadResourceData(resData, resData->getPath().generic_string(), isMapped);
+}
+
+void ResourceLoader::ReadResourceData(ResourceData* resData, const String& path, bool isMapped)
 {
-	FileBuffer& buffer = OS::LoadFileContents(path);
+	PakArchive* archive = nullptr;
+	if (const PakEntry* entry = FindInArchives(path, archive))
+	{
+		if (isMapped)
+		{
+			archive->load(entry, resData);
+		}
+		else
+		{
+			resData->setData(archive->load(entry));
+		}
+		return;
+	}
 
+	if (isMapped)
+	{
+		Ref<MemoryMappedFile> mappedFile = OS::MapFileContents(path);
+		if (mappedFile)
+		{
+			resData->setData(mappedFile);
+			return;
+		}
+		WARN("Reading file instead of mapping it: " + path);
+	}
+	resData->setData(OS::LoadFileContents(path));
+}
+
+String ResourceLoader::GetImageDataPath(ImageResourceFile* file)
+{
+	// Cooked textures are written next to the source by the cooker, and are only used while they are not older than the source
+	const String path = file->getPath().generic_string();
+	const String cookedPath = TextureCooker::GetCookedPath(path);
+	if (IsExists(cookedPath) && !(GetFileLastChangedTime(cookedPath) < file->getLastChangedTime()))
+	{
+		return cookedPath;
+	}
+	return path;
+}
+
+void ResourceLoader::LoadImageData(ImageResourceFile* file)
+{
+	ReadResourceData(file->m_ResourceData, GetImageDataPath(file), true);
+}
+
+void ResourceLoader::ReloadResourceData(const String& path)
+{
 	for (auto&& [resData, resFile] : s_ResourcesDataFiles)
 	{
 		if (resData->getPath() == path)
 		{
-			*resData->getRawData() = buffer;
+			ReadResourceData(resData.get(), resData->isMapped());
 		}
 	}
 }
@@ -420,7 +749,8 @@ void ResourceLoader::ReloadResourceData(const String& path)
 void ResourceLoader::UpdateFileTimes(ResourceFile* file)
 {
 	file->m_LastReadTime = OS::s_FileSystemClock.now();
-	file->m_LastChangedTime = OS::GetFileLastChangedTime(file->getPath().string());
+	file->m_LastChangedTime = GetFileLastChangedTime(file->getPath().string());
+	FileWatcher::GetSingleton()->markClean(file->getPath().generic_string());
 }
 
 void ResourceLoader::Reload(TextResourceFile* file)
@@ -432,49 +762,67 @@ void ResourceLoader::Reload(TextResourceFile* file)
 void ResourceLoader::Reload(LuaTextResourceFile* file)
 {
 	Reload((TextResourceFile*)file);
+	file->m_Bytecode.clear();
+	LoadCookedLua(file);
 }
 
 void ResourceLoader::Reload(AudioResourceFile* file)
 {
 	UpdateFileTimes(file);
-	ReloadResourceData(file->getPath().string());
-	const char* audioBuffer;
-	int format;
-	int size;
-	float frequency;
-	ALUT_CHECK(audioBuffer = (const char*)alutLoadMemoryFromFile(
-	               OS::GetAbsolutePath(file->m_ResourceData->getPath().string()).string().c_str(),
-	               &format,
-	               &size,
-	               &frequency));
-	file->m_ResourceData->getRawData()->clear();
-	file->m_ResourceData->getRawData()->insert(
-	    file->m_ResourceData->getRawData()->begin(),
-	    audioBuffer,
-	    audioBuffer + size);
-
-	AudioResourceFile* audioRes = file;
-	LoadALUT(audioRes, audioBuffer, format, size, frequency);
+
+	bool isDataLoaded = file->m_ResourceData->getRawDataByteSize() > 0;
+	file->m_ResourceData->setData(FileBuffer());
+	LoadAudioHeader(file);
+	if (isDataLoaded)
+	{
+		file->getAudioData();
+	}
 }
 
 void ResourceLoader::Reload(ModelResourceFile* file)
 {
 	UpdateFileTimes(file);
-	ReloadResourceData(file->getPath().string());
-	LoadAssimp(file);
+	LoadModel(file);
+}
+
+void ResourceLoader::Reload(TextResourceFile* file, FileBuffer&& data)
+{
+	UpdateFileTimes(file);
+	file->m_ResourceData->setData(std::move(data));
+}
+
+void ResourceLoader::Reload(LuaTextResourceFile* file, FileBuffer&& data)
+{
+	Reload((TextResourceFile*)file, std::move(data));
+	file->m_Bytecode.clear();
+	LoadCookedLua(file);
+}
+
+void ResourceLoader::Reload(ModelResourceFile* file, const FileBuffer& cooked)
+{
+	UpdateFileTimes(file);
+	CookedModel model;
+	if (!MeshCooker::Read(cooked.data(), cooked.size(), model))
+	{
+		ERR("Could not reload model: " + file->getPath().generic_string());
+		return;
+	}
+	LoadCookedModel(file, model);
 }
 
 void ResourceLoader::Reload(ImageResourceFile* file)
 {
 	UpdateFileTimes(file);
-	ReloadResourceData(file->m_ResourceData->getPath().string());
+	// Textures made from the image after this read it again
+	file->m_ResourceData->setData(FileBuffer());
 }
 
 void ResourceLoader::Reload(FontResourceFile* file)
 {
 	UpdateFileTimes(file);
-	ReloadResourceData(file->m_ResourceData->getPath().string());
+	ReadResourceData(file->m_ResourceData, true);
 	file->regenerateFont();
+	file->m_ResourceData->setData(FileBuffer());
 }
 
 Vector<ResourceFile*>& ResourceLoader::GetFilesOfType(ResourceFile::Type type)
@@ -486,3 +834,17 @@ HashMap<ResourceFile::Type, Vector<ResourceFile*>>& ResourceLoader::GetAllFiles(
 {
 	return s_ResourceFileLibrary;
 }
+
+void ResourceLoader::SampleMetrics()
+{
+	static const char* TypeNames[] = { "None", "Lua", "Audio", "Text", "Model", "Image", "Font" };
+	for (auto& [type, files] : s_ResourceFileLibrary)
+	{
+		size_t bytes = 0;
+		for (auto& file : files)
+		{
+			bytes += file->getData()->getRawDataByteSize();
+		}
+		Metrics::GetSingleton()->getGauge(String("Resources/") + TypeNames[(int)type] + " Memory", MetricUnit::Bytes)->set(bytes);
+	}
+}
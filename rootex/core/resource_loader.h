@@ -3,6 +3,8 @@
 #include "common/common.h"
 #include "core/resource_data.h"
 #include "core/resource_file.h"
+#include "core/pak_archive.h"
+#include "core/mesh_cooker.h"
 #include "os/os.h"
 
 #include <assimp/Importer.hpp>
@@ -20,11 +22,11 @@ static const inline HashMap<ResourceFile::Type, Vector<String>> SupportedFiles =
 	},
 	{
 	    ResourceFile::Type::Audio,
-	    { ".wav" },
+	    { ".wav", ".ogg" },
 	},
 	{
 	    ResourceFile::Type::Image,
-	    { ".png", ".jpeg", "jpg" },
+	    { ".png", ".jpeg", ".jpg" },
 	},
 	{
 	    ResourceFile::Type::Text,
@@ -45,20 +47,48 @@ bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileTy
 /// Factory for ResourceFile objects. Implements creating, loading and saving files.                                \n
 /// Maintains an internal cache that doesn't let the same file to be loaded twice. Cache misses force file loading. \n
 /// This just means you can load the same file multiple times without worrying about unnecessary copies.            \n
+/// Files are looked up in mounted .pak archives first, then on disk.                                               \n
 /// All path arguments should be relative to Rootex root.
 class ResourceLoader
 {
-	static Assimp::Importer s_ModelLoader;
+	static Vector<Ptr<PakArchive>> s_Archives;
 	static HashMap<Ptr<ResourceData>, Ptr<ResourceFile>> s_ResourcesDataFiles;
 	static HashMap<ResourceFile::Type, Vector<ResourceFile*>> s_ResourceFileLibrary;
 	
 	static void UpdateFileTimes(ResourceFile* file);
-	static void LoadAssimp(ModelResourceFile* file);
-	static void LoadALUT(AudioResourceFile* audioRes, const char* audioBuffer, int format, int size, float frequency);
+	static void LoadModel(ModelResourceFile* file);
+	/// Meshes with the same contents as meshes already loaded in the file keep their GPU buffers.
+	static void LoadCookedModel(ModelResourceFile* file, const CookedModel& model);
+	static void LoadCookedLua(LuaTextResourceFile* file);
+	/// Reads the format and the location of the PCM data of a .wav file, without reading the data.
+	static bool LoadWAVHeader(AudioResourceFile* audioRes);
+	/// Reads the format and the decoded length of a .ogg file from its headers and its last page, without decoding any audio.
+	static bool LoadVorbisHeader(AudioResourceFile* audioRes);
+	static bool LoadAudioHeader(AudioResourceFile* audioRes);
+	/// Finds a file in the mounted archives, searching the last mounted archive first. Returns nullptr if no archive has it.
+	static const PakEntry* FindInArchives(const String& path, PakArchive*& archive);
+	/// Fill resource data from an archive or from disk. Mapped files are not copied, falling back to reading them if mapping fails.
+	static void ReadResourceData(ResourceData* resData, bool isMapped);
+	static void ReadResourceData(ResourceData* resData, const String& path, bool isMapped);
 
 public:
 	static void RegisterAPI(sol::state& rootex);
 
+	/// Mount a .pak archive. Files in mounted archives are found before loose files on disk.
+	static bool MountArchive(const String& path);
+	/// If a file is in a mounted archive or on disk.
+	static bool IsExists(const String& path);
+	/// Read a whole file from a mounted archive or from disk.
+	static FileBuffer LoadFileContents(const String& path);
+	/// Open a file for reading from a mounted archive or from disk. Returns nullptr if it could not be opened.
+	static Ptr<std::istream> OpenStream(const String& path);
+	static FileTimePoint GetFileLastChangedTime(const String& path);
+	/// Read the cooked model of a model file if it is up to date, otherwise import the source with Assimp and cook it in memory.
+	/// Does not touch loaded resources, so it can be called from any thread.
+	static bool ReadModel(const String& path, FileBuffer& cooked);
+	/// Returns nullptr if the file has not been loaded.
+	static ResourceFile* FindResourceFile(const String& path);
+
 	static TextResourceFile* CreateTextResourceFile(const String& path);
 	static TextResourceFile* CreateNewTextResourceFile(const String& path);
 	static LuaTextResourceFile* CreateLuaTextResourceFile(const String& path);
@@ -70,6 +100,10 @@ public:
 	static void SaveResourceFile(ResourceFile* resourceFile);
 	/// Reload the data buffer inside a ResourceFile from disk.
 	static void ReloadResourceData(const String& path);
+	/// Path of the cooked texture of an image if it is up to date, otherwise of the image itself.
+	static String GetImageDataPath(ImageResourceFile* file);
+	/// Read the data at GetImageDataPath() into the image. Textures drop this data once it is on the GPU.
+	static void LoadImageData(ImageResourceFile* file);
 
 	static void Reload(TextResourceFile* file);
 	static void Reload(LuaTextResourceFile* file);
@@ -77,9 +111,15 @@ public:
 	static void Reload(ModelResourceFile* file);
 	static void Reload(ImageResourceFile* file);
 	static void Reload(FontResourceFile* file);
+	/// Reload with data that was read ahead of time, for example on another thread.
+	static void Reload(TextResourceFile* file, FileBuffer&& data);
+	static void Reload(LuaTextResourceFile* file, FileBuffer&& data);
+	static void Reload(ModelResourceFile* file, const FileBuffer& cooked);
 
 	/// Get a list of files that have already been loaded and belong to a certain type
 	static Vector<ResourceFile*>& GetFilesOfType(ResourceFile::Type type);
 	/// Get a list of all files that have already been loaded
 	static HashMap<ResourceFile::Type, Vector<ResourceFile*>>& GetAllFiles();
+	/// Set the gauges of the bytes held by loaded files of each type. Run by Metrics before reporting.
+	static void SampleMetrics();
 };
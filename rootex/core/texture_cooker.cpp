@@ -0,0 +1,551 @@
+#include "texture_cooker.h"
+
+#include "content_hash.h"
+
+// Static so that it does not clash with the copy Assimp builds
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include "vendor/Assimp/assimp/contrib/stb_image/stb_image.h"
+
+#define DDS_MAGIC "DDS "
+/// Marks .dds files written by the cooker, in the first reserved field of the header
+#define DDS_COOKER_TAG 0x58455452 // "RTEX"
+
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDPF_FOURCC 0x4
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+
+struct DDSPixelFormat
+{
+	unsigned int m_Size;
+	unsigned int m_Flags;
+	char m_FourCC[4];
+	unsigned int m_RGBBitCount;
+	unsigned int m_RBitMask;
+	unsigned int m_GBitMask;
+	unsigned int m_BBitMask;
+	unsigned int m_ABitMask;
+};
+
+struct DDSHeader
+{
+	unsigned int m_Size;
+	unsigned int m_Flags;
+	unsigned int m_Height;
+	unsigned int m_Width;
+	unsigned int m_PitchOrLinearSize;
+	unsigned int m_Depth;
+	unsigned int m_MipMapCount;
+	/// Unused by readers. The cooker keeps its tag, the source hash and the settings hash here.
+	unsigned int m_Reserved1[11];
+	DDSPixelFormat m_PixelFormat;
+	unsigned int m_Caps;
+	unsigned int m_Caps2;
+	unsigned int m_Caps3;
+	unsigned int m_Caps4;
+	unsigned int m_Reserved2;
+};
+
+/// RGBA8 pixels of one mip level
+struct Image
+{
+	unsigned int m_Width;
+	unsigned int m_Height;
+	Vector<unsigned char> m_Pixels;
+};
+
+static Image Downsample(const Image& source)
+{
+	Image result;
+	result.m_Width = std::max(1u, source.m_Width / 2);
+	result.m_Height = std::max(1u, source.m_Height / 2);
+	result.m_Pixels.resize(result.m_Width * result.m_Height * 4);
+
+	// Box filter, clamping at the edges of levels with odd sizes
+	for (unsigned int y = 0; y < result.m_Height; y++)
+	{
+		unsigned int y0 = std::min(y * 2, source.m_Height - 1);
+		unsigned int y1 = std::min(y * 2 + 1, source.m_Height - 1);
+		for (unsigned int x = 0; x < result.m_Width; x++)
+		{
+			unsigned int x0 = std::min(x * 2, source.m_Width - 1);
+			unsigned int x1 = std::min(x * 2 + 1, source.m_Width - 1);
+			for (int c = 0; c < 4; c++)
+			{
+				unsigned int sum = source.m_Pixels[(y0 * source.m_Width + x0) * 4 + c]
+				    + source.m_Pixels[(y0 * source.m_Width + x1) * 4 + c]
+				    + source.m_Pixels[(y1 * source.m_Width + x0) * 4 + c]
+				    + source.m_Pixels[(y1 * source.m_Width + x1) * 4 + c];
+				result.m_Pixels[(y * result.m_Width + x) * 4 + c] = (sum + 2) / 4;
+			}
+		}
+	}
+	return result;
+}
+
+static unsigned short PackRGB565(const float color[3])
+{
+	int r = std::clamp((int)(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+	int g = std::clamp((int)(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+	int b = std::clamp((int)(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+	return (r << 11) | (g << 5) | b;
+}
+
+static void UnpackRGB565(unsigned short packed, float color[3])
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	color[0] = (float)((r << 3) | (r >> 2));
+	color[1] = (float)((g << 2) | (g >> 4));
+	color[2] = (float)((b << 3) | (b >> 2));
+}
+
+/// Pick the closest of the 4 colors a BC1 block can hold for every pixel. Returns the total squared error.
+static float FindColorIndices(const unsigned char block[64], unsigned short endpoint0, unsigned short endpoint1, unsigned int& indices)
+{
+	float palette[4][3];
+	UnpackRGB565(endpoint0, palette[0]);
+	UnpackRGB565(endpoint1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+		palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+	}
+
+	float totalError = 0.0f;
+	indices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		float bestError = FLT_MAX;
+		unsigned int bestIndex = 0;
+		for (unsigned int p = 0; p < 4; p++)
+		{
+			float error = 0.0f;
+			for (int c = 0; c < 3; c++)
+			{
+				float difference = block[i * 4 + c] - palette[p][c];
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				bestIndex = p;
+			}
+		}
+		indices |= bestIndex << (i * 2);
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+/// Fit endpoints to the pixels that chose each palette entry, by least squares.
+static bool RefineColorEndpoints(const unsigned char block[64], unsigned int indices, float endpoint0[3], float endpoint1[3])
+{
+	static const float Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float aa = 0.0f;
+	float bb = 0.0f;
+	float ab = 0.0f;
+	float ax[3] = {};
+	float bx[3] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float a = Weights[(indices >> (i * 2)) & 3];
+		float b = 1.0f - a;
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for (int c = 0; c < 3; c++)
+		{
+			ax[c] += a * block[i * 4 + c];
+			bx[c] += b * block[i * 4 + c];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if (fabsf(determinant) < 1e-6f)
+	{
+		return false;
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		endpoint0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+	}
+	return true;
+}
+
+static void EncodeColorBlock(const unsigned char block[64], unsigned char* output)
+{
+	// Endpoints start at the ends of the line through the colors along their principal axis
+	float mean[3] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			mean[c] += block[i * 4 + c] / 16.0f;
+		}
+	}
+
+	float covariance[6] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float r = block[i * 4] - mean[0];
+		float g = block[i * 4 + 1] - mean[1];
+		float b = block[i * 4 + 2] - mean[2];
+		covariance[0] += r * r;
+		covariance[1] += r * g;
+		covariance[2] += r * b;
+		covariance[3] += g * g;
+		covariance[4] += g * b;
+		covariance[5] += b * b;
+	}
+
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[3] = {
+			covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+			covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+			covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+		};
+		float length = std::max({ fabsf(next[0]), fabsf(next[1]), fabsf(next[2]) });
+		if (length < 1e-6f)
+		{
+			break;
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float minimum = FLT_MAX;
+	float maximum = -FLT_MAX;
+	for (int i = 0; i < 16; i++)
+	{
+		float projection = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			projection += (block[i * 4 + c] - mean[c]) * axis[c];
+		}
+		minimum = std::min(minimum, projection);
+		maximum = std::max(maximum, projection);
+	}
+	float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	float endpoint0[3];
+	float endpoint1[3];
+	for (int c = 0; c < 3; c++)
+	{
+		endpoint0[c] = std::clamp(mean[c] + axis[c] * maximum / axisLengthSquared, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp(mean[c] + axis[c] * minimum / axisLengthSquared, 0.0f, 255.0f);
+	}
+
+	unsigned short packed0 = PackRGB565(endpoint0);
+	unsigned short packed1 = PackRGB565(endpoint1);
+	unsigned int indices;
+	float error = FindColorIndices(block, packed0, packed1, indices);
+
+	if (RefineColorEndpoints(block, indices, endpoint0, endpoint1))
+	{
+		unsigned short refined0 = PackRGB565(endpoint0);
+		unsigned short refined1 = PackRGB565(endpoint1);
+		unsigned int refinedIndices;
+		if (FindColorIndices(block, refined0, refined1, refinedIndices) < error)
+		{
+			packed0 = refined0;
+			packed1 = refined1;
+			indices = refinedIndices;
+		}
+	}
+
+	// The first endpoint has to be the larger one for the block to use 4 colors
+	if (packed0 < packed1)
+	{
+		std::swap(packed0, packed1);
+		// Swaps palette entries 0 with 1 and 2 with 3
+		indices ^= 0x55555555;
+	}
+	else if (packed0 == packed1)
+	{
+		indices = 0;
+	}
+
+	memcpy(output, &packed0, 2);
+	memcpy(output + 2, &packed1, 2);
+	memcpy(output + 4, &indices, 4);
+}
+
+static void EncodeAlphaBlock(const unsigned char block[64], unsigned char* output)
+{
+	unsigned char maximum = 0;
+	unsigned char minimum = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		maximum = std::max(maximum, block[i * 4 + 3]);
+		minimum = std::min(minimum, block[i * 4 + 3]);
+	}
+
+	// The first endpoint being larger selects 6 interpolated values between the endpoints
+	unsigned char palette[8] = { maximum, minimum };
+	for (int p = 1; p < 7; p++)
+	{
+		palette[p + 1] = ((7 - p) * maximum + p * minimum + 3) / 7;
+	}
+
+	unsigned long long indices = 0;
+	if (maximum != minimum)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			int bestError = INT_MAX;
+			unsigned long long bestIndex = 0;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = abs(block[i * 4 + 3] - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+	}
+
+	output[0] = maximum;
+	output[1] = minimum;
+	memcpy(output + 2, &indices, 6);
+}
+
+static void CompressLevel(const Image& image, bool hasAlpha, FileBuffer& cooked)
+{
+	unsigned int blocksWide = std::max(1u, (image.m_Width + 3) / 4);
+	unsigned int blocksHigh = std::max(1u, (image.m_Height + 3) / 4);
+	unsigned int blockSize = hasAlpha ? 16 : 8;
+	size_t start = cooked.size();
+	cooked.resize(start + (size_t)blocksWide * blocksHigh * blockSize);
+
+	unsigned char block[64];
+	for (unsigned int by = 0; by < blocksHigh; by++)
+	{
+		for (unsigned int bx = 0; bx < blocksWide; bx++)
+		{
+			// Levels smaller than a block repeat their edge pixels
+			for (int i = 0; i < 16; i++)
+			{
+				unsigned int x = std::min(bx * 4 + i % 4, image.m_Width - 1);
+				unsigned int y = std::min(by * 4 + i / 4, image.m_Height - 1);
+				memcpy(block + i * 4, &image.m_Pixels[(y * image.m_Width + x) * 4], 4);
+			}
+
+			unsigned char* output = (unsigned char*)cooked.data() + start + ((size_t)by * blocksWide + bx) * blockSize;
+			if (hasAlpha)
+			{
+				EncodeAlphaBlock(block, output);
+				output += 8;
+			}
+			EncodeColorBlock(block, output);
+		}
+	}
+}
+
+static bool ReadCookedHeader(const char* data, size_t size, DDSHeader& header)
+{
+	if (size < 4 + sizeof(DDSHeader) || strncmp(data, DDS_MAGIC, 4) != 0)
+	{
+		return false;
+	}
+	memcpy(&header, data + 4, sizeof(DDSHeader));
+	return true;
+}
+
+String TextureCooker::GetCookedPath(const String& sourcePath)
+{
+	return sourcePath + COOKED_TEXTURE_EXTENSION;
+}
+
+unsigned long long TextureCooker::GetSettingsHash()
+{
+	return ContentHash::Combine(COOKED_TEXTURE_VERSION, sizeof(DDSHeader));
+}
+
+bool TextureCooker::Cook(const char* imageFileData, size_t size, unsigned long long sourceHash, FileBuffer& cooked)
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* pixels = stbi_load_from_memory((const stbi_uc*)imageFileData, size, &width, &height, &channels, 4);
+	if (!pixels)
+	{
+		ERR("Could not decode image: " + String(stbi_failure_reason()));
+		return false;
+	}
+	if (width % 4 != 0 || height % 4 != 0)
+	{
+		stbi_image_free(pixels);
+		ERR("Block compressed textures need sizes that are multiples of 4, found " + std::to_string(width) + "x" + std::to_string(height));
+		return false;
+	}
+
+	Image level;
+	level.m_Width = width;
+	level.m_Height = height;
+	level.m_Pixels.assign(pixels, pixels + width * height * 4);
+	stbi_image_free(pixels);
+
+	bool hasAlpha = false;
+	for (size_t i = 3; i < level.m_Pixels.size(); i += 4)
+	{
+		if (level.m_Pixels[i] != 255)
+		{
+			hasAlpha = true;
+			break;
+		}
+	}
+
+	unsigned int mipCount = 1;
+	while ((std::max(width, height) >> mipCount) > 0)
+	{
+		mipCount++;
+	}
+
+	DDSHeader header = {};
+	header.m_Size = sizeof(DDSHeader);
+	header.m_Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.m_Height = height;
+	header.m_Width = width;
+	header.m_PitchOrLinearSize = (width / 4) * (height / 4) * (hasAlpha ? 16 : 8);
+	header.m_MipMapCount = mipCount;
+	header.m_Reserved1[0] = DDS_COOKER_TAG;
+	memcpy(&header.m_Reserved1[1], &sourceHash, sizeof(sourceHash));
+	unsigned long long settingsHash = GetSettingsHash();
+	memcpy(&header.m_Reserved1[3], &settingsHash, sizeof(settingsHash));
+	header.m_PixelFormat.m_Size = sizeof(DDSPixelFormat);
+	header.m_PixelFormat.m_Flags = DDPF_FOURCC;
+	memcpy(header.m_PixelFormat.m_FourCC, hasAlpha ? "DXT5" : "DXT1", 4);
+	header.m_Caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	cooked.clear();
+	cooked.insert(cooked.end(), DDS_MAGIC, DDS_MAGIC + 4);
+	cooked.insert(cooked.end(), (const char*)&header, (const char*)&header + sizeof(header));
+
+	for (unsigned int mip = 0; mip < mipCount; mip++)
+	{
+		if (mip > 0)
+		{
+			level = Downsample(level);
+		}
+		CompressLevel(level, hasAlpha, cooked);
+	}
+	return true;
+}
+
+bool TextureCooker::IsCooked(const char* data, size_t size)
+{
+	return size >= 4 && strncmp(data, DDS_MAGIC, 4) == 0;
+}
+
+bool TextureCooker::ReadMips(const char* data, size_t size, CookedTextureMips& mips)
+{
+	DDSHeader header;
+	if (!ReadCookedHeader(data, size, header) || header.m_Reserved1[0] != DDS_COOKER_TAG || header.m_MipMapCount == 0)
+	{
+		return false;
+	}
+
+	mips.m_Width = header.m_Width;
+	mips.m_Height = header.m_Height;
+	mips.m_HasAlpha = strncmp(header.m_PixelFormat.m_FourCC, "DXT5", 4) == 0;
+	mips.m_Mips.clear();
+
+	unsigned int blockSize = mips.m_HasAlpha ? 16 : 8;
+	size_t offset = 4 + sizeof(DDSHeader);
+	for (unsigned int i = 0; i < header.m_MipMapCount; i++)
+	{
+		CookedTextureMips::Mip mip;
+		mip.m_Width = std::max(1u, header.m_Width >> i);
+		mip.m_Height = std::max(1u, header.m_Height >> i);
+		mip.m_RowPitch = std::max(1u, (mip.m_Width + 3) / 4) * blockSize;
+		mip.m_Size = mip.m_RowPitch * std::max(1u, (mip.m_Height + 3) / 4);
+		if (mip.m_Size > size - offset)
+		{
+			return false;
+		}
+		mip.m_Data = data + offset;
+		offset += mip.m_Size;
+		mips.m_Mips.push_back(mip);
+	}
+	return true;
+}
+
+TextureCooker::CookResult TextureCooker::CookFile(const String& sourcePath)
+{
+	FileBuffer source = OS::LoadFileContents(sourcePath);
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	if (!stbi_info_from_memory((const stbi_uc*)source.data(), source.size(), &width, &height, &channels))
+	{
+		ERR("Texture could not be cooked: " + sourcePath);
+		ERR("stb_image: " + String(stbi_failure_reason()));
+		return CookResult::Failed;
+	}
+	if (width % 4 != 0 || height % 4 != 0)
+	{
+		return CookResult::Skipped;
+	}
+
+	unsigned long long sourceHash = ContentHash::Hash(source.data(), source.size());
+	const String cookedPath = GetCookedPath(sourcePath);
+
+	if (OS::IsExists(cookedPath))
+	{
+		std::ifstream cookedFile(OS::GetAbsolutePath(cookedPath), std::ios::binary);
+		char headerData[4 + sizeof(DDSHeader)] = {};
+		cookedFile.read(headerData, sizeof(headerData));
+
+		DDSHeader header;
+		unsigned long long cookedSourceHash;
+		unsigned long long cookedSettingsHash;
+		if (cookedFile && ReadCookedHeader(headerData, sizeof(headerData), header) && header.m_Reserved1[0] == DDS_COOKER_TAG)
+		{
+			memcpy(&cookedSourceHash, &header.m_Reserved1[1], sizeof(cookedSourceHash));
+			memcpy(&cookedSettingsHash, &header.m_Reserved1[3], sizeof(cookedSettingsHash));
+			if (cookedSourceHash == sourceHash && cookedSettingsHash == GetSettingsHash())
+			{
+				// The engine trusts cooked files that are newer than their source, which may have only been touched
+				if (OS::GetFileLastChangedTime(cookedPath) < OS::GetFileLastChangedTime(sourcePath))
+				{
+					cookedFile.close();
+					std::filesystem::last_write_time(OS::GetAbsolutePath(cookedPath), OS::GetFileLastChangedTime(sourcePath));
+				}
+				return CookResult::UpToDate;
+			}
+		}
+	}
+
+	FileBuffer cooked;
+	if (!Cook(source.data(), source.size(), sourceHash, cooked))
+	{
+		ERR("Texture could not be cooked: " + sourcePath);
+		return CookResult::Failed;
+	}
+
+	std::ofstream cookedFile(OS::GetAbsolutePath(cookedPath), std::ios::binary);
+	cookedFile.write(cooked.data(), cooked.size());
+	if (!cookedFile)
+	{
+		ERR("Could not write cooked texture: " + cookedPath);
+		return CookResult::Failed;
+	}
+	return CookResult::Cooked;
+}
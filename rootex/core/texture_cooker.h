@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Bump when the way textures are cooked changes, so that old cooked files get rebuilt
+#define COOKED_TEXTURE_VERSION 1
+/// Cooked textures are written next to their source, with this appended to the source file name
+#define COOKED_TEXTURE_EXTENSION ".dds"
+
+/// Mip chain of a cooked texture, pointing into the .dds file.
+struct CookedTextureMips
+{
+	struct Mip
+	{
+		const char* m_Data;
+		unsigned int m_Size;
+		/// Bytes in a row of 4x4 blocks
+		unsigned int m_RowPitch;
+		unsigned int m_Width;
+		unsigned int m_Height;
+	};
+
+	unsigned int m_Width;
+	unsigned int m_Height;
+	/// BC3 if true, BC1 otherwise
+	bool m_HasAlpha;
+	Vector<Mip> m_Mips;
+};
+
+/// Converts images into block compressed .dds files with a full mip chain, which the GPU can use without decoding them first.
+/// Opaque images become BC1, images with transparency become BC3.
+/// Cooked textures store a content hash of their source and the cook settings in the reserved part of the .dds header, so that only changed images get cooked again.
+class TextureCooker
+{
+public:
+	enum class CookResult
+	{
+		Cooked,
+		UpToDate,
+		/// Block compressed textures need sizes that are multiples of 4, other images are loaded from their source
+		Skipped,
+		Failed
+	};
+
+	static String GetCookedPath(const String& sourcePath);
+	static unsigned long long GetSettingsHash();
+
+	/// Decode an image file and encode it as a block compressed .dds file. Returns false if the image could not be cooked.
+	static bool Cook(const char* imageFileData, size_t size, unsigned long long sourceHash, FileBuffer& cooked);
+	/// If data is a .dds file, made by the cooker or not.
+	static bool IsCooked(const char* data, size_t size);
+	/// Find the mips of a .dds file made by the cooker. Returns false for any other data.
+	static bool ReadMips(const char* data, size_t size, CookedTextureMips& mips);
+
+	/// Cook an image file on disk unless its cooked file is up to date with its contents and the cook settings.
+	static CookResult CookFile(const String& sourcePath);
+};
@@ -1,5 +1,7 @@
 #include "audio_component.h"
 
+#include "systems/audio_system.h"
+
 AudioComponent::AudioComponent(bool playOnStart, bool attenuation, AudioSource::AttenuationModel model, ALfloat rolloffFactor, ALfloat referenceDistance, ALfloat maxDistance)
     : m_IsPlayOnStart(playOnStart)
     , m_IsAttenuated(attenuation)
@@ -7,13 +9,33 @@ AudioComponent::AudioComponent(bool playOnStart, bool attenuation, AudioSource::
     , m_RolloffFactor(rolloffFactor)
     , m_ReferenceDistance(referenceDistance)
     , m_MaxDistance(maxDistance)
+    , m_Priority(0)
     , m_TransformComponent(nullptr)
 {
 }
 
+AudioComponent::~AudioComponent()
+{
+	setAudioSource(nullptr);
+}
+
+void AudioComponent::setAudioSource(Ref<AudioSource> audioSource)
+{
+	if (m_AudioSource)
+	{
+		AudioSystem::GetSingleton()->removeSource(m_AudioSource);
+	}
+	m_AudioSource = audioSource;
+	if (m_AudioSource)
+	{
+		AudioSystem::GetSingleton()->addSource(m_AudioSource);
+	}
+}
+
 bool AudioComponent::setup()
 {
 	bool status = true;
+	getAudioSource()->setPriority(m_Priority);
 	if (m_Owner)
 	{
 		m_TransformComponent = m_Owner->getComponent<TransformComponent>().get();
@@ -46,6 +68,7 @@ JSON::json AudioComponent::getJSON() const
 	j["rollOffFactor"] = m_RolloffFactor;
 	j["referenceDistance"] = m_ReferenceDistance;
 	j["maxDistance"] = m_MaxDistance;
+	j["priority"] = m_Priority;
 
 	return j;
 }
@@ -104,6 +127,7 @@ void AudioComponent::draw()
 	ImGui::InputFloat("Reference Distance", &m_ReferenceDistance, 0, 100.0f);
 	ImGui::InputFloat("Rolloff Factor", &m_RolloffFactor, 0, 100.0f);
 	ImGui::InputFloat("Max Distance", &m_MaxDistance, 0, 100.0f);
+	ImGui::InputInt("Priority", &m_Priority);
 }
 
 #endif // ROOTEX_EDITOR
@@ -13,7 +13,8 @@ private:
 	ALfloat m_RolloffFactor;
 	ALfloat m_ReferenceDistance;
 	ALfloat m_MaxDistance;
-	AudioSource* m_AudioSource;
+	int m_Priority;
+	Ref<AudioSource> m_AudioSource;
 
 protected:
 	bool m_IsPlayOnStart;
@@ -28,7 +29,7 @@ public:
 
 	AudioComponent(bool playOnStart, bool attenuation, AudioSource::AttenuationModel model, ALfloat rolloffFactor, ALfloat referenceDistance, ALfloat maxDistance);
 	AudioComponent(AudioComponent&) = delete;
-	~AudioComponent() = default;
+	~AudioComponent();
 
 	virtual bool setup() override;
 
@@ -36,9 +37,13 @@ public:
 
 	bool isPlayOnStart() const { return m_IsPlayOnStart; }
 	bool isAttenuated() { return m_IsAttenuated; }
+	/// Higher priority sources get hardware voices before louder ones with lower priority.
+	void setPriority(int priority) { m_Priority = priority; }
+	int getPriority() const { return m_Priority; }
 
-	void setAudioSource(AudioSource* audioSource) { m_AudioSource = audioSource; }
-	AudioSource* getAudioSource() { return m_AudioSource; }
+	/// Hands the previous source over to the audio thread and registers the new one with it.
+	void setAudioSource(Ref<AudioSource> audioSource);
+	AudioSource* getAudioSource() { return m_AudioSource.get(); }
 
 	virtual String getName() const override { return "AudioComponent"; }
 	ComponentID getComponentID() const { return s_ID; }
@@ -10,6 +10,7 @@ Component* MusicComponent::Create(const JSON::json& componentData)
 	    (ALfloat)componentData["rollOffFactor"],
 	    (ALfloat)componentData["referenceDistance"],
 	    (ALfloat)componentData["maxDistance"]);
+	musicComponent->setPriority(componentData.value("priority", 0));
 	return musicComponent;
 }
 
@@ -45,7 +46,7 @@ bool MusicComponent::setup()
 	m_StreamingAudioBuffer.reset(new StreamingAudioBuffer(m_AudioFile));
 	m_StreamingAudioSource.reset(new StreamingAudioSource(m_StreamingAudioBuffer));
 
-	setAudioSource(m_StreamingAudioSource.get());
+	setAudioSource(m_StreamingAudioSource);
 
 	bool status = AudioComponent::setup();
 	if (m_Owner)
@@ -130,7 +131,7 @@ void MusicComponent::draw()
 			}
 			else
 			{
-				WARN("Cannot assign a non-wav file to Audio File");
+				WARN("Cannot assign a non-audio file to Audio File");
 			}
 		}
 		ImGui::EndDragDropTarget();
@@ -16,7 +16,9 @@ Component* BoxColliderComponent::Create(const JSON::json& boxComponentData)
 	        boxComponentData["gravity"]["z"]
 		},
 		boxComponentData["isMoveable"],
-		boxComponentData["isGeneratesHitEvents"]);
+		boxComponentData["isGeneratesHitEvents"],
+		boxComponentData.value("collisionGroup", (int)btBroadphaseProxy::DefaultFilter),
+		boxComponentData.value("collisionMask", (int)btBroadphaseProxy::AllFilter));
 	return component;
 }
 
@@ -27,12 +29,14 @@ Component* BoxColliderComponent::CreateDefault()
 		"Air",
 	    { 0.0f, 0.0f, 0.0f },
 		false,
-		false);
+		false,
+		btBroadphaseProxy::DefaultFilter,
+		btBroadphaseProxy::AllFilter);
 	return component;
 }
 
-BoxColliderComponent::BoxColliderComponent(const Vector3& dimensions, const String& matName, const Vector3& gravity, bool isMoveable, bool generatesHitEvents)
-    : PhysicsColliderComponent(matName, dimensions.x * dimensions.y * dimensions.z, gravity, isMoveable, Ref<btBoxShape>(new btBoxShape(vecTobtVector3(dimensions))), generatesHitEvents)
+BoxColliderComponent::BoxColliderComponent(const Vector3& dimensions, const String& matName, const Vector3& gravity, bool isMoveable, bool generatesHitEvents, int collisionGroup, int collisionMask)
+    : PhysicsColliderComponent(matName, dimensions.x * dimensions.y * dimensions.z, gravity, isMoveable, Ref<btBoxShape>(new btBoxShape(vecTobtVector3(dimensions))), generatesHitEvents, collisionGroup, collisionMask)
     , m_Dimensions(dimensions)
 {
 	if (m_Mass > 0.0f)
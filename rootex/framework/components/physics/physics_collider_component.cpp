@@ -5,13 +5,15 @@
 
 #include "entity.h"
 
-PhysicsColliderComponent::PhysicsColliderComponent(const String& matName, float volume, const Vector3& gravity, bool isMoveable, const Ref<btCollisionShape>& collisionShape, bool generatesHitEvents)
+PhysicsColliderComponent::PhysicsColliderComponent(const String& matName, float volume, const Vector3& gravity, bool isMoveable, const Ref<btCollisionShape>& collisionShape, bool generatesHitEvents, int collisionGroup, int collisionMask)
     : m_MaterialName(matName)
 	, m_Material(0, 0)
     , m_Volume(volume)
     , m_Gravity(gravity)
     , m_IsMoveable(isMoveable)
     , m_IsGeneratesHitEvents(generatesHitEvents)
+    , m_CollisionGroup(collisionGroup)
+    , m_CollisionMask(collisionMask)
 {
 	m_CollisionShape = collisionShape;
 	m_TransformComponent = nullptr;
@@ -54,20 +56,21 @@ bool PhysicsColliderComponent::setup()
 		{
 			if (!m_Body)
 			{
-				btRigidBody::btRigidBodyConstructionInfo rbInfo(m_Mass, this, m_CollisionShape.get(), m_LocalInertia);
+				// No motion state, PhysicsSystem copies the poses of active bodies to transforms itself after each step
+				btRigidBody::btRigidBodyConstructionInfo rbInfo(m_Mass, nullptr, m_CollisionShape.get(), m_LocalInertia);
+				rbInfo.m_startWorldTransform = getWorldTransform();
 
 				/// Set up the materal properties.
 				rbInfo.m_restitution = m_Material.m_Restitution;
 				rbInfo.m_friction = m_Material.m_Friction;
 
 				m_Body.reset(new btRigidBody(rbInfo));
+				m_Body->setUserPointer(this);
 
 				/// Adds a new rigid body to physics system.
-				PhysicsSystem::GetSingleton()->addRigidBody(m_Body.get());
+				PhysicsSystem::GetSingleton()->addRigidBody(m_Body.get(), m_CollisionGroup, m_CollisionMask);
 				setGravity(m_Gravity);
 				setMoveable(m_IsMoveable);
-
-				m_Body->setUserPointer(this);
 			}
 			
 			m_ScriptComponent = getOwner()->getComponent<ScriptComponent>().get();
@@ -86,14 +89,20 @@ void PhysicsColliderComponent::onRemove()
 	PhysicsSystem::GetSingleton()->removeRigidBody(m_Body.get());
 }
 
-void PhysicsColliderComponent::getWorldTransform(btTransform& worldTrans) const
+btTransform PhysicsColliderComponent::getWorldTransform() const
 {
-	worldTrans = matTobtTransform(m_TransformComponent->getRotationPosition());
+	return matTobtTransform(m_TransformComponent->getRotationPosition());
 }
 
-void PhysicsColliderComponent::setWorldTransform(const btTransform& worldTrans)
+void PhysicsColliderComponent::setCollisionLayers(int group, int mask)
 {
-	m_TransformComponent->setRotationPosition(btTransformToMat(worldTrans));
+	m_CollisionGroup = group;
+	m_CollisionMask = mask;
+	if (m_Body)
+	{
+		PhysicsSystem::GetSingleton()->removeRigidBody(m_Body.get());
+		PhysicsSystem::GetSingleton()->addRigidBody(m_Body.get(), m_CollisionGroup, m_CollisionMask);
+	}
 }
 
 void PhysicsColliderComponent::applyForce(const Vector3& force)
@@ -110,6 +119,7 @@ void PhysicsColliderComponent::kinematicMove(const Matrix& matrix)
 {
 	m_Body->setActivationState(DISABLE_DEACTIVATION);
 	m_Body->setWorldTransform(matTobtTransform(matrix));
+	PhysicsSystem::GetSingleton()->markBroadphaseDirty();
 }
 
 void PhysicsColliderComponent::setTransform(const Matrix& mat)
@@ -117,6 +127,7 @@ void PhysicsColliderComponent::setTransform(const Matrix& mat)
 	m_Body->setActivationState(DISABLE_DEACTIVATION);
 	// warp the body to the new position
 	m_Body->setWorldTransform(matTobtTransform(mat));
+	PhysicsSystem::GetSingleton()->markBroadphaseDirty();
 }
 
 Matrix PhysicsColliderComponent::getTransform()
@@ -152,6 +163,8 @@ JSON::json PhysicsColliderComponent::getJSON() const
 	
 	j["isMoveable"] = m_IsMoveable;
 	j["isGeneratesHitEvents"] = m_IsGeneratesHitEvents;
+	j["collisionGroup"] = m_CollisionGroup;
+	j["collisionMask"] = m_CollisionMask;
 
 	return j;
 }
@@ -179,6 +192,7 @@ Vector3 PhysicsColliderComponent::getAngularVelocity()
 void PhysicsColliderComponent::translate(const Vector3& vec)
 {
 	m_Body->translate(vecTobtVector3(vec));
+	PhysicsSystem::GetSingleton()->markBroadphaseDirty();
 }
 
 void PhysicsColliderComponent::RegisterAPI(sol::state& rootex)
@@ -190,6 +204,14 @@ void PhysicsColliderComponent::RegisterAPI(sol::state& rootex)
 	physicsColliderComponent["getVelocity"] = &PhysicsColliderComponent::getVelocity;
 	physicsColliderComponent["setVelocity"] = &PhysicsColliderComponent::setVelocity;
 	physicsColliderComponent["applyForce"] = &PhysicsColliderComponent::applyForce;
+	physicsColliderComponent["getCollisionGroup"] = &PhysicsColliderComponent::getCollisionGroup;
+	physicsColliderComponent["getCollisionMask"] = &PhysicsColliderComponent::getCollisionMask;
+	physicsColliderComponent["setCollisionLayers"] = &PhysicsColliderComponent::setCollisionLayers;
+
+	sol::usertype<PhysicsContact> physicsContact = rootex.new_usertype<PhysicsContact>("PhysicsContact");
+	physicsContact["point"] = &PhysicsContact::m_Point;
+	physicsContact["normal"] = &PhysicsContact::m_Normal;
+	physicsContact["impulse"] = &PhysicsContact::m_Impulse;
 }
 
 btTransform PhysicsColliderComponent::matTobtTransform(Matrix const& mat)
@@ -296,6 +318,12 @@ void PhysicsColliderComponent::draw()
 		}
 	}
 
+	int layers[2] = { m_CollisionGroup, m_CollisionMask };
+	if (ImGui::InputInt2("Collision Group/Mask", layers))
+	{
+		setCollisionLayers(layers[0], layers[1]);
+	}
+
 	if (ImGui::DragFloat3("Gravity", &m_Gravity.x))
 	{
 		setGravity(m_Gravity);
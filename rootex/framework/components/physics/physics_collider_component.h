@@ -7,7 +7,18 @@
 
 class ScriptComponent;
 
-class PhysicsColliderComponent : public Component, public btMotionState
+/// Contact information reported to scripts when colliders touch.
+struct PhysicsContact
+{
+	/// World position of the contact.
+	Vector3 m_Point;
+	/// Contact normal, pointing from the other collider towards the receiving collider.
+	Vector3 m_Normal;
+	/// Impulse applied by the solver to separate the colliders.
+	float m_Impulse;
+};
+
+class PhysicsColliderComponent : public Component
 {
 	friend class EntityFactory;
 
@@ -31,6 +42,10 @@ public:
 	float m_Volume;
 	bool m_IsMoveable;
 	bool m_IsGeneratesHitEvents;
+	/// Collision layers this collider belongs to.
+	int m_CollisionGroup;
+	/// Collision layers this collider collides with and reports hits from.
+	int m_CollisionMask;
 	
 #ifdef ROOTEX_EDITOR
 	std::string m_MaterialName;
@@ -39,10 +54,8 @@ public:
 
 	Color m_RenderColor;
 	
-	/// btMotionState interface:  Bullet calls this to get the transform of the object from game.
-	virtual void getWorldTransform(btTransform& worldTrans) const;
-	/// btMotionState interface:  Bullet calls this to set the transform of the object from the Bullet world.
-	virtual void setWorldTransform(const btTransform& worldTrans);
+	/// Pose of the transform component as a Bullet transform. Bodies start here, after which PhysicsSystem writes their poses back.
+	btTransform getWorldTransform() const;
 	
 	/// Stores material specific details.
 	struct MaterialData
@@ -58,7 +71,7 @@ public:
 	} m_Material;
 
 	/// Helpers for conversion to and from Bullet's data types.
-	PhysicsColliderComponent(const String& matName, float volume, const Vector3& gravity, bool isMoveable, const Ref<btCollisionShape>& collisionShape, bool generatesHitEvents);
+	PhysicsColliderComponent(const String& matName, float volume, const Vector3& gravity, bool isMoveable, const Ref<btCollisionShape>& collisionShape, bool generatesHitEvents, int collisionGroup, int collisionMask);
 	~PhysicsColliderComponent();
 
 	ComponentID getComponentID() const { return s_ID; }
@@ -93,6 +106,11 @@ public:
 	bool getIsGeneratesHitEvents() { return m_IsGeneratesHitEvents; }
 	void setGeneratedHitEvents(bool enabled) { m_IsGeneratesHitEvents = enabled; }
 
+	int getCollisionGroup() const { return m_CollisionGroup; }
+	int getCollisionMask() const { return m_CollisionMask; }
+	/// Move the collider to different collision layers. Re-adds the body to the physics world.
+	void setCollisionLayers(int group, int mask);
+
 	virtual void render();
 
 	virtual String getName() const override { return "PhysicsColliderComponent"; };
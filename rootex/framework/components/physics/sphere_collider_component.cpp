@@ -12,7 +12,9 @@ Component* SphereColliderComponent::Create(const JSON::json& sphereComponentData
 	        sphereComponentData["gravity"]["z"]
 		},
 		sphereComponentData["isMoveable"],
-		sphereComponentData["isGeneratesHitEvents"]);
+		sphereComponentData["isGeneratesHitEvents"],
+		sphereComponentData.value("collisionGroup", (int)btBroadphaseProxy::DefaultFilter),
+		sphereComponentData.value("collisionMask", (int)btBroadphaseProxy::AllFilter));
 	return component;
 }
 
@@ -23,12 +25,14 @@ Component* SphereColliderComponent::CreateDefault()
 		"Air", 
 		{ 0.0f, 0.0f, 0.0f },
 		false,
-		false);
+		false,
+		btBroadphaseProxy::DefaultFilter,
+		btBroadphaseProxy::AllFilter);
 	return component;
 }
 
-SphereColliderComponent::SphereColliderComponent(float rad, const String& matName, const Vector3& gravity, bool isMoveable, bool generatesHitEvents)
-    : PhysicsColliderComponent(matName, ((4.0f / 3.0f) * DirectX::XM_PI * rad * rad * rad), gravity, isMoveable, Ref<btSphereShape>(new btSphereShape(rad)), generatesHitEvents)
+SphereColliderComponent::SphereColliderComponent(float rad, const String& matName, const Vector3& gravity, bool isMoveable, bool generatesHitEvents, int collisionGroup, int collisionMask)
+    : PhysicsColliderComponent(matName, ((4.0f / 3.0f) * DirectX::XM_PI * rad * rad * rad), gravity, isMoveable, Ref<btSphereShape>(new btSphereShape(rad)), generatesHitEvents, collisionGroup, collisionMask)
     , m_Radius(rad)
 {
 	if (m_Mass > 0.0f)
@@ -2,20 +2,35 @@
 
 #include "entity.h"
 #include "resource_loader.h"
+#include "app/hot_reloader.h"
+#include "core/resource_graph.h"
+#include "systems/script_system.h"
+
+void ScriptComponent::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<ScriptComponent> scriptComponent = rootex.new_usertype<ScriptComponent>(
+	    "ScriptComponent",
+	    sol::base_classes, sol::bases<Component>());
+	rootex["Entity"]["getScript"] = &Entity::getComponent<ScriptComponent>;
+	scriptComponent["getGroup"] = &ScriptComponent::getGroup;
+	scriptComponent["getAllocatedBytes"] = [](ScriptComponent& s) { return s.getAllocationStats().m_AllocatedBytes; };
+	scriptComponent["getAllocationCount"] = [](ScriptComponent& s) { return s.getAllocationStats().m_AllocationCount; };
+}
 
 Component* ScriptComponent::Create(const JSON::json& componentData)
 {
-	ScriptComponent* sc = new ScriptComponent(componentData["scripts"]);
+	ScriptComponent* sc = new ScriptComponent(componentData["scripts"], componentData.value("group", ""));
 	return sc;
 }
 
 Component* ScriptComponent::CreateDefault()
 {
-	ScriptComponent* sc = new ScriptComponent({});
+	ScriptComponent* sc = new ScriptComponent({}, "");
 	return sc;
 }
 
-ScriptComponent::ScriptComponent(Vector<String> luaFilePaths)
+ScriptComponent::ScriptComponent(Vector<String> luaFilePaths, const String& group)
+    : m_Group(group)
 {
 	for (auto& path : luaFilePaths)
 	{
@@ -32,24 +47,62 @@ ScriptComponent::ScriptComponent(Vector<String> luaFilePaths)
 
 ScriptComponent::~ScriptComponent()
 {
+	if (!m_DependencyName.empty())
+	{
+		ResourceGraph::GetSingleton()->removeDependent(m_DependencyName);
+	}
 }
 
 bool ScriptComponent::setup()
 {
 	bool status = true;
+	for (int i = 0; i < m_ScriptFiles.size(); i++)
+	{
+		status &= runScript(i);
+	}
+
+	m_DependencyName = HotReloader::GetEntityName(m_Owner->getID());
+	updateDependencies();
+	return status;
+}
+
+bool ScriptComponent::runScript(int index)
+{
+	LuaAllocationScope allocationScope(&m_AllocationStats);
 	try
 	{
-		for (int i = 0; i < m_ScriptFiles.size(); i++)
+		const String& bytecode = m_ScriptFiles[index]->getBytecode();
+		if (bytecode.empty())
+		{
+			// Let Lua report the compilation error
+			getLuaState().script(m_ScriptFiles[index]->getString(), m_ScriptEnvironments[index], m_ScriptFiles[index]->getChunkName());
+		}
+		else
 		{
-			LuaInterpreter::GetSingleton()->getLuaState().script(m_ScriptFiles[i]->getString(), m_ScriptEnvironments[i]);
+			getLuaState().script(bytecode, m_ScriptEnvironments[index], m_ScriptFiles[index]->getChunkName(), sol::load_mode::binary);
 		}
 	}
 	catch (std::exception e)
 	{
 		ERR(e.what());
-		status = false;
+		return false;
 	}
-	return status;
+	return true;
+}
+
+void ScriptComponent::updateDependencies()
+{
+	if (m_DependencyName.empty())
+	{
+		return;
+	}
+
+	Vector<String> scriptPaths;
+	for (auto& scriptFile : m_ScriptFiles)
+	{
+		scriptPaths.push_back(scriptFile->getPath().generic_string());
+	}
+	ResourceGraph::GetSingleton()->setDependencies(m_DependencyName, scriptPaths);
 }
 
 bool ScriptComponent::isSuccessful(const sol::function_result& result)
@@ -66,6 +119,7 @@ bool ScriptComponent::isSuccessful(const sol::function_result& result)
 
 void ScriptComponent::onBegin()
 {
+	LuaAllocationScope allocationScope(&m_AllocationStats);
 	for (auto& env : m_ScriptEnvironments)
 	{
 		isSuccessful(env["onBegin"](m_Owner));
@@ -74,6 +128,7 @@ void ScriptComponent::onBegin()
 
 void ScriptComponent::onUpdate(float deltaMilliSeconds)
 {
+	LuaAllocationScope allocationScope(&m_AllocationStats);
 	for (auto& env : m_ScriptEnvironments)
 	{
 		isSuccessful(env["onUpdate"](m_Owner, deltaMilliSeconds));
@@ -82,17 +137,45 @@ void ScriptComponent::onUpdate(float deltaMilliSeconds)
 
 void ScriptComponent::onEnd()
 {
+	LuaAllocationScope allocationScope(&m_AllocationStats);
 	for (auto& env : m_ScriptEnvironments)
 	{
 		isSuccessful(env["onEnd"](m_Owner));
 	}
 }
 
-void ScriptComponent::onHit(btPersistentManifold* manifold, PhysicsColliderComponent* other)
+void ScriptComponent::onHit(const PhysicsContact& contact, PhysicsColliderComponent* other)
 {
+	LuaAllocationScope allocationScope(&m_AllocationStats);
 	for (auto& env : m_ScriptEnvironments)
 	{
-		isSuccessful(env["onHit"](m_Owner, manifold, other));
+		isSuccessful(env["onHit"](m_Owner, contact, other));
+	}
+}
+
+void ScriptComponent::onHitStay(const PhysicsContact& contact, PhysicsColliderComponent* other)
+{
+	LuaAllocationScope allocationScope(&m_AllocationStats);
+	for (auto& env : m_ScriptEnvironments)
+	{
+		sol::protected_function onHitStay = env["onHitStay"];
+		if (onHitStay.valid())
+		{
+			isSuccessful(onHitStay(m_Owner, contact, other));
+		}
+	}
+}
+
+void ScriptComponent::onHitEnd(PhysicsColliderComponent* other)
+{
+	LuaAllocationScope allocationScope(&m_AllocationStats);
+	for (auto& env : m_ScriptEnvironments)
+	{
+		sol::protected_function onHitEnd = env["onHitEnd"];
+		if (onHitEnd.valid())
+		{
+			isSuccessful(onHitEnd(m_Owner, other));
+		}
 	}
 }
 
@@ -105,17 +188,24 @@ JSON::json ScriptComponent::getJSON() const
 	{
 		j["scripts"].push_back(scriptFile->getPath().generic_string());
 	}
+	j["group"] = m_Group;
 
 	return j;
 }
 
+sol::state& ScriptComponent::getLuaState()
+{
+	return LuaInterpreter::GetSingleton()->getLuaState(m_Group);
+}
+
 void ScriptComponent::addScript(LuaTextResourceFile* scriptFile)
 {
 	m_ScriptFiles.push_back(scriptFile);
 	m_ScriptEnvironments.push_back(
-	    sol::environment(LuaInterpreter::GetSingleton()->getLuaState(),
+	    sol::environment(getLuaState(),
 	        sol::create,
-	        LuaInterpreter::GetSingleton()->getLuaState().globals()));
+	        getLuaState().globals()));
+	updateDependencies();
 }
 
 void ScriptComponent::removeScript(LuaTextResourceFile* scriptFile)
@@ -128,6 +218,26 @@ void ScriptComponent::removeScript(LuaTextResourceFile* scriptFile)
 			m_ScriptEnvironments.erase(m_ScriptEnvironments.begin() + i);
 		}
 	}
+	updateDependencies();
+}
+
+void ScriptComponent::reloadScript(LuaTextResourceFile* scriptFile)
+{
+	for (int i = 0; i < m_ScriptFiles.size(); i++)
+	{
+		if (scriptFile != m_ScriptFiles[i])
+		{
+			continue;
+		}
+
+		// A new environment drops the globals of the old version of the script
+		m_ScriptEnvironments[i] = sol::environment(getLuaState(), sol::create, getLuaState().globals());
+		if (runScript(i) && ScriptSystem::GetSingleton()->hasBegun())
+		{
+			LuaAllocationScope allocationScope(&m_AllocationStats);
+			isSuccessful(m_ScriptEnvironments[i]["onBegin"](m_Owner));
+		}
+	}
 }
 
 #ifdef ROOTEX_EDITOR
@@ -135,6 +245,8 @@ void ScriptComponent::removeScript(LuaTextResourceFile* scriptFile)
 #include "imgui_stdlib.h"
 void ScriptComponent::draw()
 {
+	ImGui::Text("Script Group: %s", m_Group.empty() ? "(Shared)" : m_Group.c_str());
+
 	ImGui::BeginGroup();
 	if (ImGui::ListBoxHeader("Scripts", m_ScriptFiles.size()))
 	{
@@ -12,20 +12,29 @@ class LuaTextResourceFile;
 class ScriptComponent : public Component
 {
 public:
+	static void RegisterAPI(sol::state& rootex);
 	static Component* Create(const JSON::json& componentData);
 	static Component* CreateDefault();
 
 private:
 	Vector<sol::environment> m_ScriptEnvironments;
 	Vector<LuaTextResourceFile*> m_ScriptFiles;
+	/// Name of the script group whose Lua state runs these scripts. Empty for the shared Lua state.
+	String m_Group;
+	/// Lua memory allocated while running the scripts of this component.
+	LuaAllocationStats m_AllocationStats;
+	/// Name of the owner in the ResourceGraph, set once the scripts have been set up
+	String m_DependencyName;
 
 	friend class EntityFactory;
 
-	ScriptComponent(Vector<String> luaFilePaths);
+	ScriptComponent(Vector<String> luaFilePaths, const String& group);
 	ScriptComponent(ScriptComponent&) = delete;
 	virtual ~ScriptComponent();
 
 	bool isSuccessful(const sol::function_result& result);
+	bool runScript(int index);
+	void updateDependencies();
 
 public:
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::ScriptComponent;
@@ -35,14 +44,26 @@ public:
 	void onBegin();
 	virtual void onUpdate(float deltaMilliSeconds);
 	void onEnd();
-	void onHit(btPersistentManifold* manifold, PhysicsColliderComponent* other);
+	/// Called once in the frame where this component's collider starts touching another collider.
+	void onHit(const PhysicsContact& contact, PhysicsColliderComponent* other);
+	/// Called once every frame while the colliders keep touching. Only runs scripts that define onHitStay.
+	void onHitStay(const PhysicsContact& contact, PhysicsColliderComponent* other);
+	/// Called once in the frame where the colliders stop touching. Only runs scripts that define onHitEnd.
+	void onHitEnd(PhysicsColliderComponent* other);
 
 	ComponentID getComponentID() const override { return s_ID; }
 	virtual String getName() const override { return "ScriptComponent"; }
 	virtual JSON::json getJSON() const override;
 
+	const String& getGroup() const { return m_Group; }
+	const LuaAllocationStats& getAllocationStats() const { return m_AllocationStats; }
+	/// Lua state that the scripts of this component run in.
+	sol::state& getLuaState();
+
 	void addScript(LuaTextResourceFile* scriptFile);
 	void removeScript(LuaTextResourceFile* scriptFile);
+	/// Run a changed script again in a new environment. Calls its onBegin() if the scripts are already running.
+	void reloadScript(LuaTextResourceFile* scriptFile);
 
 #ifdef ROOTEX_EDITOR
 	virtual void draw();
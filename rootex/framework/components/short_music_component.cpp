@@ -10,6 +10,7 @@ Component* ShortMusicComponent::Create(const JSON::json& componentData)
 	    (ALfloat)componentData["rolloffFactor"],
 	    (ALfloat)componentData["referenceDistance"],
 	    (ALfloat)componentData["maxDistance"]);
+	shortMusicComponent->setPriority(componentData.value("priority", 0));
 	return shortMusicComponent;
 }
 
@@ -40,10 +41,10 @@ ShortMusicComponent::~ShortMusicComponent()
 bool ShortMusicComponent::setup()
 {
 	m_StaticAudioSource.reset();
-	m_StaticAudioBuffer.reset(new StaticAudioBuffer(m_AudioFile));
+	m_StaticAudioBuffer = StaticAudioBuffer::Create(m_AudioFile);
 	m_StaticAudioSource.reset(new StaticAudioSource(m_StaticAudioBuffer));
 
-	setAudioSource(m_StaticAudioSource.get());
+	setAudioSource(m_StaticAudioSource);
 
 	bool status = AudioComponent::setup();
 	if (m_Owner)
@@ -128,7 +129,7 @@ void ShortMusicComponent::draw()
 			}
 			else
 			{
-				WARN("Cannot assign a non-wav file to Audio File");
+				WARN("Cannot assign a non-audio file to Audio File");
 			}
 		}
 		ImGui::EndDragDropTarget();
@@ -36,6 +36,27 @@ void TransformComponent::updatePositionRotationScaleFromTransform(Matrix& transf
 	transform.Decompose(m_TransformBuffer.m_Scale, m_TransformBuffer.m_Rotation, m_TransformBuffer.m_Position);
 }
 
+void TransformComponent::savePreviousState()
+{
+	m_PreviousPosition = m_TransformBuffer.m_Position;
+	m_PreviousRotation = m_TransformBuffer.m_Rotation;
+	m_PreviousScale = m_TransformBuffer.m_Scale;
+}
+
+void TransformComponent::interpolate(float alpha, const Matrix& parentInterpolatedTransform)
+{
+	if (alpha >= 1.0f)
+	{
+		m_InterpolatedAbsoluteTransform = m_TransformBuffer.m_Transform * parentInterpolatedTransform;
+		return;
+	}
+
+	Matrix interpolatedTransform = Matrix::CreateScale(Vector3::Lerp(m_PreviousScale, m_TransformBuffer.m_Scale, alpha));
+	interpolatedTransform *= Matrix::CreateFromQuaternion(Quaternion::Slerp(m_PreviousRotation, m_TransformBuffer.m_Rotation, alpha));
+	interpolatedTransform *= Matrix::CreateTranslation(Vector3::Lerp(m_PreviousPosition, m_TransformBuffer.m_Position, alpha));
+	m_InterpolatedAbsoluteTransform = interpolatedTransform * parentInterpolatedTransform;
+}
+
 TransformComponent::TransformComponent(const Vector3& position, const Vector4& rotation, const Vector3& scale)
 {
 	m_TransformBuffer.m_Position = position;
@@ -43,6 +64,8 @@ TransformComponent::TransformComponent(const Vector3& position, const Vector4& r
 	m_TransformBuffer.m_Scale = scale;
 
 	updateTransformFromPositionRotationScale();
+	savePreviousState();
+	m_InterpolatedAbsoluteTransform = m_TransformBuffer.m_Transform;
 
 #ifdef ROOTEX_EDITOR
 	m_EditorRotation = { 0.0f, 0.0f, 0.0f };
@@ -106,6 +129,26 @@ void TransformComponent::setRotationPosition(const Matrix& transform)
 	updatePositionRotationScaleFromTransform(m_TransformBuffer.m_Transform);
 }
 
+void TransformComponent::setRotationPosition(const Quaternion& rotation, const Vector3& position)
+{
+	m_TransformBuffer.m_Rotation = rotation;
+	m_TransformBuffer.m_Position = position;
+
+	// Scale * Rotation * Translation, by scaling the rows of the rotation and writing the translation row
+	Matrix& transform = m_TransformBuffer.m_Transform;
+	transform = Matrix::CreateFromQuaternion(rotation);
+	const float scale[3] = { m_TransformBuffer.m_Scale.x, m_TransformBuffer.m_Scale.y, m_TransformBuffer.m_Scale.z };
+	for (int row = 0; row < 3; row++)
+	{
+		transform.m[row][0] *= scale[row];
+		transform.m[row][1] *= scale[row];
+		transform.m[row][2] *= scale[row];
+	}
+	transform.m[3][0] = position.x;
+	transform.m[3][1] = position.y;
+	transform.m[3][2] = position.z;
+}
+
 void TransformComponent::addTransform(const Matrix& applyTransform)
 {
 	setTransform(getLocalTransform() * applyTransform);
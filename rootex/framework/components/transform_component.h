@@ -20,11 +20,23 @@ class TransformComponent : public Component
 	TransformBuffer m_TransformBuffer;
 	bool m_LockScale = false;
 
+	/// Local position, rotation and scale at the start of the current simulation tick.
+	Vector3 m_PreviousPosition;
+	Quaternion m_PreviousRotation;
+	Vector3 m_PreviousScale;
+	/// Absolute transform blended between the last two simulation ticks, used for rendering.
+	Matrix m_InterpolatedAbsoluteTransform;
+
 	const TransformBuffer* getTransformBuffer() const { return &m_TransformBuffer; };
 
 	void updateTransformFromPositionRotationScale();
 	void updatePositionRotationScaleFromTransform(Matrix& transform);
 
+	/// Remember the current state as the one to interpolate from. Called before every simulation tick.
+	void savePreviousState();
+	/// Blend the previous and current state by the fraction of a tick elapsed since the last simulation tick.
+	void interpolate(float alpha, const Matrix& parentInterpolatedTransform);
+
 	TransformComponent(const Vector3& position, const Vector4& rotation, const Vector3& scale);
 	TransformComponent(TransformComponent&) = delete;
 
@@ -51,6 +63,8 @@ public:
 	void setScale(const Vector3& scale);
 	void setTransform(const Matrix& transform);
 	void setRotationPosition(const Matrix& transform);
+	/// Faster than setting a matrix since nothing needs to be decomposed.
+	void setRotationPosition(const Quaternion& rotation, const Vector3& position);
 	void addTransform(const Matrix& applyTransform);
 	void addRotation(const Quaternion& applyTransform);
 
@@ -61,6 +75,8 @@ public:
 	Matrix getRotationPosition() const { return Matrix::CreateFromQuaternion(m_TransformBuffer.m_Rotation) * Matrix::CreateTranslation(m_TransformBuffer.m_Position) * m_TransformBuffer.m_ParentAbsoluteTransform; }
 	Matrix getAbsoluteTransform() const { return m_TransformBuffer.m_Transform * m_TransformBuffer.m_ParentAbsoluteTransform; }
 	Matrix getParentAbsoluteTransform() const { return m_TransformBuffer.m_ParentAbsoluteTransform; }
+	/// Absolute transform as it should be rendered this frame. Lags the simulation by up to one tick.
+	const Matrix& getInterpolatedAbsoluteTransform() const { return m_InterpolatedAbsoluteTransform; }
 	ComponentID getComponentID() const override { return s_ID; }
 	virtual String getName() const override { return "TransformComponent"; }
 	virtual JSON::json getJSON() const override;
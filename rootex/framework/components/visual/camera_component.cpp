@@ -37,7 +37,7 @@ void CameraComponent::refreshProjectionMatrix()
 
 void CameraComponent::refreshViewMatrix()
 {
-	const Matrix& absoluteTransform = m_TransformComponent->getAbsoluteTransform();
+	const Matrix& absoluteTransform = m_TransformComponent->getInterpolatedAbsoluteTransform();
 	m_ViewMatrix = Matrix::CreateLookAt(
 	    absoluteTransform.Translation(),
 	    absoluteTransform.Translation() + absoluteTransform.Forward(),
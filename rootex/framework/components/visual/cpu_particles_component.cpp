@@ -68,7 +68,6 @@ CPUParticlesComponent::CPUParticlesComponent(size_t poolSize, const String& part
 	m_AllowedMaterials = { BasicMaterial::s_MaterialName };
 	m_ParticlePool.resize(poolSize);
 	m_PoolIndex = poolSize - 1;
-	m_LastRenderTimePoint = std::chrono::high_resolution_clock::now();
 	m_EmitRate = 0;
 }
 
@@ -98,6 +97,7 @@ bool CPUParticlesComponent::preRender()
 		i--;
 	}
 
+	float delta = RenderSystem::GetSingleton()->getFrameDelta() * MS_TO_S;
 	for (auto& particle : m_ParticlePool)
 	{
 		if (particle.m_LifeRemaining <= 0.0f)
@@ -110,7 +110,6 @@ bool CPUParticlesComponent::preRender()
 			continue;
 		}
 
-		float delta = (std::chrono::high_resolution_clock::now() - m_LastRenderTimePoint).count() * (NS_TO_MS * MS_TO_S);
 		particle.m_LifeRemaining -= delta;
 		// https://gamedev.stackexchange.com/a/157018/106158
 		particle.m_Transform = Matrix::Transform(Matrix::CreateTranslation(particle.m_Velocity * delta) * particle.m_Transform, 0.5f * particle.m_AngularVelocity * delta);
@@ -151,18 +150,12 @@ void CPUParticlesComponent::render()
 	}
 }
 
-void CPUParticlesComponent::postRender()
-{
-	ModelComponent::postRender();
-	m_LastRenderTimePoint = std::chrono::high_resolution_clock::now();
-}
-
 void CPUParticlesComponent::emit(const ParticleTemplate& particleTemplate)
 {
 	Particle& particle = m_ParticlePool[m_PoolIndex];
 
 	particle.m_IsActive = true;
-	particle.m_Transform = m_TransformComponent->getAbsoluteTransform();
+	particle.m_Transform = m_TransformComponent->getInterpolatedAbsoluteTransform();
 
 	particle.m_Velocity = particleTemplate.m_Velocity;
 	particle.m_Velocity.x += particleTemplate.m_VelocityVariation * (Random::Float() - 0.5f);
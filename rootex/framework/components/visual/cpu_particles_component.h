@@ -39,7 +39,6 @@ class CPUParticlesComponent : public ModelComponent
 	size_t m_PoolIndex;
 	int m_EmitRate;
 	TransformComponent* m_TransformComponent;
-	std::chrono::time_point<std::chrono::high_resolution_clock> m_LastRenderTimePoint;
 
 	friend class EntityFactory;
 
@@ -53,7 +52,6 @@ public:
 	virtual bool setup() override;
 	virtual bool preRender() override;
 	virtual void render() override;
-	virtual void postRender() override;
 
 	void emit(const ParticleTemplate& particleTemplate);
 
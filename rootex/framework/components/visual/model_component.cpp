@@ -9,6 +9,7 @@
 #include "framework/systems/render_system.h"
 #include "renderer/material_library.h"
 #include "renderer/render_pass.h"
+#include "renderer/texture_streamer.h"
 
 Component* ModelComponent::Create(const JSON::json& componentData)
 {
@@ -76,7 +77,7 @@ bool ModelComponent::preRender()
 {
 	if (m_TransformComponent)
 	{
-		RenderSystem::GetSingleton()->pushMatrixOverride(m_TransformComponent->getAbsoluteTransform());
+		RenderSystem::GetSingleton()->pushMatrixOverride(m_TransformComponent->getInterpolatedAbsoluteTransform());
 	}
 	else
 	{
@@ -97,10 +98,16 @@ void ModelComponent::render()
 	{
 		RenderSystem::GetSingleton()->getRenderer()->bind(material.get());
 
+		float screenSize = 0.0f;
 		for (auto& mesh : meshes)
 		{
 			RenderSystem::GetSingleton()->getRenderer()->draw(mesh.m_VertexBuffer.get(), mesh.m_IndexBuffer.get());
+
+			DirectX::BoundingBox worldBounds;
+			mesh.m_Bounds.Transform(worldBounds, RenderSystem::GetSingleton()->getCurrentMatrix());
+			screenSize = std::max(screenSize, TextureStreamer::GetSingleton()->getScreenSize(worldBounds));
 		}
+		material->requestTextureDetail(screenSize);
 	}
 }
 
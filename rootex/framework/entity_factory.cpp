@@ -1,6 +1,7 @@
 #include "entity_factory.h"
 
 #include "core/event_manager.h"
+#include "os/metrics.h"
 
 #include "component.h"
 #include "entity.h"
@@ -82,6 +83,23 @@ EntityFactory::EntityFactory()
 	REGISTER_COMPONENT(CPUParticlesComponent);
 	REGISTER_COMPONENT(TriggerComponent);
 	REGISTER_COMPONENT(UIComponent);
+
+	Metrics::GetSingleton()->addSampler([this, gauges = HashMap<ComponentID, MetricGauge*>()]() mutable {
+		METRIC_GAUGE("Entities", m_Entities.size(), MetricUnit::Count);
+		for (auto& [componentID, components] : System::s_Components)
+		{
+			MetricGauge*& gauge = gauges[componentID];
+			if (!gauge)
+			{
+				if (components.empty())
+				{
+					continue;
+				}
+				gauge = Metrics::GetSingleton()->getGauge("Components/" + components.front()->getName());
+			}
+			gauge->set(components.size());
+		}
+	});
 }
 
 EntityFactory::~EntityFactory()
@@ -203,7 +221,7 @@ Ref<Entity> EntityFactory::createEntity(TextResourceFile* entityJSONDescription,
 
 	m_Entities[entity->m_ID] = entity;
 
-	PRINT("Created entity: " + entity->getFullName());
+	LOG_INFO("Created entity: {}", entity->getFullName());
 
 	return entity;
 }
@@ -8,6 +8,9 @@
 #include "core/audio/static_audio_buffer.h"
 #include "core/audio/streaming_audio_buffer.h"
 #include "core/resource_data.h"
+#include "os/metrics.h"
+#include "os/timer.h"
+#include "os/profiler.h"
 
 String AudioSystem::GetALErrorString(int errID)
 {
@@ -84,9 +87,142 @@ bool AudioSystem::initialize()
 		return false;
 	}
 
+	m_VoiceManager.reset(new VoiceManager(m_MaxVoices));
+
+	m_IsRunning = true;
+	m_AudioThread = std::thread(&AudioSystem::run, this);
+
 	return true;
 }
 
+void AudioSystem::run()
+{
+	StopTimer updateTimer;
+	while (m_IsRunning)
+	{
+		processCommands();
+
+		float deltaSeconds = updateTimer.getTimeMs() * MS_TO_S;
+		updateTimer.reset();
+		m_VoiceManager->update(m_Sources, deltaSeconds);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(m_UpdateIntervalMilliseconds.load()));
+	}
+
+	// Commands sent just before shutting down still need to release their sources
+	processCommands();
+	for (auto& source : m_Sources)
+	{
+		m_VoiceManager->release(source.get());
+	}
+	m_Sources.clear();
+}
+
+void AudioSystem::processCommands()
+{
+	AudioCommand command;
+	while (m_Commands.pop(command))
+	{
+		execute(command);
+		command.m_SourceRef.reset();
+	}
+}
+
+void AudioSystem::execute(AudioCommand& command)
+{
+	AudioSource* source = command.m_Source;
+	switch (command.m_Type)
+	{
+	case AudioCommand::Type::Play:
+		if (source->m_State == AudioSource::State::Playing)
+		{
+			// Restart, like alSourcePlay does
+			releaseVoice(source);
+			source->m_PlaybackOffset = 0.0f;
+		}
+		source->m_IsStarting = true;
+		source->m_PlayingCount = command.m_IntegerValue;
+		source->m_State = AudioSource::State::Playing;
+		break;
+	case AudioCommand::Type::Pause:
+		if (source->m_State == AudioSource::State::Playing)
+		{
+			releaseVoice(source);
+			source->m_State = AudioSource::State::Paused;
+		}
+		break;
+	case AudioCommand::Type::Stop:
+		releaseVoice(source);
+		source->m_PlaybackOffset = 0.0f;
+		source->m_State = AudioSource::State::Stopped;
+		break;
+	case AudioCommand::Type::AddSource:
+		m_Sources.push_back(command.m_SourceRef);
+		break;
+	case AudioCommand::Type::RemoveSource:
+		releaseVoice(source);
+		for (int i = 0; i < m_Sources.size(); i++)
+		{
+			if (m_Sources[i].get() == source)
+			{
+				m_Sources[i] = m_Sources.back();
+				m_Sources.pop_back();
+				break;
+			}
+		}
+		break;
+	default:
+		source->apply(command);
+		break;
+	}
+}
+
+void AudioSystem::releaseVoice(AudioSource* source)
+{
+	if (m_VoiceManager)
+	{
+		m_VoiceManager->release(source);
+	}
+}
+
+int AudioSystem::getVirtualVoiceCount() const
+{
+	return m_VoiceManager ? m_VoiceManager->getVirtualCount() : 0;
+}
+
+void AudioSystem::pushCommand(AudioCommand& command)
+{
+	if (!m_IsRunning)
+	{
+		execute(command);
+		return;
+	}
+
+	while (!m_Commands.push(command))
+	{
+		// Only happens if the audio thread is stalled for thousands of commands
+		std::this_thread::yield();
+	}
+}
+
+void AudioSystem::addSource(Ref<AudioSource> source)
+{
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::AddSource;
+	command.m_Source = source.get();
+	command.m_SourceRef = source;
+	pushCommand(command);
+}
+
+void AudioSystem::removeSource(Ref<AudioSource> source)
+{
+	AudioCommand command;
+	command.m_Type = AudioCommand::Type::RemoveSource;
+	command.m_Source = source.get();
+	command.m_SourceRef = source;
+	pushCommand(command);
+}
+
 void AudioSystem::begin()
 {
 	AudioComponent* audioComponent = nullptr;
@@ -102,15 +238,14 @@ void AudioSystem::begin()
 
 void AudioSystem::update()
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/AudioSystem");
 	AudioComponent* audioComponent = nullptr;
 	for (Component* component : s_Components[AudioComponent::s_ID])
 	{
 		audioComponent = (AudioComponent*)component;
-		audioComponent->getAudioSource()->queueNewBuffers();
 		audioComponent->update();
 	}
-
-	std::this_thread::sleep_for(std::chrono::milliseconds(m_UpdateIntervalMilliseconds));
 }
 
 AudioSystem* AudioSystem::GetSingleton()
@@ -121,24 +256,33 @@ AudioSystem* AudioSystem::GetSingleton()
 
 void AudioSystem::shutDown()
 {
+	if (m_IsRunning)
+	{
+		m_IsRunning = false;
+		m_AudioThread.join();
+	}
+
 	AudioComponent* audioComponent = nullptr;
 	for (Component* component : s_Components[AudioComponent::s_ID])
 	{
 		audioComponent = (AudioComponent*)component;
 		audioComponent->getAudioSource()->stop();
 	}
+	m_VoiceManager.reset();
 	alutExit();
 }
 
 void AudioSystem::setBufferUpdateRate(float milliseconds)
 {
-	m_UpdateIntervalMilliseconds = milliseconds;
+	m_UpdateIntervalMilliseconds = (unsigned int)milliseconds;
 }
 
 AudioSystem::AudioSystem()
     : m_Context(nullptr)
     , m_Device(nullptr)
-    , m_UpdateIntervalMilliseconds(0)
+    , m_UpdateIntervalMilliseconds(10)
+    , m_IsRunning(false)
+    , m_MaxVoices(32)
 {
 	AL_CHECK(alListener3f(AL_POSITION, 0, 0, 0));
 	AL_CHECK(alListener3f(AL_VELOCITY, 0, 0, 0));
@@ -146,4 +290,9 @@ AudioSystem::AudioSystem()
 
 AudioSystem::~AudioSystem()
 {
+	if (m_AudioThread.joinable())
+	{
+		m_IsRunning = false;
+		m_AudioThread.join();
+	}
 }
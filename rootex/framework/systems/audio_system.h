@@ -7,6 +7,11 @@
 #include "vendor/OpenAL/include/alut.h"
 
 #include "system.h"
+#include "core/audio/audio_command_queue.h"
+#include "core/audio/voice_manager.h"
+
+#include <atomic>
+#include <thread>
 
 #ifndef ALUT_CHECK
 #ifdef _DEBUG
@@ -44,17 +49,32 @@ class StreamingAudioSource;
 class ResourceFile;
 
 /// System encapsulating OpenAL error checkers and getters.
+/// Streaming buffers are refilled on a dedicated audio thread. The game thread only sends it commands through a lock-free queue, so it never waits on audio.
 class AudioSystem : public System
 {
-	unsigned int m_UpdateIntervalMilliseconds;
+	std::atomic<unsigned int> m_UpdateIntervalMilliseconds;
 	ALCdevice* m_Device;
 	ALCcontext* m_Context;
 	int m_ListenerID;
 
+	std::thread m_AudioThread;
+	std::atomic<bool> m_IsRunning;
+	AudioCommandQueue m_Commands;
+	int m_MaxVoices;
+	Ptr<VoiceManager> m_VoiceManager;
+	/// All sources known to the audio thread. Only touched on the audio thread.
+	Vector<Ref<AudioSource>> m_Sources;
+
 	AudioSystem();
 	AudioSystem(AudioSystem&) = delete;
 	~AudioSystem();
 
+	/// Audio thread loop.
+	void run();
+	void processCommands();
+	void execute(AudioCommand& command);
+	void releaseVoice(AudioSource* source);
+
 public:
 	static AudioSystem* GetSingleton();
 
@@ -69,10 +89,23 @@ public:
 	/// Wrapper over alutGetError function.
 	static void CheckALUTError(const char* msg, const char* fname, int line);
 
+	/// Set how often the audio thread refills streaming buffers.
 	void setBufferUpdateRate(float milliseconds);
+	/// Set the number of OpenAL sources shared by all audio sources. Only takes effect before initialize().
+	void setMaxVoices(int voices) { m_MaxVoices = voices; }
+	/// Number of playing sources without a voice after the last audio thread update.
+	int getVirtualVoiceCount() const;
+
+	/// Send a command to the audio thread. Call only from the game thread. Runs the command right away if the audio thread is not running.
+	void pushCommand(AudioCommand& command);
+	/// Let the audio thread start managing a source. Sources not added never get a voice.
+	void addSource(Ref<AudioSource> source);
+	/// Hand a source over to the audio thread, which deletes it once all earlier commands to it are done.
+	void removeSource(Ref<AudioSource> source);
 
 	bool initialize();
 	void begin();
+	/// Sends source positions to the audio thread.
 	void update();
 	void shutDown();
 };
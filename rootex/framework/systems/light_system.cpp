@@ -24,7 +24,7 @@ PSDiffuseConstantBufferLights LightSystem::getLights()
 	{
 		PointLightComponent* light = dynamic_cast<PointLightComponent*>(pointLightComponents[i]);
 		TransformComponent* transform = light->getOwner()->getComponent<TransformComponent>().get();
-		Vector3 transformedPosition = transform->getAbsoluteTransform().Translation();
+		Vector3 transformedPosition = transform->getInterpolatedAbsoluteTransform().Translation();
 		lights.pointLightInfos[i] = {
 			light->m_AmbientColor, light->m_DiffuseColor, light->m_DiffuseIntensity,
 			light->m_AttConst, light->m_AttLin, light->m_AttQuad,
@@ -61,7 +61,7 @@ PSDiffuseConstantBufferLights LightSystem::getLights()
 	for (; i < spotLightComponents.size() && i < 4; i++)
 	{
 		SpotLightComponent* light = dynamic_cast<SpotLightComponent*>(spotLightComponents[i]);
-		Matrix transform = light->getOwner()->getComponent<TransformComponent>()->getAbsoluteTransform();
+		Matrix transform = light->getOwner()->getComponent<TransformComponent>()->getInterpolatedAbsoluteTransform();
 		lights.spotLightInfos[i] = {
 			light->m_AmbientColor, light->m_DiffuseColor, light->m_DiffuseIntensity,
 			light->m_AttConst, light->m_AttLin, light->m_AttQuad,
@@ -3,15 +3,107 @@
 #include "core/resource_loader.h"
 
 #include "common/common.h"
+#include "app/application.h"
 
 #include "components/physics/physics_collider_component.h"
 #include "components/script_component.h"
 
+#include "os/metrics.h"
+#include "os/profiler.h"
 #include "os/timer.h"
 #include "render_system.h"
 
 #include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
 
+#include <algorithm>
+
+bool PhysicsContactPair::operator<(const PhysicsContactPair& other) const
+{
+	if (m_Entity0 != other.m_Entity0)
+	{
+		return m_Entity0 < other.m_Entity0;
+	}
+	return m_Entity1 < other.m_Entity1;
+}
+
+bool PhysicsContactPair::operator==(const PhysicsContactPair& other) const
+{
+	return m_Entity0 == other.m_Entity0 && m_Entity1 == other.m_Entity1;
+}
+
+static sol::table CastHitsToTable(sol::state_view& lua, const Vector<PhysicsCastHit>& hits)
+{
+	sol::table results = lua.create_table(hits.size(), 0);
+	for (int i = 0; i < hits.size(); i++)
+	{
+		const PhysicsCastHit& hit = hits[i];
+		sol::table result = lua.create_table(0, 5);
+		result["hit"] = hit.m_Collider != nullptr;
+		result["collider"] = hit.m_Collider;
+		result["point"] = hit.m_Point;
+		result["normal"] = hit.m_Normal;
+		result["fraction"] = hit.m_Fraction;
+		results[i + 1] = result;
+	}
+	return results;
+}
+
+void PhysicsSystem::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<PhysicsSystem> physicsSystem = rootex.new_usertype<PhysicsSystem>("PhysicsSystem");
+	physicsSystem["Get"] = &PhysicsSystem::GetSingleton;
+	physicsSystem["getActiveBodyCount"] = &PhysicsSystem::getActiveBodyCount;
+	physicsSystem["getBodyCount"] = &PhysicsSystem::getBodyCount;
+	physicsSystem["query"] = [](PhysicsSystem* system, const sol::table& queries, sol::this_state state) {
+		PhysicsQueryBatch batch;
+		// Queries are read by index so that results come back in the same order
+		auto readCasts = [](const sol::optional<sol::table>& table, Vector<PhysicsCastQuery>& casts) {
+			if (!table)
+			{
+				return;
+			}
+			for (int i = 1; i <= table->size(); i++)
+			{
+				sol::table cast = (*table)[i];
+				casts.push_back({ cast.get<Vector3>("from"), cast.get<Vector3>("to"), cast.get_or("radius", 0.0f), cast.get_or("mask", (int)btBroadphaseProxy::AllFilter) });
+			}
+		};
+		readCasts(queries["rays"], batch.m_Rays);
+		readCasts(queries["sweeps"], batch.m_Sweeps);
+		sol::optional<sol::table> overlaps = queries["overlaps"];
+		if (overlaps)
+		{
+			for (int i = 1; i <= overlaps->size(); i++)
+			{
+				sol::table overlap = (*overlaps)[i];
+				batch.m_Overlaps.push_back({ overlap.get<Vector3>("center"), overlap.get_or("radius", 0.0f), overlap.get_or("mask", (int)btBroadphaseProxy::AllFilter) });
+			}
+		}
+
+		system->query(batch, queries.get_or("parallel", false));
+
+		sol::state_view lua(state);
+		sol::table results = lua.create_table(0, 3);
+		results["rays"] = CastHitsToTable(lua, batch.m_RayHits);
+		results["sweeps"] = CastHitsToTable(lua, batch.m_SweepHits);
+		sol::table overlapResults = lua.create_table(batch.m_Overlaps.size(), 0);
+		int hitIndex = 0;
+		for (int i = 0; i < batch.m_Overlaps.size(); i++)
+		{
+			// Hits of a query are together and nearest first
+			sol::table colliders = lua.create_table();
+			int colliderIndex = 1;
+			for (; hitIndex < batch.m_OverlapHits.size() && batch.m_OverlapHits[hitIndex].m_QueryIndex == i; hitIndex++)
+			{
+				colliders[colliderIndex++] = batch.m_OverlapHits[hitIndex].m_Collider;
+			}
+			overlapResults[i + 1] = colliders;
+		}
+		results["overlaps"] = overlapResults;
+		return results;
+	};
+}
+
 PhysicsSystem* PhysicsSystem::GetSingleton()
 {
 	static PhysicsSystem singleton;
@@ -21,10 +113,25 @@ PhysicsSystem* PhysicsSystem::GetSingleton()
 void PhysicsSystem::initialize()
 {
 	m_CollisionConfiguration.reset(new btDefaultCollisionConfiguration());
-	m_Dispatcher.reset(new btCollisionDispatcher(m_CollisionConfiguration.get()));
 	m_Broadphase.reset(new btDbvtBroadphase());
-	m_Solver.reset(new btSequentialImpulseConstraintSolver);
-	m_DynamicsWorld.reset(new btDiscreteDynamicsWorld(m_Dispatcher.get(), m_Broadphase.get(), m_Solver.get(), m_CollisionConfiguration.get()));
+	if (m_IsMultithreaded)
+	{
+		// The scheduler has to be set before any of the Mt classes are created
+		m_TaskScheduler.reset(new BulletTaskScheduler(Application::GetSingleton()->getThreadPool()));
+		btSetTaskScheduler(m_TaskScheduler.get());
+
+		m_Dispatcher.reset(new btCollisionDispatcherMt(m_CollisionConfiguration.get()));
+		m_SolverPool.reset(new btConstraintSolverPoolMt(m_TaskScheduler->getNumThreads()));
+		m_Solver.reset(new btSequentialImpulseConstraintSolverMt);
+		m_DynamicsWorld.reset(new btDiscreteDynamicsWorldMt(m_Dispatcher.get(), m_Broadphase.get(), m_SolverPool.get(), m_Solver.get(), m_CollisionConfiguration.get()));
+		PRINT("Physics is running on " + std::to_string(m_TaskScheduler->getParallelism()) + " threads");
+	}
+	else
+	{
+		m_Dispatcher.reset(new btCollisionDispatcher(m_CollisionConfiguration.get()));
+		m_Solver.reset(new btSequentialImpulseConstraintSolver);
+		m_DynamicsWorld.reset(new btDiscreteDynamicsWorld(m_Dispatcher.get(), m_Broadphase.get(), m_Solver.get(), m_CollisionConfiguration.get()));
+	}
 
 	LuaTextResourceFile* physicsMaterial = ResourceLoader::CreateLuaTextResourceFile("game/assets/config/physics.lua");
 	LuaInterpreter::GetSingleton()->getLuaState().script(physicsMaterial->getString());
@@ -40,6 +147,17 @@ void PhysicsSystem::initialize()
 	m_DynamicsWorld->setWorldUserInfo(this);
 	m_DynamicsWorld->setDebugDrawer(&m_DebugDrawer);
 	m_DynamicsWorld->getDebugDrawer()->setDebugMode(btIDebugDraw::DBG_DrawWireframe);
+
+	Metrics::GetSingleton()->addSampler([this]() {
+		const btCollisionObjectArray& objects = m_DynamicsWorld->getCollisionObjectArray();
+		int activeCount = 0;
+		for (int i = 0; i < objects.size(); i++)
+		{
+			activeCount += objects[i]->isActive();
+		}
+		METRIC_GAUGE("Physics/Bodies", objects.size(), MetricUnit::Count);
+		METRIC_GAUGE("Physics/Active Bodies", activeCount, MetricUnit::Count);
+	});
 }
 
 PhysicsSystem::~PhysicsSystem()
@@ -53,11 +171,18 @@ PhysicsSystem::~PhysicsSystem()
 		m_DynamicsWorld->removeCollisionObject(obj);
 		delete obj;
 	}
+
+	if (m_TaskScheduler)
+	{
+		btSetTaskScheduler(btGetSequentialTaskScheduler());
+	}
 }
 
-void PhysicsSystem::addRigidBody(btRigidBody* body)
+void PhysicsSystem::addRigidBody(btRigidBody* body, int collisionGroup, int collisionMask)
 {
-	m_DynamicsWorld->addRigidBody(body);
+	m_DynamicsWorld->addRigidBody(body, collisionGroup, collisionMask);
+	m_IsBroadphaseDirty = true;
+	m_BodyTransforms.push_back({ body, static_cast<PhysicsColliderComponent*>(body->getUserPointer())->m_TransformComponent });
 }
 
 sol::table PhysicsSystem::getPhysicsMaterial()
@@ -67,8 +192,8 @@ sol::table PhysicsSystem::getPhysicsMaterial()
 
 btCollisionWorld::AllHitsRayResultCallback PhysicsSystem::reportAllRayHits(const btVector3& m_From, const btVector3& m_To)
 {
-	m_DynamicsWorld->updateAabbs();
-	m_DynamicsWorld->computeOverlappingPairs();
+	refreshBroadphase();
+	std::shared_lock<std::shared_mutex> lock(m_QueryMutex);
 
 	btCollisionWorld::AllHitsRayResultCallback allResults(m_From, m_To);
 	allResults.m_flags |= btTriangleRaycastCallback::kF_KeepUnflippedNormal;
@@ -80,6 +205,9 @@ btCollisionWorld::AllHitsRayResultCallback PhysicsSystem::reportAllRayHits(const
 
 btCollisionWorld::ClosestRayResultCallback PhysicsSystem::reportClosestRayHits(const btVector3& m_From, const btVector3& m_To)
 {
+	refreshBroadphase();
+	std::shared_lock<std::shared_mutex> lock(m_QueryMutex);
+
 	btCollisionWorld::ClosestRayResultCallback closestResults(m_From, m_To);
 	closestResults.m_flags |= btTriangleRaycastCallback::kF_FilterBackfaces;
 
@@ -88,6 +216,216 @@ btCollisionWorld::ClosestRayResultCallback PhysicsSystem::reportClosestRayHits(c
 	return closestResults;
 }
 
+void PhysicsQueryBatch::clear()
+{
+	m_Rays.clear();
+	m_Sweeps.clear();
+	m_Overlaps.clear();
+	m_RayHits.clear();
+	m_SweepHits.clear();
+	m_OverlapHits.clear();
+}
+
+/// Answers a slice of the rays and sweeps of a batch on a worker thread.
+class PhysicsQueryTask : public Task
+{
+public:
+	PhysicsQueryBatch* m_Batch;
+	bool m_IsSweep;
+	int m_Begin;
+	int m_End;
+
+	void execute() override
+	{
+		if (m_IsSweep)
+		{
+			PhysicsSystem::GetSingleton()->castSweeps(*m_Batch, m_Begin, m_End);
+		}
+		else
+		{
+			PhysicsSystem::GetSingleton()->castRays(*m_Batch, m_Begin, m_End);
+		}
+	}
+};
+
+/// Collects every collider touching a query shape, once each.
+struct OverlapResultCallback : public btCollisionWorld::ContactResultCallback
+{
+	Vector<PhysicsOverlapHit>& m_Hits;
+	const btCollisionObject* m_QueryObject;
+	int m_QueryIndex;
+	/// Index of the first hit of this query in m_Hits.
+	size_t m_FirstHit;
+
+	OverlapResultCallback(Vector<PhysicsOverlapHit>& hits, const btCollisionObject* queryObject, int queryIndex)
+	    : m_Hits(hits)
+	    , m_QueryObject(queryObject)
+	    , m_QueryIndex(queryIndex)
+	    , m_FirstHit(hits.size())
+	{
+	}
+
+	btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1) override
+	{
+		if (cp.getDistance() > 0.0f)
+		{
+			return 0;
+		}
+
+		// Bullet may report the pair in either order
+		const btCollisionObject* other = colObj0Wrap->getCollisionObject() == m_QueryObject ? colObj1Wrap->getCollisionObject() : colObj0Wrap->getCollisionObject();
+		PhysicsColliderComponent* collider = static_cast<PhysicsColliderComponent*>(other->getUserPointer());
+		if (!collider)
+		{
+			return 0;
+		}
+		for (size_t i = m_FirstHit; i < m_Hits.size(); i++)
+		{
+			if (m_Hits[i].m_Collider == collider)
+			{
+				return 0;
+			}
+		}
+		float distance = (other->getWorldTransform().getOrigin() - m_QueryObject->getWorldTransform().getOrigin()).length();
+		m_Hits.push_back({ m_QueryIndex, collider, distance });
+		return 0;
+	}
+};
+
+void PhysicsSystem::refreshBroadphase()
+{
+	if (!m_IsBroadphaseDirty)
+	{
+		return;
+	}
+	std::unique_lock<std::shared_mutex> lock(m_QueryMutex);
+	if (m_IsBroadphaseDirty.exchange(false))
+	{
+		m_DynamicsWorld->updateAabbs();
+	}
+}
+
+void PhysicsSystem::castRays(PhysicsQueryBatch& batch, int begin, int end)
+{
+	for (int i = begin; i < end; i++)
+	{
+		const PhysicsCastQuery& ray = batch.m_Rays[i];
+		btVector3 from = PhysicsColliderComponent::vecTobtVector3(ray.m_From);
+		btVector3 to = PhysicsColliderComponent::vecTobtVector3(ray.m_To);
+
+		btCollisionWorld::ClosestRayResultCallback result(from, to);
+		result.m_collisionFilterMask = ray.m_CollisionMask;
+		m_DynamicsWorld->rayTest(from, to, result);
+
+		PhysicsCastHit& hit = batch.m_RayHits[i];
+		if (result.hasHit())
+		{
+			hit.m_Collider = static_cast<PhysicsColliderComponent*>(result.m_collisionObject->getUserPointer());
+			hit.m_Point = PhysicsColliderComponent::btVector3ToVec(result.m_hitPointWorld);
+			hit.m_Normal = PhysicsColliderComponent::btVector3ToVec(result.m_hitNormalWorld);
+			hit.m_Fraction = result.m_closestHitFraction;
+		}
+	}
+}
+
+void PhysicsSystem::castSweeps(PhysicsQueryBatch& batch, int begin, int end)
+{
+	for (int i = begin; i < end; i++)
+	{
+		const PhysicsCastQuery& sweep = batch.m_Sweeps[i];
+		btVector3 from = PhysicsColliderComponent::vecTobtVector3(sweep.m_From);
+		btVector3 to = PhysicsColliderComponent::vecTobtVector3(sweep.m_To);
+		btSphereShape sphere(sweep.m_Radius);
+
+		btCollisionWorld::ClosestConvexResultCallback result(from, to);
+		result.m_collisionFilterMask = sweep.m_CollisionMask;
+		m_DynamicsWorld->convexSweepTest(&sphere, btTransform(btQuaternion::getIdentity(), from), btTransform(btQuaternion::getIdentity(), to), result);
+
+		PhysicsCastHit& hit = batch.m_SweepHits[i];
+		if (result.hasHit())
+		{
+			hit.m_Collider = static_cast<PhysicsColliderComponent*>(result.m_hitCollisionObject->getUserPointer());
+			hit.m_Point = PhysicsColliderComponent::btVector3ToVec(result.m_hitPointWorld);
+			hit.m_Normal = PhysicsColliderComponent::btVector3ToVec(result.m_hitNormalWorld);
+			hit.m_Fraction = result.m_closestHitFraction;
+		}
+	}
+}
+
+void PhysicsSystem::testOverlaps(PhysicsQueryBatch& batch)
+{
+	// Narrowphase algorithms are created through the shared dispatcher, which is not thread safe
+	std::unique_lock<std::shared_mutex> lock(m_QueryMutex);
+
+	btSphereShape sphere(1.0f);
+	btCollisionObject queryObject;
+	queryObject.setCollisionShape(&sphere);
+	for (int i = 0; i < batch.m_Overlaps.size(); i++)
+	{
+		const PhysicsOverlapQuery& overlap = batch.m_Overlaps[i];
+		sphere.setUnscaledRadius(overlap.m_Radius);
+		queryObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), PhysicsColliderComponent::vecTobtVector3(overlap.m_Center)));
+
+		OverlapResultCallback result(batch.m_OverlapHits, &queryObject, i);
+		result.m_collisionFilterMask = overlap.m_CollisionMask;
+		m_DynamicsWorld->contactTest(&queryObject, result);
+		// A total order, so that an in-place sort, which does not allocate unlike a stable sort, orders hits the same in every run
+		std::sort(batch.m_OverlapHits.begin() + result.m_FirstHit, batch.m_OverlapHits.end(), [](const PhysicsOverlapHit& a, const PhysicsOverlapHit& b) {
+			if (a.m_Distance != b.m_Distance)
+			{
+				return a.m_Distance < b.m_Distance;
+			}
+			EntityID entityA = a.m_Collider->getOwner()->getID();
+			EntityID entityB = b.m_Collider->getOwner()->getID();
+			if (entityA != entityB)
+			{
+				return entityA < entityB;
+			}
+			return std::less<PhysicsColliderComponent*>()(a.m_Collider, b.m_Collider);
+		});
+	}
+}
+
+void PhysicsSystem::query(PhysicsQueryBatch& batch, bool isParallel)
+{
+	refreshBroadphase();
+
+	batch.m_RayHits.assign(batch.m_Rays.size(), PhysicsCastHit());
+	batch.m_SweepHits.assign(batch.m_Sweeps.size(), PhysicsCastHit());
+	batch.m_OverlapHits.clear();
+
+	// Parallel tasks read the world under this lock too, as the waiting thread holds it for them
+	std::shared_lock<std::shared_mutex> lock(m_QueryMutex);
+	if (isParallel)
+	{
+		static const int QueriesPerTask = 64;
+
+		Vector<Ref<Task>> tasks;
+		auto addTasks = [&](int count, bool isSweep) {
+			for (int begin = 0; begin < count; begin += QueriesPerTask)
+			{
+				Ref<PhysicsQueryTask> task(new PhysicsQueryTask());
+				task->m_Batch = &batch;
+				task->m_IsSweep = isSweep;
+				task->m_Begin = begin;
+				task->m_End = std::min(begin + QueriesPerTask, count);
+				tasks.push_back(task);
+			}
+		};
+		addTasks(batch.m_Rays.size(), false);
+		addTasks(batch.m_Sweeps.size(), true);
+		Application::GetSingleton()->getThreadPool().submit(tasks);
+	}
+	else
+	{
+		castRays(batch, 0, batch.m_Rays.size());
+		castSweeps(batch, 0, batch.m_Sweeps.size());
+	}
+	lock.unlock();
+
+	testOverlaps(batch);
+}
+
 // This function is called after bullet performs its internal update.
 // To detect collisions between objects.
 void PhysicsSystem::InternalTickCallback(btDynamicsWorld* const world, btScalar const timeStep)
@@ -101,29 +439,143 @@ void PhysicsSystem::InternalTickCallback(btDynamicsWorld* const world, btScalar
 		// get the "manifold", the set of data corresponding to a contact point
 		// between two physics objects
 		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(manifoldIdx);
+		if (manifold->getNumContacts() == 0)
+		{
+			continue;
+		}
 
-		// get the two bodies used in the manifold.
-		btRigidBody const* const body0 = static_cast<btRigidBody const*>(manifold->getBody0());
-		btRigidBody const* const body1 = static_cast<btRigidBody const*>(manifold->getBody1());
+		PhysicsColliderComponent* collider0 = static_cast<PhysicsColliderComponent*>(manifold->getBody0()->getUserPointer());
+		PhysicsColliderComponent* collider1 = static_cast<PhysicsColliderComponent*>(manifold->getBody1()->getUserPointer());
+		if (!collider0 || !collider1)
+		{
+			continue;
+		}
 
-		PhysicsColliderComponent* collider0 = (PhysicsColliderComponent*)body0->getUserPointer();
-		PhysicsColliderComponent* collider1 = (PhysicsColliderComponent*)body1->getUserPointer();
+		bool isReported0 = collider0->getIsGeneratesHitEvents() && collider0->getScriptComponent();
+		bool isReported1 = collider1->getIsGeneratesHitEvents() && collider1->getScriptComponent();
+		if (!isReported0 && !isReported1)
+		{
+			continue;
+		}
 
-		if (collider0->getIsGeneratesHitEvents())
+		const btManifoldPoint& point = manifold->getContactPoint(0);
+		PhysicsContactPair pair;
+		pair.m_Collider0 = collider0;
+		pair.m_Collider1 = collider1;
+		pair.m_Contact.m_Point = PhysicsColliderComponent::btVector3ToVec(point.getPositionWorldOnB());
+		// Bullet's normal is on body 1 and points towards body 0
+		pair.m_Contact.m_Normal = PhysicsColliderComponent::btVector3ToVec(point.m_normalWorldOnB);
+		pair.m_Contact.m_Impulse = point.getAppliedImpulse();
+		pair.m_Entity0 = collider0->getOwner()->getID();
+		pair.m_Entity1 = collider1->getOwner()->getID();
+		if (pair.m_Entity1 < pair.m_Entity0)
 		{
-			if (collider0->getScriptComponent())
-			{
-				collider0->getScriptComponent()->onHit(manifold, collider1);
-			}
+			std::swap(pair.m_Collider0, pair.m_Collider1);
+			std::swap(pair.m_Entity0, pair.m_Entity1);
+			pair.m_Contact.m_Normal = -pair.m_Contact.m_Normal;
+		}
+		pair.m_Sequence = physicsSystem->m_ContactBuffer.size();
+
+		physicsSystem->m_ContactBuffer.push_back(pair);
+	}
+}
+
+void PhysicsSystem::dispatchContacts()
+{
+	PROFILE_FUNCTION();
+	// Sorting in place does not allocate, unlike a stable sort. Ties are broken by gathering order, so the contact kept for a pair is always the first one gathered.
+	std::sort(m_ContactBuffer.begin(), m_ContactBuffer.end(), [](const PhysicsContactPair& a, const PhysicsContactPair& b) {
+		if (a == b)
+		{
+			return a.m_Sequence < b.m_Sequence;
+		}
+		return a < b;
+	});
+	m_ContactBuffer.erase(std::unique(m_ContactBuffer.begin(), m_ContactBuffer.end()), m_ContactBuffer.end());
+
+	// Both buffers are sorted, so a single merge pass finds which pairs began, persisted or ended
+	m_ContactNotifications.clear();
+	auto current = m_ContactBuffer.begin();
+	auto previous = m_PreviousContacts.begin();
+	while (current != m_ContactBuffer.end() || previous != m_PreviousContacts.end())
+	{
+		if (previous == m_PreviousContacts.end() || (current != m_ContactBuffer.end() && *current < *previous))
+		{
+			m_ContactNotifications.push_back({ *current, PhysicsContactNotification::Type::Begin });
+			++current;
+		}
+		else if (current == m_ContactBuffer.end() || *previous < *current)
+		{
+			m_ContactNotifications.push_back({ *previous, PhysicsContactNotification::Type::End });
+			++previous;
+		}
+		else
+		{
+			m_ContactNotifications.push_back({ *current, PhysicsContactNotification::Type::Stay });
+			++current;
+			++previous;
 		}
-		if (collider1->getIsGeneratesHitEvents())
+	}
+
+	// Reuse both buffers every frame to avoid allocations
+	std::swap(m_ContactBuffer, m_PreviousContacts);
+	m_ContactBuffer.clear();
+
+	// Scripts may remove colliders, which clears them from the notifications, so notifications are looked up again after every script call
+	for (int n = 0; n < m_ContactNotifications.size(); n++)
+	{
+		for (int i = 0; i < 2; i++)
 		{
-			if (collider1->getScriptComponent())
+			const PhysicsContactNotification& notification = m_ContactNotifications[n];
+			PhysicsColliderComponent* self = i == 0 ? notification.m_Pair.m_Collider0 : notification.m_Pair.m_Collider1;
+			PhysicsColliderComponent* other = i == 0 ? notification.m_Pair.m_Collider1 : notification.m_Pair.m_Collider0;
+			if (!self || !other)
+			{
+				break;
+			}
+			ScriptComponent* script = self->getScriptComponent();
+			if (!self->getIsGeneratesHitEvents() || !script || !(other->getCollisionGroup() & self->getCollisionMask()))
+			{
+				continue;
+			}
+
+			PhysicsContact contact = notification.m_Pair.m_Contact;
+			if (i == 1)
+			{
+				contact.m_Normal = -contact.m_Normal;
+			}
+
+			switch (notification.m_Type)
 			{
-				collider1->getScriptComponent()->onHit(manifold, collider0);
+			case PhysicsContactNotification::Type::Begin:
+				script->onHit(contact, other);
+				break;
+			case PhysicsContactNotification::Type::Stay:
+				script->onHitStay(contact, other);
+				break;
+			case PhysicsContactNotification::Type::End:
+				script->onHitEnd(other);
+				break;
 			}
 		}
 	}
+	m_ContactNotifications.clear();
+}
+
+void PhysicsSystem::removeContacts(PhysicsColliderComponent* collider)
+{
+	auto isInvolved = [collider](const PhysicsContactPair& pair) { return pair.m_Collider0 == collider || pair.m_Collider1 == collider; };
+	m_ContactBuffer.erase(std::remove_if(m_ContactBuffer.begin(), m_ContactBuffer.end(), isInvolved), m_ContactBuffer.end());
+	m_PreviousContacts.erase(std::remove_if(m_PreviousContacts.begin(), m_PreviousContacts.end(), isInvolved), m_PreviousContacts.end());
+	// Notifications are being delivered, so they are only cleared instead of erased
+	for (auto& notification : m_ContactNotifications)
+	{
+		if (isInvolved(notification.m_Pair))
+		{
+			notification.m_Pair.m_Collider0 = nullptr;
+			notification.m_Pair.m_Collider1 = nullptr;
+		}
+	}
 }
 
 void PhysicsSystem::debugDraw()
@@ -146,10 +598,45 @@ void PhysicsSystem::debugDrawComponent(const btTransform& worldTransform, const
 
 void PhysicsSystem::update(float deltaMilliseconds)
 {
-	m_DynamicsWorld->stepSimulation(deltaMilliseconds * MS_TO_S, 10);
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/PhysicsSystem");
+	// Called once per fixed simulation tick, so take exactly one internal step of that size
+	m_DynamicsWorld->stepSimulation(deltaMilliseconds * MS_TO_S, 0);
+	m_IsBroadphaseDirty = true;
+	syncTransforms();
+	dispatchContacts();
 }
 
 void PhysicsSystem::removeRigidBody(btRigidBody* rigidBody)
 {
+	removeContacts(static_cast<PhysicsColliderComponent*>(rigidBody->getUserPointer()));
 	m_DynamicsWorld->removeRigidBody(rigidBody);
+
+	for (int i = 0; i < m_BodyTransforms.size(); i++)
+	{
+		if (m_BodyTransforms[i].m_Body == rigidBody)
+		{
+			m_BodyTransforms[i] = m_BodyTransforms.back();
+			m_BodyTransforms.pop_back();
+			break;
+		}
+	}
+}
+
+void PhysicsSystem::syncTransforms()
+{
+	m_ActiveBodyCount = 0;
+	for (auto& [body, transform] : m_BodyTransforms)
+	{
+		if (!body->isActive() || body->isStaticOrKinematicObject())
+		{
+			continue;
+		}
+		m_ActiveBodyCount++;
+
+		const btTransform& pose = body->getWorldTransform();
+		const btVector3& position = pose.getOrigin();
+		const btQuaternion rotation = pose.getRotation();
+		transform->setRotationPosition({ rotation.x(), rotation.y(), rotation.z(), rotation.w() }, { position.x(), position.y(), position.z() });
+	}
 }
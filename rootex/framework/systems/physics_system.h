@@ -1,10 +1,103 @@
 #pragma once
 
 #include "core/physics/debug_drawer.h"
+#include "core/physics/bullet_task_scheduler.h"
 
 #include "btBulletDynamicsCommon.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
 #include "entity.h"
 #include "framework/system.h"
+#include "components/physics/physics_collider_component.h"
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+/// A pair of colliders in contact, ordered by the IDs of their entities so that every pair has exactly one representation, and pairs sort the same in every run.
+struct PhysicsContactPair
+{
+	PhysicsColliderComponent* m_Collider0;
+	PhysicsColliderComponent* m_Collider1;
+	EntityID m_Entity0;
+	EntityID m_Entity1;
+	/// Contact as seen by m_Collider0.
+	PhysicsContact m_Contact;
+	/// Position in the contacts gathered this frame, so that the first contact gathered for a pair is the one kept.
+	int m_Sequence;
+
+	bool operator<(const PhysicsContactPair& other) const;
+	bool operator==(const PhysicsContactPair& other) const;
+};
+
+/// A contact event waiting to be delivered to scripts
+struct PhysicsContactNotification
+{
+	enum class Type
+	{
+		Begin,
+		Stay,
+		End
+	};
+
+	/// Colliders are set to nullptr if they are removed before the notification is delivered.
+	PhysicsContactPair m_Pair;
+	Type m_Type;
+};
+
+/// A ray, or a sphere swept along a segment when used as a sweep.
+struct PhysicsCastQuery
+{
+	Vector3 m_From;
+	Vector3 m_To;
+	/// Radius of the swept sphere. Unused by rays.
+	float m_Radius = 0.0f;
+	int m_CollisionMask = btBroadphaseProxy::AllFilter;
+};
+
+/// A sphere to find overlapping colliders in.
+struct PhysicsOverlapQuery
+{
+	Vector3 m_Center;
+	float m_Radius = 0.0f;
+	int m_CollisionMask = btBroadphaseProxy::AllFilter;
+};
+
+/// Closest hit of a cast query. m_Collider is null if nothing was hit.
+struct PhysicsCastHit
+{
+	PhysicsColliderComponent* m_Collider = nullptr;
+	Vector3 m_Point;
+	Vector3 m_Normal;
+	/// Fraction of the segment travelled before the hit.
+	float m_Fraction = 1.0f;
+};
+
+struct PhysicsOverlapHit
+{
+	int m_QueryIndex;
+	PhysicsColliderComponent* m_Collider;
+	/// Distance from the center of the query to the origin of the collider.
+	float m_Distance;
+};
+
+/// Scene queries answered together by PhysicsSystem::query. Reuse a batch across frames to avoid reallocating.
+struct PhysicsQueryBatch
+{
+	Vector<PhysicsCastQuery> m_Rays;
+	Vector<PhysicsCastQuery> m_Sweeps;
+	Vector<PhysicsOverlapQuery> m_Overlaps;
+
+	/// One hit per ray, in the order of m_Rays.
+	Vector<PhysicsCastHit> m_RayHits;
+	/// One hit per sweep, in the order of m_Sweeps.
+	Vector<PhysicsCastHit> m_SweepHits;
+	/// Every collider overlapping each overlap query, ordered by query and then nearest first.
+	Vector<PhysicsOverlapHit> m_OverlapHits;
+
+	void clear();
+};
 
 class PhysicsSystem : public System
 {
@@ -24,31 +117,89 @@ class PhysicsSystem : public System
 	/// Allows to configure Bullet collision detection.
 	Ptr<btDefaultCollisionConfiguration> m_CollisionConfiguration;
 
+	/// Solvers used by the multithreaded world to solve islands in parallel.
+	Ptr<btConstraintSolverPoolMt> m_SolverPool;
+
+	/// Dispatches the parallel loops of the multithreaded world to the engine thread pool.
+	Ptr<BulletTaskScheduler> m_TaskScheduler;
+
+	/// Build a btDiscreteDynamicsWorldMt instead of a btDiscreteDynamicsWorld on initialization.
+	bool m_IsMultithreaded = false;
+
 	/// Table of all the material types and their respective data.
 	sol::table m_PhysicsMaterialTable;
 
 	DebugDrawer m_DebugDrawer;
 
+	/// Contacts gathered from every substep of the current frame. May contain duplicates till they are dispatched.
+	Vector<PhysicsContactPair> m_ContactBuffer;
+	/// Sorted unique contact pairs of the last frame, used to find contacts that began or ended.
+	Vector<PhysicsContactPair> m_PreviousContacts;
+	/// Contact events of this frame. Built before any script runs, so that scripts can remove colliders while they are delivered.
+	Vector<PhysicsContactNotification> m_ContactNotifications;
+
+	/// Bodies and the transforms their poses are written to, packed so that syncing touches nothing else.
+	struct BodyTransform
+	{
+		btRigidBody* m_Body;
+		TransformComponent* m_Transform;
+	};
+	Vector<BodyTransform> m_BodyTransforms;
+	int m_ActiveBodyCount = 0;
+
+	/// Set when bodies have moved since the broadphase bounds were last refreshed for queries.
+	std::atomic<bool> m_IsBroadphaseDirty = true;
+	/// Queries read the world under a shared lock, which may be held by several script threads.
+	/// The broadphase refresh and overlap tests, which create narrowphase algorithms through the shared dispatcher, take it exclusively.
+	std::shared_mutex m_QueryMutex;
+
 	PhysicsSystem() = default;
 
+	/// Deduplicate the contacts of this frame into begin, persist and end events and deliver them to scripts.
+	void dispatchContacts();
+	void removeContacts(PhysicsColliderComponent* collider);
+
+	/// Copy the poses of bodies that Bullet simulated in the last step to their transforms. Sleeping bodies are skipped.
+	void syncTransforms();
+	/// Bring the broadphase bounds up to date with the last step or move, at most once in between.
+	void refreshBroadphase();
+	void castRays(PhysicsQueryBatch& batch, int begin, int end);
+	void castSweeps(PhysicsQueryBatch& batch, int begin, int end);
+	void testOverlaps(PhysicsQueryBatch& batch);
+
+	friend class PhysicsQueryTask;
+
 public:
+	static void RegisterAPI(sol::state& rootex);
 	static PhysicsSystem* GetSingleton();
 	virtual ~PhysicsSystem();
 
-	void addRigidBody(btRigidBody* body);
+	void setMultithreaded(bool enabled) { m_IsMultithreaded = enabled; }
+	bool getMultithreaded() const { return m_IsMultithreaded; }
+
+	void addRigidBody(btRigidBody* body, int collisionGroup, int collisionMask);
+	/// Bodies were moved outside of a step, so the next query has to refresh the broadphase bounds first.
+	void markBroadphaseDirty() { m_IsBroadphaseDirty = true; }
 	sol::table getPhysicsMaterial();
 	btCollisionWorld::AllHitsRayResultCallback reportAllRayHits(const btVector3& m_From, const btVector3& m_To);
 	btCollisionWorld::ClosestRayResultCallback reportClosestRayHits(const btVector3& m_From, const btVector3& m_To);
+	/// Answer all queries in the batch against the world as of the last step. Rays and sweeps can be split over the thread pool.
+	void query(PhysicsQueryBatch& batch, bool isParallel = false);
 
 	/// Initialization and Maintenance of the Physics World
 	void initialize();
 
-	/// Callback from bullet for each physics time step.
+	/// Callback from bullet for each physics time step. Only gathers contacts, scripts are notified once per frame.
 	static void InternalTickCallback(btDynamicsWorld* const world, btScalar const timeStep);
 
 	void debugDraw();
 	void debugDrawComponent(const btTransform& worldTransform, const btCollisionShape* shape, const btVector3& color);
+	/// Step the world by exactly one simulation tick.
 	void update(float deltaMilliseconds);
 
 	void removeRigidBody(btRigidBody* rigidBody);
+
+	/// Number of bodies that were awake in the last step.
+	int getActiveBodyCount() const { return m_ActiveBodyCount; }
+	int getBodyCount() const { return m_BodyTransforms.size(); }
 };
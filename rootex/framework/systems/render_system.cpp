@@ -4,6 +4,10 @@
 #include "renderer/shaders/register_locations_pixel_shader.h"
 #include "light_system.h"
 #include "renderer/material_library.h"
+#include "renderer/texture_streamer.h"
+#include "renderer/gpu_profiler.h"
+#include "app/application.h"
+#include "os/metrics.h"
 
 RenderSystem* RenderSystem::GetSingleton()
 {
@@ -17,6 +21,8 @@ RenderSystem::RenderSystem()
     , m_VSPerFrameConstantBuffer(nullptr)
     , m_PSPerFrameConstantBuffer(nullptr)
     , m_IsEditorRenderPassEnabled(false)
+    , m_InterpolationAlpha(1.0f)
+    , m_FrameDeltaMilliseconds(0.0f)
 {
 	m_Camera = HierarchySystem::GetSingleton()->getRootEntity()->getComponent<CameraComponent>().get();
 	m_TransformationStack.push_back(Matrix::Identity);
@@ -29,15 +35,26 @@ RenderSystem::RenderSystem()
 
 void RenderSystem::calculateTransforms(HierarchyComponent* hierarchyComponent)
 {
-	pushMatrix(hierarchyComponent->getOwner()->getComponent<TransformComponent>()->getLocalTransform());
+	TransformComponent* transform = hierarchyComponent->getOwner()->getComponent<TransformComponent>().get();
+	pushMatrix(transform->getLocalTransform());
 	for (auto&& child : hierarchyComponent->getChildren())
 	{
-		child->getOwner()->getComponent<TransformComponent>()->m_TransformBuffer.m_ParentAbsoluteTransform = getCurrentMatrix();
+		TransformComponent* childTransform = child->getOwner()->getComponent<TransformComponent>().get();
+		childTransform->m_TransformBuffer.m_ParentAbsoluteTransform = getCurrentMatrix();
+		childTransform->interpolate(m_InterpolationAlpha, transform->getInterpolatedAbsoluteTransform());
 		calculateTransforms(child);
 	}
 	popMatrix();
 }
 
+void RenderSystem::savePreviousTransforms()
+{
+	for (auto& component : s_Components[TransformComponent::s_ID])
+	{
+		((TransformComponent*)component)->savePreviousState();
+	}
+}
+
 void RenderSystem::renderPassRender(RenderPass renderPass)
 {
 	ModelComponent* mc = nullptr;
@@ -61,9 +78,16 @@ void RenderSystem::recoverLostDevice()
 	ERR("Fatal error: D3D Device lost");
 }
 
-void RenderSystem::render()
+void RenderSystem::render(float interpolationAlpha)
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/RenderSystem");
+	m_FrameDeltaMilliseconds = m_FrameTimer.getTimeMs();
+	m_FrameTimer.reset();
+	m_InterpolationAlpha = interpolationAlpha;
+
 	Ref<HierarchyComponent> rootHC = HierarchySystem::GetSingleton()->getRootEntity()->getComponent<HierarchyComponent>();
+	rootHC->getOwner()->getComponent<TransformComponent>()->interpolate(m_InterpolationAlpha, Matrix::Identity);
 	calculateTransforms(rootHC.get());
 
 	RenderingDevice::GetSingleton()->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -74,18 +98,33 @@ void RenderSystem::render()
 	perFrameVSCBBinds();
 	perFramePSCBBinds();
 
+	TextureStreamer::GetSingleton()->setCamera(
+	    getCamera()->getViewMatrix().Invert().Translation(),
+	    getCamera()->getProjectionMatrix(),
+	    Application::GetSingleton()->getWindow()->getHeight());
+
 #ifdef ROOTEX_EDITOR
 	if (m_IsEditorRenderPassEnabled)
 	{
+		PROFILE_SCOPE("RenderPass::Editor");
+		PROFILE_GPU_SCOPE("RenderPass::Editor");
 		renderPassRender(RenderPass::Editor);
 		renderLines();
 	}
 #endif // ROOTEX_EDITOR
-	renderPassRender(RenderPass::Basic);
+	{
+		PROFILE_SCOPE("RenderPass::Basic");
+		PROFILE_GPU_SCOPE("RenderPass::Basic");
+		renderPassRender(RenderPass::Basic);
+	}
+
+	TextureStreamer::GetSingleton()->update();
 }
 
 void RenderSystem::renderLines()
 {
+	PROFILE_FUNCTION();
+	PROFILE_GPU_SCOPE("Lines");
 	if (m_CurrentFrameLines.m_Endpoints.size())
 	{
 		m_Renderer->bind(m_LineMaterial.get());
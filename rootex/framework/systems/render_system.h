@@ -5,6 +5,7 @@
 #include "framework/system.h"
 #include "framework/systems/hierarchy_system.h"
 #include "main/window.h"
+#include "os/timer.h"
 #include "components/visual/model_component.h"
 #include "renderer/render_pass.h"
 
@@ -32,6 +33,11 @@ class RenderSystem : public System
 
 	bool m_IsEditorRenderPassEnabled;
 
+	/// Fraction of a simulation tick to interpolate transforms by in the current frame.
+	float m_InterpolationAlpha;
+	StopTimer m_FrameTimer;
+	float m_FrameDeltaMilliseconds;
+
 	RenderSystem();
 	RenderSystem(RenderSystem&) = delete;
 	~RenderSystem() = default;
@@ -41,7 +47,8 @@ class RenderSystem : public System
 public:
 	static RenderSystem* GetSingleton();
 	
-	void render();
+	/// Render a frame with transforms interpolated between the last two simulation ticks. An alpha of 1 renders the latest state.
+	void render(float interpolationAlpha = 1.0f);
 	void renderLines();
 	void submitLine(const Vector3& from, const Vector3& to);
 	void recoverLostDevice();
@@ -50,6 +57,8 @@ public:
 	void restoreCamera();
 
 	void calculateTransforms(HierarchyComponent* hierarchyComponent);
+	/// Record the transforms of all entities as the state to interpolate from. Call before every simulation tick.
+	void savePreviousTransforms();
 	void pushMatrix(const Matrix& transform);
 	void pushMatrixOverride(const Matrix& transform);
 	void popMatrix();
@@ -67,6 +76,8 @@ public:
 	void resetRenderMode();
 
 	CameraComponent* getCamera() const { return m_Camera; }
+	/// Time between the starts of the last two rendered frames. Use for purely visual effects.
+	float getFrameDelta() const { return m_FrameDeltaMilliseconds; }
 	const Matrix& getCurrentMatrix() const;
 	const Renderer* getRenderer() const { return m_Renderer.get(); }
 };
@@ -3,6 +3,8 @@
 #include "renderer/rendering_device.h"
 
 #include "components/visual/render_ui_component.h"
+#include "core/renderer/gpu_profiler.h"
+#include "os/metrics.h"
 
 RenderUISystem::RenderUISystem()
 {
@@ -17,6 +19,9 @@ RenderUISystem* RenderUISystem::GetSingleton()
 
 void RenderUISystem::render()
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/RenderUISystem");
+	PROFILE_GPU_SCOPE("RenderUISystem");
 	RenderingDevice::GetSingleton()->beginDrawUI();
 	RenderUIComponent* ui = nullptr;
 	for (auto& component : s_Components[RenderUIComponent::s_ID])
@@ -1,6 +1,26 @@
 #include "script_system.h"
 
+#include "app/application.h"
+#include "core/resource_data.h"
 #include "components/script_component.h"
+#include "os/metrics.h"
+#include "os/profiler.h"
+
+/// Calls OnUpdate() function of all script components belonging to a single script group.
+class ScriptGroupTask : public Task
+{
+public:
+	Vector<ScriptComponent*> m_ScriptComponents;
+	float m_DeltaMilliseconds = 0.0f;
+
+	void execute() override
+	{
+		for (auto&& scriptComponent : m_ScriptComponents)
+		{
+			scriptComponent->onUpdate(m_DeltaMilliseconds);
+		}
+	}
+};
 
 ScriptSystem* ScriptSystem::GetSingleton()
 {
@@ -10,6 +30,7 @@ ScriptSystem* ScriptSystem::GetSingleton()
 
 void ScriptSystem::begin()
 {
+	m_HasBegun = true;
 	ScriptComponent* scriptComponent = nullptr;
 	for (auto&& component : s_Components[ScriptComponent::s_ID])
 	{
@@ -20,20 +41,72 @@ void ScriptSystem::begin()
 
 void ScriptSystem::update(float deltaMilliseconds)
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/ScriptSystem");
+	// Ordered by name, so that serial updates and the calls groups queue for the main thread always run in the same order
+	Map<String, Vector<ScriptComponent*>> groups;
+
 	ScriptComponent* scriptComponent = nullptr;
 	for (auto&& component : s_Components[ScriptComponent::s_ID])
 	{
 		scriptComponent = (ScriptComponent*)component;
-		scriptComponent->onUpdate(deltaMilliseconds);
+		if (scriptComponent->getGroup().empty())
+		{
+			scriptComponent->onUpdate(deltaMilliseconds);
+		}
+		else
+		{
+			groups[scriptComponent->getGroup()].push_back(scriptComponent);
+		}
 	}
+
+	if (groups.empty())
+	{
+		return;
+	}
+
+	if (!m_IsParallelGroups)
+	{
+		for (auto&& [group, scriptComponents] : groups)
+		{
+			for (auto&& groupComponent : scriptComponents)
+			{
+				groupComponent->onUpdate(deltaMilliseconds);
+			}
+		}
+		return;
+	}
+
+	Vector<Ref<Task>> tasks;
+	tasks.reserve(groups.size());
+	for (auto&& [group, scriptComponents] : groups)
+	{
+		Ref<ScriptGroupTask> task(new ScriptGroupTask());
+		task->m_ScriptComponents = std::move(scriptComponents);
+		task->m_DeltaMilliseconds = deltaMilliseconds;
+		tasks.push_back(task);
+	}
+	Application::GetSingleton()->getThreadPool().submit(tasks);
+	LuaInterpreter::GetSingleton()->runMainThreadCalls();
 }
 
 void ScriptSystem::end()
 {
+	m_HasBegun = false;
 	ScriptComponent* scriptComponent = nullptr;
 	for (auto&& component : s_Components[ScriptComponent::s_ID])
 	{
 		scriptComponent = (ScriptComponent*)component;
 		scriptComponent->onEnd();
+
+		const LuaAllocationStats& stats = scriptComponent->getAllocationStats();
+		PRINT("Lua allocations by " + scriptComponent->getOwner()->getFullName() + ": " + std::to_string(stats.m_AllocationCount) + " allocations, " + std::to_string(stats.m_AllocatedBytes * B_TO_KB) + " KB");
+	}
+
+	const LuaAllocator* allocator = LuaInterpreter::GetSingleton()->getSharedState().m_Allocator.get();
+	PRINT("Shared Lua state memory: " + std::to_string(allocator->getLiveBytes() * B_TO_KB) + " KB live, " + std::to_string(allocator->getPeakBytes() * B_TO_KB) + " KB peak");
+	for (auto&& [group, groupStateData] : LuaInterpreter::GetSingleton()->getGroupStates())
+	{
+		PRINT("Script group " + group + " memory: " + std::to_string(groupStateData.m_Allocator->getLiveBytes() * B_TO_KB) + " KB live, " + std::to_string(groupStateData.m_Allocator->getPeakBytes() * B_TO_KB) + " KB peak");
 	}
 }
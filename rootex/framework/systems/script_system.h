@@ -5,6 +5,11 @@
 /// Interface for initialisation, amintenance and dleetion of script components.
 class ScriptSystem : public System
 {
+	/// Whether script groups are updated in parallel on the application thread pool.
+	bool m_IsParallelGroups = false;
+	/// Whether onBegin() has been called and onEnd() has not.
+	bool m_HasBegun = false;
+
 	ScriptSystem() = default;
 	ScriptSystem(ScriptSystem&) = delete;
 	~ScriptSystem() = default;
@@ -14,8 +19,13 @@ public:
 
 	/// Calls OnBegin() function of script components.
 	void begin();
-	/// Calls OnUpdate() function of script components.
+	/// Calls OnUpdate() function of script components. Components in the shared Lua state are updated first, followed by each script group.
 	void update(float deltaMilliseconds);
 	/// Calls OnEnd() function of script components.
 	void end();
+
+	/// Script groups only communicate through deferred events while running in parallel. Calls that are not thread safe are run after the groups are done.
+	void setParallelGroups(bool enabled) { m_IsParallelGroups = enabled; }
+	bool getParallelGroups() const { return m_IsParallelGroups; }
+	bool hasBegun() const { return m_HasBegun; }
 };
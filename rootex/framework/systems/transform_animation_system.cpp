@@ -1,6 +1,8 @@
 #include "transform_animation_system.h"
 
 #include "components/transform_animation_component.h"
+#include "os/metrics.h"
+#include "os/profiler.h"
 
 TransformAnimationSystem* TransformAnimationSystem::GetSingleton()
 {
@@ -24,6 +26,8 @@ void TransformAnimationSystem::begin()
 
 void TransformAnimationSystem::update(float deltaMilliseconds)
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/TransformAnimationSystem");
 	TransformAnimationComponent* animation = nullptr;
 	for (auto& component : s_Components[TransformAnimationComponent::s_ID])
 	{
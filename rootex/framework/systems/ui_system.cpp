@@ -1,7 +1,11 @@
 #include "ui_system.h"
 
 #include "app/application.h"
+#include "core/renderer/gpu_profiler.h"
 #include "core/ui/input_interface.h"
+#include "os/metrics.h"
+
+#include <iomanip>
 
 #undef interface
 #include "RmlUi/Core.h"
@@ -56,9 +60,12 @@ void EventListener::ProcessEvent(Rml::Core::Event& event)
 
 UISystem::UISystem()
     : m_Context(nullptr)
+    , m_MetricsOverlay(nullptr)
+    , m_MetricsOverlayFrame(0)
 {
 	BIND_EVENT_MEMBER_FUNCTION("UISystemEnableDebugger", UISystem::enableDebugger);
 	BIND_EVENT_MEMBER_FUNCTION("UISystemDisableDebugger", UISystem::disableDebugger);
+	BIND_EVENT_MEMBER_FUNCTION("UISystemToggleMetricsOverlay", UISystem::toggleMetricsOverlay);
 }
 
 Variant UISystem::enableDebugger(const Event* event)
@@ -73,6 +80,33 @@ Variant UISystem::disableDebugger(const Event* event)
 	return true;
 }
 
+Variant UISystem::toggleMetricsOverlay(const Event* event)
+{
+	setMetricsOverlay(!m_MetricsOverlay || !m_MetricsOverlay->IsVisible());
+	return true;
+}
+
+void UISystem::updateMetricsOverlay()
+{
+	const MetricsSnapshot& snapshot = Metrics::GetSingleton()->getSnapshot();
+	if (snapshot.m_Frame == m_MetricsOverlayFrame)
+	{
+		return;
+	}
+	m_MetricsOverlayFrame = snapshot.m_Frame;
+
+	StringStream rml;
+	rml << std::fixed << std::setprecision(2);
+	for (auto& value : snapshot.m_Values)
+	{
+		rml << "<div><span class=\"name\">" << value.m_Name << "</span>" << value.m_Value << " " << value.m_Unit << "</div>";
+	}
+	if (Rml::Core::Element* metrics = m_MetricsOverlay->GetElementById("metrics"))
+	{
+		metrics->SetInnerRML(rml.str());
+	}
+}
+
 UISystem* UISystem::GetSingleton()
 {
 	static UISystem singleton;
@@ -133,11 +167,20 @@ void UISystem::initialize(int width, int height)
 
 void UISystem::update()
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/UISystem");
+	if (m_MetricsOverlay && m_MetricsOverlay->IsVisible())
+	{
+		updateMetricsOverlay();
+	}
 	m_Context->Update();
 }
 
 void UISystem::render()
 {
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/UISystem");
+	PROFILE_GPU_SCOPE("UISystem");
 	RenderingDevice::GetSingleton()->setAlphaBlendState();
 	RenderingDevice::GetSingleton()->setTemporaryUIRasterizerState();
 	m_Context->Render();
@@ -154,3 +197,32 @@ void UISystem::setDebugger(bool enabled)
 {
 	Rml::Debugger::SetVisible(enabled);
 }
+
+void UISystem::setMetricsOverlay(bool enabled)
+{
+	if (!m_MetricsOverlay)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+		m_MetricsOverlay = m_Context->LoadDocument("rootex/assets/rml/metrics.rml");
+		if (!m_MetricsOverlay)
+		{
+			WARN("Could not load metrics overlay");
+			return;
+		}
+	}
+
+	if (enabled)
+	{
+		// Fill in the last report right away
+		m_MetricsOverlayFrame = 0;
+		updateMetricsOverlay();
+		m_MetricsOverlay->Show();
+	}
+	else
+	{
+		m_MetricsOverlay->Hide();
+	}
+}
@@ -37,10 +37,15 @@ class UISystem : public System
 	Ptr<CustomSystemInterface> m_RmlSystemInterface;
 	Ptr<CustomRenderInterface> m_RmlRenderInterface;
 	Rml::Core::Context* m_Context;
+	Rml::Core::ElementDocument* m_MetricsOverlay;
+	/// Frame of the metrics report shown in the overlay
+	unsigned long long m_MetricsOverlayFrame;
 
 	UISystem();
 	Variant enableDebugger(const Event* event);
 	Variant disableDebugger(const Event* event);
+	Variant toggleMetricsOverlay(const Event* event);
+	void updateMetricsOverlay();
 
 public:
 	static UISystem* GetSingleton();
@@ -55,4 +60,6 @@ public:
 	void shutdown();
 
 	void setDebugger(bool enabled);
+	/// Show the values of the last metrics report on top of the game.
+	void setMetricsOverlay(bool enabled);
 };
@@ -9,6 +9,8 @@ int main()
 	app->run();
 	app->shutDown();
 	OS::Print(app->getAppTitle() + " is now safely exiting");
+	int exitCode = app->getExitCode();
+	Logger::GetSingleton()->shutDown();
 
-	return 0;
+	return exitCode;
 }
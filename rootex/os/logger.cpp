@@ -0,0 +1,540 @@
+#include "logger.h"
+
+#include "common/common.h"
+#ifdef ROOTEX_EDITOR
+#include "core/event_manager.h"
+#endif // ROOTEX_EDITOR
+
+#include <cstring>
+#include <iostream>
+
+static const char* LevelNames[] = { "Info", "Warning", "Error", "Off" };
+static const char* CategoryNames[] = { "Engine", "Resources", "Rendering", "Audio", "Physics", "Scripting", "UI", "Editor", "Game" };
+static_assert(sizeof(CategoryNames) / sizeof(CategoryNames[0]) == (int)LogCategory::Count, "Every log category needs a name");
+static_assert((LOGGER_RING_SIZE & (LOGGER_RING_SIZE - 1)) == 0, "LOGGER_RING_SIZE must be a power of 2");
+
+std::atomic<int> Logger::s_Levels[(int)LogCategory::Count] = {};
+
+void ConsoleLogSink::write(LogLevel level, LogCategory category, const String& message)
+{
+	std::cout.clear();
+	switch (level)
+	{
+	case LogLevel::Warning:
+		std::cout << "\033[93m" << message << "\033[0m\n";
+		break;
+	case LogLevel::Error:
+		std::cout << "\033[91m" << message << "\033[0m\n";
+		break;
+	default:
+		std::cout << message << "\n";
+		break;
+	}
+}
+
+void ConsoleLogSink::flush()
+{
+	std::cout.flush();
+}
+
+FileLogSink::FileLogSink(const String& path)
+    : m_File(path, std::ios::out | std::ios::app)
+{
+}
+
+void FileLogSink::write(LogLevel level, LogCategory category, const String& message)
+{
+	m_File << "[" << Logger::GetCategoryName(category) << "] " << message << "\n";
+}
+
+void FileLogSink::flush()
+{
+	m_File.flush();
+}
+
+void Logger::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<Logger> logger = rootex.new_usertype<Logger>("Logger");
+	logger["Get"] = &Logger::GetSingleton;
+	logger["SetLevel"] = [](const String& categoryName, const String& levelName) {
+		LogCategory category;
+		LogLevel level;
+		if (!FindCategory(categoryName, category) || !FindLevel(levelName, level))
+		{
+			return false;
+		}
+		SetLevel(category, level);
+		return true;
+	};
+	logger["flush"] = &Logger::flush;
+	logger["getDroppedCount"] = &Logger::getDroppedCount;
+}
+
+Logger* Logger::GetSingleton()
+{
+	static Logger singleton;
+	return &singleton;
+}
+
+Logger::Logger()
+    : m_Cells(new Cell[LOGGER_RING_SIZE])
+    , m_EnqueuePosition(0)
+    , m_DequeuePosition(0)
+    , m_DroppedCount(0)
+    , m_OverflowPolicy(LogOverflowPolicy::Drop)
+    , m_IsRunning(true)
+    , m_IsSleeping(false)
+{
+	for (size_t i = 0; i < LOGGER_RING_SIZE; i++)
+	{
+		m_Cells[i].m_Sequence.store(i, std::memory_order_relaxed);
+	}
+	m_Sinks.emplace_back(new ConsoleLogSink());
+	m_Thread = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger()
+{
+	shutDown();
+}
+
+const char* Logger::GetLevelName(LogLevel level)
+{
+	return LevelNames[(int)level];
+}
+
+const char* Logger::GetCategoryName(LogCategory category)
+{
+	return CategoryNames[(int)category];
+}
+
+bool Logger::FindLevel(const String& name, LogLevel& level)
+{
+	for (int i = 0; i <= (int)LogLevel::Off; i++)
+	{
+		if (name == LevelNames[i])
+		{
+			level = (LogLevel)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Logger::FindCategory(const String& name, LogCategory& category)
+{
+	for (int i = 0; i < (int)LogCategory::Count; i++)
+	{
+		if (name == CategoryNames[i])
+		{
+			category = (LogCategory)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+void Logger::SetLevel(LogLevel level)
+{
+	for (auto& categoryLevel : s_Levels)
+	{
+		categoryLevel = (int)level;
+	}
+}
+
+void Logger::addSink(Ptr<LogSink> sink)
+{
+	std::lock_guard<std::mutex> lock(m_SinksMutex);
+	m_Sinks.push_back(std::move(sink));
+}
+
+void Logger::EncodeBytes(Record& record, ArgumentType type, const void* data, unsigned int size)
+{
+	if (record.m_DataSize + 1 + size > LOGGER_RECORD_DATA_SIZE)
+	{
+		if (record.m_DataSize < LOGGER_RECORD_DATA_SIZE)
+		{
+			record.m_Data[record.m_DataSize++] = (char)ArgumentType::Missing;
+		}
+		return;
+	}
+	record.m_Data[record.m_DataSize++] = (char)type;
+	memcpy(record.m_Data + record.m_DataSize, data, size);
+	record.m_DataSize += size;
+}
+
+void Logger::Encode(Record& record, bool value)
+{
+	EncodeBytes(record, ArgumentType::Bool, &value, sizeof(value));
+}
+
+void Logger::Encode(Record& record, double value)
+{
+	EncodeBytes(record, ArgumentType::Real, &value, sizeof(value));
+}
+
+void Logger::Encode(Record& record, const char* value)
+{
+	size_t length = strlen(value);
+	// Strings are stored after their length, and moved to the heap if they do not fit
+	if (record.m_DataSize + 1 + sizeof(unsigned short) + length <= LOGGER_RECORD_DATA_SIZE)
+	{
+		unsigned short shortLength = (unsigned short)length;
+		EncodeBytes(record, ArgumentType::InlineString, &shortLength, sizeof(shortLength));
+		memcpy(record.m_Data + record.m_DataSize, value, length);
+		record.m_DataSize += length;
+		return;
+	}
+	Encode(record, String(value, length));
+}
+
+void Logger::Encode(Record& record, const String& value)
+{
+	if (record.m_DataSize + 1 + sizeof(unsigned short) + value.size() <= LOGGER_RECORD_DATA_SIZE)
+	{
+		Encode(record, value.c_str());
+		return;
+	}
+	Encode(record, String(value));
+}
+
+void Logger::Encode(Record& record, String&& value)
+{
+	if (record.m_DataSize + 1 + sizeof(unsigned short) + value.size() <= LOGGER_RECORD_DATA_SIZE)
+	{
+		Encode(record, value.c_str());
+		return;
+	}
+	if (record.m_DataSize + 1 + sizeof(String*) > LOGGER_RECORD_DATA_SIZE)
+	{
+		record.m_Data[record.m_DataSize++] = (char)ArgumentType::Missing;
+		return;
+	}
+	String* heapString = new String(std::move(value));
+	EncodeBytes(record, ArgumentType::HeapString, &heapString, sizeof(heapString));
+}
+
+void Logger::Encode(Record& record, const FilePath& value)
+{
+	Encode(record, value.generic_string());
+}
+
+String Logger::FormatMessage(Record& record)
+{
+	String message;
+	unsigned int position = 0;
+	auto appendArgument = [&]() {
+		if (position >= record.m_DataSize)
+		{
+			message += "?";
+			return;
+		}
+		ArgumentType type = (ArgumentType)record.m_Data[position++];
+		const char* data = record.m_Data + position;
+		switch (type)
+		{
+		case ArgumentType::Bool:
+			message += *(const bool*)data ? "true" : "false";
+			position += sizeof(bool);
+			break;
+		case ArgumentType::Integer:
+		{
+			long long value;
+			memcpy(&value, data, sizeof(value));
+			message += std::to_string(value);
+			position += sizeof(value);
+			break;
+		}
+		case ArgumentType::Unsigned:
+		{
+			unsigned long long value;
+			memcpy(&value, data, sizeof(value));
+			message += std::to_string(value);
+			position += sizeof(value);
+			break;
+		}
+		case ArgumentType::Real:
+		{
+			double value;
+			memcpy(&value, data, sizeof(value));
+			message += std::to_string(value);
+			position += sizeof(value);
+			break;
+		}
+		case ArgumentType::InlineString:
+		{
+			unsigned short length;
+			memcpy(&length, data, sizeof(length));
+			message.append(data + sizeof(length), length);
+			position += sizeof(length) + length;
+			break;
+		}
+		case ArgumentType::HeapString:
+		{
+			String* value;
+			memcpy(&value, data, sizeof(value));
+			message += *value;
+			delete value;
+			position += sizeof(value);
+			break;
+		}
+		default:
+			message += "?";
+			position = record.m_DataSize;
+			break;
+		}
+	};
+
+	if (!record.m_Format)
+	{
+		appendArgument();
+		return message;
+	}
+	for (const char* character = record.m_Format; *character != '\0'; character++)
+	{
+		if (character[0] == '{' && character[1] == '}')
+		{
+			appendArgument();
+			character++;
+		}
+		else
+		{
+			message += *character;
+		}
+	}
+	return message;
+}
+
+String Logger::FormatSource(LogLevel level, const char* file, unsigned int line, const char* function)
+{
+	if (!function)
+	{
+		return "";
+	}
+	if (level == LogLevel::Info)
+	{
+		return String(function) + ": ";
+	}
+	return String(file) + ":" + std::to_string(line) + ":" + String(function) + ": ";
+}
+
+Logger::Cell* Logger::claim(LogLevel level)
+{
+	size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell* cell = &m_Cells[position & (LOGGER_RING_SIZE - 1)];
+		size_t sequence = cell->m_Sequence.load(std::memory_order_acquire);
+		ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+		if (difference == 0)
+		{
+			if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				return cell;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The ring is full. Errors are never dropped
+			if (level != LogLevel::Error && m_OverflowPolicy.load(std::memory_order_relaxed) == LogOverflowPolicy::Drop)
+			{
+				m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			m_WakeCondition.notify_one();
+			std::this_thread::yield();
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void Logger::publish(Cell* cell)
+{
+	cell->m_Sequence.store(cell->m_Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	if (m_IsSleeping.load(std::memory_order_relaxed))
+	{
+		m_WakeCondition.notify_one();
+	}
+}
+
+bool Logger::pop()
+{
+	size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+	Cell& cell = m_Cells[position & (LOGGER_RING_SIZE - 1)];
+	if (cell.m_Sequence.load(std::memory_order_acquire) != position + 1)
+	{
+		return false;
+	}
+
+	Record& record = cell.m_Record;
+	String message = FormatSource(record.m_Level, record.m_File, record.m_Line, record.m_Function) + FormatMessage(record);
+	LogLevel level = record.m_Level;
+	LogCategory category = record.m_Category;
+	cell.m_Sequence.store(position + LOGGER_RING_SIZE, std::memory_order_release);
+	m_DequeuePosition.store(position + 1, std::memory_order_release);
+
+	write(level, category, message);
+	return true;
+}
+
+void Logger::write(LogLevel level, LogCategory category, const String& message)
+{
+	String text;
+	switch (level)
+	{
+	case LogLevel::Warning:
+		text = "WARNING: " + message;
+		break;
+	case LogLevel::Error:
+		text = "ERROR: " + message;
+		break;
+	default:
+		text = message;
+		break;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_SinksMutex);
+		for (auto& sink : m_Sinks)
+		{
+			sink->write(level, category, text);
+		}
+	}
+
+#ifdef ROOTEX_EDITOR
+	std::lock_guard<std::mutex> lock(m_EventsMutex);
+	m_Events.emplace_back(level == LogLevel::Info ? "Print" : GetLevelName(level), std::move(text));
+#endif // ROOTEX_EDITOR
+}
+
+void Logger::run()
+{
+	while (true)
+	{
+		bool isStopping = !m_IsRunning;
+
+		bool isWritten = false;
+		while (pop())
+		{
+			isWritten = true;
+		}
+		if (unsigned long long droppedCount = m_DroppedCount.exchange(0, std::memory_order_relaxed))
+		{
+			write(LogLevel::Warning, LogCategory::Engine, "Logger: Dropped " + std::to_string(droppedCount) + " messages because the log was full");
+			isWritten = true;
+		}
+		if (isWritten)
+		{
+			std::lock_guard<std::mutex> lock(m_SinksMutex);
+			for (auto& sink : m_Sinks)
+			{
+				sink->flush();
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_FlushedCondition.notify_all();
+		// Messages that were claimed but not published yet are waited for before stopping
+		if (isStopping && m_DequeuePosition.load() == m_EnqueuePosition.load())
+		{
+			break;
+		}
+		m_IsSleeping = true;
+		m_WakeCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+			size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+			return !m_IsRunning || m_Cells[position & (LOGGER_RING_SIZE - 1)].m_Sequence.load(std::memory_order_acquire) == position + 1;
+		});
+		m_IsSleeping = false;
+	}
+}
+
+void Logger::log(LogCategory category, LogLevel level, const char* file, unsigned int line, const char* function, String&& message)
+{
+	String error;
+	if (level == LogLevel::Error)
+	{
+		error = FormatSource(level, file, line, function) + message;
+	}
+
+	if (m_IsRunning)
+	{
+		if (Cell* cell = claim(level))
+		{
+			Record& record = cell->m_Record;
+			record.m_Format = nullptr;
+			record.m_File = file;
+			record.m_Function = function;
+			record.m_Line = line;
+			record.m_Level = level;
+			record.m_Category = category;
+			record.m_DataSize = 0;
+			Encode(record, std::move(message));
+			publish(cell);
+		}
+		if (level == LogLevel::Error)
+		{
+			// Errors are on screen before the message box stops the thread that logged them
+			flush();
+		}
+	}
+	else
+	{
+		write(level, category, FormatSource(level, file, line, function) + message);
+	}
+
+	if (level == LogLevel::Error)
+	{
+		OS::PostError(error, "Error");
+	}
+}
+
+void Logger::flush()
+{
+	if (m_IsRunning)
+	{
+		size_t target = m_EnqueuePosition.load();
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_WakeCondition.notify_one();
+		m_FlushedCondition.wait(lock, [this, target]() { return m_DequeuePosition.load() >= target; });
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_SinksMutex);
+	for (auto& sink : m_Sinks)
+	{
+		sink->flush();
+	}
+}
+
+void Logger::shutDown()
+{
+	if (!m_Thread.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_IsRunning = false;
+	}
+	m_WakeCondition.notify_one();
+	m_Thread.join();
+}
+
+void Logger::dispatchEvents()
+{
+#ifdef ROOTEX_EDITOR
+	Vector<Pair<String, String>> events;
+	{
+		std::lock_guard<std::mutex> lock(m_EventsMutex);
+		events.swap(m_Events);
+	}
+	for (auto& [type, message] : events)
+	{
+		EventManager::GetSingleton()->call(type, "OSPrint", message);
+	}
+#endif // ROOTEX_EDITOR
+}
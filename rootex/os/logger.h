@@ -0,0 +1,361 @@
+#pragma once
+
+#include "common/types.h"
+#include "sol/forward.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+/// Messages that can wait in the ring before logging calls start to drop or block. Must be a power of 2.
+#define LOGGER_RING_SIZE 4096
+/// Bytes of arguments stored with each message. Longer strings are moved to the heap.
+#define LOGGER_RECORD_DATA_SIZE 192
+
+/// Log a message with a format string checked at compile time. Each {} in the format is replaced by the next argument.
+/// Arguments are formatted on the logging thread, so a message that is not logged costs a level check.
+#define LOG(m_Level, m_Format, ...)                                                                                                                             \
+	{                                                                                                                                                           \
+		static_assert(Logger::CountPlaceholders(m_Format) == std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value, "Log arguments do not match format"); \
+		constexpr LogCategory logCategory = Logger::GetCategory(__FILE__);                                                                                      \
+		if (Logger::IsEnabled(logCategory, m_Level))                                                                                                            \
+		{                                                                                                                                                       \
+			Logger::GetSingleton()->log(logCategory, m_Level, __FILE__, __LINE__, __FUNCTION__, m_Format, ##__VA_ARGS__);                                       \
+		}                                                                                                                                                       \
+	}
+#define LOG_INFO(m_Format, ...) LOG(LogLevel::Info, m_Format, ##__VA_ARGS__)
+#define LOG_WARN(m_Format, ...) LOG(LogLevel::Warning, m_Format, ##__VA_ARGS__)
+#define LOG_ERROR(m_Format, ...) LOG(LogLevel::Error, m_Format, ##__VA_ARGS__)
+
+/// Log a message that is already a string, or is built out of strings only if its category logs the level.
+#define LOG_MESSAGE(m_Level, m_Msg)                                                                                      \
+	{                                                                                                                    \
+		constexpr LogCategory logCategory = Logger::GetCategory(__FILE__);                                               \
+		if (Logger::IsEnabled(logCategory, m_Level))                                                                     \
+		{                                                                                                                \
+			Logger::GetSingleton()->log(logCategory, m_Level, __FILE__, __LINE__, __FUNCTION__, String() + m_Msg); \
+		}                                                                                                                \
+	}
+
+enum class LogLevel : int
+{
+	Info,
+	Warning,
+	Error,
+	/// Logs nothing
+	Off
+};
+
+/// Parts of the engine that get their own log level. Messages get the category of the file they are logged from.
+enum class LogCategory : int
+{
+	Engine,
+	Resources,
+	Rendering,
+	Audio,
+	Physics,
+	Scripting,
+	UI,
+	Editor,
+	Game,
+	Count
+};
+
+/// What logging calls do when the ring is full
+enum class LogOverflowPolicy
+{
+	/// Drop the message and report the number of dropped messages later
+	Drop,
+	/// Wait for the logging thread to make space
+	Block
+};
+
+/// Receives formatted messages on the logging thread.
+class LogSink
+{
+public:
+	virtual ~LogSink() = default;
+
+	virtual void write(LogLevel level, LogCategory category, const String& message) = 0;
+	virtual void flush() {}
+};
+
+/// Writes messages to the console, coloured by level.
+class ConsoleLogSink : public LogSink
+{
+public:
+	void write(LogLevel level, LogCategory category, const String& message) override;
+	void flush() override;
+};
+
+/// Appends messages to a file.
+class FileLogSink : public LogSink
+{
+	std::ofstream m_File;
+
+public:
+	FileLogSink(const String& path);
+
+	bool isOpen() const { return m_File.is_open(); }
+
+	void write(LogLevel level, LogCategory category, const String& message) override;
+	void flush() override;
+};
+
+/// Logs messages through sinks on a background thread.
+/// Logging calls copy their format string pointer and arguments into a bounded lock free ring, which the logging thread formats and writes out.
+/// Errors are written out before the logging call returns, and show a message box as well.
+class Logger
+{
+	/// A logged message waiting in the ring
+	struct Record
+	{
+		/// Nullptr if the message is the only argument
+		const char* m_Format;
+		const char* m_File;
+		const char* m_Function;
+		unsigned int m_Line;
+		LogLevel m_Level;
+		LogCategory m_Category;
+		unsigned int m_DataSize;
+		char m_Data[LOGGER_RECORD_DATA_SIZE];
+	};
+
+	struct Cell
+	{
+		std::atomic<size_t> m_Sequence;
+		Record m_Record;
+	};
+
+	enum class ArgumentType : char
+	{
+		Bool,
+		Integer,
+		Unsigned,
+		Real,
+		InlineString,
+		HeapString,
+		/// An argument that did not fit
+		Missing
+	};
+
+	static std::atomic<int> s_Levels[(int)LogCategory::Count];
+
+	Ptr<Cell[]> m_Cells;
+	std::atomic<size_t> m_EnqueuePosition;
+	/// Only moved by the logging thread
+	std::atomic<size_t> m_DequeuePosition;
+	std::atomic<unsigned long long> m_DroppedCount;
+	std::atomic<LogOverflowPolicy> m_OverflowPolicy;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_IsRunning;
+	std::atomic<bool> m_IsSleeping;
+	std::mutex m_WakeMutex;
+	std::condition_variable m_WakeCondition;
+	std::condition_variable m_FlushedCondition;
+
+	/// Guards sinks, which are written by the logging thread or by callers once the thread has stopped
+	std::mutex m_SinksMutex;
+	Vector<Ptr<LogSink>> m_Sinks;
+
+#ifdef ROOTEX_EDITOR
+	std::mutex m_EventsMutex;
+	/// Messages waiting to be sent as OSPrint events on the main thread
+	Vector<Pair<String, String>> m_Events;
+#endif // ROOTEX_EDITOR
+
+	Logger();
+	Logger(Logger&) = delete;
+	~Logger();
+
+	void run();
+	/// Claim a cell of the ring, following the overflow policy if it is full. Returns nullptr if the message is dropped.
+	Cell* claim(LogLevel level);
+	void publish(Cell* cell);
+	/// Write out the oldest published record. Returns false if there is none.
+	bool pop();
+	void write(LogLevel level, LogCategory category, const String& message);
+
+	/// Format the arguments of a record into its format string, and free its heap strings.
+	static String FormatMessage(Record& record);
+	static String FormatSource(LogLevel level, const char* file, unsigned int line, const char* function);
+
+	static void Encode(Record& record, bool value);
+	static void Encode(Record& record, const char* value);
+	static void Encode(Record& record, const String& value);
+	static void Encode(Record& record, String&& value);
+	static void Encode(Record& record, const FilePath& value);
+	static void Encode(Record& record, double value);
+	template <class T>
+	static void Encode(Record& record, T value);
+	static void EncodeBytes(Record& record, ArgumentType type, const void* data, unsigned int size);
+
+	constexpr static bool Contains(const char* text, const char* part);
+
+public:
+	static void RegisterAPI(sol::state& rootex);
+	static Logger* GetSingleton();
+
+	static const char* GetLevelName(LogLevel level);
+	static const char* GetCategoryName(LogCategory category);
+	/// Returns false if the name is not a level.
+	static bool FindLevel(const String& name, LogLevel& level);
+	static bool FindCategory(const String& name, LogCategory& category);
+
+	/// Number of {} in a format string.
+	constexpr static int CountPlaceholders(const char* format);
+	/// Category of messages logged from a source file, found from the names of the file and its directory.
+	constexpr static LogCategory GetCategory(const char* file);
+
+	static bool IsEnabled(LogCategory category, LogLevel level) { return (int)level >= s_Levels[(int)category].load(std::memory_order_relaxed) && level != LogLevel::Off; }
+	static void SetLevel(LogCategory category, LogLevel level) { s_Levels[(int)category] = (int)level; }
+	static void SetLevel(LogLevel level);
+
+	void setOverflowPolicy(LogOverflowPolicy policy) { m_OverflowPolicy = policy; }
+	void addSink(Ptr<LogSink> sink);
+	unsigned long long getDroppedCount() const { return m_DroppedCount; }
+
+	template <class... Args>
+	void log(LogCategory category, LogLevel level, const char* file, unsigned int line, const char* function, const char* format, const Args&... args);
+	/// Log a message that is already formatted. file and function can be nullptr for messages without a source.
+	void log(LogCategory category, LogLevel level, const char* file, unsigned int line, const char* function, String&& message);
+
+	/// Wait until every message logged so far has been written out.
+	void flush();
+	/// Write out waiting messages and stop the logging thread. Messages logged after this are written out by the logging call.
+	void shutDown();
+	/// Send messages logged since the last call as OSPrint events. Call from the main thread.
+	void dispatchEvents();
+};
+
+constexpr bool Logger::Contains(const char* text, const char* part)
+{
+	for (int i = 0; text[i] != '\0'; i++)
+	{
+		int j = 0;
+		while (part[j] != '\0' && text[i + j] == part[j])
+		{
+			j++;
+		}
+		if (part[j] == '\0')
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+constexpr int Logger::CountPlaceholders(const char* format)
+{
+	int count = 0;
+	for (int i = 0; format[i] != '\0'; i++)
+	{
+		if (format[i] == '{' && format[i + 1] == '}')
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+constexpr LogCategory Logger::GetCategory(const char* file)
+{
+	// Only the file name and its directory are looked at, so that the paths of checkouts do not matter
+	int length = 0;
+	int separators[2] = { -1, -1 };
+	for (; file[length] != '\0'; length++)
+	{
+		if (file[length] == '/' || file[length] == '\\')
+		{
+			separators[0] = separators[1];
+			separators[1] = length;
+		}
+	}
+	const char* name = file + separators[0] + 1;
+
+	if (Contains(name, "editor") || Contains(name, "gui"))
+	{
+		return LogCategory::Editor;
+	}
+	if (Contains(name, "game"))
+	{
+		return LogCategory::Game;
+	}
+	if (Contains(name, "render") || Contains(name, "shader") || Contains(name, "material") || Contains(name, "texture") || Contains(name, "mesh"))
+	{
+		return LogCategory::Rendering;
+	}
+	if (Contains(name, "audio"))
+	{
+		return LogCategory::Audio;
+	}
+	if (Contains(name, "physics"))
+	{
+		return LogCategory::Physics;
+	}
+	if (Contains(name, "script") || Contains(name, "interpreter"))
+	{
+		return LogCategory::Scripting;
+	}
+	if (Contains(name, "ui/") || Contains(name, "ui\\") || Contains(name, "ui_"))
+	{
+		return LogCategory::UI;
+	}
+	if (Contains(name, "resource") || Contains(name, "cooker") || Contains(name, "pak_") || Contains(name, "file_watcher") || Contains(name, "hot_reload"))
+	{
+		return LogCategory::Resources;
+	}
+	return LogCategory::Engine;
+}
+
+template <class T>
+void Logger::Encode(Record& record, T value)
+{
+	static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only numbers, bools and strings can be logged");
+	if constexpr (std::is_floating_point<T>::value)
+	{
+		Encode(record, (double)value);
+	}
+	else if constexpr (std::is_signed<T>::value || std::is_enum<T>::value)
+	{
+		long long integer = (long long)value;
+		EncodeBytes(record, ArgumentType::Integer, &integer, sizeof(integer));
+	}
+	else
+	{
+		unsigned long long integer = (unsigned long long)value;
+		EncodeBytes(record, ArgumentType::Unsigned, &integer, sizeof(integer));
+	}
+}
+
+template <class... Args>
+void Logger::log(LogCategory category, LogLevel level, const char* file, unsigned int line, const char* function, const char* format, const Args&... args)
+{
+	if (level == LogLevel::Error || !m_IsRunning)
+	{
+		// Errors are written out right away, so there is nothing to gain from deferring formatting
+		Record record = { format, file, function, line, level, category, 0 };
+		(Encode(record, args), ...);
+		log(category, level, file, line, function, FormatMessage(record));
+		return;
+	}
+
+	Cell* cell = claim(level);
+	if (!cell)
+	{
+		return;
+	}
+	Record& record = cell->m_Record;
+	record.m_Format = format;
+	record.m_File = file;
+	record.m_Function = function;
+	record.m_Line = line;
+	record.m_Level = level;
+	record.m_Category = category;
+	record.m_DataSize = 0;
+	(Encode(record, args), ...);
+	publish(cell);
+}
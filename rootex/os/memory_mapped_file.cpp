@@ -0,0 +1,111 @@
+#include "memory_mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+MemoryMappedFile::MemoryMappedFile()
+#ifdef _WIN32
+    : m_File(INVALID_HANDLE_VALUE)
+    , m_Mapping(nullptr)
+#else
+    : m_File(-1)
+#endif // _WIN32
+    , m_Data(nullptr)
+    , m_Size(0)
+{
+}
+
+Ref<MemoryMappedFile> MemoryMappedFile::Open(const String& absolutePath)
+{
+	Ref<MemoryMappedFile> mappedFile(new MemoryMappedFile());
+
+#ifdef _WIN32
+	// Sharing writes and deletes lets editors keep saving the file while it is mapped
+	mappedFile->m_File = CreateFileA(absolutePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mappedFile->m_File == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mappedFile->m_File, &size))
+	{
+		return nullptr;
+	}
+	mappedFile->m_Size = size.QuadPart;
+	// Empty files cannot be mapped, they are represented by an empty view instead
+	if (mappedFile->m_Size == 0)
+	{
+		return mappedFile;
+	}
+
+	mappedFile->m_Mapping = CreateFileMappingA(mappedFile->m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappedFile->m_Mapping)
+	{
+		return nullptr;
+	}
+	mappedFile->m_Data = (const char*)MapViewOfFile(mappedFile->m_Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	mappedFile->m_File = open(absolutePath.c_str(), O_RDONLY);
+	if (mappedFile->m_File < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat fileStat;
+	if (fstat(mappedFile->m_File, &fileStat) != 0)
+	{
+		return nullptr;
+	}
+	mappedFile->m_Size = fileStat.st_size;
+	if (mappedFile->m_Size == 0)
+	{
+		return mappedFile;
+	}
+
+	void* data = mmap(nullptr, mappedFile->m_Size, PROT_READ, MAP_PRIVATE, mappedFile->m_File, 0);
+	if (data == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	madvise(data, mappedFile->m_Size, MADV_SEQUENTIAL);
+	mappedFile->m_Data = (const char*)data;
+#endif // _WIN32
+
+	if (!mappedFile->m_Data)
+	{
+		return nullptr;
+	}
+	return mappedFile;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef _WIN32
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	if (m_File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_File);
+	}
+#else
+	if (m_Data)
+	{
+		munmap((void*)m_Data, m_Size);
+	}
+	if (m_File >= 0)
+	{
+		close(m_File);
+	}
+#endif // _WIN32
+}
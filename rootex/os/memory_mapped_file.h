@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Read-only view of a whole file mapped into memory. Pages are read from disk lazily by the OS when they are first touched.
+class MemoryMappedFile
+{
+#ifdef _WIN32
+	HANDLE m_File;
+	HANDLE m_Mapping;
+#else
+	int m_File;
+#endif // _WIN32
+	const char* m_Data;
+	size_t m_Size;
+
+	MemoryMappedFile();
+
+public:
+	/// Map a file by its absolute path. Returns nullptr if the file could not be mapped.
+	static Ref<MemoryMappedFile> Open(const String& absolutePath);
+
+	MemoryMappedFile(MemoryMappedFile&) = delete;
+	~MemoryMappedFile();
+
+	const char* getData() const { return m_Data; }
+	size_t getSize() const { return m_Size; }
+};
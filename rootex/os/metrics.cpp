@@ -0,0 +1,307 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const char* GetUnitName(MetricUnit unit)
+{
+	switch (unit)
+	{
+	case MetricUnit::Milliseconds:
+	case MetricUnit::Nanoseconds:
+		return "ms";
+	case MetricUnit::Bytes:
+		return "MB";
+	default:
+		return "";
+	}
+}
+
+/// Convert a value to the unit it is shown in
+static double GetShownValue(double value, MetricUnit unit)
+{
+	switch (unit)
+	{
+	case MetricUnit::Nanoseconds:
+		return value * NS_TO_MS;
+	case MetricUnit::Bytes:
+		return value / (MB_TO_KB * KB_TO_B);
+	default:
+		return value;
+	}
+}
+
+static void AtomicAdd(std::atomic<double>& value, double add)
+{
+	double current = value.load(std::memory_order_relaxed);
+	while (!value.compare_exchange_weak(current, current + add, std::memory_order_relaxed))
+	{
+	}
+}
+
+static void AtomicMax(std::atomic<double>& value, double other)
+{
+	double current = value.load(std::memory_order_relaxed);
+	while (current < other && !value.compare_exchange_weak(current, other, std::memory_order_relaxed))
+	{
+	}
+}
+
+MetricCounter::MetricCounter(MetricUnit unit)
+    : m_Value(0)
+    , m_Unit(unit)
+{
+}
+
+MetricGauge::MetricGauge(MetricUnit unit)
+    : m_Value(0.0)
+    , m_Unit(unit)
+{
+}
+
+MetricHistogram::MetricHistogram(MetricUnit unit)
+    : m_Max(0.0)
+    , m_Sum(0.0)
+    , m_Unit(unit)
+{
+	for (auto& bucket : m_Buckets)
+	{
+		bucket = 0;
+	}
+}
+
+void MetricHistogram::record(double value)
+{
+	int bucket = 0;
+	if (value > METRICS_HISTOGRAM_MIN)
+	{
+		bucket = std::min((int)(std::log2(value / METRICS_HISTOGRAM_MIN) * METRICS_BUCKETS_PER_OCTAVE) + 1, METRICS_HISTOGRAM_BUCKETS - 1);
+	}
+	m_Buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	AtomicAdd(m_Sum, value);
+	AtomicMax(m_Max, value);
+}
+
+MetricHistogram::Summary MetricHistogram::take()
+{
+	unsigned int counts[METRICS_HISTOGRAM_BUCKETS];
+	unsigned int total = 0;
+	for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+	{
+		counts[i] = m_Buckets[i].exchange(0, std::memory_order_relaxed);
+		total += counts[i];
+	}
+	Summary summary = { total, 0.0, 0.0, 0.0, 0.0, m_Max.exchange(0.0, std::memory_order_relaxed) };
+	double sum = m_Sum.exchange(0.0, std::memory_order_relaxed);
+	if (total == 0)
+	{
+		return summary;
+	}
+	summary.m_Mean = sum / total;
+
+	auto percentile = [&](double fraction) {
+		double rank = fraction * total;
+		unsigned int seen = 0;
+		for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+		{
+			if (counts[i] == 0 || seen + counts[i] < rank)
+			{
+				seen += counts[i];
+				continue;
+			}
+			if (i == 0)
+			{
+				return METRICS_HISTOGRAM_MIN;
+			}
+			// Interpolate inside the bucket, which spans a constant ratio of values
+			double position = (rank - seen) / counts[i];
+			return std::min(METRICS_HISTOGRAM_MIN * std::exp2((i - 1 + position) / METRICS_BUCKETS_PER_OCTAVE), summary.m_Max);
+		}
+		return summary.m_Max;
+	};
+	summary.m_P50 = percentile(0.5);
+	summary.m_P90 = percentile(0.9);
+	summary.m_P99 = percentile(0.99);
+	return summary;
+}
+
+void Metrics::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<Metrics> metrics = rootex.new_usertype<Metrics>("Metrics");
+	metrics["Get"] = &Metrics::GetSingleton;
+	metrics["getValue"] = &Metrics::getValue;
+	metrics["setPeriod"] = &Metrics::setPeriod;
+	metrics["setCSVFile"] = &Metrics::setCSVFile;
+	metrics["setJSONFile"] = &Metrics::setJSONFile;
+}
+
+Metrics* Metrics::GetSingleton()
+{
+	static Metrics singleton;
+	return &singleton;
+}
+
+Metrics::Metrics()
+    : m_Period(60)
+    , m_PeriodFrameCount(0)
+    , m_FrameCount(0)
+{
+	m_FrameTime = getHistogram("Frame Time", MetricUnit::Milliseconds);
+}
+
+MetricCounter* Metrics::getCounter(const String& name, MetricUnit unit)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Ptr<MetricCounter>& counter = m_Counters[name];
+	if (!counter)
+	{
+		counter.reset(new MetricCounter(unit));
+	}
+	return counter.get();
+}
+
+MetricGauge* Metrics::getGauge(const String& name, MetricUnit unit)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Ptr<MetricGauge>& gauge = m_Gauges[name];
+	if (!gauge)
+	{
+		gauge.reset(new MetricGauge(unit));
+	}
+	return gauge.get();
+}
+
+MetricHistogram* Metrics::getHistogram(const String& name, MetricUnit unit)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Ptr<MetricHistogram>& histogram = m_Histograms[name];
+	if (!histogram)
+	{
+		histogram.reset(new MetricHistogram(unit));
+	}
+	return histogram.get();
+}
+
+void Metrics::addSampler(const Function<void()>& sampler)
+{
+	std::lock_guard<std::mutex> lock(m_SamplersMutex);
+	m_Samplers.push_back(sampler);
+}
+
+bool Metrics::setCSVFile(const String& path)
+{
+	FilePath absolutePath = OS::GetAbsolutePath(path);
+	bool isEmpty = !std::filesystem::exists(absolutePath) || std::filesystem::file_size(absolutePath) == 0;
+	m_CSVFile = OutputFileStream(absolutePath, std::ios::out | std::ios::app);
+	if (!m_CSVFile)
+	{
+		WARN("Could not open metrics file: " + path);
+		return false;
+	}
+	if (isEmpty)
+	{
+		m_CSVFile << "frame,metric,value,unit\n";
+	}
+	return true;
+}
+
+bool Metrics::setJSONFile(const String& path)
+{
+	m_JSONFile = OutputFileStream(OS::GetAbsolutePath(path), std::ios::out | std::ios::app);
+	if (!m_JSONFile)
+	{
+		WARN("Could not open metrics file: " + path);
+		return false;
+	}
+	return true;
+}
+
+void Metrics::endFrame(float frameMilliseconds)
+{
+	m_FrameTime->record(frameMilliseconds);
+	m_FrameCount++;
+	m_PeriodFrameCount++;
+	if (m_PeriodFrameCount >= m_Period)
+	{
+		report();
+	}
+}
+
+void Metrics::report()
+{
+	PROFILE_FUNCTION();
+	{
+		std::lock_guard<std::mutex> lock(m_SamplersMutex);
+		for (auto& sampler : m_Samplers)
+		{
+			sampler();
+		}
+	}
+
+	MetricsSnapshot snapshot;
+	snapshot.m_Frame = m_FrameCount;
+	snapshot.m_FrameCount = m_PeriodFrameCount;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (auto& [name, counter] : m_Counters)
+		{
+			// Counters are shown per frame
+			double value = (double)counter->take() / m_PeriodFrameCount;
+			snapshot.m_Values.push_back({ name, GetShownValue(value, counter->getUnit()), GetUnitName(counter->getUnit()) });
+		}
+		for (auto& [name, gauge] : m_Gauges)
+		{
+			snapshot.m_Values.push_back({ name, GetShownValue(gauge->get(), gauge->getUnit()), GetUnitName(gauge->getUnit()) });
+		}
+		for (auto& [name, histogram] : m_Histograms)
+		{
+			MetricUnit unit = histogram->getUnit();
+			MetricHistogram::Summary summary = histogram->take();
+			snapshot.m_Values.push_back({ name + " Mean", GetShownValue(summary.m_Mean, unit), GetUnitName(unit) });
+			snapshot.m_Values.push_back({ name + " P50", GetShownValue(summary.m_P50, unit), GetUnitName(unit) });
+			snapshot.m_Values.push_back({ name + " P90", GetShownValue(summary.m_P90, unit), GetUnitName(unit) });
+			snapshot.m_Values.push_back({ name + " P99", GetShownValue(summary.m_P99, unit), GetUnitName(unit) });
+			snapshot.m_Values.push_back({ name + " Max", GetShownValue(summary.m_Max, unit), GetUnitName(unit) });
+		}
+	}
+	std::sort(snapshot.m_Values.begin(), snapshot.m_Values.end(), [](const MetricValue& a, const MetricValue& b) { return a.m_Name < b.m_Name; });
+
+	write(snapshot);
+	m_Snapshot = std::move(snapshot);
+	m_PeriodFrameCount = 0;
+}
+
+void Metrics::write(const MetricsSnapshot& snapshot)
+{
+	if (m_CSVFile.is_open())
+	{
+		for (auto& value : snapshot.m_Values)
+		{
+			m_CSVFile << snapshot.m_Frame << "," << JSON::json(value.m_Name).dump() << "," << value.m_Value << "," << value.m_Unit << "\n";
+		}
+		m_CSVFile.flush();
+	}
+	if (m_JSONFile.is_open())
+	{
+		JSON::json values = JSON::json::object();
+		for (auto& value : snapshot.m_Values)
+		{
+			values[value.m_Name] = value.m_Value;
+		}
+		JSON::json line = { { "frame", snapshot.m_Frame }, { "frameCount", snapshot.m_FrameCount }, { "metrics", values } };
+		m_JSONFile << line.dump() << "\n";
+		m_JSONFile.flush();
+	}
+}
+
+double Metrics::getValue(const String& name) const
+{
+	for (auto& value : m_Snapshot.m_Values)
+	{
+		if (value.m_Name == name)
+		{
+			return value.m_Value;
+		}
+	}
+	return 0.0;
+}
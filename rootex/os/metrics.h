@@ -0,0 +1,201 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/// Buckets of a histogram. Buckets grow by 2^(1/METRICS_BUCKETS_PER_OCTAVE) from METRICS_HISTOGRAM_MIN.
+#define METRICS_HISTOGRAM_BUCKETS 160
+#define METRICS_BUCKETS_PER_OCTAVE 8
+#define METRICS_HISTOGRAM_MIN 0.001
+
+/// Add to a counter. name should be a string literal, the counter is looked up only once.
+#define METRIC_COUNT(name, count)                                                                  \
+	{                                                                                              \
+		static MetricCounter* metricCounter = Metrics::GetSingleton()->getCounter(name);           \
+		metricCounter->add(count);                                                                 \
+	}
+/// Set a gauge. name should be a string literal, the gauge is looked up only once.
+#define METRIC_GAUGE(name, value, unit)                                                             \
+	{                                                                                               \
+		static MetricGauge* metricGauge = Metrics::GetSingleton()->getGauge(name, unit);            \
+		metricGauge->set(value);                                                                    \
+	}
+/// Add the time taken by the enclosing scope to a counter. name should be a string literal.
+#define METRIC_TIME(name)                                                                                                                      \
+	static MetricCounter* PROFILER_CONCAT(metricTimer, __LINE__) = Metrics::GetSingleton()->getCounter(name, MetricUnit::Nanoseconds); \
+	MetricTimeScope PROFILER_CONCAT(metricTimeScope, __LINE__)(PROFILER_CONCAT(metricTimer, __LINE__))
+
+/// How the values of a metric are shown
+enum class MetricUnit
+{
+	Count,
+	Milliseconds,
+	/// Shown in milliseconds
+	Nanoseconds,
+	/// Shown in megabytes
+	Bytes
+};
+
+/// A count that is summed over a reporting period, and reported per frame. Cheap to add to from any thread.
+class MetricCounter
+{
+	std::atomic<long long> m_Value;
+	MetricUnit m_Unit;
+
+public:
+	MetricCounter(MetricUnit unit);
+	MetricCounter(MetricCounter&) = delete;
+	~MetricCounter() = default;
+
+	void add(long long count) { m_Value.fetch_add(count, std::memory_order_relaxed); }
+	/// Returns the count since the last call and starts counting from 0.
+	long long take() { return m_Value.exchange(0, std::memory_order_relaxed); }
+
+	MetricUnit getUnit() const { return m_Unit; }
+};
+
+/// A value that is set, and reported as it is at the end of a reporting period. Can be set from any thread.
+class MetricGauge
+{
+	std::atomic<double> m_Value;
+	MetricUnit m_Unit;
+
+public:
+	MetricGauge(MetricUnit unit);
+	MetricGauge(MetricGauge&) = delete;
+	~MetricGauge() = default;
+
+	void set(double value) { m_Value.store(value, std::memory_order_relaxed); }
+	double get() const { return m_Value.load(std::memory_order_relaxed); }
+
+	MetricUnit getUnit() const { return m_Unit; }
+};
+
+/// Percentiles of the values recorded in a reporting period, to within a few percent.
+/// Values are counted in logarithmic buckets, so recording does not allocate or lock and can be done from any thread.
+class MetricHistogram
+{
+	std::atomic<unsigned int> m_Buckets[METRICS_HISTOGRAM_BUCKETS];
+	std::atomic<double> m_Max;
+	std::atomic<double> m_Sum;
+	MetricUnit m_Unit;
+
+public:
+	/// Percentiles, mean and maximum of a reporting period
+	struct Summary
+	{
+		unsigned int m_Count;
+		double m_Mean;
+		double m_P50;
+		double m_P90;
+		double m_P99;
+		double m_Max;
+	};
+
+	MetricHistogram(MetricUnit unit);
+	MetricHistogram(MetricHistogram&) = delete;
+	~MetricHistogram() = default;
+
+	void record(double value);
+	/// Summarise the values recorded since the last call and start a new period.
+	Summary take();
+
+	MetricUnit getUnit() const { return m_Unit; }
+};
+
+/// Adds the time between its construction and destruction to a counter. Use through METRIC_TIME.
+class MetricTimeScope
+{
+	MetricCounter* m_Counter;
+	std::chrono::steady_clock::time_point m_Begin;
+
+public:
+	MetricTimeScope(MetricCounter* counter)
+	    : m_Counter(counter)
+	    , m_Begin(std::chrono::steady_clock::now())
+	{
+	}
+	MetricTimeScope(MetricTimeScope&) = delete;
+	~MetricTimeScope()
+	{
+		m_Counter->add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Begin).count());
+	}
+};
+
+/// A reported value of a metric
+struct MetricValue
+{
+	String m_Name;
+	double m_Value;
+	/// Unit the value is shown in, empty for counts
+	const char* m_Unit;
+};
+
+/// Values of all metrics at the end of a reporting period, sorted by name
+struct MetricsSnapshot
+{
+	/// Frame the period ended at
+	unsigned long long m_Frame = 0;
+	unsigned int m_FrameCount = 0;
+	Vector<MetricValue> m_Values;
+};
+
+/// Registry of counters, gauges and histograms that are reported every few frames.
+/// Reports drive the metrics overlay of the UISystem, and are appended to CSV and JSON files for tracking regressions.
+class Metrics
+{
+	std::mutex m_Mutex;
+	Map<String, Ptr<MetricCounter>> m_Counters;
+	Map<String, Ptr<MetricGauge>> m_Gauges;
+	Map<String, Ptr<MetricHistogram>> m_Histograms;
+	/// Guards samplers separately, since samplers make metrics while they run
+	std::mutex m_SamplersMutex;
+	/// Set gauges that are too costly to keep up to date every frame, run before reporting
+	Vector<Function<void()>> m_Samplers;
+
+	MetricHistogram* m_FrameTime;
+	unsigned int m_Period;
+	unsigned int m_PeriodFrameCount;
+	unsigned long long m_FrameCount;
+	MetricsSnapshot m_Snapshot;
+
+	OutputFileStream m_CSVFile;
+	OutputFileStream m_JSONFile;
+
+	Metrics();
+	Metrics(Metrics&) = delete;
+	~Metrics() = default;
+
+	void write(const MetricsSnapshot& snapshot);
+
+public:
+	static void RegisterAPI(sol::state& rootex);
+	static Metrics* GetSingleton();
+
+	/// Find a metric by name, or make it if there is none. Metrics live as long as the registry, so callers can keep the pointer.
+	MetricCounter* getCounter(const String& name, MetricUnit unit = MetricUnit::Count);
+	MetricGauge* getGauge(const String& name, MetricUnit unit = MetricUnit::Count);
+	MetricHistogram* getHistogram(const String& name, MetricUnit unit = MetricUnit::Count);
+	/// Add a function that sets gauges before each report, on the main thread. Samplers can not add samplers.
+	void addSampler(const Function<void()>& sampler);
+
+	/// Frames in a reporting period
+	void setPeriod(unsigned int frames) { m_Period = frames ? frames : 1; }
+	/// Append a line of frame,metric,value,unit for each metric to a CSV file every period.
+	bool setCSVFile(const String& path);
+	/// Append a JSON object of the snapshot on a line of its own to a file every period.
+	bool setJSONFile(const String& path);
+
+	/// Call at the end of every frame from the main thread.
+	void endFrame(float frameMilliseconds);
+	/// End the reporting period now and start a new one. Only use from the main thread.
+	void report();
+	/// Values of the last reporting period. Only use from the main thread.
+	const MetricsSnapshot& getSnapshot() const { return m_Snapshot; }
+	/// Value of a metric in the last reporting period, or 0 if there is none.
+	double getValue(const String& name) const;
+};
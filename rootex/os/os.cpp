@@ -6,10 +6,7 @@
 
 #include "common/common.h"
 #include "resource_data.h"
-
-#ifdef ROOTEX_EDITOR
-#include "event_manager.h"
-#endif // ROOTEX_EDITOR
+#include "memory_mapped_file.h"
 
 std::filesystem::file_time_type::clock OS::s_FileSystemClock;
 const std::chrono::time_point<std::chrono::system_clock> OS::s_ApplicationStartTime = std::chrono::system_clock::now();
@@ -357,13 +354,25 @@ FileBuffer OS::LoadFileContents(String stringPath)
 	}
 
 	std::ifstream::pos_type pos = stream.tellg();
-	std::vector<char> buffer(pos);
+	FileBuffer buffer(pos);
 
 	stream.seekg(0, std::ios_base::beg);
 	stream.read(buffer.data(), pos);
 
 	stream.close();
-	return FileBuffer(buffer);
+	return buffer;
+}
+
+Ref<MemoryMappedFile> OS::MapFileContents(String stringPath)
+{
+	std::filesystem::path path = GetAbsolutePath(stringPath);
+
+	Ref<MemoryMappedFile> mappedFile = MemoryMappedFile::Open(path.generic_string());
+	if (!mappedFile)
+	{
+		ERR("OS: File IO error: Could not map " + path.generic_string());
+	}
+	return mappedFile;
 }
 
 bool OS::IsExists(String relativePath)
@@ -373,11 +382,12 @@ bool OS::IsExists(String relativePath)
 
 void OS::Print(const String& msg, const String& type)
 {
-#ifdef ROOTEX_EDITOR
-	EventManager::GetSingleton()->call(type, "OSPrint", msg);
-#endif // ROOTEX_EDITOR
-	std::cout.clear();
-	std::cout << msg << std::endl;
+	LogLevel level = LogLevel::Info;
+	Logger::FindLevel(type, level);
+	if (Logger::IsEnabled(LogCategory::Engine, level))
+	{
+		Logger::GetSingleton()->log(LogCategory::Engine, level, nullptr, 0, nullptr, String(msg));
+	}
 }
 
 void OS::Print(const float& real)
@@ -402,17 +412,12 @@ void OS::PrintLine(const String& msg)
 
 void OS::PrintWarning(const String& warning)
 {
-	std::cout << "\033[93m";
-	Print("WARNING: " + warning, "Warning");
-	std::cout << "\033[0m";
+	Print(warning, "Warning");
 }
 
 void OS::PrintError(const String& error)
 {
-	std::cout << "\033[91m";
-	Print("ERROR: " + error, "Error");
-	std::cout << "\033[0m";
-	PostError(error, "Error");
+	Print(error, "Error");
 }
 
 void OS::PrintIf(const bool& expr, const String& error)
@@ -15,6 +15,7 @@ typedef Vector<char> FileBuffer;
 typedef std::chrono::time_point<std::filesystem::file_time_type::clock> FileTimePoint; 
 
 class ResourceData;
+class MemoryMappedFile;
 
 /// Provides features that are provided directly by the OS.
 class OS
@@ -48,6 +49,8 @@ public:
 
 	static bool IsExists(String relativePath);
 	static FileBuffer LoadFileContents(String stringPath);
+	/// Map a file into memory instead of reading it. Returns nullptr if the file could not be mapped.
+	static Ref<MemoryMappedFile> MapFileContents(String stringPath);
 	static FilePath OS::GetAbsolutePath(String stringPath);
 	static FilePath OS::GetRootRelativePath(String stringPath);
 	static FilePath OS::GetRelativePath(String stringPath, String base);
@@ -66,6 +69,7 @@ public:
 
 	static bool SaveFile(const FilePath& filePath, ResourceData* fileData);
 
+	/// Log a message in the Engine category, without its source. type is Print, Warning or Error.
 	static void Print(const String& msg, const String& type = "Print");
 	static void Print(const float& real);
 	static void Print(const int& number);
@@ -0,0 +1,148 @@
+#include "profiler.h"
+
+#include <fstream>
+#include <iomanip>
+
+/// Ring buffer of the calling thread, made when it records its first event
+static thread_local ProfilerThread* CurrentThread = nullptr;
+
+std::atomic<bool> Profiler::s_IsCapturing = false;
+const std::chrono::steady_clock::time_point Profiler::s_StartTime = std::chrono::steady_clock::now();
+
+void Profiler::RegisterAPI(sol::state& rootex)
+{
+	sol::usertype<Profiler> profiler = rootex.new_usertype<Profiler>("Profiler");
+	profiler["Get"] = &Profiler::GetSingleton;
+	profiler["IsCapturing"] = &Profiler::IsCapturing;
+	profiler["startCapture"] = &Profiler::startCapture;
+	profiler["stopCapture"] = &Profiler::stopCapture;
+	profiler["exportChromeTrace"] = &Profiler::exportChromeTrace;
+}
+
+Profiler* Profiler::GetSingleton()
+{
+	static Profiler singleton;
+	return &singleton;
+}
+
+Profiler::Profiler()
+    : m_EventsPerThread(65536)
+{
+}
+
+ProfilerThread* Profiler::getCurrentThread()
+{
+	if (!CurrentThread)
+	{
+		CurrentThread = addThread("");
+	}
+	return CurrentThread;
+}
+
+ProfilerThread* Profiler::addThread(const String& name)
+{
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+	Ptr<ProfilerThread> thread(new ProfilerThread());
+	thread->m_ID = m_Threads.size();
+	thread->m_Name = name.empty() ? "Thread " + std::to_string(thread->m_ID) : name;
+	if (IsCapturing())
+	{
+		thread->m_Events.resize(m_EventsPerThread);
+	}
+	thread->m_RecordedCount = 0;
+	m_Threads.push_back(std::move(thread));
+	return m_Threads.back().get();
+}
+
+void Profiler::setEventsPerThread(unsigned int events)
+{
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+	m_EventsPerThread = events;
+}
+
+void Profiler::setThreadName(const String& name)
+{
+	ProfilerThread* thread = getCurrentThread();
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+	thread->m_Name = name;
+}
+
+void Profiler::record(const char* name, long long begin, long long end)
+{
+	record(getCurrentThread(), name, begin, end);
+}
+
+void Profiler::record(ProfilerThread* thread, const char* name, long long begin, long long end)
+{
+	if (thread->m_Events.empty())
+	{
+		return;
+	}
+	unsigned long long index = thread->m_RecordedCount.load(std::memory_order_relaxed);
+	thread->m_Events[index % thread->m_Events.size()] = { name, begin, end };
+	thread->m_RecordedCount.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::startCapture()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+		for (auto& thread : m_Threads)
+		{
+			if (thread->m_Events.empty())
+			{
+				thread->m_Events.resize(m_EventsPerThread);
+			}
+			thread->m_RecordedCount = 0;
+		}
+	}
+	s_IsCapturing = true;
+}
+
+void Profiler::stopCapture()
+{
+	s_IsCapturing = false;
+}
+
+bool Profiler::exportChromeTrace(const String& path)
+{
+	if (IsCapturing())
+	{
+		WARN("Stop capturing before exporting a trace");
+		return false;
+	}
+
+	std::ofstream trace(OS::GetAbsolutePath(path));
+	if (!trace)
+	{
+		ERR("Could not write trace: " + path);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+	trace << std::fixed << std::setprecision(3);
+	trace << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool isFirst = true;
+	size_t eventCount = 0;
+	for (auto& thread : m_Threads)
+	{
+		trace << (isFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->m_ID
+		      << ",\"args\":{\"name\":" << JSON::json(thread->m_Name).dump() << "}}";
+		isFirst = false;
+
+		unsigned long long recordedCount = thread->m_RecordedCount.load(std::memory_order_acquire);
+		unsigned long long first = recordedCount > thread->m_Events.size() ? recordedCount - thread->m_Events.size() : 0;
+		for (unsigned long long i = first; i < recordedCount; i++)
+		{
+			const ProfileEvent& event = thread->m_Events[i % thread->m_Events.size()];
+			// Chrome traces are in microseconds
+			trace << ",\n{\"name\":" << JSON::json(event.m_Name).dump() << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->m_ID
+			      << ",\"ts\":" << event.m_Begin / 1000.0 << ",\"dur\":" << (event.m_End - event.m_Begin) / 1000.0 << "}";
+		}
+		eventCount += recordedCount - first;
+	}
+	trace << "\n]}\n";
+
+	PRINT("Exported " + std::to_string(eventCount) + " profiled events to " + path);
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/common.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+/// Record the time taken by the enclosing scope while capturing. name should be a string literal, it is stored as a pointer.
+#define PROFILE_SCOPE(name) ProfileScope PROFILER_CONCAT(profileScope, __LINE__)(name)
+/// Record the time taken by the enclosing function while capturing.
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+
+/// A scope that ended, in nanoseconds since the profiler was created
+struct ProfileEvent
+{
+	const char* m_Name;
+	long long m_Begin;
+	long long m_End;
+};
+
+/// Ring buffer of events recorded by a single thread. When it is full, the oldest events are overwritten.
+/// Empty until the first capture, so that threads do not hold on to memory for events when nothing is profiled.
+struct ProfilerThread
+{
+	String m_Name;
+	unsigned int m_ID;
+	Vector<ProfileEvent> m_Events;
+	/// Events recorded since the capture started, only written by the recording thread
+	std::atomic<unsigned long long> m_RecordedCount;
+};
+
+/// Records scopes into per thread ring buffers while capturing, and exports them as a Chrome trace.
+/// Recording does not allocate or lock after the first event of a thread. When not capturing, a scope only checks a flag.
+class Profiler
+{
+	static std::atomic<bool> s_IsCapturing;
+	static const std::chrono::steady_clock::time_point s_StartTime;
+
+	std::mutex m_ThreadsMutex;
+	Vector<Ptr<ProfilerThread>> m_Threads;
+	unsigned int m_EventsPerThread;
+
+	Profiler();
+	Profiler(Profiler&) = delete;
+	~Profiler() = default;
+
+	ProfilerThread* getCurrentThread();
+
+public:
+	static void RegisterAPI(sol::state& rootex);
+	static Profiler* GetSingleton();
+
+	static bool IsCapturing() { return s_IsCapturing.load(std::memory_order_relaxed); }
+	/// Nanoseconds since the profiler was created
+	static long long Now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_StartTime).count(); }
+
+	/// Make a ring buffer for events that are not recorded by a thread, like GPU timings. Only record into it from one thread at a time.
+	/// Unnamed buffers are named by their ID.
+	ProfilerThread* addThread(const String& name);
+	/// Name the calling thread in exported traces.
+	void setThreadName(const String& name);
+	/// Size of ring buffers made after this is set. Ring buffers are only made once a capture starts.
+	void setEventsPerThread(unsigned int events);
+
+	void record(const char* name, long long begin, long long end);
+	void record(ProfilerThread* thread, const char* name, long long begin, long long end);
+
+	/// Forget recorded events and start recording new ones.
+	void startCapture();
+	void stopCapture();
+	/// Write the events of the last capture as Chrome trace_event JSON, which can be opened in chrome://tracing, Perfetto or imported into Tracy.
+	/// Call after stopping the capture, once other threads have finished the scopes they were in.
+	bool exportChromeTrace(const String& path);
+};
+
+/// Records the time between its construction and destruction. Use through PROFILE_SCOPE.
+class ProfileScope
+{
+	const char* m_Name;
+	long long m_Begin;
+
+public:
+	ProfileScope(const char* name)
+	    : m_Name(Profiler::IsCapturing() ? name : nullptr)
+	    , m_Begin(m_Name ? Profiler::Now() : 0)
+	{
+	}
+	ProfileScope(ProfileScope&) = delete;
+	~ProfileScope()
+	{
+		if (m_Name && Profiler::IsCapturing())
+		{
+			Profiler::GetSingleton()->record(m_Name, m_Begin, Profiler::Now());
+		}
+	}
+};
@@ -1,9 +1,13 @@
 #include "thread.h"
+#include "profiler.h"
 #include <Windows.h>
 
 /// The main function which runs on every thread.
 DWORD WINAPI MainLoop(LPVOID voidParameters);
 
+/// Set on the threads of a pool. Tasks submitted from them run inline since the pool cannot wait on itself.
+static thread_local bool s_IsWorkerThread = false;
+
 void DebugTask::execute()
 {
 	int i = 10;
@@ -33,6 +37,7 @@ void ThreadPool::initialize()
 	InitializeConditionVariable(&m_ConsumerVariable);
 	InitializeConditionVariable(&m_ProducerVariable);
 	InitializeCriticalSection(&m_CriticalSection);
+	InitializeCriticalSection(&m_SubmitSection);
 
 	m_DefaultWorkerParameter.m_Thread = 0;
 	m_DefaultWorkerParameter.m_ThreadPool = NULL;
@@ -42,7 +47,6 @@ void ThreadPool::initialize()
 		m_TaskQueue.m_Write = 0;
 		m_TaskQueue.m_Jobs = 0;
 		m_TasksFinished = 0;
-		m_TasksComplete.m_Jobs = 0;
 	}
 
 	for (__int32 iThread = 0; iThread < m_Threads; iThread++)
@@ -63,27 +67,14 @@ DWORD WINAPI MainLoop(LPVOID voidParameters)
 {
 	const struct WorkerParameters* parameters = (struct WorkerParameters*)voidParameters;
 
-	const __int32 iThread = parameters->m_Thread;
 	ThreadPool& m_ThreadPool = *parameters->m_ThreadPool;
-
-	__int32 taskId = -1;
-	__int32 increment = 0;
+	s_IsWorkerThread = true;
+	Profiler::GetSingleton()->setThreadName("Worker " + std::to_string(parameters->m_Thread));
 
 	while (true)
 	{
 		EnterCriticalSection(&m_ThreadPool.m_CriticalSection);
 
-		/*if (m_ThreadPool.m_TasksComplete.m_Jobs > 0)
-		{
-			m_ThreadPool.m_TasksComplete.ids.push_back(taskId);
-			m_ThreadPool.m_TasksComplete.m_Jobs += increment;
-			m_ThreadPool.m_TasksFinished += increment;
-			increment++;
-			std::cout << increment;
-		}*/
-
-		WakeAllConditionVariable(&m_ThreadPool.m_ProducerVariable);
-
 		while ((m_ThreadPool.m_TaskQueue.m_Jobs == 0) && m_ThreadPool.m_IsRunning)
 		{
 			SleepConditionVariableCS(&m_ThreadPool.m_ConsumerVariable, &m_ThreadPool.m_CriticalSection, INFINITE);
@@ -95,19 +86,32 @@ DWORD WINAPI MainLoop(LPVOID voidParameters)
 			return 0;
 		}
 
-		taskId = m_ThreadPool.m_TaskQueue.m_QueueJobs[m_ThreadPool.m_TaskQueue.m_Read]->m_ID;
-		__int32 m_ReadTemp = m_ThreadPool.m_TaskQueue.m_Read;
+		// Hold a reference so the task outlives the queue being cleared by the master thread
+		Ref<Task> task = m_ThreadPool.m_TaskQueue.m_QueueJobs[m_ThreadPool.m_TaskQueue.m_Read];
 		m_ThreadPool.m_TaskQueue.m_Jobs--;
 		m_ThreadPool.m_TaskQueue.m_Read++;
 
 		LeaveCriticalSection(&m_ThreadPool.m_CriticalSection);
 
-		m_ThreadPool.m_TaskQueue.m_QueueJobs[m_ReadTemp]->execute();
-		m_ThreadPool.m_TasksComplete.m_Jobs++;
+		{
+			PROFILE_SCOPE("Task");
+			task->execute();
+		}
+
+		EnterCriticalSection(&m_ThreadPool.m_CriticalSection);
+		m_ThreadPool.m_TasksFinished++;
+		LeaveCriticalSection(&m_ThreadPool.m_CriticalSection);
+
+		WakeAllConditionVariable(&m_ThreadPool.m_ProducerVariable);
 	}
 	return 0;
 }
 
+bool ThreadPool::IsWorkerThread()
+{
+	return s_IsWorkerThread;
+}
+
 ThreadPool::ThreadPool()
 {
 	initialize();
@@ -120,103 +124,46 @@ ThreadPool::~ThreadPool()
 
 void ThreadPool::submit(Vector<Ref<Task>>& tasks)
 {
-	MasterThread master_thread;
-	master_thread.m_TasksComplete.m_Jobs = 0;
-	master_thread.m_TasksReady.m_Jobs = 0;
-	master_thread.m_TasksReady.m_Read = 0;
-	master_thread.m_TasksReady.m_Write = 0;
-
-	bool isTasksRemaining = true;
-
-	m_TasksFinished = 0;
-
+	PROFILE_FUNCTION();
+	if (tasks.empty())
 	{
-		static __int32 idIndex = 0;
-		for (auto i_Job : tasks)
-		{
-			i_Job->m_Dependencies = 0;
-			m_TaskQueue.m_QueueJobs.push_back(i_Job);
-			m_TaskQueue.m_QueueJobs[idIndex]->m_ID = idIndex;
-			idIndex++;
-		}
-
-		/*for (__int32 i_Job = 0; i_Job < tasks.size(); i_Job++)
-		{
-			for (__int32 i_Permission = 0; i_Permission < tasks[i_Job]->m_Permisions; i_Permission++)
-			{
-				tasks[tasks[i_Job]->i_Permissions[i_Permission]]->m_Dependencies++;
-			}
-		}*/
+		return;
 	}
 
-	while (isTasksRemaining)
+	if (s_IsWorkerThread)
 	{
-
-		/*{
-			const __int32 nJobs = master_thread.m_TasksComplete.m_Jobs;
-			for (__int32 i_job = 0; i_job < nJobs; i_job++)
-			{
-				__int32 taskId = master_thread.m_TasksComplete.ids[i_job];
-
-				for (__int32 i_Permission = 0; i_Permission < tasks[taskId]->m_Permisions; i_Permission++)
-				{
-					tasks[tasks[taskId]->i_Permissions[i_Permission]]->m_Dependencies--;
-				}
-				master_thread.m_TasksComplete.m_Jobs--;
-			}
-		}*/
-		{
-			__int32 i_Job = 0;
-			while (i_Job < tasks.size())
-			{
-				if (tasks[i_Job]->m_Dependencies == 0)
-				{
-					master_thread.m_TasksReady.m_IDs.push_back(tasks[i_Job]->m_ID);
-					master_thread.m_TasksReady.m_Write++;
-					master_thread.m_TasksReady.m_Jobs++;
-					tasks[i_Job]->m_Dependencies--;
-				}
-				i_Job++;
-			}
-		}
-
-		EnterCriticalSection(&m_CriticalSection);
-
+		for (auto& task : tasks)
 		{
-			__int32 nJobs = master_thread.m_TasksReady.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
-			{
-				m_TaskQueue.m_QueueJobs[m_TaskQueue.m_Write]->m_ID = master_thread.m_TasksReady.m_IDs[master_thread.m_TasksReady.m_Read];
-				m_TaskQueue.m_Write++;
-				m_TaskQueue.m_Jobs++;
-				m_TasksFinished++;
-				master_thread.m_TasksReady.m_Read++;
-				master_thread.m_TasksReady.m_Jobs--;
-			}
+			task->execute();
 		}
+		return;
+	}
 
-		WakeAllConditionVariable(&m_ConsumerVariable);
+	// Waiting below leaves m_CriticalSection, which would let another thread replace the queue of this batch
+	EnterCriticalSection(&m_SubmitSection);
+	EnterCriticalSection(&m_CriticalSection);
 
-		while ((m_TasksComplete.m_Jobs == 0) && m_IsRunning)
-		{
-			SleepConditionVariableCS(&m_ProducerVariable, &m_CriticalSection, INFINITE);
-		}
+	m_TaskQueue.m_QueueJobs = tasks;
+	for (__int32 i_Job = 0; i_Job < tasks.size(); i_Job++)
+	{
+		m_TaskQueue.m_QueueJobs[i_Job]->m_ID = i_Job;
+	}
+	m_TaskQueue.m_Read = 0;
+	m_TaskQueue.m_Write = tasks.size();
+	m_TaskQueue.m_Jobs = tasks.size();
+	m_TasksFinished = 0;
 
-		/*{
-			const __int32 nJobs = m_TasksComplete.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
-			{
+	WakeAllConditionVariable(&m_ConsumerVariable);
 
-				master_thread.m_TasksComplete.ids[i_Job] = m_TasksComplete.ids[i_Job];
-				master_thread.m_TasksComplete.m_Jobs++;
-				m_TasksComplete.m_Jobs--;
-			}
-		}*/
+	while ((m_TasksFinished < tasks.size()) && m_IsRunning)
+	{
+		SleepConditionVariableCS(&m_ProducerVariable, &m_CriticalSection, INFINITE);
+	}
 
-		isTasksRemaining = m_TasksFinished < tasks.size();
+	m_TaskQueue.m_QueueJobs.clear();
 
-		LeaveCriticalSection(&m_CriticalSection);
-	}
+	LeaveCriticalSection(&m_CriticalSection);
+	LeaveCriticalSection(&m_SubmitSection);
 }
 
 void ThreadPool::shutDown()
@@ -228,4 +175,11 @@ void ThreadPool::shutDown()
 	LeaveCriticalSection(&this->m_CriticalSection);
 	WakeAllConditionVariable(&this->m_ConsumerVariable);
 	WaitForMultipleObjects(m_Threads, m_Handles.data(), TRUE, INFINITE);
+
+	for (HANDLE& handle : m_Handles)
+	{
+		CloseHandle(handle);
+	}
+	DeleteCriticalSection(&m_CriticalSection);
+	DeleteCriticalSection(&m_SubmitSection);
 }
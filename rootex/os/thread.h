@@ -47,29 +47,6 @@ struct TaskQueue
 	Vector<Ref<Task>> m_QueueJobs;
 };
 
-/// Contains th information of completed jobs.
-struct TaskComplete
-{
-	__int32 m_Jobs;
-	Vector<__int32> m_IDs;
-};
-
-/// Contains information of jobs ready for execution.
-struct TaskReady
-{	
-	__int32 m_Jobs;
-	unsigned __int32 m_Write;
-	unsigned __int32 m_Read;
-	Vector<__int32> m_IDs;
-};
-
-/// Master thread to communicate with and maintain worker threads.
-struct MasterThread
-{	
-	TaskComplete m_TasksComplete;
-	TaskReady m_TasksReady;
-};
-
 class ThreadPool
 {
 	bool m_IsRunning;
@@ -81,10 +58,11 @@ class ThreadPool
 	CONDITION_VARIABLE m_ConsumerVariable;
 	CONDITION_VARIABLE m_ProducerVariable;
 	CRITICAL_SECTION m_CriticalSection;
+	/// Held for the whole of a batch, so that batches submitted from several threads wait for each other instead of sharing the queue.
+	CRITICAL_SECTION m_SubmitSection;
 
 	__int32 m_TasksFinished;
 	TaskQueue m_TaskQueue;
-	TaskComplete m_TasksComplete;
 
 	friend DWORD WINAPI MainLoop(LPVOID voidParameters);
 
@@ -92,10 +70,16 @@ class ThreadPool
 	void shutDown();
 
 public:
+	/// If the calling thread is a worker of a thread pool.
+	static bool IsWorkerThread();
+
 	ThreadPool();
 	ThreadPool(ThreadPool&) = delete;
 	~ThreadPool();
 	
-	/// To submit a job to the jobs queue.
+	/// To submit a batch of jobs to the jobs queue. Blocks until every job in the batch has finished executing.
+	/// Batches submitted from inside a job are executed inline on that thread. Batches submitted from several other threads run one after the other.
 	void submit(Vector<Ref<Task>>& tasks);
+
+	__int32 getThreadCount() const { return m_Threads; }
 };
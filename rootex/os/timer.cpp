@@ -54,3 +54,37 @@ void FrameTimer::showFPS()
 		" at " + 
 		std::to_string(1.0f / ((s_Clock.now() - m_FrameStartTime).count() * NS_TO_MS * MS_TO_S)) + " fps");
 }
+
+FixedStepTimer::FixedStepTimer(float tickRate, int maxStepsPerFrame)
+    : m_MaxStepsPerFrame(maxStepsPerFrame)
+    , m_AccumulatedMilliseconds(0.0f)
+    , m_TickCount(0)
+{
+	setTickRate(tickRate);
+}
+
+void FixedStepTimer::setTickRate(float tickRate)
+{
+	if (tickRate <= 0.0f)
+	{
+		WARN("Invalid tick rate: " + std::to_string(tickRate) + ". Using 60 ticks per second");
+		tickRate = 60.0f;
+	}
+	m_StepMilliseconds = S_TO_MS / tickRate;
+}
+
+void FixedStepTimer::accumulate(float frameMilliseconds)
+{
+	m_AccumulatedMilliseconds += std::min(frameMilliseconds, m_StepMilliseconds * m_MaxStepsPerFrame);
+}
+
+bool FixedStepTimer::tick()
+{
+	if (m_AccumulatedMilliseconds < m_StepMilliseconds)
+	{
+		return false;
+	}
+	m_AccumulatedMilliseconds -= m_StepMilliseconds;
+	m_TickCount++;
+	return true;
+}
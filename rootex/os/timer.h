@@ -72,3 +72,32 @@ public:
 	float getLastFrameTime() const { return m_LastFrameTime; }
 	float getLastFPS() const { return 1.0f / (m_LastFrameTime * MS_TO_S); }
 };
+
+/// Splits variable frame times into fixed size simulation ticks.
+class FixedStepTimer
+{
+	float m_StepMilliseconds;
+	int m_MaxStepsPerFrame;
+	float m_AccumulatedMilliseconds;
+	unsigned long long int m_TickCount;
+
+public:
+	FixedStepTimer(float tickRate = 60.0f, int maxStepsPerFrame = 5);
+	FixedStepTimer(FixedStepTimer&) = delete;
+	~FixedStepTimer() = default;
+
+	/// Set the number of ticks per second.
+	void setTickRate(float tickRate);
+	/// Frames that take longer than this many ticks only simulate this many, so that a slow frame cannot make the next one slower.
+	void setMaxStepsPerFrame(int maxSteps) { m_MaxStepsPerFrame = maxSteps; }
+
+	/// Add the time taken by the last frame.
+	void accumulate(float frameMilliseconds);
+	/// Consume one tick of accumulated time. Returns false when less than a tick is left.
+	bool tick();
+
+	float getStepTime() const { return m_StepMilliseconds; }
+	/// Fraction of a tick left over after ticking, to interpolate rendered state by.
+	float getAlpha() const { return m_AccumulatedMilliseconds / m_StepMilliseconds; }
+	unsigned long long int getTickCount() const { return m_TickCount; }
+};
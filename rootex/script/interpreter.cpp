@@ -9,10 +9,18 @@
 #include "components/visual/model_component.h"
 #include "components/physics/box_collider_component.h"
 #include "components/trigger_component.h"
+#include "components/script_component.h"
+#include "systems/physics_system.h"
+#include "renderer/texture_streamer.h"
 #include "entity_factory.h"
 #include "event_manager.h"
 #include "script/interpreter.h"
 #include "core/input/input_manager.h"
+#include "os/thread.h"
+#include "os/timer.h"
+#include "os/logger.h"
+#include "os/metrics.h"
+#include "os/profiler.h"
 
 void SolPanic(std::optional<String> maybeMsg)
 {
@@ -24,16 +32,8 @@ void SolPanic(std::optional<String> maybeMsg)
 }
 
 LuaInterpreter::LuaInterpreter()
-    : m_Lua(sol::c_call<decltype(&SolPanic), &SolPanic>)
 {
-	m_Lua.open_libraries(sol::lib::base);
-	m_Lua.open_libraries(sol::lib::io);
-	m_Lua.open_libraries(sol::lib::math);
-	m_Lua.open_libraries(sol::lib::os);
-	m_Lua.open_libraries(sol::lib::string);
-	m_Lua.open_libraries(sol::lib::table);
-
-	registerTypes();
+	createState(m_SharedState);
 }
 
 LuaInterpreter* LuaInterpreter::GetSingleton()
@@ -42,9 +42,221 @@ LuaInterpreter* LuaInterpreter::GetSingleton()
 	return &singleton;
 }
 
-void LuaInterpreter::registerTypes()
+sol::state& LuaInterpreter::getLuaState(const String& group)
+{
+	if (group.empty())
+	{
+		return *m_SharedState.m_State;
+	}
+
+	auto&& findIt = m_GroupStates.find(group);
+	if (findIt != m_GroupStates.end())
+	{
+		return *findIt->second.m_State;
+	}
+
+	LuaStateData& groupStateData = m_GroupStates[group];
+	createState(groupStateData);
+	sol::state& groupState = *groupStateData.m_State;
+
+	// Script groups may be updated on worker threads, so events raised from them are deferred, in the order of the groups
+	groupState["CallEvent"] = [group](const Event& event) {
+		String eventName = event.getName();
+		Event::Type eventType = event.getType();
+		Variant data = event.getData();
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [eventName, eventType, data]() { EventManager::GetSingleton()->deferredCall(eventName, eventType, data); });
+	};
+	// Listeners and entities are not thread safe, so changes to them are run on the main thread once the groups are done
+	groupState["Connect"] = [group](const sol::function& function, const String& eventName) {
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [function, eventName]() { BIND_EVENT_FUNCTION(eventName, function); });
+	};
+	groupState["AddEvent"] = [group](const String& eventType) {
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [eventType]() { EventManager::GetSingleton()->addEvent(eventType); });
+	};
+	groupState["RemoveEvent"] = [group](const String& eventType) {
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [eventType]() { EventManager::GetSingleton()->removeEvent(eventType); });
+	};
+	groupState["Entity"]["destroy"] = [group](Entity* entity) {
+		EntityID entityID = entity->getID();
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [entityID]() {
+			if (Ref<Entity> found = EntityFactory::GetSingleton()->findEntity(entityID))
+			{
+				found->destroy();
+			}
+		});
+	};
+	groupState["Entity"]["removeComponent"] = [group](Entity* entity, Ref<Component> component) {
+		EntityID entityID = entity->getID();
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [entityID, component]() {
+			if (Ref<Entity> found = EntityFactory::GetSingleton()->findEntity(entityID))
+			{
+				found->removeComponent(component);
+			}
+		});
+	};
+	// Collider setters change the shared Bullet world, which other groups may be querying
+	auto callOnCollider = [group](PhysicsColliderComponent* collider, const Function<void(PhysicsColliderComponent*)>& call) {
+		EntityID entityID = collider->getOwner()->getID();
+		LuaInterpreter::GetSingleton()->callOnMainThread(group, [entityID, call]() {
+			if (Ref<Entity> found = EntityFactory::GetSingleton()->findEntity(entityID))
+			{
+				if (Ref<PhysicsColliderComponent> foundCollider = found->getComponent<PhysicsColliderComponent>())
+				{
+					call(foundCollider.get());
+				}
+			}
+		});
+	};
+	groupState["PhysicsColliderComponent"]["setVelocity"] = [callOnCollider](PhysicsColliderComponent* collider, const Vector3& velocity) {
+		callOnCollider(collider, [velocity](PhysicsColliderComponent* found) { found->setVelocity(velocity); });
+	};
+	groupState["PhysicsColliderComponent"]["applyForce"] = [callOnCollider](PhysicsColliderComponent* collider, const Vector3& force) {
+		callOnCollider(collider, [force](PhysicsColliderComponent* found) { found->applyForce(force); });
+	};
+	groupState["PhysicsColliderComponent"]["setCollisionLayers"] = [callOnCollider](PhysicsColliderComponent* collider, int collisionGroup, int collisionMask) {
+		callOnCollider(collider, [collisionGroup, collisionMask](PhysicsColliderComponent* found) { found->setCollisionLayers(collisionGroup, collisionMask); });
+	};
+	// Calls that return a result can not wait for the main thread
+	groupState["ReturnCallEvent"] = [](const Event& event) -> Variant {
+		if (ThreadPool::IsWorkerThread())
+		{
+			WARN("ReturnCallEvent is not available to script groups running in parallel: " + event.getName());
+			return false;
+		}
+		return EventManager::GetSingleton()->returnCall(event);
+	};
+	groupState["EntityFactory"]["Create"] = [](TextResourceFile* entityJSONDescription) -> Ref<Entity> {
+		if (ThreadPool::IsWorkerThread())
+		{
+			WARN("EntityFactory.Create is not available to script groups running in parallel");
+			return nullptr;
+		}
+		return EntityFactory::GetSingleton()->createEntity(entityJSONDescription);
+	};
+
+	PRINT("Created Lua state for script group: " + group);
+	return groupState;
+}
+
+void LuaInterpreter::callOnMainThread(const String& group, const Function<void()>& call)
+{
+	if (!ThreadPool::IsWorkerThread())
+	{
+		call();
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_MainThreadCallsMutex);
+	m_MainThreadCalls[group].push_back(call);
+}
+
+void LuaInterpreter::runMainThreadCalls()
+{
+	Map<String, Vector<Function<void()>>> calls;
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadCallsMutex);
+		calls.swap(m_MainThreadCalls);
+	}
+	for (auto&& [group, groupCalls] : calls)
+	{
+		for (auto& call : groupCalls)
+		{
+			call();
+		}
+	}
+}
+
+void LuaInterpreter::createState(LuaStateData& stateData)
+{
+	stateData.m_Allocator.reset(new LuaAllocator());
+	stateData.m_State.reset(new sol::state(sol::c_call<decltype(&SolPanic), &SolPanic>, &LuaAllocator::Allocate, stateData.m_Allocator.get()));
+	openLibraries(*stateData.m_State);
+	registerTypes(*stateData.m_State);
+	applyGarbageCollection(stateData);
+}
+
+void LuaInterpreter::setGarbageCollection(float stepBudgetMs, int pause, int stepMultiplier)
+{
+	m_GCStepBudgetMs = stepBudgetMs;
+	m_GCPause = pause;
+	m_GCStepMultiplier = stepMultiplier;
+
+	applyGarbageCollection(m_SharedState);
+	for (auto&& [group, groupStateData] : m_GroupStates)
+	{
+		applyGarbageCollection(groupStateData);
+	}
+}
+
+void LuaInterpreter::applyGarbageCollection(LuaStateData& stateData)
+{
+	lua_State* state = stateData.m_State->lua_state();
+	lua_gc(state, LUA_GCSETPAUSE, m_GCPause);
+	lua_gc(state, LUA_GCSETSTEPMUL, m_GCStepMultiplier);
+	if (m_GCStepBudgetMs > 0.0f)
+	{
+		lua_gc(state, LUA_GCSTOP, 0);
+	}
+	else
+	{
+		lua_gc(state, LUA_GCRESTART, 0);
+	}
+}
+
+void LuaInterpreter::stepGarbageCollector()
+{
+	PROFILE_FUNCTION();
+	METRIC_TIME("System Time/LuaGarbageCollector");
+	if (m_GCStepBudgetMs <= 0.0f)
+	{
+		return;
+	}
+
+	const float stateBudgetMs = m_GCStepBudgetMs / (m_GroupStates.size() + 1);
+	stepGarbageCollector(m_SharedState, stateBudgetMs);
+	for (auto&& [group, groupStateData] : m_GroupStates)
+	{
+		stepGarbageCollector(groupStateData, stateBudgetMs);
+	}
+}
+
+void LuaInterpreter::stepGarbageCollector(LuaStateData& stateData, float budgetMs)
+{
+	lua_State* state = stateData.m_State->lua_state();
+	if (!stateData.m_IsCollecting)
+	{
+		// Start a new cycle only after memory has grown enough since the last one, like Lua's own pause
+		if (lua_gc(state, LUA_GCCOUNT, 0) * 100 < stateData.m_LastCycleKB * m_GCPause)
+		{
+			return;
+		}
+		stateData.m_IsCollecting = true;
+	}
+
+	Timer timer;
+	while (timer.getTimeMs() < budgetMs)
+	{
+		// Returns 1 when a collection cycle has finished
+		if (lua_gc(state, LUA_GCSTEP, 0))
+		{
+			stateData.m_IsCollecting = false;
+			stateData.m_LastCycleKB = lua_gc(state, LUA_GCCOUNT, 0);
+			break;
+		}
+	}
+}
+
+void LuaInterpreter::openLibraries(sol::state& rootex)
+{
+	rootex.open_libraries(sol::lib::base);
+	rootex.open_libraries(sol::lib::io);
+	rootex.open_libraries(sol::lib::math);
+	rootex.open_libraries(sol::lib::os);
+	rootex.open_libraries(sol::lib::string);
+	rootex.open_libraries(sol::lib::table);
+}
+
+void LuaInterpreter::registerTypes(sol::state& rootex)
 {
-	sol::state& rootex = m_Lua;
 	{
 		sol::usertype<Vector2> vector2 = rootex.new_usertype<Vector2>(
 		    "Vector2",
@@ -104,25 +316,32 @@ void LuaInterpreter::registerTypes()
 		matrix["Identity"] = sol::var(Matrix::Identity);
 	}
 	
-	Event::RegisterAPI(m_Lua);
-	EventManager::RegisterAPI(m_Lua);
-	InputManager::RegisterAPI(m_Lua);
-
-	ResourceLoader::RegisterAPI(m_Lua);
-	ResourceFile::RegisterAPI(m_Lua);
-	TextResourceFile::RegisterAPI(m_Lua);
-	LuaTextResourceFile::RegisterAPI(m_Lua);
-	AudioResourceFile::RegisterAPI(m_Lua);
-	ModelResourceFile::RegisterAPI(m_Lua);
-	ImageResourceFile::RegisterAPI(m_Lua);
-	FontResourceFile::RegisterAPI(m_Lua);
+	Event::RegisterAPI(rootex);
+	EventManager::RegisterAPI(rootex);
+	InputManager::RegisterAPI(rootex);
+
+	ResourceLoader::RegisterAPI(rootex);
+	ResourceFile::RegisterAPI(rootex);
+	TextResourceFile::RegisterAPI(rootex);
+	LuaTextResourceFile::RegisterAPI(rootex);
+	AudioResourceFile::RegisterAPI(rootex);
+	ModelResourceFile::RegisterAPI(rootex);
+	ImageResourceFile::RegisterAPI(rootex);
+	FontResourceFile::RegisterAPI(rootex);
 	
-	EntityFactory::RegisterAPI(m_Lua);
-	Entity::RegisterAPI(m_Lua);
-	TransformComponent::RegisterAPI(m_Lua);
-	HierarchyComponent::RegisterAPI(m_Lua);
-	ModelComponent::RegisterAPI(m_Lua);
-	RenderUIComponent::RegisterAPI(m_Lua);
-	TextUIComponent::RegisterAPI(m_Lua);
-	PhysicsColliderComponent::RegisterAPI(m_Lua);
+	EntityFactory::RegisterAPI(rootex);
+	Entity::RegisterAPI(rootex);
+	TransformComponent::RegisterAPI(rootex);
+	HierarchyComponent::RegisterAPI(rootex);
+	ModelComponent::RegisterAPI(rootex);
+	RenderUIComponent::RegisterAPI(rootex);
+	TextUIComponent::RegisterAPI(rootex);
+	PhysicsColliderComponent::RegisterAPI(rootex);
+	ScriptComponent::RegisterAPI(rootex);
+
+	PhysicsSystem::RegisterAPI(rootex);
+	TextureStreamer::RegisterAPI(rootex);
+	Profiler::RegisterAPI(rootex);
+	Logger::RegisterAPI(rootex);
+	Metrics::RegisterAPI(rootex);
 }
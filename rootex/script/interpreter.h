@@ -25,19 +25,66 @@
 
 #include "sol/sol.hpp"
 
+#include "common/types.h"
+#include "script/lua_allocator.h"
+
+#include <mutex>
+
+/// A Lua state along with the allocator serving its memory and its garbage collection progress.
+struct LuaStateData
+{
+	Ptr<LuaAllocator> m_Allocator;
+	Ptr<sol::state> m_State;
+	/// Memory in use after the last finished collection cycle, in KB.
+	int m_LastCycleKB = 0;
+	bool m_IsCollecting = false;
+};
+
 /// Lua interpreter that runs all Lua scripts inside the same Lua state. This means that all Lua code-snippets that are run can cross-reference each other.
+/// Scripts that opt into a named script group instead run inside a separate Lua state owned by that group, so that different groups can be run in parallel.
 class LuaInterpreter
 {
-	sol::state m_Lua;
+	LuaStateData m_SharedState;
+	/// Ordered by name, so that groups are always visited in the same order.
+	Map<String, LuaStateData> m_GroupStates;
+
+	/// Per-frame time budget for stepping the garbage collectors. Lua's automatic collector is used when this is 0.
+	float m_GCStepBudgetMs = 0.0f;
+	/// Percentage of memory growth since the last cycle after which a new collection cycle starts.
+	int m_GCPause = 200;
+	/// Speed of the collector relative to memory allocation, in percent.
+	int m_GCStepMultiplier = 200;
+
+	/// Calls made by script groups running on worker threads, waiting to be run on the main thread. Kept per group, so that their order does not depend on thread timing.
+	Map<String, Vector<Function<void()>>> m_MainThreadCalls;
+	std::mutex m_MainThreadCallsMutex;
 	
 	LuaInterpreter();
 	LuaInterpreter(LuaInterpreter&) = delete;
 	~LuaInterpreter() = default;
 
-	void registerTypes();
+	void createState(LuaStateData& stateData);
+	void openLibraries(sol::state& rootex);
+	void registerTypes(sol::state& rootex);
+	void applyGarbageCollection(LuaStateData& stateData);
+	void stepGarbageCollector(LuaStateData& stateData, float budgetMs);
 
 public:
 	static LuaInterpreter* GetSingleton();
 
-	sol::state& getLuaState() { return m_Lua; }
+	sol::state& getLuaState() { return *m_SharedState.m_State; }
+	/// Get the Lua state of a script group. The state is created with all engine bindings on first access. An empty group name returns the shared Lua state.
+	sol::state& getLuaState(const String& group);
+	const LuaStateData& getSharedState() const { return m_SharedState; }
+	const Map<String, LuaStateData>& getGroupStates() const { return m_GroupStates; }
+
+	/// Switch between Lua's automatic collector and incremental collection driven by stepGarbageCollector().
+	void setGarbageCollection(float stepBudgetMs, int pause, int stepMultiplier);
+	/// Step the garbage collector of every Lua state within the per-frame budget. Call once per frame while no scripts are running.
+	void stepGarbageCollector();
+
+	/// Run a call of a script group that is not thread safe. Calls made from a worker thread are queued till runMainThreadCalls(), others run right away.
+	void callOnMainThread(const String& group, const Function<void()>& call);
+	/// Run the calls queued by script groups that ran in parallel. Groups are run in order of their names, and the calls of a group in the order they were made.
+	void runMainThreadCalls();
 };
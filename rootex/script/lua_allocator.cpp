@@ -0,0 +1,155 @@
+#include "lua_allocator.h"
+
+#include <cstdlib>
+#include <cstring>
+
+thread_local LuaAllocationStats* LuaAllocator::s_CurrentScope = nullptr;
+
+void* LuaAllocator::Allocate(void* userData, void* block, size_t oldSize, size_t newSize)
+{
+	LuaAllocator* allocator = (LuaAllocator*)userData;
+
+	// Lua passes the type of the object being created in oldSize when block is null
+	if (block == nullptr)
+	{
+		oldSize = 0;
+	}
+
+	if (newSize == 0)
+	{
+		if (block)
+		{
+			allocator->deallocate(block, oldSize);
+			allocator->track(oldSize, 0);
+		}
+		return nullptr;
+	}
+
+	void* newBlock = nullptr;
+	if (block == nullptr)
+	{
+		newBlock = allocator->allocate(newSize);
+	}
+	else if (oldSize > s_MaxPooledSize && newSize > s_MaxPooledSize)
+	{
+		newBlock = realloc(block, newSize);
+	}
+	else if (oldSize <= s_MaxPooledSize && newSize <= s_MaxPooledSize && GetSizeClass(oldSize) == GetSizeClass(newSize))
+	{
+		newBlock = block;
+	}
+	else
+	{
+		newBlock = allocator->allocate(newSize);
+		if (newBlock)
+		{
+			memcpy(newBlock, block, oldSize < newSize ? oldSize : newSize);
+			allocator->deallocate(block, oldSize);
+		}
+		else if (newSize < oldSize)
+		{
+			// Lua expects shrinking to never fail, the old block is still large enough
+			newBlock = block;
+		}
+	}
+
+	if (newBlock)
+	{
+		allocator->track(oldSize, newSize);
+	}
+	return newBlock;
+}
+
+LuaAllocator::~LuaAllocator()
+{
+	for (char* page : m_Pages)
+	{
+		free(page);
+	}
+}
+
+void* LuaAllocator::allocate(size_t size)
+{
+	if (size > s_MaxPooledSize)
+	{
+		return malloc(size);
+	}
+
+	size_t sizeClass = GetSizeClass(size);
+	if (!m_FreeLists[sizeClass])
+	{
+		refillFreeList(sizeClass);
+		if (!m_FreeLists[sizeClass])
+		{
+			return nullptr;
+		}
+	}
+
+	FreeBlock* block = m_FreeLists[sizeClass];
+	m_FreeLists[sizeClass] = block->m_Next;
+	return block;
+}
+
+void LuaAllocator::deallocate(void* block, size_t size)
+{
+	if (size > s_MaxPooledSize)
+	{
+		free(block);
+		return;
+	}
+
+	size_t sizeClass = GetSizeClass(size);
+	FreeBlock* freeBlock = (FreeBlock*)block;
+	freeBlock->m_Next = m_FreeLists[sizeClass];
+	m_FreeLists[sizeClass] = freeBlock;
+}
+
+void LuaAllocator::refillFreeList(size_t sizeClass)
+{
+	char* page = (char*)malloc(s_PageSize);
+	if (!page)
+	{
+		return;
+	}
+	m_Pages.push_back(page);
+
+	const size_t blockSize = (sizeClass + 1) * s_SizeClassGranularity;
+	const size_t blockCount = s_PageSize / blockSize;
+	for (size_t i = 0; i < blockCount; i++)
+	{
+		FreeBlock* freeBlock = (FreeBlock*)(page + i * blockSize);
+		freeBlock->m_Next = m_FreeLists[sizeClass];
+		m_FreeLists[sizeClass] = freeBlock;
+	}
+}
+
+void LuaAllocator::track(size_t oldSize, size_t newSize)
+{
+	m_LiveBytes = m_LiveBytes - oldSize + newSize;
+	if (m_LiveBytes > m_PeakBytes)
+	{
+		m_PeakBytes = m_LiveBytes;
+	}
+
+	if (newSize > oldSize)
+	{
+		m_Stats.m_AllocatedBytes += newSize - oldSize;
+		m_Stats.m_AllocationCount++;
+		if (s_CurrentScope)
+		{
+			s_CurrentScope->m_AllocatedBytes += newSize - oldSize;
+			s_CurrentScope->m_AllocationCount++;
+		}
+	}
+}
+
+LuaAllocationScope::LuaAllocationScope(LuaAllocationStats* stats)
+    : m_PreviousScope(LuaAllocator::s_CurrentScope)
+{
+	LuaAllocator::s_CurrentScope = stats;
+}
+
+LuaAllocationScope::~LuaAllocationScope()
+{
+	LuaAllocator::s_CurrentScope = m_PreviousScope;
+}
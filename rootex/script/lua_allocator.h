@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Counters of memory allocated by Lua on behalf of a single owner.
+struct LuaAllocationStats
+{
+	/// Total bytes requested from the allocator, including growth of existing blocks.
+	unsigned long long m_AllocatedBytes = 0;
+	/// Number of allocations and reallocations served.
+	unsigned long long m_AllocationCount = 0;
+};
+
+/// Custom lua_Alloc for a single Lua state. Small blocks are served from per size-class free lists carved out of large pages,
+/// larger blocks fall back to the CRT heap. A Lua state is only ever run from one thread at a time, so the allocator is not locked.
+class LuaAllocator
+{
+	/// Blocks up to this size are pooled.
+	static const size_t s_MaxPooledSize = 256;
+	/// Pooled block sizes are multiples of this.
+	static const size_t s_SizeClassGranularity = 16;
+	static const size_t s_SizeClassCount = s_MaxPooledSize / s_SizeClassGranularity;
+	/// Size of each page that pooled blocks are carved from.
+	static const size_t s_PageSize = 64 * 1024;
+
+	/// Allocations made on a thread are also attributed to this, if set. See LuaAllocationScope.
+	static thread_local LuaAllocationStats* s_CurrentScope;
+
+	struct FreeBlock
+	{
+		FreeBlock* m_Next;
+	};
+
+	FreeBlock* m_FreeLists[s_SizeClassCount] = {};
+	Vector<char*> m_Pages;
+
+	LuaAllocationStats m_Stats;
+	size_t m_LiveBytes = 0;
+	size_t m_PeakBytes = 0;
+
+	static size_t GetSizeClass(size_t size) { return (size - 1) / s_SizeClassGranularity; }
+
+	void* allocate(size_t size);
+	void deallocate(void* block, size_t size);
+	void refillFreeList(size_t sizeClass);
+	void track(size_t oldSize, size_t newSize);
+
+	friend class LuaAllocationScope;
+
+public:
+	/// Matches the lua_Alloc signature. Pass the owning LuaAllocator as the userdata.
+	static void* Allocate(void* userData, void* block, size_t oldSize, size_t newSize);
+
+	LuaAllocator() = default;
+	LuaAllocator(LuaAllocator&) = delete;
+	~LuaAllocator();
+
+	const LuaAllocationStats& getStats() const { return m_Stats; }
+	/// Bytes currently held by the Lua state.
+	size_t getLiveBytes() const { return m_LiveBytes; }
+	/// Highest number of bytes ever held by the Lua state.
+	size_t getPeakBytes() const { return m_PeakBytes; }
+	/// Bytes reserved in pages for pooled blocks.
+	size_t getReservedPoolBytes() const { return m_Pages.size() * s_PageSize; }
+};
+
+/// Attributes Lua allocations made on the current thread to a set of counters, till the end of the scope.
+class LuaAllocationScope
+{
+	LuaAllocationStats* m_PreviousScope;
+
+public:
+	LuaAllocationScope(LuaAllocationStats* stats);
+	LuaAllocationScope(LuaAllocationScope&) = delete;
+	~LuaAllocationScope();
+};